@@ -518,6 +518,9 @@ idEntity::idEntity():
 	spawnNode.SetOwner( this );
 	activeNode.SetOwner( this );
 
+	// spawnArgs live exactly as long as the map
+	spawnArgs.SetMemTag( TAG_ENTITY );
+
 	snapshotNode.SetOwner( this );
 	snapshotChanged = -1;
 	snapshotStale = false;
@@ -593,9 +596,26 @@ void idEntity::Spawn()
 	const char*			classname;
 	const char*			scriptObjectName;
 
+	// Spawn runs for every entity on map load so the spawn arg keys are only interned once
+	static const idDictKey	classnameKey( "classname" );
+	static const idDictKey	noGrabKey( "noGrab" );
+	static const idDictKey	skinXrayKey( "skin_xray" );
+	static const idDictKey	cameraTargetKey( "cameraTarget" );
+	static const idDictKey	solidForTeamKey( "solidForTeam" );
+	static const idDictKey	neverDormantKey( "neverDormant" );
+	static const idDictKey	hideKey( "hide" );
+	static const idDictKey	cinematicKey( "cinematic" );
+	static const idDictKey	networkSyncKey( "networkSync" );
+	static const idDictKey	nameKey( "name" );
+	static const idDictKey	healthKey( "health" );
+	static const idDictKey	modelKey( "model" );
+	static const idDictKey	bindKey( "bind" );
+	static const idDictKey	scriptObjectKey( "scriptobject" );
+	static const idDictKey	slowmoKey( "slowmo" );
+
 	gameLocal.RegisterEntity( this, -1, gameLocal.GetSpawnArgs() );
 
-	spawnArgs.GetString( "classname", NULL, &classname );
+	spawnArgs.GetString( classnameKey, NULL, &classname );
 	const idDeclEntityDef* def = gameLocal.FindEntityDef( classname, false );
 	if( def )
 	{
@@ -609,13 +629,13 @@ void idEntity::Spawn()
 
 	renderEntity.entityNum = entityNumber;
 
-	noGrab = spawnArgs.GetBool( "noGrab", "0" );
+	noGrab = spawnArgs.GetBool( noGrabKey );
 
 	xraySkin = NULL;
 	renderEntity.xrayIndex = 1;
 
 	idStr str;
-	if( spawnArgs.GetString( "skin_xray", "", str ) )
+	if( spawnArgs.GetString( skinXrayKey, "", str ) )
 	{
 		xraySkin = declManager->FindSkin( str.c_str() );
 	}
@@ -634,7 +654,7 @@ void idEntity::Spawn()
 	refSound.listenerId = entityNumber + 1;
 
 	cameraTarget = NULL;
-	temp = spawnArgs.GetString( "cameraTarget" );
+	temp = spawnArgs.GetString( cameraTargetKey );
 	if( temp != NULL && temp[0] != '\0' )
 	{
 		// update the camera taget
@@ -646,17 +666,17 @@ void idEntity::Spawn()
 		UpdateGuiParms( renderEntity.gui[ i ], &spawnArgs );
 	}
 
-	fl.solidForTeam = spawnArgs.GetBool( "solidForTeam", "0" );
-	fl.neverDormant = spawnArgs.GetBool( "neverDormant", "0" );
-	fl.hidden = spawnArgs.GetBool( "hide", "0" );
+	fl.solidForTeam = spawnArgs.GetBool( solidForTeamKey );
+	fl.neverDormant = spawnArgs.GetBool( neverDormantKey );
+	fl.hidden = spawnArgs.GetBool( hideKey );
 	if( fl.hidden )
 	{
 		// make sure we're hidden, since a spawn function might not set it up right
 		PostEventMS( &EV_Hide, 0 );
 	}
-	cinematic = spawnArgs.GetBool( "cinematic", "0" );
+	cinematic = spawnArgs.GetBool( cinematicKey );
 
-	networkSync = spawnArgs.FindKey( "networkSync" );
+	networkSync = spawnArgs.FindKey( networkSyncKey );
 	if( networkSync )
 	{
 		fl.networkSync = ( atoi( networkSync->GetValue() ) != 0 );
@@ -674,7 +694,7 @@ void idEntity::Spawn()
 #endif
 
 	// every object will have a unique name
-	temp = spawnArgs.GetString( "name", va( "%s_%s_%d", GetClassname(), spawnArgs.GetString( "classname" ), entityNumber ) );
+	temp = spawnArgs.GetString( nameKey, va( "%s_%s_%d", GetClassname(), spawnArgs.GetString( classnameKey ), entityNumber ) );
 	SetName( temp );
 
 	// if we have targets, wait until all entities are spawned to get them
@@ -691,14 +711,14 @@ void idEntity::Spawn()
 		}
 	}
 
-	health = spawnArgs.GetInt( "health" );
+	health = spawnArgs.GetInt( healthKey );
 
 	InitDefaultPhysics( origin, axis, def );
 
 	SetOrigin( origin );
 	SetAxis( axis );
 
-	temp = spawnArgs.GetString( "model" );
+	temp = spawnArgs.GetString( modelKey );
 	if( temp != NULL && *temp != '\0' )
 	{
 		SetModel( temp );
@@ -716,7 +736,7 @@ void idEntity::Spawn()
 		if( idStr::Icmpn( name.c_str(), "genmodel_", 9 ) == 0 )
 		{
 			// grab the model key from the definition instead
-			temp = def->dict.GetString( "model" );
+			temp = def->dict.GetString( modelKey );
 			if( temp != NULL && *temp != '\0' )
 			{
 				SetModel( temp );
@@ -730,7 +750,7 @@ void idEntity::Spawn()
 	}
 	// RB end
 
-	if( spawnArgs.GetString( "bind", "", &temp ) )
+	if( spawnArgs.GetString( bindKey, "", &temp ) )
 	{
 		PostEventMS( &EV_SpawnBind, 0 );
 	}
@@ -742,7 +762,7 @@ void idEntity::Spawn()
 	}
 
 	// setup script object
-	if( ShouldConstructScriptObjectAtSpawn() && spawnArgs.GetString( "scriptobject", NULL, &scriptObjectName ) )
+	if( ShouldConstructScriptObjectAtSpawn() && spawnArgs.GetString( scriptObjectKey, NULL, &scriptObjectName ) )
 	{
 		if( !scriptObject.SetType( scriptObjectName ) )
 		{
@@ -753,7 +773,7 @@ void idEntity::Spawn()
 	}
 
 	// determine time group
-	DetermineTimeGroup( spawnArgs.GetBool( "slowmo", "1" ) );
+	DetermineTimeGroup( spawnArgs.GetBool( slowmoKey, true ) );
 }
 
 /*
@@ -50,6 +50,7 @@ If you have questions concerning this license or the applicable additional terms
 	idCVar* 					idCVar::staticVars = NULL;
 
 	idCVar com_forceGenericSIMD( "com_forceGenericSIMD", "0", CVAR_BOOL | CVAR_SYSTEM, "force generic platform independent SIMD" );
+	idCVar com_forceSSESIMD( "com_forceSSESIMD", "0", CVAR_BOOL | CVAR_SYSTEM, "force SSE SIMD even if the CPU supports AVX2" );
 
 #endif
 
@@ -311,7 +312,7 @@ void idGameLocal::Init()
 	idCVar::RegisterStaticVars();
 
 	// initialize processor specific SIMD
-	idSIMD::InitProcessor( "game", com_forceGenericSIMD.GetBool() );
+	idSIMD::InitProcessor( "game", com_forceGenericSIMD.GetBool(), com_forceSSESIMD.GetBool() );
 
 #endif
 
@@ -1741,6 +1742,9 @@ void idGameLocal::MapShutdown()
 	clip.Shutdown();
 	idClipModel::ClearTraceModelCache();
 
+	// the path node blocks come from the level region, so they can't be kept for the next map
+	idAI::FreeObstacleAvoidanceNodes();
+
 	common->UpdateLevelLoadPacifier();
 
 	collisionModelManager->FreeMap();		// Fixes an issue where when maps were reloaded the materials wouldn't get their surfaceFlags re-set.  Now we free the map collision model forcing materials to be reparsed.
@@ -2688,9 +2692,9 @@ void idGameLocal::RunFrame( idUserCmdMgr& cmdMgr, gameReturn_t& ret )
 
 #ifdef GAME_DLL
 			// allow changing SIMD usage on the fly
-			if( com_forceGenericSIMD.IsModified() )
+			if( com_forceGenericSIMD.IsModified() || com_forceSSESIMD.IsModified() )
 			{
-				idSIMD::InitProcessor( "game", com_forceGenericSIMD.GetBool() );
+				idSIMD::InitProcessor( "game", com_forceGenericSIMD.GetBool(), com_forceSSESIMD.GetBool() );
 			}
 #endif
 
@@ -3853,6 +3857,12 @@ bool idGameLocal::SpawnEntityDef( const idDict& args, idEntity** ent, bool setDe
 	idStr		error;
 	const char*  name;
 
+	static const idDictKey	nameKey( "name" );
+	static const idDictKey	classnameKey( "classname" );
+	static const idDictKey	slowmoKey( "slowmo" );
+	static const idDictKey	spawnclassKey( "spawnclass" );
+	static const idDictKey	spawnfuncKey( "spawnfunc" );
+
 	if( ent )
 	{
 		*ent = NULL;
@@ -3860,12 +3870,12 @@ bool idGameLocal::SpawnEntityDef( const idDict& args, idEntity** ent, bool setDe
 
 	spawnArgs = args;
 
-	if( spawnArgs.GetString( "name", "", &name ) )
+	if( spawnArgs.GetString( nameKey, "", &name ) )
 	{
 		sprintf( error, " on '%s'", name );
 	}
 
-	spawnArgs.GetString( "classname", NULL, &classname );
+	spawnArgs.GetString( classnameKey, NULL, &classname );
 
 	const idDeclEntityDef* def = FindEntityDef( classname, false );
 
@@ -3877,7 +3887,7 @@ bool idGameLocal::SpawnEntityDef( const idDict& args, idEntity** ent, bool setDe
 
 	spawnArgs.SetDefaults( &def->dict );
 
-	if( !spawnArgs.FindKey( "slowmo" ) )
+	if( !spawnArgs.FindKey( slowmoKey ) )
 	{
 		bool slowmo = true;
 
@@ -3897,7 +3907,7 @@ bool idGameLocal::SpawnEntityDef( const idDict& args, idEntity** ent, bool setDe
 	}
 
 	// check if we should spawn a class object
-	spawnArgs.GetString( "spawnclass", NULL, &spawn );
+	spawnArgs.GetString( spawnclassKey, NULL, &spawn );
 	if( spawn )
 	{
 
@@ -3926,7 +3936,7 @@ bool idGameLocal::SpawnEntityDef( const idDict& args, idEntity** ent, bool setDe
 	}
 
 	// check if we should call a script function to spawn
-	spawnArgs.GetString( "spawnfunc", NULL, &spawn );
+	spawnArgs.GetString( spawnfuncKey, NULL, &spawn );
 	if( spawn )
 	{
 		const function_t* func = program.FindFunction( spawn );
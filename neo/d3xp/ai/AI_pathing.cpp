@@ -91,7 +91,7 @@ void pathNode_s::Init()
 	parent = children[0] = children[1] = next = NULL;
 }
 
-idBlockAlloc<pathNode_t, 128>	pathNodeAllocator;
+idBlockAlloc<pathNode_t, 128, TAG_LEVEL>	pathNodeAllocator;
 
 
 /*
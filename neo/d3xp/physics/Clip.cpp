@@ -63,7 +63,7 @@ typedef struct trmCache_s
 
 idVec3 vec3_boxEpsilon( CM_BOX_EPSILON, CM_BOX_EPSILON, CM_BOX_EPSILON );
 
-idBlockAlloc<clipLink_t, 1024>	clipLinkAllocator;
+idBlockAlloc<clipLink_t, 1024, TAG_PHYSICS_CLIP>	clipLinkAllocator;
 
 
 /*
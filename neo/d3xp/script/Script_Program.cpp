@@ -1349,8 +1349,8 @@ a new one and copies it out.
 */
 idTypeDef* idProgram::GetType( idTypeDef& type, bool allocate )
 {
-
-	for( int i = typesHash.First( idStr::Hash( type.Name() ) ); i != -1; i = typesHash.Next( i ) )
+	idFlatHashIndex::iterator_t it;
+	for( int i = typesHash.First( idStr::Hash( type.Name() ), it ); i != -1; i = typesHash.Next( it ) )
 	{
 		if( types[ i ]->MatchesType( type ) && !strcmp( types[ i ]->Name(), type.Name() ) )
 		{
@@ -1376,8 +1376,8 @@ Returns a preexisting complex type that matches the name, or returns NULL if not
 */
 idTypeDef* idProgram::FindType( const char* name )
 {
-
-	for( int i = typesHash.First( idStr::Hash( name ) ); i != -1; i = typesHash.Next( i ) )
+	idFlatHashIndex::iterator_t it;
+	for( int i = typesHash.First( idStr::Hash( name ), it ); i != -1; i = typesHash.Next( it ) )
 	{
 		idTypeDef* check = types[ i ];
 		if( !strcmp( check->Name(), name ) )
@@ -1397,9 +1397,10 @@ idProgram::GetDefList
 idVarDef* idProgram::GetDefList( const char* name ) const
 {
 	int i, hash;
+	idFlatHashIndex::iterator_t it;
 
 	hash = varDefNameHash.GenerateKey( name, true );
-	for( i = varDefNameHash.First( hash ); i != -1; i = varDefNameHash.Next( i ) )
+	for( i = varDefNameHash.First( hash, it ); i != -1; i = varDefNameHash.Next( it ) )
 	{
 		if( idStr::Cmp( varDefNames[i]->Name(), name ) == 0 )
 		{
@@ -1417,9 +1418,10 @@ idProgram::AddDefToNameList
 void idProgram::AddDefToNameList( idVarDef* def, const char* name )
 {
 	int i, hash;
+	idFlatHashIndex::iterator_t it;
 
 	hash = varDefNameHash.GenerateKey( name, true );
-	for( i = varDefNameHash.First( hash ); i != -1; i = varDefNameHash.Next( i ) )
+	for( i = varDefNameHash.First( hash, it ); i != -1; i = varDefNameHash.Next( it ) )
 	{
 		if( idStr::Cmp( varDefNames[i]->Name(), name ) == 0 )
 		{
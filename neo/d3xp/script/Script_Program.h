@@ -502,9 +502,9 @@ private:
 	idStaticList<function_t, MAX_FUNCS>			functions;
 	idStaticList<statement_t, MAX_STATEMENTS>	statements;
 	idList<idTypeDef*, TAG_SCRIPT>				types;
-	idHashIndex									typesHash;
+	idFlatHashIndex								typesHash;
 	idList<idVarDefName*, TAG_SCRIPT>			varDefNames;
-	idHashIndex									varDefNameHash;
+	idFlatHashIndex								varDefNameHash;
 	idList<idVarDef*, TAG_SCRIPT>				varDefs;
 
 	idVarDef*									sysDef;
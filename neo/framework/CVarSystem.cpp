@@ -534,7 +534,7 @@ public:
 private:
 	bool					initialized;
 	idList<idInternalCVar*, TAG_CVAR>	cvars;
-	idHashIndex				cvarHash;
+	idFlatHashIndex			cvarHash;
 	int						modifiedFlags;
 
 private:
@@ -590,8 +590,9 @@ idCVarSystemLocal::FindInternal
 */
 idInternalCVar* idCVarSystemLocal::FindInternal( const char* name ) const
 {
+	idFlatHashIndex::iterator_t it;
 	int hash = cvarHash.GenerateKey( name, false );
-	for( int i = cvarHash.First( hash ); i != -1; i = cvarHash.Next( i ) )
+	for( int i = cvarHash.First( hash, it ); i != -1; i = cvarHash.Next( it ) )
 	{
 		if( cvars[i]->nameString.Icmp( name ) == 0 )
 		{
@@ -70,6 +70,7 @@ struct version_s
 
 idCVar com_version( "si_version", version.string, CVAR_SYSTEM | CVAR_ROM | CVAR_SERVERINFO, "engine version" );
 idCVar com_forceGenericSIMD( "com_forceGenericSIMD", "0", CVAR_BOOL | CVAR_SYSTEM | CVAR_NOCHEAT, "force generic platform independent SIMD" );
+idCVar com_forceSSESIMD( "com_forceSSESIMD", "0", CVAR_BOOL | CVAR_SYSTEM | CVAR_NOCHEAT, "force SSE SIMD even if the CPU supports AVX2" );
 
 // RB: not allowing the console is a bit harsh for shipping builds
 #if 0 //def ID_RETAIL
@@ -1031,8 +1032,9 @@ idCommonLocal::InitSIMD
 */
 void idCommonLocal::InitSIMD()
 {
-	idSIMD::InitProcessor( "doom", com_forceGenericSIMD.GetBool() );
+	idSIMD::InitProcessor( "doom", com_forceGenericSIMD.GetBool(), com_forceSSESIMD.GetBool() );
 	com_forceGenericSIMD.ClearModified();
+	com_forceSSESIMD.ClearModified();
 }
 
 
@@ -472,6 +472,7 @@ void idCommonLocal::ExecuteMapChange()
 	// Free media from previous level and
 	// note which media we are going to need to load
 	sm = Sys_Milliseconds();
+	Mem_BeginLevel();
 	renderSystem->BeginLevelLoad();
 	soundSystem->BeginLevelLoad();
 	declManager->BeginLevelLoad();
@@ -601,6 +602,7 @@ void idCommonLocal::ExecuteMapChange()
 	declManager->EndLevelLoad();
 	uiManager->EndLevelLoad( currentMapName );
 	fileSystem->EndLevelLoad();
+	Mem_EndLevelLoad();
 
 	if( !mapSpawnData.savegameFile && !IsMultiplayer() )
 	{
@@ -140,6 +140,9 @@ protected:
 	// Set textSource possible with compression.
 	void						SetTextLocal( const char* text, const int length );
 
+	// Reads the text of a decl that was registered from the decl index.
+	void						LoadDeferredText();
+
 private:
 	idDecl* 					self;
 
@@ -152,6 +155,7 @@ private:
 	int							sourceTextLength;		// length of decl text in source file
 	int							sourceLine;				// this is where the actual declaration token starts
 	int							checksum;				// checksum of the decl text
+	bool						textDeferred;			// the text is still only in the source file
 	declType_t					type;					// decl type
 	declState_t					declState;				// decl state
 	int							index;					// index in the per-type list
@@ -164,6 +168,36 @@ private:
 	idDeclLocal* 				nextInFile;				// next decl in the decl file
 };
 
+// text span of a single decl found by scanning a decl file
+struct declSpan_t
+{
+	declType_t					type;
+	idStr						name;
+	int							offset;
+	int							length;
+	int							line;					// line the decl starts on
+	int							endLine;				// line after the closing brace
+	int							checksum;				// checksum of the decl text
+};
+
+// the scan of a decl file only touches this so it can run on a job
+struct declFileScan_t
+{
+	idDeclFile* 				file;
+	idStr						fullPath;				// where the file was found in the search paths
+	ID_TIME_T					timestamp;
+	ID_TIME_T					packTimestamp;			// files in packs have no timestamp, the pack's timestamp and length stand in
+	int							packLength;
+	char* 						buffer;					// NULL when the decls come from the decl index
+	int							length;
+	bool						quiet;					// don't print warnings, they can't be printed from a job
+	bool						loaded;
+	bool						hadWarnings;			// warnings were suppressed, scan again to print them
+	int							checksum;
+	int							numLines;
+	idList< declSpan_t >		decls;
+};
+
 class idDeclFile
 {
 public:
@@ -173,6 +207,13 @@ public:
 	void						Reload( bool force );
 	int							LoadAndParse();
 
+	// LoadAndParse split up so the files of a folder can be scanned in parallel
+	void						Load( declFileScan_t& scan );
+	int							Parse( declFileScan_t& scan );
+
+	// reads the text of all decls registered from the decl index in one go
+	void						LoadDeferredText();
+
 public:
 	idStr						fileName;
 	declType_t					defaultType;
@@ -185,6 +226,33 @@ public:
 	idDeclLocal* 				decls;
 };
 
+/*
+===============================================================================
+
+	Decl index
+
+	Remembers what ScanDeclFile found in every file of a decl folder, so files
+	that didn't change since the last run don't have to be read at startup.
+	The text of those decls is read from the source file on the first parse.
+
+===============================================================================
+*/
+
+class idDeclIndex
+{
+public:
+	bool						Load( const char* indexName, int typesChecksum );
+	void						Write( const char* indexName, int typesChecksum, const idList< declFileScan_t >& scans ) const;
+
+	// fills in the scan from the index if the file is unchanged
+	bool						Find( const char* fileName, declFileScan_t& scan ) const;
+
+private:
+	idStrList					fileNames;
+	idList< declFileScan_t >	files;
+	idHashIndex					fileHash;
+};
+
 class idDeclManagerLocal : public idDeclManager
 {
 	friend class idDeclLocal;
@@ -256,7 +324,7 @@ private:
 	idList<idDeclFolder*, TAG_IDLIB_LIST_DECL>		declFolders;
 
 	idList<idDeclFile*, TAG_IDLIB_LIST_DECL>		loadedFiles;
-	idHashIndex					hashTables[DECL_MAX_TYPES];
+	idFlatHashIndex				hashTables[DECL_MAX_TYPES];
 	idList<idDeclLocal*, TAG_IDLIB_LIST_DECL>		linearLists[DECL_MAX_TYPES];
 	idDeclFile					implicitDecls;	// this holds all the decls that were created because explicit
 	// text definitions were not found. Decls that became default
@@ -266,6 +334,7 @@ private:
 	bool						insideLevelLoad;
 
 	static idCVar				decl_show;
+	static idCVar				decl_useIndex;
 
 private:
 	static void					ListDecls_f( const idCmdArgs& args );
@@ -283,6 +352,7 @@ private:
 };
 
 idCVar idDeclManagerLocal::decl_show( "decl_show", "0", CVAR_SYSTEM, "set to 1 to print parses, 2 to also print references", 0, 2, idCmdSystem::ArgCompletion_Integer<0, 2> );
+idCVar idDeclManagerLocal::decl_useIndex( "decl_useIndex", "1", CVAR_SYSTEM | CVAR_BOOL, "register the decls of unchanged files from generated/decls and read their text on the first parse" );
 
 idDeclManagerLocal	declManagerLocal;
 idDeclManager* 		declManager = &declManagerLocal;
@@ -677,53 +747,87 @@ void idDeclFile::Reload( bool force )
 
 /*
 ================
-idDeclFile::LoadAndParse
+idDeclFile::LoadDeferredText
 
-This is used during both the initial load, and any reloads
+The first decl of a file that needs its text reads the whole file, so every other
+decl of the file gets its text from the same read. The file has to match the checksum
+of the file the decls were registered from, otherwise decls could be missing.
+
+This is called while a decl is parsed, so it must not reload the file. If the file
+changed since the decls were registered they are left without text and defaulted,
+the next reloadDecls parses the file again.
 ================
 */
-int c_savedMemory = 0;
-
-int idDeclFile::LoadAndParse()
+void idDeclFile::LoadDeferredText()
 {
-	int			i, numTypes;
-	idLexer		src;
-	idToken		token;
-	int			startMarker;
-	char* 		buffer;
-	int			length, size;
-	int			sourceLine;
-	idStr		name;
-	idDeclLocal* newDecl;
-	bool		reparse;
+	idStr		fullPath;
+	ID_TIME_T	testTimestamp;
+	int			testLength;
+	char*		buffer = NULL;
+	bool		valid = false;
 
-	// load the text
-	common->DPrintf( "...loading '%s'\n", fileName.c_str() );
-	length = fileSystem->ReadFile( fileName, ( void** )&buffer, &timestamp );
-	if( length == -1 )
+	if( fileSystem->GetFileInfo( fileName, fullPath, testTimestamp, testLength ) && testTimestamp == timestamp && testLength == fileSize )
 	{
-		common->FatalError( "couldn't load %s", fileName.c_str() );
-		return 0;
+		valid = ( fileSystem->ReadFile( fileName, ( void** )&buffer ) == fileSize && MD5_BlockChecksum( buffer, fileSize ) == ( unsigned int )checksum );
 	}
 
-	if( !src.LoadMemory( buffer, length, fileName ) )
+	if( !valid )
 	{
-		common->Error( "Couldn't parse %s", fileName.c_str() );
-		Mem_Free( buffer );
-		return 0;
+		common->Warning( "%s changed after the decls were registered, use reloadDecls to parse it again", fileName.c_str() );
+		// make sure the next reloadDecls doesn't skip the file
+		timestamp = 0;
 	}
 
-	// mark all the defs that were from the last reload of this file
-	for( idDeclLocal* decl = decls; decl; decl = decl->nextInFile )
+	for( idDeclLocal* decl = decls; decl != NULL; decl = decl->nextInFile )
 	{
-		decl->redefinedInReload = false;
+		if( decl->textDeferred )
+		{
+			decl->textDeferred = false;
+			if( valid )
+			{
+				decl->SetTextLocal( buffer + decl->sourceTextOffset, decl->sourceTextLength );
+			}
+			else
+			{
+				decl->textLength = 0;
+			}
+		}
 	}
 
-	src.SetFlags( DECL_LEXER_FLAGS );
+	if( buffer != NULL )
+	{
+		fileSystem->FreeFile( buffer );
+	}
+}
+
+/*
+================
+ScanDeclFile
+
+Finds the type, name and text span of every decl in a loaded decl file. This doesn't
+touch the decl manager, only the decl types are read, so it can run on a job.
+================
+*/
+void ScanDeclFile( declFileScan_t* scan )
+{
+	int			i, numTypes;
+	idLexer		src;
+	idToken		token;
+	int			startMarker;
+	int			sourceLine;
+	declSpan_t	span;
 
-	checksum = MD5_BlockChecksum( buffer, length );
+	scan->decls.Clear();
 
-	fileSize = length;
+	scan->loaded = src.LoadMemory( scan->buffer, scan->length, scan->file->fileName );
+	if( !scan->loaded )
+	{
+		return;
+	}
+
+	src.SetFlags( DECL_LEXER_FLAGS | ( scan->quiet ? ( LEXFL_NOWARNINGS | LEXFL_NOERRORS ) : 0 ) );
+
+	scan->checksum = MD5_BlockChecksum( scan->buffer, scan->length );
 
 	// scan through, identifying each individual declaration
 	while( 1 )
@@ -767,14 +871,14 @@ int idDeclFile::LoadAndParse()
 			else
 			{
 
-				if( defaultType == DECL_MAX_TYPES )
+				if( scan->file->defaultType == DECL_MAX_TYPES )
 				{
 					src.Warning( "No type" );
 					continue;
 				}
 				src.UnreadToken( &token );
 				// use the default type
-				identifiedType = defaultType;
+				identifiedType = scan->file->defaultType;
 			}
 		}
 
@@ -800,7 +904,8 @@ int idDeclFile::LoadAndParse()
 			continue;
 		}
 
-		name = token;
+		span.type = identifiedType;
+		span.name = token;
 
 		// make sure there's a '{'
 		if( !src.ReadToken( &token ) )
@@ -817,18 +922,97 @@ int idDeclFile::LoadAndParse()
 
 		// now take everything until a matched closing brace
 		src.SkipBracedSection();
-		size = src.GetFileOffset() - startMarker;
+
+		span.offset = startMarker;
+		span.length = src.GetFileOffset() - startMarker;
+		span.line = sourceLine;
+		span.endLine = src.GetLineNum();
+		span.checksum = MD5_BlockChecksum( scan->buffer + span.offset, span.length );
+		scan->decls.Append( span );
+	}
+
+	scan->numLines = src.GetLineNum();
+	scan->hadWarnings = src.HadWarning() || src.HadError();
+}
+
+REGISTER_PARALLEL_JOB( ScanDeclFile, "ScanDeclFile" );
+
+/*
+================
+idDeclFile::Load
+================
+*/
+void idDeclFile::Load( declFileScan_t& scan )
+{
+	scan.file = this;
+	scan.quiet = false;
+	scan.loaded = false;
+	scan.hadWarnings = false;
+	scan.checksum = 0;
+	scan.numLines = 0;
+	scan.buffer = NULL;
+
+	// load the text
+	common->DPrintf( "...loading '%s'\n", fileName.c_str() );
+	scan.length = fileSystem->ReadFile( fileName, ( void** )&scan.buffer, &scan.timestamp );
+	if( scan.length == -1 )
+	{
+		common->FatalError( "couldn't load %s", fileName.c_str() );
+	}
+}
+
+/*
+================
+idDeclFile::Parse
+
+Adds the decls found by ScanDeclFile to the decl manager and frees the text.
+================
+*/
+int idDeclFile::Parse( declFileScan_t& scan )
+{
+	idDeclLocal* newDecl;
+	bool		reparse;
+
+	// warnings are suppressed on the jobs, scan the file again to print them
+	if( scan.quiet && scan.hadWarnings )
+	{
+		scan.quiet = false;
+		ScanDeclFile( &scan );
+	}
+
+	if( !scan.loaded )
+	{
+		common->Error( "Couldn't parse %s", fileName.c_str() );
+		Mem_Free( scan.buffer );
+		return 0;
+	}
+
+	// mark all the defs that were from the last reload of this file
+	for( idDeclLocal* decl = decls; decl; decl = decl->nextInFile )
+	{
+		decl->redefinedInReload = false;
+	}
+
+	timestamp = scan.timestamp;
+
+	checksum = scan.checksum;
+
+	fileSize = scan.length;
+
+	for( int i = 0; i < scan.decls.Num(); i++ )
+	{
+		const declSpan_t& span = scan.decls[i];
 
 		// look it up, possibly getting a newly created default decl
 		reparse = false;
-		newDecl = declManagerLocal.FindTypeWithoutParsing( identifiedType, name, false );
+		newDecl = declManagerLocal.FindTypeWithoutParsing( span.type, span.name, false );
 		if( newDecl )
 		{
 			// update the existing copy
 			if( newDecl->sourceFile != this || newDecl->redefinedInReload )
 			{
-				src.Warning( "%s '%s' previously defined at %s:%i", declManagerLocal.GetDeclNameFromType( identifiedType ),
-							 name.c_str(), newDecl->sourceFile->fileName.c_str(), newDecl->sourceLine );
+				common->Warning( "file %s, line %d: %s '%s' previously defined at %s:%i", fileName.c_str(), span.endLine,
+								 declManagerLocal.GetDeclNameFromType( span.type ), span.name.c_str(), newDecl->sourceFile->fileName.c_str(), newDecl->sourceLine );
 				continue;
 			}
 			if( newDecl->declState != DS_UNPARSED )
@@ -839,7 +1023,7 @@ int idDeclFile::LoadAndParse()
 		else
 		{
 			// allow it to be created as a default, then add it to the per-file list
-			newDecl = declManagerLocal.FindTypeWithoutParsing( identifiedType, name, true );
+			newDecl = declManagerLocal.FindTypeWithoutParsing( span.type, span.name, true );
 			newDecl->nextInFile = this->decls;
 			this->decls = newDecl;
 		}
@@ -852,11 +1036,21 @@ int idDeclFile::LoadAndParse()
 			newDecl->textSource = NULL;
 		}
 
-		newDecl->SetTextLocal( buffer + startMarker, size );
+		if( scan.buffer != NULL )
+		{
+			newDecl->SetTextLocal( scan.buffer + span.offset, span.length );
+		}
+		else
+		{
+			// registered from the decl index, the text is read when the decl is parsed
+			newDecl->textDeferred = true;
+			newDecl->textLength = span.length;
+			newDecl->checksum = span.checksum;
+		}
 		newDecl->sourceFile = this;
-		newDecl->sourceTextOffset = startMarker;
-		newDecl->sourceTextLength = size;
-		newDecl->sourceLine = sourceLine;
+		newDecl->sourceTextOffset = span.offset;
+		newDecl->sourceTextLength = span.length;
+		newDecl->sourceLine = span.line;
 		newDecl->declState = DS_UNPARSED;
 
 		// if it is currently in use, reparse it immedaitely
@@ -866,15 +1060,20 @@ int idDeclFile::LoadAndParse()
 		}
 	}
 
-	numLines = src.GetLineNum();
+	numLines = scan.numLines;
 
-	Mem_Free( buffer );
+	if( scan.buffer != NULL )
+	{
+		Mem_Free( scan.buffer );
+		scan.buffer = NULL;
+	}
 
 	// any defs that weren't redefinedInReload should now be defaulted
 	for( idDeclLocal* decl = decls ; decl ; decl = decl->nextInFile )
 	{
 		if( decl->redefinedInReload == false )
 		{
+			decl->textDeferred = false;
 			decl->MakeDefault();
 			decl->sourceTextOffset = decl->sourceFile->fileSize;
 			decl->sourceTextLength = 0;
@@ -885,6 +1084,202 @@ int idDeclFile::LoadAndParse()
 	return checksum;
 }
 
+/*
+================
+idDeclFile::LoadAndParse
+
+This is used during both the initial load, and any reloads
+================
+*/
+int c_savedMemory = 0;
+
+int idDeclFile::LoadAndParse()
+{
+	declFileScan_t scan;
+
+	Load( scan );
+	ScanDeclFile( &scan );
+	return Parse( scan );
+}
+
+/*
+====================================================================================
+
+ idDeclIndex
+
+====================================================================================
+*/
+
+static const byte BDECLS_VERSION = 2;
+static const unsigned int BDECLS_MAGIC = ( 'B' << 24 ) | ( 'D' << 16 ) | ( 'C' << 8 ) | BDECLS_VERSION;
+
+/*
+================
+idDeclIndex::Load
+================
+*/
+bool idDeclIndex::Load( const char* indexName, int typesChecksum )
+{
+	fileNames.Clear();
+	files.Clear();
+	fileHash.Clear();
+
+	idFileLocal file( fileSystem->OpenFileReadMemory( indexName ) );
+	if( file == NULL )
+	{
+		return false;
+	}
+
+	unsigned int magic = 0;
+	file->ReadBig( magic );
+	if( magic != BDECLS_MAGIC )
+	{
+		return false;
+	}
+
+	int loadedTypesChecksum = 0;
+	file->ReadBig( loadedTypesChecksum );
+	if( loadedTypesChecksum != typesChecksum )
+	{
+		return false;
+	}
+
+	int numFiles = 0;
+	file->ReadBig( numFiles );
+	if( numFiles < 0 )
+	{
+		return false;
+	}
+
+	fileNames.SetNum( numFiles );
+	files.SetNum( numFiles );
+	for( int i = 0; i < numFiles; i++ )
+	{
+		declFileScan_t& scan = files[i];
+
+		file->ReadString( fileNames[i] );
+		file->ReadString( scan.fullPath );
+		file->ReadBig( scan.timestamp );
+		file->ReadBig( scan.packTimestamp );
+		file->ReadBig( scan.packLength );
+		file->ReadBig( scan.length );
+		file->ReadBig( scan.checksum );
+		file->ReadBig( scan.numLines );
+		file->ReadBig( scan.hadWarnings );
+
+		int numDecls = 0;
+		if( file->ReadBig( numDecls ) != sizeof( numDecls ) || numDecls < 0 )
+		{
+			files.Clear();
+			fileNames.Clear();
+			return false;
+		}
+
+		scan.file = NULL;
+		scan.buffer = NULL;
+		scan.quiet = false;
+		scan.loaded = true;
+		scan.decls.SetNum( numDecls );
+		for( int j = 0; j < numDecls; j++ )
+		{
+			declSpan_t& span = scan.decls[j];
+
+			int type = 0;
+			file->ReadBig( type );
+			span.type = ( declType_t )type;
+			file->ReadString( span.name );
+			file->ReadBig( span.offset );
+			file->ReadBig( span.length );
+			file->ReadBig( span.line );
+			file->ReadBig( span.endLine );
+			file->ReadBig( span.checksum );
+		}
+
+		fileHash.Add( fileHash.GenerateKey( fileNames[i], false ), i );
+	}
+
+	return true;
+}
+
+/*
+================
+idDeclIndex::Write
+================
+*/
+void idDeclIndex::Write( const char* indexName, int typesChecksum, const idList< declFileScan_t >& scans ) const
+{
+	idFileLocal file( fileSystem->OpenFileWrite( indexName ) );
+	if( file == NULL )
+	{
+		common->Warning( "couldn't write %s", indexName );
+		return;
+	}
+
+	file->WriteBig( BDECLS_MAGIC );
+	file->WriteBig( typesChecksum );
+	file->WriteBig( scans.Num() );
+	for( int i = 0; i < scans.Num(); i++ )
+	{
+		const declFileScan_t& scan = scans[i];
+
+		file->WriteString( scan.file->fileName );
+		file->WriteString( scan.fullPath );
+		file->WriteBig( scan.timestamp );
+		file->WriteBig( scan.packTimestamp );
+		file->WriteBig( scan.packLength );
+		file->WriteBig( scan.length );
+		file->WriteBig( scan.checksum );
+		file->WriteBig( scan.numLines );
+		file->WriteBig( scan.hadWarnings );
+		file->WriteBig( scan.decls.Num() );
+		for( int j = 0; j < scan.decls.Num(); j++ )
+		{
+			const declSpan_t& span = scan.decls[j];
+
+			file->WriteBig( ( int )span.type );
+			file->WriteString( span.name );
+			file->WriteBig( span.offset );
+			file->WriteBig( span.length );
+			file->WriteBig( span.line );
+			file->WriteBig( span.endLine );
+			file->WriteBig( span.checksum );
+		}
+	}
+}
+
+/*
+================
+idDeclIndex::Find
+
+The full path makes sure the same file is still found first in the search paths, so
+adding or removing a mod doesn't use the decls of a file that is hidden now. Files in
+packs are only trusted while the pack keeps its timestamp and length.
+================
+*/
+bool idDeclIndex::Find( const char* fileName, declFileScan_t& scan ) const
+{
+	for( int i = fileHash.First( fileHash.GenerateKey( fileName, false ) ); i != -1; i = fileHash.Next( i ) )
+	{
+		if( fileNames[i].Icmp( fileName ) != 0 )
+		{
+			continue;
+		}
+
+		const declFileScan_t& entry = files[i];
+		if( entry.hadWarnings || entry.timestamp != scan.timestamp || entry.length != scan.length || entry.fullPath.Cmp( scan.fullPath ) != 0 ||
+				entry.packTimestamp != scan.packTimestamp || entry.packLength != scan.packLength )
+		{
+			return false;
+		}
+
+		idDeclFile* declFile = scan.file;
+		scan = entry;
+		scan.file = declFile;
+		return true;
+	}
+	return false;
+}
+
 /*
 ====================================================================================
 
@@ -1191,7 +1586,33 @@ void idDeclManagerLocal::RegisterDeclFolder( const char* folder, const char* ext
 	// scan for decl files
 	fileList = fileSystem->ListFiles( declFolder->folder, declFolder->extension, true );
 
-	// load and parse decl files
+	// the index is only valid for the decl types it was written with
+	idStr typeNames;
+	for( i = 0; i < declTypes.Num(); i++ )
+	{
+		if( declTypes[i] != NULL )
+		{
+			typeNames += va( "%s %d ", declTypes[i]->typeName.c_str(), declTypes[i]->type );
+		}
+	}
+	typeNames += va( "%d", defaultType );
+	const int typesChecksum = MD5_BlockChecksum( typeNames.c_str(), typeNames.Length() );
+
+	idStr indexName = declFolder->folder + "_" + ( declFolder->extension.c_str() + ( declFolder->extension[0] == '.' ? 1 : 0 ) );
+	indexName.Replace( "/", "_" );
+	indexName = "generated/decls/" + indexName + ".bdecls";
+
+	idDeclIndex declIndex;
+	bool writeIndex = false;
+	if( decl_useIndex.GetBool() )
+	{
+		writeIndex = !declIndex.Load( indexName, typesChecksum );
+	}
+
+	// load the decl files, file system access has to stay on this thread
+	idList< declFileScan_t > scans;
+	idList< int > pendingScans;
+	scans.SetNum( fileList->GetNumFiles() );
 	for( i = 0; i < fileList->GetNumFiles(); i++ )
 	{
 		fileName = declFolder->folder + "/" + fileList->GetFile( i );
@@ -1213,7 +1634,65 @@ void idDeclManagerLocal::RegisterDeclFolder( const char* folder, const char* ext
 			df = new( TAG_DECL ) idDeclFile( fileName, defaultType );
 			loadedFiles.Append( df );
 		}
-		df->LoadAndParse();
+
+		scans[i].packTimestamp = 0;
+		scans[i].packLength = 0;
+
+		// files that are already loaded are always parsed again like a reload
+		if( decl_useIndex.GetBool() && df->decls == NULL )
+		{
+			// only stat the file, an unchanged file is never opened
+			scans[i].file = df;
+			if( fileSystem->GetFileInfo( fileName, scans[i].fullPath, scans[i].timestamp, scans[i].length ) )
+			{
+				// the full path of a file in a pack is the path of the pack
+				if( scans[i].timestamp == 0 && !Sys_FileStat( scans[i].fullPath, scans[i].packTimestamp, scans[i].packLength ) )
+				{
+					scans[i].packTimestamp = 0;
+					scans[i].packLength = 0;
+				}
+				if( declIndex.Find( fileName, scans[i] ) )
+				{
+					continue;
+				}
+			}
+			writeIndex = true;
+		}
+
+		df->Load( scans[i] );
+		scans[i].quiet = true;
+		pendingScans.Append( i );
+	}
+
+	// find the decls in all files at once
+	if( pendingScans.Num() > 1 && parallelJobManager->GetNumProcessingUnits() > 0 )
+	{
+		idParallelJobList* jobList = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, pendingScans.Num(), 0, NULL );
+		for( i = 0; i < pendingScans.Num(); i++ )
+		{
+			jobList->AddJob( ( jobRun_t )ScanDeclFile, &scans[ pendingScans[i] ] );
+		}
+		jobList->Submit();
+		jobList->Wait();
+		parallelJobManager->FreeJobList( jobList );
+	}
+	else
+	{
+		for( i = 0; i < pendingScans.Num(); i++ )
+		{
+			ScanDeclFile( &scans[ pendingScans[i] ] );
+		}
+	}
+
+	// add the decls in file order so the result is the same as loading the files one by one
+	for( i = 0; i < scans.Num(); i++ )
+	{
+		scans[i].file->Parse( scans[i] );
+	}
+
+	if( writeIndex )
+	{
+		declIndex.Write( indexName, typesChecksum, scans );
 	}
 
 	fileSystem->FreeFileList( fileList );
@@ -1569,6 +2048,7 @@ void idDeclManagerLocal::PrintType( const idCmdArgs& args, declType_t type )
 	common->Printf( "%s %s:\n", declTypes[ type ]->typeName.c_str(), decl->name.c_str() );
 	common->Printf( "source: %s:%i\n", decl->sourceFile->fileName.c_str(), decl->sourceLine );
 	common->Printf( "----------\n" );
+	decl->LoadDeferredText();
 	if( decl->textSource != NULL )
 	{
 		char* declText = ( char* )_alloca( decl->textLength + 1 );
@@ -1637,8 +2117,9 @@ idDecl* idDeclManagerLocal::CreateNewDecl( declType_t type, const char* name, co
 	fileName.BackSlashesToSlashes();
 
 	// see if it already exists
+	idFlatHashIndex::iterator_t it;
 	hash = hashTables[typeIndex].GenerateKey( canonicalName, false );
-	for( i = hashTables[typeIndex].First( hash ); i >= 0; i = hashTables[typeIndex].Next( i ) )
+	for( i = hashTables[typeIndex].First( hash, it ); i >= 0; i = hashTables[typeIndex].Next( it ) )
 	{
 		if( linearLists[typeIndex][i]->name.Icmp( canonicalName ) == 0 )
 		{
@@ -1723,8 +2204,9 @@ bool idDeclManagerLocal::RenameDecl( declType_t type, const char* oldName, const
 	// make sure it already exists
 	int typeIndex = ( int )type;
 	int i, hash;
+	idFlatHashIndex::iterator_t it;
 	hash = hashTables[typeIndex].GenerateKey( canonicalOldName, false );
-	for( i = hashTables[typeIndex].First( hash ); i >= 0; i = hashTables[typeIndex].Next( i ) )
+	for( i = hashTables[typeIndex].First( hash, it ); i >= 0; i = hashTables[typeIndex].Next( it ) )
 	{
 		if( linearLists[typeIndex][i]->name.Icmp( canonicalOldName ) == 0 )
 		{
@@ -4166,8 +4648,9 @@ idDeclLocal* idDeclManagerLocal::FindTypeWithoutParsing( declType_t type, const
 	MakeNameCanonical( name, canonicalName, sizeof( canonicalName ) );
 
 	// see if it already exists
+	idFlatHashIndex::iterator_t it;
 	hash = hashTables[typeIndex].GenerateKey( canonicalName, false );
-	for( i = hashTables[typeIndex].First( hash ); i >= 0; i = hashTables[typeIndex].Next( i ) )
+	for( i = hashTables[typeIndex].First( hash, it ); i >= 0; i = hashTables[typeIndex].Next( it ) )
 	{
 		if( linearLists[typeIndex][i]->name.Icmp( canonicalName ) == 0 )
 		{
@@ -4192,6 +4675,7 @@ idDeclLocal* idDeclManagerLocal::FindTypeWithoutParsing( declType_t type, const
 	decl->declState = DS_UNPARSED;
 	decl->textSource = NULL;
 	decl->textLength = 0;
+	decl->textDeferred = false;
 	decl->sourceFile = &implicitDecls;
 	decl->referencedThisLevel = false;
 	decl->everReferenced = false;
@@ -4414,6 +4898,7 @@ idDeclLocal::idDeclLocal()
 	sourceTextLength = 0;
 	sourceLine = 0;
 	checksum = 0;
+	textDeferred = false;
 	type = DECL_ENTITYDEF;
 	index = 0;
 	declState = DS_UNPARSED;
@@ -4544,6 +5029,8 @@ idDeclLocal::GetText
 */
 void idDeclLocal::GetText( char* text ) const
 {
+	const_cast< idDeclLocal* >( this )->LoadDeferredText();
+
 #ifdef USE_COMPRESSED_DECLS
 	HuffmanDecompressText( text, textLength, ( byte* )textSource, compressedLength );
 #else
@@ -4580,6 +5067,7 @@ void idDeclLocal::SetTextLocal( const char* text, const int length )
 {
 
 	Mem_Free( textSource );
+	textDeferred = false;
 
 	checksum = MD5_BlockChecksum( text, length );
 
@@ -4605,6 +5093,23 @@ void idDeclLocal::SetTextLocal( const char* text, const int length )
 	textLength = length;
 }
 
+/*
+=================
+idDeclLocal::LoadDeferredText
+
+Decls registered from the decl index only know where their text is in the source file.
+=================
+*/
+void idDeclLocal::LoadDeferredText()
+{
+	if( !textDeferred )
+	{
+		return;
+	}
+	sourceFile->LoadDeferredText();
+	assert( !textDeferred );
+}
+
 /*
 =================
 idDeclLocal::ReplaceSourceFileText
@@ -4623,6 +5128,8 @@ bool idDeclLocal::ReplaceSourceFileText()
 		return false;
 	}
 
+	LoadDeferredText();
+
 	// get length and allocate buffer to hold the file
 	oldFileLength = sourceFile->fileSize;
 	newFileLength = oldFileLength - sourceTextLength + textLength;
@@ -4857,6 +5364,8 @@ void idDeclLocal::ParseLocal()
 
 	declManagerLocal.MediaPrint( "parsing %s %s\n", declManagerLocal.declTypes[type]->typeName.c_str(), name.c_str() );
 
+	LoadDeferredText();
+
 	// if no text source try to generate default text
 	if( textSource == NULL )
 	{
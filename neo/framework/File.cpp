@@ -1893,6 +1893,7 @@ idFile_InnerResource::idFile_InnerResource( const char* _name, idFile* rezFile,
 	resourceFile = rezFile;
 	internalFilePos = 0;
 	resourceBuffer = NULL;
+	ownsResourceFile = false;
 }
 
 /*
@@ -1906,6 +1907,10 @@ idFile_InnerResource::~idFile_InnerResource()
 	{
 		fileSystem->FreeResourceBuffer();
 	}
+	if( ownsResourceFile )
+	{
+		delete resourceFile;
+	}
 }
 
 /*
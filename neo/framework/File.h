@@ -403,6 +403,11 @@ public:
 		resourceBuffer = buf;
 		internalFilePos = 0;
 	}
+	// the resource file is deleted with this file
+	void					TakeResourceFileOwnership()
+	{
+		ownsResourceFile = true;
+	}
 
 private:
 	idStr				name;				// name of the file in the pak
@@ -411,6 +416,7 @@ private:
 	idFile* 			resourceFile;		// actual file
 	int					internalFilePos;	// seek offset
 	byte* 				resourceBuffer;		// if using the temp save memory
+	bool				ownsResourceFile;	// private handle to the resource file
 };
 
 /*
@@ -134,6 +134,7 @@ struct searchpath_t
 // search flags when opening a file
 #define FSFLAG_SEARCH_DIRS		( 1 << 0 )
 #define FSFLAG_RETURN_FILE_MEM	( 1 << 1 )
+#define FSFLAG_RETURN_FILE_PRIVATE	( 1 << 2 )	// the file can be read on another thread, nothing shares its handle
 
 class idFileSystemLocal : public idFileSystem
 {
@@ -154,6 +155,9 @@ public:
 	virtual void			CreateOSPath( const char* OSPath );
 	virtual int				ReadFile( const char* relativePath, void** buffer, ID_TIME_T* timestamp );
 	virtual void			FreeFile( void* buffer );
+	virtual fsAsyncHandle_t	ReadFileAsync( const char* relativePath, fsAsyncPriority_t priority, fsAsyncCallback_t callback, void* userData );
+	virtual fsAsyncState_t	FinishReadAsync( fsAsyncHandle_t handle, void** buffer, int* length, bool wait );
+	virtual void			CancelReadAsync( fsAsyncHandle_t handle );
 	virtual int				WriteFile( const char* relativePath, const void* buffer, int size, const char* basePath = "fs_savepath" );
 	virtual void			RemoveFile( const char* relativePath );
 	virtual	bool			RemoveDir( const char* relativePath );
@@ -173,6 +177,7 @@ public:
 	virtual findFile_t		FindFile( const char* path );
 	virtual bool			FilenameCompare( const char* s1, const char* s2 ) const;
 	virtual int				GetFileLength( const char* relativePath );
+	virtual bool			GetFileInfo( const char* relativePath, idStr& fullPath, ID_TIME_T& timestamp, int& length );
 	virtual sysFolder_t		IsFolder( const char* relativePath, const char* basePath = "fs_basepath" );
 	// resource tracking
 	virtual void			EnableBackgroundCache( bool enable );
@@ -210,7 +215,7 @@ public:
 
 	virtual void			StartPreload( const idStrList& _preload );
 	virtual void			StopPreload();
-	idFile* 				GetResourceFile( const char* fileName, bool memFile );
+	idFile* 				GetResourceFile( const char* fileName, bool memFile, bool privateFile = false );
 	bool					GetResourceCacheEntry( const char* fileName, idResourceCacheEntry& rc );
 	virtual int				ReadFromBGL( idFile* _resourceFile, void* _buffer, int _offset, int _len );
 	virtual bool			IsBinaryModel( const idStr& resName ) const;
@@ -255,6 +260,7 @@ public:
 	static void				ExtractResourceFile_f( const idCmdArgs& args );
 	static void				UpdateResourceFile_f( const idCmdArgs& args );
 	static void				GenerateResourceCRCs_f( const idCmdArgs& args );
+	static void				TestResourceFile_f( const idCmdArgs& args );
 	static void				CreateCRCsForResourceFileList( const idFileList& list );
 
 	void					BuildOrderedStartupContainer();
@@ -282,6 +288,36 @@ private:
 	int		resourceBufferAvailable;
 	int		numFilesOpenedAsCached;
 
+	// the entries of all resource containers, only the one that takes precedence for every file name
+	idList< const idResourceCacheEntry* > resourceIndex;
+	idFlatHashIndex			resourceIndexHash;
+	int						resourceLookupCount = 0;		// lookups timed with fs_debugResources
+	double					resourceLookupTicks = 0.0;
+
+	idAsyncFileReader		asyncReader;
+
+	// access order recording and read-ahead
+	struct readAheadSpan_t
+	{
+		idStr				container;			// OS path of the resource file
+		int					offset;
+		int					length;
+		int					lastResource;		// index in readAheadNames of the last resource in the span
+	};
+	static const int		READAHEAD_WINDOW = 4;			// spans in flight
+	static const int		READAHEAD_MAX_SPAN = 1024 * 1024;
+	static const int		READAHEAD_MERGE_GAP = 64 * 1024;	// smaller holes are read instead of skipped
+
+	idSysMutex				readAheadMutex;		// resources are opened from the job and I/O threads too
+	idAccessManifest		accessRecord;
+	idStr					accessRecordName;
+	bool					accessRecording = false;
+	idStrList				readAheadNames;
+	idFlatHashIndex			readAheadHash;
+	idList< readAheadSpan_t > readAheadSpans;
+	int						readAheadNext = 0;
+	idList< fsAsyncHandle_t > readAheadHandles;
+
 	// RB: shortcut
 	bool	resourceFilesFound = false;
 	bool	zipFilesFound = false;
@@ -315,6 +351,8 @@ private:
 	void					RemoveResourceFileByIndex( const idVec2i& idx );
 	void					RemoveResourceFile( const char* resourceFileName );
 	idVec2i					FindResourceFile( const char* resourceFileName );
+	void					RebuildResourceIndex();
+	int						FindResourceIndex( const char* canonical, const int key ) const;
 
 	void					SetupGameDirectories( const char* gameName );
 	void					Startup();
@@ -322,8 +360,15 @@ private:
 	void					ReOpenCacheFiles();
 
 	// RB: PK4 support
-	idFile* 				GetZipFile( const char* fileName, bool memFile );
+	idFile* 				GetZipFile( const char* fileName, bool memFile, bool privateFile = false );
 	bool					GetZipCacheEntry( const char* fileName, idZipCacheEntry& rc );
+
+	bool					GetPackFileInfo( const char* relativePath, idStr& fullPath, ID_TIME_T& timestamp, int& length );
+
+	void					RecordAccess( const idResourceCacheEntry& rc );
+	void					WriteAccessRecord();
+	void					PumpReadAhead( int accessedResource );
+	int						FindReadAhead( const char* resourceName ) const;
 };
 
 idCVar	idFileSystemLocal::fs_debug( "fs_debug", "0", CVAR_SYSTEM | CVAR_INTEGER, "", 0, 2, idCmdSystem::ArgCompletion_Integer<0, 2> );
@@ -339,6 +384,10 @@ idCVar	fs_basepath( "fs_basepath", "", CVAR_SYSTEM | CVAR_INIT, "" );
 idCVar	fs_savepath( "fs_savepath", "", CVAR_SYSTEM | CVAR_INIT, "" );
 idCVar	fs_resourceLoadPriority( "fs_resourceLoadPriority", "0", CVAR_SYSTEM , "if 1, open requests will be honored from resource files first; if 0, the resource files are checked after normal search paths" );
 idCVar	fs_enableBackgroundCaching( "fs_enableBackgroundCaching", "1", CVAR_SYSTEM , "if 1 allow the 360 to precache game files in the background" );
+idCVar	fs_mapResources( "fs_mapResources", "1", CVAR_SYSTEM | CVAR_BOOL | CVAR_INIT, "memory map .resources files and read their entries straight from the mapping" );
+idCVar	fs_recordAccessOrder( "fs_recordAccessOrder", "0", CVAR_SYSTEM | CVAR_BOOL, "record the order resource files are first opened in while a map is played and write it to maps/<map>.access" );
+idCVar	fs_readAhead( "fs_readAhead", "1", CVAR_SYSTEM | CVAR_BOOL, "prefetch the resources listed in maps/<map>.access in order on the I/O threads" );
+idCVar	fs_compressResources( "fs_compressResources", "0", CVAR_SYSTEM | CVAR_BOOL, "write version 2 .resources files with block compressed entries" );
 
 idFileSystemLocal	fileSystemLocal;
 idFileSystem* 		fileSystem = &fileSystemLocal;
@@ -360,10 +409,71 @@ int idFileSystemLocal::ReadFromBGL( idFile* _resourceFile, void* _buffer, int _o
 /*
 ================
 idFileSystemLocal::StartPreload
+
+Reads the container ranges of the given resources in order on the I/O threads and
+throws the data away, so the loads that follow find it in the OS cache. Ranges that
+are close together in the same container are read as one span.
 ================
 */
 void idFileSystemLocal::StartPreload( const idStrList& _preload )
 {
+	StopPreload();
+
+	if( !fs_readAhead.GetBool() || !UsingResourceFiles() || asyncReader.NumThreads() == 0 )
+	{
+		return;
+	}
+
+	idScopedCriticalSection lock( readAheadMutex );
+
+	idResourceCacheEntry rc;
+	for( int i = 0; i < _preload.Num(); i++ )
+	{
+		if( !GetResourceCacheEntry( _preload[ i ], rc ) || rc.owner->resourceFile == NULL )
+		{
+			continue;
+		}
+
+		int offset;
+		int length;
+		rc.owner->GetEntryRange( rc, offset, length );
+		const char* container = rc.owner->resourceFile->GetFullPath();
+		if( length <= 0 || container[0] == '\0' )
+		{
+			continue;
+		}
+
+		const int resource = readAheadNames.Append( rc.filename );
+		readAheadHash.Add( idFlatHashIndex::GenerateKey( rc.filename, false ), resource );
+
+		if( readAheadSpans.Num() > 0 )
+		{
+			readAheadSpan_t& span = readAheadSpans[ readAheadSpans.Num() - 1 ];
+			const int spanEnd = span.offset + span.length;
+			if( offset >= spanEnd && offset - spanEnd <= READAHEAD_MERGE_GAP && offset + length - span.offset <= READAHEAD_MAX_SPAN && span.container.Icmp( container ) == 0 )
+			{
+				span.length = offset + length - span.offset;
+				span.lastResource = resource;
+				continue;
+			}
+		}
+
+		for( int start = 0; start < length; start += READAHEAD_MAX_SPAN )
+		{
+			readAheadSpan_t& span = readAheadSpans.Alloc();
+			span.container = container;
+			span.offset = offset + start;
+			span.length = Min( READAHEAD_MAX_SPAN, length - start );
+			span.lastResource = resource;
+		}
+	}
+
+	if( fs_debugResources.GetBool() )
+	{
+		idLib::Printf( "RES: read-ahead of %d resources in %d spans\n", readAheadNames.Num(), readAheadSpans.Num() );
+	}
+
+	PumpReadAhead( -1 );
 }
 
 /*
@@ -373,6 +483,118 @@ idFileSystemLocal::StopPreload
 */
 void idFileSystemLocal::StopPreload()
 {
+	idScopedCriticalSection lock( readAheadMutex );
+
+	for( int i = 0; i < readAheadHandles.Num(); i++ )
+	{
+		asyncReader.Cancel( readAheadHandles[ i ] );
+	}
+	readAheadHandles.Clear();
+	readAheadSpans.Clear();
+	readAheadNames.Clear();
+	readAheadHash.Clear();
+	readAheadNext = 0;
+}
+
+/*
+================
+idFileSystemLocal::PumpReadAhead
+
+Keeps READAHEAD_WINDOW spans in flight, called whenever a resource is opened. Spans
+with resources before the one just opened are skipped, the game is already past them.
+Must be called with readAheadMutex held.
+================
+*/
+void idFileSystemLocal::PumpReadAhead( int accessedResource )
+{
+	for( int i = readAheadHandles.Num() - 1; i >= 0; i-- )
+	{
+		// only the OS cache needs the data
+		if( asyncReader.Finish( readAheadHandles[ i ], NULL, NULL, false ) != FS_ASYNC_PENDING )
+		{
+			readAheadHandles.RemoveIndexFast( i );
+		}
+	}
+
+	while( readAheadNext < readAheadSpans.Num() && readAheadSpans[ readAheadNext ].lastResource < accessedResource )
+	{
+		readAheadNext++;
+	}
+
+	while( readAheadHandles.Num() < READAHEAD_WINDOW && readAheadNext < readAheadSpans.Num() )
+	{
+		const readAheadSpan_t& span = readAheadSpans[ readAheadNext++ ];
+		idFile* rezFile = OpenExplicitFileRead( span.container );
+		if( rezFile == NULL )
+		{
+			continue;
+		}
+		idFile_InnerResource* file = new idFile_InnerResource( span.container, rezFile, span.offset, span.length );
+		file->TakeResourceFileOwnership();
+		readAheadHandles.Append( asyncReader.Submit( file, FS_ASYNC_PRIORITY_LOW, NULL, NULL ) );
+	}
+}
+
+/*
+================
+idFileSystemLocal::FindReadAhead
+================
+*/
+int idFileSystemLocal::FindReadAhead( const char* resourceName ) const
+{
+	idFlatHashIndex::iterator_t it;
+	for( int i = readAheadHash.First( idFlatHashIndex::GenerateKey( resourceName, false ), it ); i != idFlatHashIndex::NULL_INDEX; i = readAheadHash.Next( it ) )
+	{
+		if( readAheadNames[ i ].Icmp( resourceName ) == 0 )
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+================
+idFileSystemLocal::RecordAccess
+
+Must be called with readAheadMutex held.
+================
+*/
+void idFileSystemLocal::RecordAccess( const idResourceCacheEntry& rc )
+{
+	int offset;
+	int length;
+	rc.owner->GetEntryRange( rc, offset, length );
+	accessRecord.Add( rc.owner->GetFileName(), rc.filename, offset, length );
+}
+
+/*
+================
+idFileSystemLocal::WriteAccessRecord
+
+Writes the first accesses of the map that was played, the file is picked up by
+the next load of the map and by the resource pack builder.
+================
+*/
+void idFileSystemLocal::WriteAccessRecord()
+{
+	idScopedCriticalSection lock( readAheadMutex );
+
+	if( !accessRecording )
+	{
+		return;
+	}
+	accessRecording = false;
+
+	if( accessRecord.NumResources() > 0 )
+	{
+		idStrStatic< MAX_OSPATH > accessName = "maps/";
+		accessName += accessRecordName;
+		accessName += ".access";
+		accessRecord.WriteManifest( accessName );
+		common->Printf( "Wrote the access order of %d resources to %s\n", accessRecord.NumResources(), accessName.c_str() );
+	}
+	accessRecord.Clear();
 }
 
 /*
@@ -490,6 +712,97 @@ int idFileSystemLocal::GetFileLength( const char* relativePath )
 	return len;
 }
 
+/*
+========================
+idFileSystemLocal::GetPackFileInfo
+
+Files in .pk4 and .resources files report no timestamp, like the files opened from them.
+========================
+*/
+bool idFileSystemLocal::GetPackFileInfo( const char* relativePath, idStr& fullPath, ID_TIME_T& timestamp, int& length )
+{
+	// RB: .pk4 files have a higher priority than .resources because they are aimed for modding
+	if( UsingZipFiles() )
+	{
+		idZipCacheEntry rc;
+		if( GetZipCacheEntry( relativePath, rc ) )
+		{
+			fullPath = rc.owner->GetFileName();
+			timestamp = 0;
+			length = rc.length;
+			return true;
+		}
+	}
+
+	if( UsingResourceFiles() )
+	{
+		idResourceCacheEntry rc;
+		if( GetResourceCacheEntry( relativePath, rc ) )
+		{
+			fullPath = rc.owner->resourceFile->GetFullPath();
+			timestamp = 0;
+			length = rc.length;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+========================
+idFileSystemLocal::GetFileInfo
+
+Follows the search order of OpenFileReadFlags, but only stats the files in the search paths.
+========================
+*/
+bool idFileSystemLocal::GetFileInfo( const char* relativePath, idStr& fullPath, ID_TIME_T& timestamp, int& length )
+{
+	if( !IsInitialized() )
+	{
+		idLib::FatalError( "Filesystem call made without initialization" );
+	}
+
+	if( !relativePath || !relativePath[0] )
+	{
+		idLib::Warning( "idFileSystemLocal::GetFileInfo with empty name" );
+		return false;
+	}
+
+	// qpaths are not supposed to have a leading slash
+	if( relativePath[0] == '/' || relativePath[0] == '\\' )
+	{
+		relativePath++;
+	}
+
+	if( strstr( relativePath, ".." ) || strstr( relativePath, "::" ) || relativePath[0] == '\0' )
+	{
+		return false;
+	}
+
+	if( fs_resourceLoadPriority.GetInteger() == 1 && GetPackFileInfo( relativePath, fullPath, timestamp, length ) )
+	{
+		return true;
+	}
+
+	for( int sp = searchPaths.Num() - 1; sp >= 0; sp-- )
+	{
+		idStr netpath = BuildOSPath( searchPaths[sp].path, searchPaths[sp].gamedir, relativePath );
+		if( Sys_FileStat( netpath, timestamp, length ) )
+		{
+			fullPath = netpath;
+			return true;
+		}
+	}
+
+	if( fs_resourceLoadPriority.GetInteger() == 0 && GetPackFileInfo( relativePath, fullPath, timestamp, length ) )
+	{
+		return true;
+	}
+
+	return false;
+}
+
 /*
 ================
 idFileSystemLocal::OpenOSFile
@@ -720,6 +1033,10 @@ void idFileSystemLocal::BeginLevelLoad( const char* name, char* _blockBuffer, in
 		return;
 	}
 
+	// the previous map is done
+	StopPreload();
+	WriteAccessRecord();
+
 	resourceBufferPtr = ( byte* )_blockBuffer;
 	resourceBufferAvailable = _blockBufferSize;
 	resourceBufferSize = _blockBufferSize;
@@ -737,8 +1054,26 @@ void idFileSystemLocal::BeginLevelLoad( const char* name, char* _blockBuffer, in
 	if( UsingResourceFiles() )
 	{
 		AddResourceFile( va( "%s.resources", manifestName.c_str() ) );
-	}
 
+		idAccessManifest accessOrder;
+		if( fs_readAhead.GetBool() && accessOrder.LoadManifest( va( "maps/%s.access", manifestName.c_str() ) ) )
+		{
+			idStrList readAhead;
+			readAhead.SetGranularity( 2048 );
+			for( int i = 0; i < accessOrder.NumResources(); i++ )
+			{
+				readAhead.Append( accessOrder.GetResourceNameByIndex( i ) );
+			}
+			StartPreload( readAhead );
+		}
+
+		if( fs_recordAccessOrder.GetBool() )
+		{
+			idScopedCriticalSection lock( readAheadMutex );
+			accessRecordName = manifestName;
+			accessRecording = true;
+		}
+	}
 }
 
 /*
@@ -1442,6 +1777,13 @@ void idFileSystemLocal::WriteResourcePacks()
 		filesCommonToAllMaps.Append( idStr( "maps/" ) + work[ i ] );
 	}
 
+	// the recorded access orders only name the resources, the ranges are looked up again when a map loads
+	ListOSFiles( path, "*.access", work );
+	for( int i = 0; i < work.Num(); i++ )
+	{
+		filesCommonToAllMaps.Append( idStr( "maps/" ) + work[ i ] );
+	}
+
 	filesCommonToAllMaps.Append( "_common.preload" );
 
 	// write out common models, images and sounds to separate containers
@@ -2130,6 +2472,75 @@ void idFileSystemLocal::FreeFile( void* buffer )
 	Mem_Free( buffer );
 }
 
+/*
+============
+idFileSystemLocal::ReadFileAsync
+
+The file is opened here so the search path rules stay on the calling thread,
+only the read itself happens on the I/O threads
+============
+*/
+fsAsyncHandle_t idFileSystemLocal::ReadFileAsync( const char* relativePath, fsAsyncPriority_t priority, fsAsyncCallback_t callback, void* userData )
+{
+	if( !IsInitialized() )
+	{
+		common->FatalError( "Filesystem call made without initialization\n" );
+	}
+
+	if( relativePath == NULL || !relativePath[0] )
+	{
+		common->FatalError( "idFileSystemLocal::ReadFileAsync with empty name\n" );
+	}
+
+	idFile* f = OpenFileReadFlags( relativePath, FSFLAG_SEARCH_DIRS | FSFLAG_RETURN_FILE_PRIVATE );
+	if( f == NULL )
+	{
+		return 0;
+	}
+
+	loadCount++;
+	if( callback != NULL )
+	{
+		// the callback gets the buffer straight from the I/O thread
+		loadStack++;
+	}
+	return asyncReader.Submit( f, priority, callback, userData );
+}
+
+/*
+============
+idFileSystemLocal::FinishReadAsync
+============
+*/
+fsAsyncState_t idFileSystemLocal::FinishReadAsync( fsAsyncHandle_t handle, void** buffer, int* length, bool wait )
+{
+	void* data = NULL;
+	const fsAsyncState_t state = asyncReader.Finish( handle, &data, length, wait );
+	if( data != NULL )
+	{
+		if( buffer != NULL )
+		{
+			loadStack++;
+			*buffer = data;
+		}
+		else
+		{
+			Mem_Free( data );
+		}
+	}
+	return state;
+}
+
+/*
+============
+idFileSystemLocal::CancelReadAsync
+============
+*/
+void idFileSystemLocal::CancelReadAsync( fsAsyncHandle_t handle )
+{
+	asyncReader.Cancel( handle );
+}
+
 /*
 ============
 idFileSystemLocal::WriteFile
@@ -2835,10 +3246,17 @@ void idFileSystemLocal::Path_f( const idCmdArgs& args )
 		idx = search.resourceFiles.Num() - 1;
 		while( idx >= 0 )
 		{
-			common->Printf( "%s/%s/%s (%i files)\n", search.path.c_str(), search.gamedir.c_str(), search.resourceFiles[idx]->GetFileName(), search.resourceFiles[idx]->GetNumFileResources() );
+			common->Printf( "%s/%s/%s (%i files%s)\n", search.path.c_str(), search.gamedir.c_str(), search.resourceFiles[idx]->GetFileName(), search.resourceFiles[idx]->GetNumFileResources(), search.resourceFiles[idx]->IsMapped() ? ", mapped" : "" );
 			idx--;
 		}
 	}
+
+	if( fs_debugResources.GetBool() && fileSystemLocal.resourceLookupCount > 0 )
+	{
+		const double microseconds = fileSystemLocal.resourceLookupTicks * 1000000.0 / Sys_ClockTicksPerSecond();
+		common->Printf( "%i resource files indexed, %i lookups averaging %.3f usec\n", fileSystemLocal.resourceIndex.Num(),
+						fileSystemLocal.resourceLookupCount, microseconds / fileSystemLocal.resourceLookupCount );
+	}
 }
 
 /*
@@ -2943,50 +3361,81 @@ void idFileSystemLocal::CreateCRCsForResourceFileList( const idFileList& list )
 	{
 		idLib::Printf( " Processing %s.\n", list.GetFile( fileIndex ) );
 
-		std::unique_ptr<idFile_Memory> currentFile( static_cast<idFile_Memory*>( fileSystem->OpenFileReadMemory( list.GetFile( fileIndex ) ) ) );
-
-		if( currentFile.get() == NULL )
+		uint32 resourceMagic = 0;
 		{
-			idLib::Printf( " Error reading %s.\n", list.GetFile( fileIndex ) );
-			continue;
+			std::unique_ptr<idFile> currentFile( fileSystem->OpenFileRead( list.GetFile( fileIndex ) ) );
+			if( currentFile.get() == NULL )
+			{
+				idLib::Printf( " Error reading %s.\n", list.GetFile( fileIndex ) );
+				continue;
+			}
+			currentFile->ReadBig( resourceMagic );
 		}
 
-		uint32 resourceMagic;
-		currentFile->ReadBig( resourceMagic );
-
-		if( resourceMagic != RESOURCE_FILE_MAGIC )
+		if( resourceMagic != RESOURCE_FILE_MAGIC && resourceMagic != RESOURCE_FILE_MAGIC_V2 )
 		{
 			idLib::Printf( "Resource file magic number doesn't match, skipping %s.\n", list.GetFile( fileIndex ) );
 			continue;
 		}
 
-		int tableOffset;
-		currentFile->ReadBig( tableOffset );
-
-		int tableLength;
-		currentFile->ReadBig( tableLength );
+		idResourceContainer container;
+		if( !container.Init( list.GetFile( fileIndex ) ) )
+		{
+			idLib::Printf( " Error reading %s.\n", list.GetFile( fileIndex ) );
+			continue;
+		}
 
-		// Read in the table
-		currentFile->Seek( tableOffset, FS_SEEK_SET );
+		// The entries are read through the container, so compressed ones get the CRC of their
+		// uncompressed data like in a version 1 container, and checksummed on the job threads
+		// a batch at a time.
+		const int CRC_BATCH_SIZE = 64 * 1024 * 1024;
+		const int numFileResources = container.GetNumFileResources();
+		idTempArray< resourceChecksum_t > checksums( numFileResources );
+		bool readFailed = false;
+		for( int firstEntry = 0; firstEntry < numFileResources && !readFailed; )
+		{
+			int lastEntry = firstEntry;
+			int batchLength = 0;
+			while( lastEntry < numFileResources && ( lastEntry == firstEntry || batchLength + container.cacheTable[lastEntry].length <= CRC_BATCH_SIZE ) )
+			{
+				batchLength += container.cacheTable[lastEntry].length;
+				lastEntry++;
+			}
 
-		int numFileResources;
-		currentFile->ReadBig( numFileResources );
+			byte* batch = ( byte* )Mem_Alloc( Max( batchLength, 1 ), TAG_TEMP );
+			int batchOffset = 0;
+			for( int innerFileIndex = firstEntry; innerFileIndex < lastEntry; ++innerFileIndex )
+			{
+				const idResourceCacheEntry& entry = container.cacheTable[innerFileIndex];
+				if( !container.ReadEntry( entry, batch + batchOffset ) )
+				{
+					readFailed = true;
+					break;
+				}
+				checksums[innerFileIndex].data = batch + batchOffset;
+				checksums[innerFileIndex].length = entry.length;
+				checksums[innerFileIndex].withDigest = false;
+				batchOffset += entry.length;
+			}
+			if( !readFailed )
+			{
+				idResourceContainer::ChecksumData( &checksums[firstEntry], lastEntry - firstEntry );
+			}
+			Mem_Free( batch );
 
-		idList< idResourceCacheEntry > cacheEntries;
-		cacheEntries.SetNum( numFileResources );
+			firstEntry = lastEntry;
+		}
 
-		for( int innerFileIndex = 0; innerFileIndex < numFileResources; ++innerFileIndex )
+		if( readFailed )
 		{
-			cacheEntries[innerFileIndex].Read( currentFile.get() );
+			idLib::Printf( " Error reading %s.\n", list.GetFile( fileIndex ) );
+			continue;
 		}
 
-		// All tables read, now seek to each one and calculate the CRC.
 		idTempArray< unsigned int > innerFileCRCs( numFileResources ); // DG: use int instead of long for 64bit compatibility
 		for( int innerFileIndex = 0; innerFileIndex < numFileResources; ++innerFileIndex )
 		{
-			const char* innerFileDataBegin = currentFile->GetDataPtr() + cacheEntries[innerFileIndex].offset;
-
-			innerFileCRCs[innerFileIndex] = CRC32_BlockChecksum( innerFileDataBegin, cacheEntries[innerFileIndex].length );
+			innerFileCRCs[innerFileIndex] = checksums[innerFileIndex].crc;
 		}
 
 		// Get the CRC for all the CRCs.
@@ -3014,6 +3463,137 @@ void idFileSystemLocal::CreateCRCsForResourceFileList( const idFileList& list )
 	}
 }
 
+/*
+================
+idFileSystemLocal::TestResourceFile_f
+
+Writes a block compressed container and reads its entries back through OpenFileRead,
+the same way the game loads them.
+================
+*/
+void idFileSystemLocal::TestResourceFile_f( const idCmdArgs& args )
+{
+	const char* testFolder = "generated/testresource";
+	const char* testContainer = "_testresource";
+
+	// an entry that spans several compressed blocks, one with a stored and a compressed block
+	// and one that doesn't compress at all and keeps its plain layout
+	idList< idStr > names;
+	idList< idList< byte > > contents;
+	names.Append( va( "%s/blocks.txt", testFolder ) );
+	names.Append( va( "%s/mixed.bin", testFolder ) );
+	names.Append( va( "%s/stored.bin", testFolder ) );
+	contents.SetNum( names.Num() );
+
+	idStr text;
+	for( int i = 0; text.Length() < RESOURCE_BLOCK_SIZE * 3 + 1000; i++ )
+	{
+		text += va( "line %d of the compressed resource test\n", i );
+	}
+	contents[ 0 ].SetNum( text.Length() );
+	memcpy( contents[ 0 ].Ptr(), text.c_str(), text.Length() );
+
+	idRandom random( 0x5eed );
+	contents[ 1 ].SetNum( RESOURCE_BLOCK_SIZE + 5000 );
+	for( int i = 0; i < RESOURCE_BLOCK_SIZE; i++ )
+	{
+		contents[ 1 ][ i ] = ( byte )random.RandomInt( 256 );
+	}
+	memcpy( contents[ 1 ].Ptr() + RESOURCE_BLOCK_SIZE, text.c_str(), 5000 );
+
+	contents[ 2 ].SetNum( 1000 );
+	for( int i = 0; i < contents[ 2 ].Num(); i++ )
+	{
+		contents[ 2 ][ i ] = ( byte )random.RandomInt( 256 );
+	}
+
+	idStrList manifest;
+	for( int i = 0; i < names.Num(); i++ )
+	{
+		idFile* f = fileSystemLocal.OpenFileWrite( names[ i ] );
+		if( f == NULL )
+		{
+			idLib::Warning( "testResourceFile: cannot write %s", names[ i ].c_str() );
+			return;
+		}
+		f->Write( contents[ i ].Ptr(), contents[ i ].Num() );
+		delete f;
+		manifest.Append( names[ i ] );
+	}
+
+	const bool compress = fs_compressResources.GetBool();
+	fs_compressResources.SetBool( true );
+	idResourceContainer::WriteResourceFile( va( "maps/%s", testContainer ), manifest, false );
+	fs_compressResources.SetBool( compress );
+
+	// only the container may provide the files
+	for( int i = 0; i < names.Num(); i++ )
+	{
+		fileSystemLocal.RemoveFile( names[ i ] );
+	}
+
+	const bool resourceFilesFound = fileSystemLocal.resourceFilesFound;
+	fileSystemLocal.resourceFilesFound = true;
+
+	int numFailed = 0;
+	const idVec2i idx = fileSystemLocal.AddResourceFile( va( "%s.resources", testContainer ) );
+	if( idx.x == -1 )
+	{
+		numFailed++;
+	}
+	else
+	{
+		for( int i = 0; i < names.Num(); i++ )
+		{
+			idResourceCacheEntry rc;
+			if( !fileSystemLocal.GetResourceCacheEntry( names[ i ], rc ) || rc.owner != fileSystemLocal.searchPaths[ idx.x ].resourceFiles[ idx.y ] )
+			{
+				idLib::Printf( "%s: not in the resource index\n", names[ i ].c_str() );
+				numFailed++;
+				continue;
+			}
+			if( rc.owner->IsCompressed( rc ) != ( i < 2 ) )
+			{
+				idLib::Printf( "%s: %s\n", names[ i ].c_str(), ( i < 2 ) ? "not compressed" : "compressed" );
+				numFailed++;
+			}
+
+			idFile* f = fileSystemLocal.OpenFileRead( names[ i ] );
+			if( f == NULL )
+			{
+				idLib::Printf( "%s: cannot open\n", names[ i ].c_str() );
+				numFailed++;
+				continue;
+			}
+
+			idList< byte > data;
+			data.SetNum( f->Length() );
+			const int read = f->Read( data.Ptr(), data.Num() );
+			delete f;
+
+			if( data.Num() != contents[ i ].Num() || read != data.Num() || memcmp( data.Ptr(), contents[ i ].Ptr(), data.Num() ) != 0 )
+			{
+				idLib::Printf( "%s: read %d of %d bytes, contents differ\n", names[ i ].c_str(), read, contents[ i ].Num() );
+				numFailed++;
+			}
+		}
+
+		fileSystemLocal.RemoveResourceFileByIndex( idx );
+	}
+
+	fileSystemLocal.resourceFilesFound = resourceFilesFound;
+	fileSystemLocal.RemoveFile( va( "maps/%s.resources", testContainer ) );
+
+	if( numFailed > 0 )
+	{
+		idLib::Warning( "testResourceFile: %d checks failed", numFailed );
+	}
+	else
+	{
+		idLib::Printf( "testResourceFile: %d entries read back correctly\n", names.Num() );
+	}
+}
+
 /*
 ================
 idFileSystemLocal::AddResourceFile
@@ -3040,6 +3620,7 @@ idVec2i idFileSystemLocal::AddResourceFile( const char* resourceFileName )
 		{
 			search.resourceFiles.Append( rc );
 			common->Printf( "Loaded resource file %s\n", resourceFile.c_str() );
+			RebuildResourceIndex();
 			return idVec2i( sp, search.resourceFiles.Num() - 1 );
 		}
 		delete rc;
@@ -3070,6 +3651,70 @@ idVec2i idFileSystemLocal::FindResourceFile( const char* resourceFileName )
 
 	return idVec2i( -1, -1 );
 }
+/*
+================
+idFileSystemLocal::RebuildResourceIndex
+
+Merges the entries of all resource containers into one index, keeping the entry that
+a search through the containers would find first for every file name.
+================
+*/
+void idFileSystemLocal::RebuildResourceIndex()
+{
+	int numEntries = 0;
+	for( int sp = 0; sp < searchPaths.Num(); sp++ )
+	{
+		for( int i = 0; i < searchPaths[sp].resourceFiles.Num(); i++ )
+		{
+			numEntries += searchPaths[sp].resourceFiles[i]->GetNumFileResources();
+		}
+	}
+
+	resourceIndex.Clear();
+	resourceIndex.Resize( numEntries );
+	resourceIndexHash.Clear();
+	resourceIndexHash.Reserve( numEntries );
+
+	// later search paths and later containers take precedence
+	for( int sp = searchPaths.Num() - 1; sp >= 0; sp-- )
+	{
+		const searchpath_t& search = searchPaths[sp];
+
+		for( int idx = search.resourceFiles.Num() - 1; idx >= 0; idx-- )
+		{
+			const idResourceContainer* container = search.resourceFiles[ idx ];
+
+			for( int i = 0; i < container->cacheTable.Num(); i++ )
+			{
+				const idResourceCacheEntry& rt = container->cacheTable[ i ];
+				if( FindResourceIndex( rt.filename, rt.hash ) == -1 )
+				{
+					resourceIndexHash.Add( rt.hash, resourceIndex.Append( &rt ) );
+				}
+			}
+		}
+	}
+}
+
+/*
+================
+idFileSystemLocal::FindResourceIndex
+================
+*/
+int idFileSystemLocal::FindResourceIndex( const char* canonical, const int key ) const
+{
+	idFlatHashIndex::iterator_t it;
+	for( int index = resourceIndexHash.First( key, it ); index != idFlatHashIndex::NULL_INDEX; index = resourceIndexHash.Next( it ) )
+	{
+		// both names are lower case already
+		if( idStr::Cmp( resourceIndex[ index ]->filename, canonical ) == 0 )
+		{
+			return index;
+		}
+	}
+	return -1;
+}
+
 /*
 ================
 idFileSystemLocal::RemoveResourceFileByIndex
@@ -3083,8 +3728,12 @@ void idFileSystemLocal::RemoveResourceFileByIndex( const idVec2i& idx )
 
 		if( idx.y >= 0 && idx.y < search.resourceFiles.Num() )
 		{
+			// queued reads may still point into the container
+			asyncReader.Flush();
+
 			delete search.resourceFiles[ idx.y ];
 			search.resourceFiles.RemoveIndex( idx.y );
+			RebuildResourceIndex();
 		}
 	}
 }
@@ -3228,6 +3877,8 @@ void idFileSystemLocal::AddGameDirectory( const char* path, const char* dir )
 #endif
 	}
 	// RB end
+
+	RebuildResourceIndex();
 }
 
 /*
@@ -3315,12 +3966,15 @@ void idFileSystemLocal::Startup()
 	cmdSystem->AddCommand( "touchFile", TouchFile_f, CMD_FL_SYSTEM, "touches a file" );
 	cmdSystem->AddCommand( "touchFileList", TouchFileList_f, CMD_FL_SYSTEM, "touches a list of files" );
 
+	asyncReader.Init();
+
 	cmdSystem->AddCommand( "buildGame", BuildGame_f, CMD_FL_SYSTEM, "builds game pak files" );
 	cmdSystem->AddCommand( "writeResourceFile", WriteResourceFile_f, CMD_FL_SYSTEM, "writes a .resources file from a supplied manifest" );
 	cmdSystem->AddCommand( "extractResourceFile", ExtractResourceFile_f, CMD_FL_SYSTEM, "extracts to the supplied resource file to the supplied path" );
 	cmdSystem->AddCommand( "updateResourceFile", UpdateResourceFile_f, CMD_FL_SYSTEM, "updates or appends the supplied files in the supplied resource file" );
 
 	cmdSystem->AddCommand( "generateResourceCRCs", GenerateResourceCRCs_f, CMD_FL_SYSTEM, "Generates CRC checksums for all the resource files." );
+	cmdSystem->AddCommand( "testResourceFile", TestResourceFile_f, CMD_FL_SYSTEM, "writes a version 2 .resources file and reads its entries back through the file system" );
 
 	// print the current search paths
 	Path_f( idCmdArgs() );
@@ -3410,6 +4064,12 @@ Frees all resources and closes all files
 */
 void idFileSystemLocal::Shutdown( bool reloading )
 {
+	StopPreload();
+	WriteAccessRecord();
+
+	// the reads in progress need the containers
+	asyncReader.Shutdown();
+
 	gameFolder.Clear();
 
 	for( int sp = fileSystemLocal.searchPaths.Num() - 1; sp >= 0; sp-- )
@@ -3418,6 +4078,7 @@ void idFileSystemLocal::Shutdown( bool reloading )
 		search.resourceFiles.DeleteContents();
 		search.zipFiles.DeleteContents();
 	}
+	RebuildResourceIndex();
 
 	cmdSystem->RemoveCommand( "path" );
 	cmdSystem->RemoveCommand( "dir" );
@@ -3467,35 +4128,27 @@ bool idFileSystemLocal::GetResourceCacheEntry( const char* fileName, idResourceC
 		canonical = fileName;
 	}
 
+	const bool timeLookup = fs_debugResources.GetBool();
+	const double startTicks = timeLookup ? Sys_GetClockTicks() : 0.0;
+
 	canonical.BackSlashesToSlashes();
 	canonical.ToLower();
 
-	for( int sp = fileSystemLocal.searchPaths.Num() - 1; sp >= 0; sp-- )
+	// one lookup in the merged index of all containers
+	const int index = FindResourceIndex( canonical, idFlatHashIndex::GenerateKey( canonical, false ) );
+	if( index != -1 )
 	{
-		const searchpath_t& search = fileSystemLocal.searchPaths[sp];
-
-		int idx = search.resourceFiles.Num() - 1;
-		while( idx >= 0 )
-		{
-			const int key = search.resourceFiles[ idx ]->cacheHash.GenerateKey( canonical, false );
-			for( int index = search.resourceFiles[ idx ]->cacheHash.GetFirst( key ); index != idHashIndex::NULL_INDEX; index = search.resourceFiles[ idx ]->cacheHash.GetNext( index ) )
-			{
-				idResourceCacheEntry& rt = search.resourceFiles[ idx ]->cacheTable[ index ];
-				if( idStr::Icmp( rt.filename, canonical ) == 0 )
-				{
-					rc.filename = rt.filename;
-					rc.length = rt.length;
-					rc.offset = rt.offset;
-					rc.owner = search.resourceFiles[idx];
+		// the whole entry, compressed entries are read through their blocks
+		rc = *resourceIndex[ index ];
+	}
 
-					return true;
-				}
-			}
-			idx--;
-		}
+	if( timeLookup )
+	{
+		resourceLookupCount++;
+		resourceLookupTicks += Sys_GetClockTicks() - startTicks;
 	}
 
-	return false;
+	return ( index != -1 );
 }
 
 
@@ -3559,7 +4212,7 @@ idFileSystemLocal::GetZipFile
 Returns NULL
 ========================
 */
-idFile* idFileSystemLocal::GetZipFile( const char* fileName, bool memFile )
+idFile* idFileSystemLocal::GetZipFile( const char* fileName, bool memFile, bool privateFile )
 {
 	if( !UsingZipFiles() )
 	{
@@ -3579,7 +4232,8 @@ idFile* idFileSystemLocal::GetZipFile( const char* fileName, bool memFile )
 		// RB: TODO I don't like that we always create a new idFile_Memory buffer instead of reusing
 		// the temporary resourceBufferPtr. This needs some profiling
 
-		if( file != NULL && ( ( memFile /*|| rc.length <= resourceBufferAvailable*/ ) || rc.length < 8 * 1024 * 1024 ) )
+		// a private file is read on another thread, don't read it here
+		if( file != NULL && !privateFile && ( ( memFile /*|| rc.length <= resourceBufferAvailable*/ ) || rc.length < 8 * 1024 * 1024 ) )
 		{
 			byte* buf = NULL;
 			//if( rc.length < resourceBufferAvailable )
@@ -3628,14 +4282,15 @@ idFileSystemLocal::GetResourceFile
 Returns NULL
 ========================
 */
-idFile* idFileSystemLocal::GetResourceFile( const char* fileName, bool memFile )
+idFile* idFileSystemLocal::GetResourceFile( const char* fileName, bool memFile, bool privateFile )
 {
 	if( !UsingResourceFiles() )
 	{
 		return NULL;
 	}
 
-	static idResourceCacheEntry rc;
+	// not static, other threads open resources at the same time
+	idResourceCacheEntry rc;
 	if( GetResourceCacheEntry( fileName, rc ) )
 	{
 		if( fs_debugResources.GetBool() )
@@ -3643,6 +4298,58 @@ idFile* idFileSystemLocal::GetResourceFile( const char* fileName, bool memFile )
 			idLib::Printf( "RES: loading file %s\n", rc.filename.c_str() );
 		}
 
+		{
+			idScopedCriticalSection lock( readAheadMutex );
+			if( accessRecording )
+			{
+				RecordAccess( rc );
+			}
+			if( readAheadSpans.Num() > 0 )
+			{
+				PumpReadAhead( FindReadAhead( rc.filename ) );
+			}
+		}
+
+		// compressed entries are always inflated into memory
+		if( rc.owner->IsCompressed( rc ) )
+		{
+			byte* buf = ( byte* )Mem_Alloc( rc.length, TAG_TEMP );
+			if( !rc.owner->ReadEntry( rc, buf ) )
+			{
+				Mem_Free( buf );
+				return NULL;
+			}
+			idFile_Memory* mfile = new idFile_Memory( rc.filename, ( const char* )buf, rc.length );
+			mfile->TakeDataOwnership();
+			return mfile;
+		}
+
+		// mapped containers hand out views into the mapping, memory files and streamed files alike
+		idFile* view = rc.owner->OpenMappedFile( rc );
+		if( view != NULL )
+		{
+			return view;
+		}
+
+		if( privateFile )
+		{
+			// the container handle seeks for every read so another thread needs its own
+			idFile* rezFile = OpenExplicitFileRead( rc.owner->resourceFile->GetFullPath() );
+			if( rezFile != NULL )
+			{
+				idFile_InnerResource* file = new idFile_InnerResource( rc.filename, rezFile, rc.offset, rc.length );
+				file->TakeResourceFileOwnership();
+				return file;
+			}
+
+			// the container only lives in memory, copy the entry out of it
+			byte* buf = ( byte* )Mem_Alloc( rc.length, TAG_TEMP );
+			ReadFromBGL( rc.owner->resourceFile, buf, rc.offset, rc.length );
+			idFile_Memory* mfile = new idFile_Memory( rc.filename, ( const char* )buf, rc.length );
+			mfile->TakeDataOwnership();
+			return mfile;
+		}
+
 		idFile_InnerResource* file = new idFile_InnerResource( rc.filename, rc.owner->resourceFile, rc.offset, rc.length );
 
 		// DG: add parenthesis to make sure this block is only entered when file != NULL - bug found by clang.
@@ -3740,7 +4447,7 @@ idFile* idFileSystemLocal::OpenFileReadFlags( const char* relativePath, int sear
 	// RB: .pk4 files have a higher priority than .resources because they are aimed for modding
 	if( UsingZipFiles() && fs_resourceLoadPriority.GetInteger() == 1 )
 	{
-		idFile* rf = GetZipFile( relativePath, ( searchFlags & FSFLAG_RETURN_FILE_MEM ) != 0 );
+		idFile* rf = GetZipFile( relativePath, ( searchFlags & FSFLAG_RETURN_FILE_MEM ) != 0, ( searchFlags & FSFLAG_RETURN_FILE_PRIVATE ) != 0 );
 		if( rf != NULL )
 		{
 			return rf;
@@ -3750,7 +4457,7 @@ idFile* idFileSystemLocal::OpenFileReadFlags( const char* relativePath, int sear
 
 	if( UsingResourceFiles() && fs_resourceLoadPriority.GetInteger() == 1 )
 	{
-		idFile* rf = GetResourceFile( relativePath, ( searchFlags & FSFLAG_RETURN_FILE_MEM ) != 0 );
+		idFile* rf = GetResourceFile( relativePath, ( searchFlags & FSFLAG_RETURN_FILE_MEM ) != 0, ( searchFlags & FSFLAG_RETURN_FILE_PRIVATE ) != 0 );
 		if( rf != NULL )
 		{
 			return rf;
@@ -3889,7 +4596,7 @@ idFile* idFileSystemLocal::OpenFileReadFlags( const char* relativePath, int sear
 	// RB: .pk4 files have a higher priority than .resources because they are aimed for modding
 	if( UsingZipFiles() && fs_resourceLoadPriority.GetInteger() == 0 )
 	{
-		idFile* rf = GetZipFile( relativePath, ( searchFlags & FSFLAG_RETURN_FILE_MEM ) != 0 );
+		idFile* rf = GetZipFile( relativePath, ( searchFlags & FSFLAG_RETURN_FILE_MEM ) != 0, ( searchFlags & FSFLAG_RETURN_FILE_PRIVATE ) != 0 );
 		if( rf != NULL )
 		{
 			return rf;
@@ -3899,7 +4606,7 @@ idFile* idFileSystemLocal::OpenFileReadFlags( const char* relativePath, int sear
 
 	if( UsingResourceFiles() && fs_resourceLoadPriority.GetInteger() == 0 )
 	{
-		idFile* rf = GetResourceFile( relativePath, ( searchFlags & FSFLAG_RETURN_FILE_MEM ) != 0 );
+		idFile* rf = GetResourceFile( relativePath, ( searchFlags & FSFLAG_RETURN_FILE_MEM ) != 0, ( searchFlags & FSFLAG_RETURN_FILE_PRIVATE ) != 0 );
 		if( rf != NULL )
 		{
 			return rf;
@@ -67,6 +67,27 @@ typedef enum
 	FIND_YES
 } findFile_t;
 
+// priorities for ReadFileAsync, higher priorities are read first
+typedef enum
+{
+	FS_ASYNC_PRIORITY_LOW,
+	FS_ASYNC_PRIORITY_NORMAL,
+	FS_ASYNC_PRIORITY_HIGH
+} fsAsyncPriority_t;
+
+typedef enum
+{
+	FS_ASYNC_PENDING,
+	FS_ASYNC_DONE,
+	FS_ASYNC_FAILED
+} fsAsyncState_t;
+
+// 0 is never a valid handle
+typedef int fsAsyncHandle_t;
+
+// called on an I/O thread when an asynchronous read completes, buffer is NULL and length -1 if the read failed
+typedef void ( *fsAsyncCallback_t )( fsAsyncHandle_t handle, void* buffer, int length, void* userData );
+
 // file list for directory listings
 class idFileList
 {
@@ -149,9 +170,25 @@ public:
 	// The buffer should be considered read-only, because it may be cached for other uses.
 	virtual int				ReadFile( const char* relativePath, void** buffer, ID_TIME_T* timestamp = NULL ) = 0;
 
-	// Frees the memory allocated by ReadFile.
+	// Frees the memory allocated by ReadFile and ReadFileAsync.
 	virtual void			FreeFile( void* buffer ) = 0;
 
+	// Queues a complete file read on the I/O threads.
+	// Returns a handle for the read, or 0 if the file is not present.
+	// Reads are serviced by priority and in the order they were queued within a priority.
+	// Without a callback the result is collected with FinishReadAsync.
+	// With a callback the callback owns the buffer and the handle is only good for CancelReadAsync.
+	// A 0 byte will always be appended at the end, the buffer is freed with FreeFile.
+	virtual fsAsyncHandle_t	ReadFileAsync( const char* relativePath, fsAsyncPriority_t priority = FS_ASYNC_PRIORITY_NORMAL, fsAsyncCallback_t callback = NULL, void* userData = NULL ) = 0;
+
+	// Collects a read queued without a callback.
+	// Returns FS_ASYNC_PENDING if the read isn't done and wait is false, waiting moves the read to the front of the queue.
+	// Otherwise the handle is released and buffer and length are set if the read succeeded.
+	virtual fsAsyncState_t	FinishReadAsync( fsAsyncHandle_t handle, void** buffer, int* length, bool wait = true ) = 0;
+
+	// Drops a queued read, a read that already started is completed and thrown away.
+	virtual void			CancelReadAsync( fsAsyncHandle_t handle ) = 0;
+
 	// Writes a complete file, will create any needed subdirectories.
 	// Returns the length of the file, or -1 on failure.
 	virtual int				WriteFile( const char* relativePath, const void* buffer, int size, const char* basePath = "fs_savepath" ) = 0;
@@ -220,6 +257,11 @@ public:
 	// Returns length of file, -1 if no file exists
 	virtual int				GetFileLength( const char* relativePath ) = 0;
 
+	// Finds the file OpenFileRead would open without opening it. The full path is the OS path
+	// of the file or of the pack it is in, the timestamp is the one the opened file reports.
+	// Returns false if no file exists
+	virtual bool			GetFileInfo( const char* relativePath, idStr& fullPath, ID_TIME_T& timestamp, int& length ) = 0;
+
 	virtual sysFolder_t		IsFolder( const char* relativePath, const char* basePath = "fs_basepath" ) = 0;
 
 	// resource tracking and related things
@@ -0,0 +1,408 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "precompiled.h"
+#pragma hdrstop
+
+idCVar fs_asyncReadThreads( "fs_asyncReadThreads", "2", CVAR_SYSTEM | CVAR_INTEGER | CVAR_INIT, "number of threads servicing asynchronous file reads, 0 reads on the calling thread", 0, 8 );
+
+class idAsyncReadThread : public idSysThread
+{
+public:
+	virtual int			Run()
+	{
+		while( reader->ServiceRequest() )
+		{
+		}
+		return 0;
+	}
+	idAsyncFileReader* 	reader;
+};
+
+/*
+========================
+idAsyncFileReader::idAsyncFileReader
+========================
+*/
+idAsyncFileReader::idAsyncFileReader() :
+	idle( true ),
+	numOutstanding( 0 ),
+	nextHandle( 1 )
+{
+	idle.Raise();
+}
+
+/*
+========================
+idAsyncFileReader::~idAsyncFileReader
+========================
+*/
+idAsyncFileReader::~idAsyncFileReader()
+{
+	Shutdown();
+}
+
+/*
+========================
+idAsyncFileReader::Init
+========================
+*/
+void idAsyncFileReader::Init()
+{
+	for( int i = threads.Num(); i < fs_asyncReadThreads.GetInteger(); i++ )
+	{
+		idAsyncReadThread* thread = new( TAG_IDFILE ) idAsyncReadThread();
+		thread->reader = this;
+		thread->StartWorkerThread( va( "AsyncFileRead%d", i ), CORE_ANY );
+		threads.Append( thread );
+	}
+}
+
+/*
+========================
+idAsyncFileReader::Shutdown
+
+Drops everything still queued and waits for the reads in progress. Reads that are
+done but not collected yet survive, their buffers don't depend on the file system.
+========================
+*/
+void idAsyncFileReader::Shutdown()
+{
+	mutex.Lock();
+	for( int i = requests.Num() - 1; i >= 0; i-- )
+	{
+		asyncRead_t* r = requests[i];
+		if( !r->started )
+		{
+			delete r->file;
+			requests.RemoveIndex( i );
+			RequestDone();
+			delete r;
+		}
+	}
+	mutex.Unlock();
+
+	Flush();
+
+	// deleting a worker thread stops it
+	threads.DeleteContents();
+}
+
+/*
+========================
+idAsyncFileReader::Submit
+========================
+*/
+fsAsyncHandle_t idAsyncFileReader::Submit( idFile* file, fsAsyncPriority_t priority, fsAsyncCallback_t callback, void* userData )
+{
+	asyncRead_t* r = new( TAG_IDFILE ) asyncRead_t;
+	r->priority = priority;
+	r->file = file;
+	r->started = false;
+	r->cancelled = false;
+	r->state = FS_ASYNC_PENDING;
+	r->buffer = NULL;
+	r->length = -1;
+	r->callback = callback;
+	r->userData = userData;
+
+	mutex.Lock();
+	r->handle = nextHandle++;
+	if( nextHandle <= 0 )
+	{
+		nextHandle = 1;
+	}
+	const fsAsyncHandle_t handle = r->handle;
+	requests.Append( r );
+	if( numOutstanding++ == 0 )
+	{
+		idle.Clear();
+	}
+	mutex.Unlock();
+
+	if( threads.Num() == 0 )
+	{
+		// no I/O threads, read it right away
+		ServiceRequest();
+		return handle;
+	}
+
+	for( int i = 0; i < threads.Num(); i++ )
+	{
+		threads[i]->SignalWork();
+	}
+	return handle;
+}
+
+/*
+========================
+idAsyncFileReader::Finish
+========================
+*/
+fsAsyncState_t idAsyncFileReader::Finish( fsAsyncHandle_t handle, void** buffer, int* length, bool wait )
+{
+	mutex.Lock();
+	int index = FindRequest( handle );
+	if( index == -1 )
+	{
+		mutex.Unlock();
+		return FS_ASYNC_FAILED;
+	}
+
+	asyncRead_t* r = requests[index];
+	if( r->callback != NULL )
+	{
+		assert( false );
+		mutex.Unlock();
+		return FS_ASYNC_FAILED;
+	}
+
+	if( r->state == FS_ASYNC_PENDING )
+	{
+		if( !wait )
+		{
+			mutex.Unlock();
+			return FS_ASYNC_PENDING;
+		}
+
+		// whoever blocks on a read needs it before anything else
+		if( !r->started )
+		{
+			r->priority = FS_ASYNC_PRIORITY_HIGH;
+			requests.RemoveIndex( index );
+			requests.Insert( r, 0 );
+		}
+		mutex.Unlock();
+
+		r->done.Wait();
+
+		mutex.Lock();
+	}
+
+	requests.Remove( r );
+	mutex.Unlock();
+
+	const fsAsyncState_t state = r->state;
+	if( buffer != NULL )
+	{
+		*buffer = r->buffer;
+	}
+	else if( r->buffer != NULL )
+	{
+		Mem_Free( r->buffer );
+	}
+	if( length != NULL )
+	{
+		*length = r->length;
+	}
+	delete r;
+
+	return state;
+}
+
+/*
+========================
+idAsyncFileReader::Cancel
+========================
+*/
+void idAsyncFileReader::Cancel( fsAsyncHandle_t handle )
+{
+	mutex.Lock();
+	int index = FindRequest( handle );
+	if( index == -1 )
+	{
+		mutex.Unlock();
+		return;
+	}
+
+	asyncRead_t* r = requests[index];
+	if( !r->started )
+	{
+		requests.RemoveIndex( index );
+		RequestDone();
+		mutex.Unlock();
+
+		delete r->file;
+		delete r;
+		return;
+	}
+
+	if( r->state == FS_ASYNC_PENDING || r->callback != NULL )
+	{
+		// the I/O thread throws it away when the read is done
+		r->cancelled = true;
+		mutex.Unlock();
+		return;
+	}
+
+	requests.RemoveIndex( index );
+	mutex.Unlock();
+
+	if( r->buffer != NULL )
+	{
+		Mem_Free( r->buffer );
+	}
+	delete r;
+}
+
+/*
+========================
+idAsyncFileReader::Flush
+========================
+*/
+void idAsyncFileReader::Flush()
+{
+	if( threads.Num() == 0 )
+	{
+		while( ServiceRequest() )
+		{
+		}
+	}
+	idle.Wait();
+}
+
+/*
+========================
+idAsyncFileReader::ServiceRequest
+========================
+*/
+bool idAsyncFileReader::ServiceRequest()
+{
+	mutex.Lock();
+	asyncRead_t* r = NULL;
+	for( int i = 0; i < requests.Num(); i++ )
+	{
+		asyncRead_t* candidate = requests[i];
+		if( !candidate->started && ( r == NULL || candidate->priority > r->priority ) )
+		{
+			r = candidate;
+		}
+	}
+	if( r == NULL )
+	{
+		mutex.Unlock();
+		return false;
+	}
+	r->started = true;
+	mutex.Unlock();
+
+	const bool succeeded = ReadRequest( r );
+
+	mutex.Lock();
+	r->state = succeeded ? FS_ASYNC_DONE : FS_ASYNC_FAILED;
+	if( r->cancelled )
+	{
+		requests.Remove( r );
+		RequestDone();
+		mutex.Unlock();
+
+		if( r->buffer != NULL )
+		{
+			Mem_Free( r->buffer );
+		}
+		delete r;
+		return true;
+	}
+
+	if( r->callback == NULL )
+	{
+		// the buffer waits for Finish
+		r->done.Raise();
+		RequestDone();
+		mutex.Unlock();
+		return true;
+	}
+	mutex.Unlock();
+
+	r->callback( r->handle, r->buffer, r->length, r->userData );
+
+	mutex.Lock();
+	requests.Remove( r );
+	RequestDone();
+	mutex.Unlock();
+
+	delete r;
+	return true;
+}
+
+/*
+========================
+idAsyncFileReader::FindRequest
+========================
+*/
+int idAsyncFileReader::FindRequest( fsAsyncHandle_t handle ) const
+{
+	for( int i = 0; i < requests.Num(); i++ )
+	{
+		if( requests[i]->handle == handle )
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+========================
+idAsyncFileReader::ReadRequest
+
+Runs without the mutex, the file and the buffer belong to the request alone.
+========================
+*/
+bool idAsyncFileReader::ReadRequest( asyncRead_t* r ) const
+{
+	const int length = r->file->Length();
+	byte* buffer = ( byte* )Mem_Alloc( length + 1, TAG_IDFILE );
+	const int read = r->file->Read( buffer, length );
+	delete r->file;
+	r->file = NULL;
+
+	if( read != length )
+	{
+		Mem_Free( buffer );
+		return false;
+	}
+
+	buffer[length] = 0;
+	r->buffer = buffer;
+	r->length = length;
+	return true;
+}
+
+/*
+========================
+idAsyncFileReader::RequestDone
+========================
+*/
+void idAsyncFileReader::RequestDone()
+{
+	if( --numOutstanding == 0 )
+	{
+		idle.Raise();
+	}
+}
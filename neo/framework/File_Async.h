@@ -0,0 +1,111 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __FILE_ASYNC_H__
+#define __FILE_ASYNC_H__
+
+/*
+==============================================================
+
+	Asynchronous file reads
+
+	The file system resolves the file on the calling thread and hands
+	the reader a file object that nobody else touches, a loose file
+	with its own handle, a zip stream of its own, a view into a mapped
+	resource container or a resource entry on a private handle to the
+	container. A small pool of I/O threads takes the queued reads
+	highest priority first and reads every file completely into a new
+	buffer, so any number of reads can be in flight while the game
+	keeps running.
+
+==============================================================
+*/
+
+class idAsyncReadThread;
+
+class idAsyncFileReader
+{
+public:
+	idAsyncFileReader();
+	~idAsyncFileReader();
+
+	void				Init();
+	void				Shutdown();
+
+	// takes ownership of the file, it is deleted on the I/O thread
+	fsAsyncHandle_t		Submit( idFile* file, fsAsyncPriority_t priority, fsAsyncCallback_t callback, void* userData );
+	fsAsyncState_t		Finish( fsAsyncHandle_t handle, void** buffer, int* length, bool wait );
+	void				Cancel( fsAsyncHandle_t handle );
+
+	// blocks until every queued read is done
+	void				Flush();
+
+	int					NumOutstanding() const
+	{
+		return numOutstanding;
+	}
+
+	int					NumThreads() const
+	{
+		return threads.Num();
+	}
+
+	// runs a single queued read, returns false if there is nothing to read
+	bool				ServiceRequest();
+
+private:
+	struct asyncRead_t
+	{
+		asyncRead_t() : done( true ) {}
+
+		fsAsyncHandle_t		handle;
+		fsAsyncPriority_t	priority;
+		idFile* 			file;			// closed by the I/O thread
+		bool				started;		// taken by an I/O thread
+		bool				cancelled;		// nobody wants the buffer anymore
+		fsAsyncState_t		state;
+		void* 				buffer;
+		int					length;
+		fsAsyncCallback_t	callback;
+		void* 				userData;
+		idSysSignal			done;			// raised when state leaves FS_ASYNC_PENDING
+	};
+
+	mutable idSysMutex				mutex;
+	idList< asyncRead_t* >			requests;		// in the order they were queued
+	idList< idAsyncReadThread* >	threads;
+	idSysSignal						idle;			// raised while nothing is queued or being read
+	int								numOutstanding;
+	fsAsyncHandle_t					nextHandle;
+
+	int					FindRequest( fsAsyncHandle_t handle ) const;
+	bool				ReadRequest( asyncRead_t* r ) const;
+	void				RequestDone();		// the mutex must be held
+};
+
+#endif /* !__FILE_ASYNC_H__ */
@@ -217,5 +217,92 @@ void idFileManifest::AddFile( const char* fileName )
 	//}
 }
 
+/*
+================================================================================================
+
+idAccessManifest
+
+================================================================================================
+*/
+
+/*
+========================
+idAccessManifest::LoadManifest
+========================
+*/
+bool idAccessManifest::LoadManifest( const char* fileName )
+{
+	Clear();
+
+	idFile* inFile = fileSystem->OpenFileReadMemory( fileName );
+	if( inFile == NULL )
+	{
+		return false;
+	}
+
+	int version = 0;
+	int numEntries = 0;
+	inFile->ReadBig( version );
+	inFile->ReadBig( numEntries );
+	if( version != ACCESS_MANIFEST_VERSION || numEntries < 0 )
+	{
+		idLib::Warning( "%s has the wrong version", fileName );
+		delete inFile;
+		return false;
+	}
+
+	entries.SetNum( numEntries );
+	for( int i = 0; i < numEntries; i++ )
+	{
+		entries[ i ].Read( inFile );
+		entryHash.Add( entryHash.GenerateKey( entries[ i ].resourceName, false ), i );
+	}
+	delete inFile;
+	return true;
+}
 
+/*
+========================
+idAccessManifest::WriteManifest
+========================
+*/
+void idAccessManifest::WriteManifest( const char* fileName )
+{
+	idFile* outFile = fileSystem->OpenFileWrite( fileName, "fs_savepath" );
+	if( outFile == NULL )
+	{
+		return;
+	}
+	outFile->WriteBig( ( int )ACCESS_MANIFEST_VERSION );
+	outFile->WriteBig( entries.Num() );
+	for( int i = 0; i < entries.Num(); i++ )
+	{
+		entries[ i ].Write( outFile );
+	}
+	delete outFile;
+}
 
+/*
+========================
+idAccessManifest::Add
+========================
+*/
+bool idAccessManifest::Add( const char* container, const char* resourceName, int offset, int length )
+{
+	const int key = entryHash.GenerateKey( resourceName, false );
+	for( int index = entryHash.First( key ); index != idHashIndex::NULL_INDEX; index = entryHash.Next( index ) )
+	{
+		if( entries[ index ].resourceName.Icmp( resourceName ) == 0 )
+		{
+			return false;
+		}
+	}
+
+	accessEntry_s& entry = entries.Alloc();
+	entry.container = container;
+	entry.resourceName = resourceName;
+	entry.offset = offset;
+	entry.length = length;
+	entryHash.Add( key, entries.Num() - 1 );
+	return true;
+}
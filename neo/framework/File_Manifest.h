@@ -323,5 +323,78 @@ private:
 	idStr filename;
 };
 
+// access order
+struct accessEntry_s
+{
+	void Write( idFile* outFile )
+	{
+		outFile->WriteString( container );
+		outFile->WriteString( resourceName );
+		outFile->WriteBig( offset );
+		outFile->WriteBig( length );
+	}
+
+	void Read( idFile* inFile )
+	{
+		inFile->ReadString( container );
+		inFile->ReadString( resourceName );
+		inFile->ReadBig( offset );
+		inFile->ReadBig( length );
+	}
+
+	idStr			container;		// resource file the entry was read from
+	idStr			resourceName;	// resource name
+	int				offset;			// byte range read from the container, all the blocks of a compressed entry
+	int				length;
+};
+
+/*
+================================================
+idAccessManifest lists the resource container entries a map touched in the
+order they were first opened, it drives the read-ahead on later loads.
+================================================
+*/
+class idAccessManifest
+{
+public:
+	static const int ACCESS_MANIFEST_VERSION = 1;
+
+	idAccessManifest()
+	{
+		entries.SetGranularity( 2048 );
+	}
+	~idAccessManifest() {}
+
+	bool LoadManifest( const char* fileName );
+	void WriteManifest( const char* fileName );
+
+	int NumResources() const
+	{
+		return entries.Num();
+	}
+
+	const accessEntry_s& GetAccessByIndex( int idx ) const
+	{
+		return entries[ idx ];
+	}
+
+	const idStr& GetResourceNameByIndex( int idx ) const
+	{
+		return entries[ idx ].resourceName;
+	}
+
+	// only the first access of a resource is kept, returns false for the later ones
+	bool Add( const char* container, const char* resourceName, int offset, int length );
+
+	void Clear()
+	{
+		entries.Clear();
+		entryHash.Clear();
+	}
+
+private:
+	idList< accessEntry_s > entries;
+	idHashIndex	entryHash;
+};
 
 #endif /* !__FILE_MANIFEST_H__ */
@@ -33,6 +33,588 @@ If you have questions concerning this license or the applicable additional terms
 #include "../sound/WaveFile.h"
 #include "../renderer/CmdlineProgressbar.h"
 
+extern idCVar fs_mapResources;
+extern idCVar fs_compressResources;
+
+/*
+================================================================================================
+
+Block compression
+
+================================================================================================
+*/
+
+struct resourceBlockJob_t
+{
+	const byte* 	src;
+	int				srcLength;
+	byte* 			dest;
+	int				destLength;
+	uint32			checksum;
+	bool			valid;				// set by the job
+};
+
+/*
+========================
+DecompressResourceBlock
+========================
+*/
+void DecompressResourceBlock( resourceBlockJob_t* job )
+{
+	if( job->srcLength == job->destLength )
+	{
+		// stored
+		memcpy( job->dest, job->src, job->destLength );
+	}
+	else
+	{
+		uLongf destLength = job->destLength;
+		if( uncompress( job->dest, &destLength, job->src, job->srcLength ) != Z_OK || destLength != ( uLongf )job->destLength )
+		{
+			job->valid = false;
+			return;
+		}
+	}
+	job->valid = ( CRC32_BlockChecksum( job->dest, job->destLength ) == job->checksum );
+}
+
+REGISTER_PARALLEL_JOB( DecompressResourceBlock, "DecompressResourceBlock" );
+
+/*
+========================
+CompressResourceBlocks
+========================
+*/
+struct resourceCompressJob_t
+{
+	const byte* 		src;				// first block
+	int					length;				// of all the blocks
+	byte* 				dest;				// destStride bytes for every block
+	int					destStride;
+	resourceBlock_t* 	blocks;				// compressedLength and checksum are set by the job
+};
+
+void CompressResourceBlocks( resourceCompressJob_t* job )
+{
+	for( int i = 0, start = 0; start < job->length; i++, start += RESOURCE_BLOCK_SIZE )
+	{
+		const int blockLength = Min( RESOURCE_BLOCK_SIZE, job->length - start );
+		resourceBlock_t& block = job->blocks[ i ];
+		block.checksum = CRC32_BlockChecksum( job->src + start, blockLength );
+
+		uLongf compressedLength = job->destStride;
+		if( compress2( job->dest + i * job->destStride, &compressedLength, job->src + start, blockLength, Z_BEST_COMPRESSION ) == Z_OK && compressedLength < ( uLongf )blockLength )
+		{
+			block.compressedLength = compressedLength;
+		}
+		else
+		{
+			// stored
+			block.compressedLength = blockLength;
+		}
+	}
+}
+
+REGISTER_PARALLEL_JOB( CompressResourceBlocks, "CompressResourceBlocks" );
+
+/*
+========================
+ChecksumResourceData
+========================
+*/
+void ChecksumResourceData( resourceChecksum_t* checksum )
+{
+	checksum->crc = CRC32_BlockChecksum( checksum->data, checksum->length );
+	if( checksum->withDigest )
+	{
+		MD5_CTX ctx;
+		MD5_Init( &ctx );
+		MD5_Update( &ctx, checksum->data, checksum->length );
+		MD5_Final( &ctx, checksum->digest );
+	}
+}
+
+REGISTER_PARALLEL_JOB( ChecksumResourceData, "ChecksumResourceData" );
+
+/*
+================================================
+idResourceWriter writes the entries of a container followed by the table
+of contents, the header is written again once the table is known.
+
+Files with the same contents are written once and all their entries
+point at the same data. AddFiles streams the files through three stages,
+the next batch is read on the I/O threads while the current batch is
+hashed and compressed on the job threads and the previous batch is
+written out in order.
+================================================
+*/
+class idResourceWriter
+{
+public:
+	idResourceWriter( idFile* file, bool compress );
+	~idResourceWriter();
+
+	void			AddFile( const char* filename, const byte* data, int length );
+	void			AddFiles( const idStrList& filenames );
+	void			Finish();
+
+	int				GetNumDuplicates() const
+	{
+		return numDuplicates;
+	}
+	int64			GetDuplicateBytes() const
+	{
+		return duplicateBytes;
+	}
+
+private:
+	static const int BATCH_FILES = 32;
+	static const int MAX_JOBS_PER_FILE = 64;
+
+	struct pendingFile_t
+	{
+		idStr				filename;
+		fsAsyncHandle_t		handle;
+		void* 				readBuffer;		// from FinishReadAsync, freed with FreeFile
+		const byte* 		data;
+		int					length;			// -1 if the read failed
+		resourceChecksum_t	checksum;
+		idList< resourceBlock_t > blocks;	// offsets are set when the blocks are written
+		byte* 				compressed;
+	};
+
+	struct batch_t
+	{
+		idList< pendingFile_t >			files;
+		idList< resourceCompressJob_t >	jobs;
+	};
+
+	struct payload_t
+	{
+		int					length;
+		byte				digest[16];
+		int					entry;			// first entry with this data
+	};
+
+	idFile* 		file;
+	bool			compress;
+	idList< idResourceCacheEntry > entries;
+	idList< resourceBlock_t > blocks;
+	idList< payload_t > payloads;
+	idFlatHashIndex	payloadHash;			// CRC32 of the payload data
+	int				numDuplicates;
+	int64			duplicateBytes;
+	int64			written;
+	idParallelJobList* jobList;
+	batch_t			batches[3];
+
+	void			WriteHeader( int tableOffset, int tableLength );
+	void			Align( int alignment );
+	void			PrepareFile( pendingFile_t& pf, idList< resourceCompressJob_t >& jobs );
+	void			WriteFile( pendingFile_t& pf );
+	int				QueueReads( batch_t& batch, const idStrList& filenames, int nextFile );
+	void			StartBatch( batch_t& batch );
+	void			WriteBatch( batch_t& batch );
+};
+
+/*
+========================
+idResourceWriter::idResourceWriter
+========================
+*/
+idResourceWriter::idResourceWriter( idFile* file_, bool compress_ ) :
+	file( file_ ),
+	compress( compress_ ),
+	numDuplicates( 0 ),
+	duplicateBytes( 0 ),
+	written( 0 ),
+	jobList( NULL )
+{
+	entries.SetGranularity( 1024 );
+	payloads.SetGranularity( 1024 );
+	WriteHeader( 0, 0 );
+}
+
+/*
+========================
+idResourceWriter::~idResourceWriter
+========================
+*/
+idResourceWriter::~idResourceWriter()
+{
+	if( jobList != NULL )
+	{
+		parallelJobManager->FreeJobList( jobList );
+	}
+}
+
+/*
+========================
+idResourceWriter::WriteHeader
+========================
+*/
+void idResourceWriter::WriteHeader( int tableOffset, int tableLength )
+{
+	const uint32 magic = compress ? RESOURCE_FILE_MAGIC_V2 : RESOURCE_FILE_MAGIC;
+	file->WriteBig( magic );
+	file->WriteBig( tableOffset );
+	file->WriteBig( tableLength );
+	if( compress )
+	{
+		file->WriteBig( RESOURCE_BLOCK_SIZE );
+	}
+}
+
+/*
+========================
+idResourceWriter::Align
+========================
+*/
+void idResourceWriter::Align( int alignment )
+{
+	static const byte zeros[RESOURCE_TABLE_ALIGNMENT] = {};
+	const int pad = ( alignment - ( file->Tell() & ( alignment - 1 ) ) ) & ( alignment - 1 );
+	if( pad > 0 )
+	{
+		file->Write( zeros, pad );
+	}
+}
+
+/*
+========================
+idResourceWriter::PrepareFile
+
+Sets up the checksum and the compression jobs of a file, large files are
+split over at most MAX_JOBS_PER_FILE jobs.
+========================
+*/
+void idResourceWriter::PrepareFile( pendingFile_t& pf, idList< resourceCompressJob_t >& jobs )
+{
+	pf.checksum.data = pf.data;
+	pf.checksum.length = pf.length;
+	pf.checksum.withDigest = true;
+	pf.compressed = NULL;
+
+	if( !compress || pf.length <= 0 )
+	{
+		return;
+	}
+
+	const int numBlocks = ( pf.length + RESOURCE_BLOCK_SIZE - 1 ) / RESOURCE_BLOCK_SIZE;
+	const int destStride = compressBound( RESOURCE_BLOCK_SIZE );
+	const int blocksPerJob = ( numBlocks + MAX_JOBS_PER_FILE - 1 ) / MAX_JOBS_PER_FILE;
+
+	pf.blocks.SetNum( numBlocks );
+	pf.compressed = ( byte* )Mem_Alloc( numBlocks * destStride, TAG_TEMP );
+
+	for( int i = 0; i < numBlocks; i += blocksPerJob )
+	{
+		resourceCompressJob_t& job = jobs.Alloc();
+		job.src = pf.data + i * RESOURCE_BLOCK_SIZE;
+		job.length = Min( blocksPerJob * RESOURCE_BLOCK_SIZE, pf.length - i * RESOURCE_BLOCK_SIZE );
+		job.dest = pf.compressed + i * destStride;
+		job.destStride = destStride;
+		job.blocks = &pf.blocks[ i ];
+	}
+}
+
+/*
+========================
+idResourceWriter::WriteFile
+
+Writes a file that has been checksummed and compressed, or adds another entry
+for the data if a file with the same contents was written before.
+========================
+*/
+void idResourceWriter::WriteFile( pendingFile_t& pf )
+{
+	idResourceCacheEntry ent;
+	ent.filename = pf.filename;
+	ent.length = pf.length;
+
+	const int key = ( int )pf.checksum.crc;
+	idFlatHashIndex::iterator_t it;
+	for( int i = payloadHash.First( key, it ); i != idFlatHashIndex::NULL_INDEX; i = payloadHash.Next( it ) )
+	{
+		const payload_t& payload = payloads[ i ];
+		if( payload.length == pf.length && memcmp( payload.digest, pf.checksum.digest, sizeof( payload.digest ) ) == 0 )
+		{
+			ent.offset = entries[ payload.entry ].offset;
+			ent.firstBlock = entries[ payload.entry ].firstBlock;
+			entries.Append( ent );
+			numDuplicates++;
+			duplicateBytes += pf.length;
+			return;
+		}
+	}
+
+	payload_t& payload = payloads.Alloc();
+	payload.length = pf.length;
+	memcpy( payload.digest, pf.checksum.digest, sizeof( payload.digest ) );
+	payload.entry = entries.Num();
+	payloadHash.Add( key, payloads.Num() - 1 );
+
+	if( !compress )
+	{
+		ent.offset = file->Tell();
+		file->Write( pf.data, pf.length );
+		entries.Append( ent );
+		return;
+	}
+
+	// aligned so the uncompressed entries are usable if memory mapped
+	Align( RESOURCE_DATA_ALIGNMENT );
+	ent.offset = file->Tell();
+
+	const int firstBlock = blocks.Num();
+	bool shrunk = false;
+	for( int i = 0; i < pf.blocks.Num(); i++ )
+	{
+		const int start = i * RESOURCE_BLOCK_SIZE;
+		const int blockLength = Min( RESOURCE_BLOCK_SIZE, pf.length - start );
+
+		resourceBlock_t& block = blocks.Alloc();
+		block = pf.blocks[ i ];
+		block.offset = file->Tell();
+
+		if( block.compressedLength < blockLength )
+		{
+			file->Write( pf.compressed + i * compressBound( RESOURCE_BLOCK_SIZE ), block.compressedLength );
+			shrunk = true;
+		}
+		else
+		{
+			file->Write( pf.data + start, blockLength );
+		}
+	}
+
+	if( shrunk )
+	{
+		ent.firstBlock = firstBlock;
+	}
+	else
+	{
+		// every block was stored, so the entry is just its uncompressed data
+		blocks.SetNum( firstBlock );
+	}
+	entries.Append( ent );
+}
+
+/*
+========================
+idResourceWriter::AddFile
+========================
+*/
+void idResourceWriter::AddFile( const char* filename, const byte* data, int length )
+{
+	pendingFile_t pf;
+	pf.filename = filename;
+	pf.data = data;
+	pf.length = length;
+
+	idList< resourceCompressJob_t > jobs;
+	PrepareFile( pf, jobs );
+	ChecksumResourceData( &pf.checksum );
+	for( int i = 0; i < jobs.Num(); i++ )
+	{
+		CompressResourceBlocks( &jobs[ i ] );
+	}
+
+	WriteFile( pf );
+
+	Mem_Free( pf.compressed );
+}
+
+/*
+========================
+idResourceWriter::QueueReads
+========================
+*/
+int idResourceWriter::QueueReads( batch_t& batch, const idStrList& filenames, int nextFile )
+{
+	assert( batch.files.Num() == 0 );
+
+	for( ; nextFile < filenames.Num() && batch.files.Num() < BATCH_FILES; nextFile++ )
+	{
+		const fsAsyncHandle_t handle = fileSystem->ReadFileAsync( filenames[ nextFile ] );
+		if( handle == 0 )
+		{
+			continue;
+		}
+		pendingFile_t& pf = batch.files.Alloc();
+		pf.filename = filenames[ nextFile ];
+		pf.handle = handle;
+		pf.readBuffer = NULL;
+		pf.data = NULL;
+		pf.length = -1;
+		pf.compressed = NULL;
+	}
+	return nextFile;
+}
+
+/*
+========================
+idResourceWriter::StartBatch
+
+Waits for the reads of the batch and starts hashing and compressing it.
+========================
+*/
+void idResourceWriter::StartBatch( batch_t& batch )
+{
+	for( int i = 0; i < batch.files.Num(); i++ )
+	{
+		pendingFile_t& pf = batch.files[ i ];
+		int length = 0;
+		if( fileSystem->FinishReadAsync( pf.handle, &pf.readBuffer, &length, true ) != FS_ASYNC_DONE )
+		{
+			idLib::Warning( "Skipping unreadable %s", pf.filename.c_str() );
+			continue;
+		}
+		pf.data = ( const byte* )pf.readBuffer;
+		pf.length = length;
+		PrepareFile( pf, batch.jobs );
+	}
+
+	// the job pointers stay valid because neither list grows from here on
+	for( int i = 0; i < batch.files.Num(); i++ )
+	{
+		pendingFile_t& pf = batch.files[ i ];
+		if( pf.length < 0 )
+		{
+			continue;
+		}
+		if( jobList != NULL )
+		{
+			jobList->AddJob( ( jobRun_t )ChecksumResourceData, &pf.checksum );
+		}
+		else
+		{
+			ChecksumResourceData( &pf.checksum );
+		}
+	}
+	for( int i = 0; i < batch.jobs.Num(); i++ )
+	{
+		if( jobList != NULL )
+		{
+			jobList->AddJob( ( jobRun_t )CompressResourceBlocks, &batch.jobs[ i ] );
+		}
+		else
+		{
+			CompressResourceBlocks( &batch.jobs[ i ] );
+		}
+	}
+	if( jobList != NULL )
+	{
+		jobList->Submit();
+	}
+}
+
+/*
+========================
+idResourceWriter::WriteBatch
+========================
+*/
+void idResourceWriter::WriteBatch( batch_t& batch )
+{
+	for( int i = 0; i < batch.files.Num(); i++ )
+	{
+		pendingFile_t& pf = batch.files[ i ];
+		if( pf.length >= 0 )
+		{
+			WriteFile( pf );
+
+			// pacifier every ten megs
+			if( ( written + pf.length ) / 10000000 != written / 10000000 )
+			{
+				idLib::Printf( "." );
+			}
+			written += pf.length;
+		}
+		if( pf.readBuffer != NULL )
+		{
+			fileSystem->FreeFile( pf.readBuffer );
+		}
+		Mem_Free( pf.compressed );
+	}
+	batch.files.Clear();
+	batch.jobs.Clear();
+}
+
+/*
+========================
+idResourceWriter::AddFiles
+
+Files that are missing or can't be read are skipped.
+========================
+*/
+void idResourceWriter::AddFiles( const idStrList& filenames )
+{
+	if( jobList == NULL && parallelJobManager->GetNumProcessingUnits() > 0 )
+	{
+		jobList = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, BATCH_FILES * ( MAX_JOBS_PER_FILE + 1 ), 0, NULL );
+	}
+
+	int nextFile = QueueReads( batches[ 0 ], filenames, 0 );
+	int current = 0;
+	while( batches[ current ].files.Num() > 0 )
+	{
+		const int next = ( current + 1 ) % 3;
+		const int previous = ( current + 2 ) % 3;
+
+		StartBatch( batches[ current ] );
+		nextFile = QueueReads( batches[ next ], filenames, nextFile );
+		WriteBatch( batches[ previous ] );
+		if( jobList != NULL )
+		{
+			jobList->Wait();
+		}
+		current = next;
+	}
+	WriteBatch( batches[ ( current + 2 ) % 3 ] );
+}
+
+/*
+========================
+idResourceWriter::Finish
+========================
+*/
+void idResourceWriter::Finish()
+{
+	if( compress )
+	{
+		Align( RESOURCE_TABLE_ALIGNMENT );
+	}
+	const int tableOffset = file->Tell();
+
+	if( compress )
+	{
+		file->WriteBig( blocks.Num() );
+		for( int i = 0; i < blocks.Num(); i++ )
+		{
+			file->WriteBig( blocks[ i ].offset );
+			file->WriteBig( blocks[ i ].compressedLength );
+			file->WriteBig( blocks[ i ].checksum );
+		}
+	}
+
+	file->WriteBig( entries.Num() );
+
+	// write the individual resource entries
+	for( int i = 0; i < entries.Num(); i++ )
+	{
+		entries[ i ].Write( file );
+		if( compress )
+		{
+			file->WriteBig( entries[ i ].firstBlock );
+		}
+	}
+
+	// go back and write the header offsets again, now that we have file offsets and lengths
+	const int tableLength = file->Tell() - tableOffset;
+	file->Seek( 0, FS_SEEK_SET );
+	WriteHeader( tableOffset, tableLength );
+}
+
 /*
 ================================================================================================
 
@@ -59,7 +641,9 @@ idResourceContainer::Init
 */
 bool idResourceContainer::Init( const char* _fileName )
 {
-	if( idStr::Icmp( _fileName, "_ordered.resources" ) == 0 )
+	const bool ordered = ( idStr::Icmp( _fileName, "_ordered.resources" ) == 0 );
+
+	if( ordered && !fs_mapResources.GetBool() )
 	{
 		resourceFile = fileSystem->OpenFileReadMemory( _fileName );
 	}
@@ -74,57 +658,260 @@ bool idResourceContainer::Init( const char* _fileName )
 		return false;
 	}
 
+	if( fs_mapResources.GetBool() )
+	{
+		// containers inside zip files can't be mapped and fall back to the file handle
+		mappedData = Sys_MapFile( resourceFile->GetFullPath(), mappedLength );
+		if( mappedData == NULL && ordered )
+		{
+			delete resourceFile;
+			resourceFile = fileSystem->OpenFileReadMemory( _fileName );
+			if( resourceFile == NULL )
+			{
+				idLib::Warning( "Unable to open resource file %s", _fileName );
+				return false;
+			}
+		}
+	}
+
 	resourceFile->ReadBig( resourceMagic );
-	if( resourceMagic != RESOURCE_FILE_MAGIC )
+	if( resourceMagic != RESOURCE_FILE_MAGIC && resourceMagic != RESOURCE_FILE_MAGIC_V2 )
 	{
 		idLib::FatalError( "resourceFileMagic != RESOURCE_FILE_MAGIC" );
 	}
+	const bool v2 = ( resourceMagic == RESOURCE_FILE_MAGIC_V2 );
 
 	fileName = _fileName;
 
 	resourceFile->ReadBig( tableOffset );
 	resourceFile->ReadBig( tableLength );
+	if( v2 )
+	{
+		resourceFile->ReadBig( blockSize );
+		if( blockSize <= 0 )
+		{
+			idLib::FatalError( "bad block size in %s", _fileName );
+		}
+	}
 	// read this into a memory buffer with a single read
 	char* const buf = ( char* )Mem_Alloc( tableLength, TAG_RESOURCE );
 	resourceFile->Seek( tableOffset, FS_SEEK_SET );
 	resourceFile->Read( buf, tableLength );
 	idFile_Memory memFile( "resourceHeader", ( const char* )buf, tableLength );
 
+	if( v2 )
+	{
+		int numBlocks = 0;
+		memFile.ReadBig( numBlocks );
+		blocks.SetNum( numBlocks );
+		for( int i = 0; i < numBlocks; i++ )
+		{
+			memFile.ReadBig( blocks[ i ].offset );
+			memFile.ReadBig( blocks[ i ].compressedLength );
+			memFile.ReadBig( blocks[ i ].checksum );
+		}
+	}
+
 	// Parse the resourceFile header, which includes every resource used
 	// by the game.
 	memFile.ReadBig( numFileResources );
 
 	cacheTable.SetNum( numFileResources );
 
+	// the file system merges the entries of all containers into a single index
 	for( int i = 0; i < numFileResources; i++ )
 	{
 		idResourceCacheEntry& rt = cacheTable[ i ];
 		rt.Read( &memFile );
+		if( v2 )
+		{
+			memFile.ReadBig( rt.firstBlock );
+		}
 		rt.filename.BackSlashesToSlashes();
 		rt.filename.ToLower();
 		rt.owner = this;
+		rt.hash = idFlatHashIndex::GenerateKey( rt.filename, false );
+	}
+	Mem_Free( buf );
 
-		const int key = cacheHash.GenerateKey( rt.filename, false );
-		bool found = false;
-		//for ( int index = cacheHash.GetFirst( key ); index != idHashIndex::NULL_INDEX; index = cacheHash.GetNext( index ) ) {
-		//	idResourceCacheEntry & rtc = cacheTable[ index ];
-		//	if ( idStr::Icmp( rtc.filename, rt.filename ) == 0 ) {
-		//		found = true;
-		//		break;
-		//	}
-		//}
-		if( !found )
+	return true;
+}
+
+/*
+========================
+idResourceContainer::OpenMappedFile
+
+The view doesn't own the data, so it has to be closed before the container is destroyed.
+========================
+*/
+idFile* idResourceContainer::OpenMappedFile( const idResourceCacheEntry& rc ) const
+{
+	if( mappedData == NULL || IsCompressed( rc ) || rc.offset < 0 || rc.length < 0 || rc.offset > mappedLength - rc.length )
+	{
+		return NULL;
+	}
+	return new( TAG_IDFILE ) idFile_Memory( rc.filename, ( const char* )mappedData + rc.offset, rc.length );
+}
+
+/*
+========================
+idResourceContainer::ReadEntry
+
+The blocks of an entry follow each other in the container, so they are read with
+a single read, or used in place if the container is mapped, and then inflated in
+parallel. Every job writes its own part of dest.
+========================
+*/
+bool idResourceContainer::ReadEntry( const idResourceCacheEntry& rc, byte* dest )
+{
+	if( !IsCompressed( rc ) )
+	{
+		if( mappedData != NULL && rc.offset >= 0 && rc.length >= 0 && rc.offset <= mappedLength - rc.length )
 		{
-			//idLib::Printf( "rez file name: %s\n", rt.filename.c_str() );
-			cacheHash.Add( key, i );
+			memcpy( dest, mappedData + rc.offset, rc.length );
+			return true;
 		}
+		return ( fileSystem->ReadFromBGL( resourceFile, dest, rc.offset, rc.length ) == rc.length );
+	}
+
+	const int numBlocks = ( rc.length + blockSize - 1 ) / blockSize;
+	if( rc.firstBlock + numBlocks > blocks.Num() )
+	{
+		idLib::Warning( "%s has a bad block range in %s", rc.filename.c_str(), fileName.c_str() );
+		return false;
+	}
+
+	int start;
+	int length;
+	GetEntryRange( rc, start, length );
+
+	const byte* src = NULL;
+	byte* readBuffer = NULL;
+	if( mappedData != NULL && start >= 0 && length >= 0 && start <= mappedLength - length )
+	{
+		src = mappedData + start;
+	}
+	else
+	{
+		readBuffer = ( byte* )Mem_Alloc( length, TAG_TEMP );
+		if( fileSystem->ReadFromBGL( resourceFile, readBuffer, start, length ) != length )
+		{
+			Mem_Free( readBuffer );
+			return false;
+		}
+		src = readBuffer;
+	}
+
+	idTempArray< resourceBlockJob_t > jobs( numBlocks );
+	for( int i = 0; i < numBlocks; i++ )
+	{
+		const resourceBlock_t& block = blocks[ rc.firstBlock + i ];
+		resourceBlockJob_t& job = jobs[ i ];
+		job.src = src + ( block.offset - start );
+		job.srcLength = block.compressedLength;
+		job.dest = dest + i * blockSize;
+		job.destLength = Min( blockSize, rc.length - i * blockSize );
+		job.checksum = block.checksum;
+		job.valid = false;
+	}
+
+	// the job list is shared, a second thread reading at the same time (the async readers) inflates inline
+	static const int MAX_BLOCK_JOBS = 256;
+	static idSysMutex blockJobsMutex;
+	static idParallelJobList* blockJobs = NULL;
+	if( numBlocks > 1 && parallelJobManager->GetNumProcessingUnits() > 0 && blockJobsMutex.Lock( false ) )
+	{
+		if( blockJobs == NULL )
+		{
+			blockJobs = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_HIGH, MAX_BLOCK_JOBS, 0, NULL );
+		}
+		for( int i = 0; i < numBlocks; i += MAX_BLOCK_JOBS )
+		{
+			for( int j = i; j < Min( i + MAX_BLOCK_JOBS, numBlocks ); j++ )
+			{
+				blockJobs->AddJob( ( jobRun_t )DecompressResourceBlock, &jobs[ j ] );
+			}
+			blockJobs->Submit();
+			blockJobs->Wait();
+		}
+		blockJobsMutex.Unlock();
+	}
+	else
+	{
+		for( int i = 0; i < numBlocks; i++ )
+		{
+			DecompressResourceBlock( &jobs[ i ] );
+		}
+	}
+
+	if( readBuffer != NULL )
+	{
+		Mem_Free( readBuffer );
 	}
-	Mem_Free( buf );
 
+	for( int i = 0; i < numBlocks; i++ )
+	{
+		if( !jobs[ i ].valid )
+		{
+			idLib::Warning( "%s is corrupt in %s", rc.filename.c_str(), fileName.c_str() );
+			return false;
+		}
+	}
 	return true;
 }
 
 
+/*
+========================
+idResourceContainer::GetEntryRange
+========================
+*/
+void idResourceContainer::GetEntryRange( const idResourceCacheEntry& rc, int& offset, int& length ) const
+{
+	const int numBlocks = ( rc.length + blockSize - 1 ) / blockSize;
+	if( !IsCompressed( rc ) || rc.firstBlock + numBlocks > blocks.Num() )
+	{
+		offset = rc.offset;
+		length = rc.length;
+		return;
+	}
+	const resourceBlock_t& first = blocks[ rc.firstBlock ];
+	const resourceBlock_t& last = blocks[ rc.firstBlock + numBlocks - 1 ];
+	offset = first.offset;
+	length = last.offset + last.compressedLength - first.offset;
+}
+
+/*
+========================
+idResourceContainer::ChecksumData
+========================
+*/
+void idResourceContainer::ChecksumData( resourceChecksum_t* checksums, int num )
+{
+	if( num > 1 && parallelJobManager->GetNumProcessingUnits() > 0 )
+	{
+		static const int MAX_CHECKSUM_JOBS = 1024;
+		idParallelJobList* jobList = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, MAX_CHECKSUM_JOBS, 0, NULL );
+		for( int i = 0; i < num; i += MAX_CHECKSUM_JOBS )
+		{
+			for( int j = i; j < Min( i + MAX_CHECKSUM_JOBS, num ); j++ )
+			{
+				jobList->AddJob( ( jobRun_t )ChecksumResourceData, &checksums[ j ] );
+			}
+			jobList->Submit();
+			jobList->Wait();
+		}
+		parallelJobManager->FreeJobList( jobList );
+	}
+	else
+	{
+		for( int i = 0; i < num; i++ )
+		{
+			ChecksumResourceData( &checksums[ i ] );
+		}
+	}
+}
+
 /*
 ========================
 idResourceContainer::WriteManifestFile
@@ -188,87 +975,54 @@ void idResourceContainer::UpdateResourceFile( const char* _filename, const idStr
 		return;
 	}
 
-	uint32 magic = 0;
-	int _tableOffset = 0;
-	int _tableLength = 0;
-	idList< idResourceCacheEntry > entries;
 	idStrList filesToUpdate = _filesToUpdate;
 
-	idFile* inFile = fileSystem->OpenFileRead( _filename );
-	if( inFile == NULL )
-	{
-		magic = RESOURCE_FILE_MAGIC;
+	// the updated file keeps the format of the one it replaces
+	idResourceContainer container;
+	const bool existing = ( fileSystem->GetFileLength( _filename ) >= 0 ) && container.Init( _filename );
+	const bool compress = existing ? ( container.resourceMagic == ( int )RESOURCE_FILE_MAGIC_V2 ) : fs_compressResources.GetBool();
 
-		outFile->WriteBig( magic );
-		outFile->WriteBig( _tableOffset );
-		outFile->WriteBig( _tableLength );
+	idResourceWriter writer( outFile, compress );
 
-	}
-	else
+	for( int i = 0; i < container.cacheTable.Num(); i++ )
 	{
-		inFile->ReadBig( magic );
-		if( magic != RESOURCE_FILE_MAGIC )
-		{
-			delete inFile;
-			return;
-		}
+		const idResourceCacheEntry& entry = container.cacheTable[ i ];
 
-		inFile->ReadBig( _tableOffset );
-		inFile->ReadBig( _tableLength );
-		// read this into a memory buffer with a single read
-		char* const buf = ( char* )Mem_Alloc( _tableLength, TAG_RESOURCE );
-		inFile->Seek( _tableOffset, FS_SEEK_SET );
-		inFile->Read( buf, _tableLength );
-		idFile_Memory memFile( "resourceHeader", ( const char* )buf, _tableLength );
+		idLib::Printf( "examining %s\n", entry.filename.c_str() );
+		byte* fileData = NULL;
+		int fileLength = entry.length;
 
-		int _numFileResources = 0;
-		memFile.ReadBig( _numFileResources );
-
-		outFile->WriteBig( magic );
-		outFile->WriteBig( _tableOffset );
-		outFile->WriteBig( _tableLength );
-
-		entries.SetNum( _numFileResources );
-
-		for( int i = 0; i < _numFileResources; i++ )
+		for( int j = filesToUpdate.Num() - 1; j >= 0; j-- )
 		{
-			entries[ i ].Read( &memFile );
-
-
-			idLib::Printf( "examining %s\n", entries[ i ].filename.c_str() );
-			byte* fileData = NULL;
-
-			for( int j = filesToUpdate.Num() - 1; j >= 0; j-- )
+			if( filesToUpdate[ j ].Icmp( entry.filename ) == 0 )
 			{
-				if( filesToUpdate[ j ].Icmp( entries[ i ].filename ) == 0 )
+				idFile* newFile = fileSystem->OpenFileReadMemory( filesToUpdate[ j ] );
+				if( newFile != NULL )
 				{
-					idFile* newFile = fileSystem->OpenFileReadMemory( filesToUpdate[ j ] );
-					if( newFile != NULL )
-					{
-						idLib::Printf( "Updating %s\n", filesToUpdate[ j ].c_str() );
-						entries[ i ].length = newFile->Length();
-						fileData = ( byte* )Mem_Alloc( entries[ i ].length, TAG_TEMP );
-						newFile->Read( fileData, newFile->Length() );
-						delete newFile;
-					}
-					filesToUpdate.RemoveIndex( j );
+					idLib::Printf( "Updating %s\n", filesToUpdate[ j ].c_str() );
+					fileLength = newFile->Length();
+					fileData = ( byte* )Mem_Alloc( fileLength, TAG_TEMP );
+					newFile->Read( fileData, fileLength );
+					delete newFile;
 				}
+				filesToUpdate.RemoveIndex( j );
 			}
+		}
 
-			if( fileData == NULL )
+		if( fileData == NULL )
+		{
+			fileData = ( byte* )Mem_Alloc( fileLength, TAG_TEMP );
+			if( !container.ReadEntry( entry, fileData ) )
 			{
-				inFile->Seek( entries[ i ].offset, FS_SEEK_SET );
-				fileData = ( byte* )Mem_Alloc( entries[ i ].length, TAG_TEMP );
-				inFile->Read( fileData, entries[ i ].length );
+				idLib::Warning( "Dropping unreadable %s", entry.filename.c_str() );
+				Mem_Free( fileData );
+				continue;
 			}
-
-			entries[ i ].offset = outFile->Tell();
-			outFile->Write( ( void* )fileData, entries[ i ].length );
-
-			Mem_Free( fileData );
 		}
 
-		Mem_Free( buf );
+		writer.AddFile( entry.filename, fileData, fileLength );
+
+		Mem_Free( fileData );
 	}
 
 	while( filesToUpdate.Num() > 0 )
@@ -277,41 +1031,19 @@ void idResourceContainer::UpdateResourceFile( const char* _filename, const idStr
 		if( newFile != NULL )
 		{
 			idLib::Printf( "Appending %s\n", filesToUpdate[ 0 ].c_str() );
-			idResourceCacheEntry rt;
-			rt.filename = filesToUpdate[ 0 ];
-			rt.length = newFile->Length();
-			byte* fileData = ( byte* )Mem_Alloc( rt.length, TAG_TEMP );
-			newFile->Read( fileData, rt.length );
-			int idx = entries.Append( rt );
-			if( idx >= 0 )
-			{
-				entries[ idx ].offset = outFile->Tell();
-				outFile->Write( ( void* )fileData, entries[ idx ].length );
-			}
+			const int fileLength = newFile->Length();
+			byte* fileData = ( byte* )Mem_Alloc( fileLength, TAG_TEMP );
+			newFile->Read( fileData, fileLength );
+			writer.AddFile( filesToUpdate[ 0 ], fileData, fileLength );
 			delete newFile;
 			Mem_Free( fileData );
 		}
 		filesToUpdate.RemoveIndex( 0 );
 	}
 
-	_tableOffset = outFile->Tell();
-	outFile->WriteBig( entries.Num() );
-
-	// write the individual resource entries
-	for( int i = 0; i < entries.Num(); i++ )
-	{
-		entries[ i ].Write( outFile );
-	}
-
-	// go back and write the header offsets again, now that we have file offsets and lengths
-	_tableLength = outFile->Tell() - _tableOffset;
-	outFile->Seek( 0, FS_SEEK_SET );
-	outFile->WriteBig( magic );
-	outFile->WriteBig( _tableOffset );
-	outFile->WriteBig( _tableLength );
+	writer.Finish();
 
 	delete outFile;
-	delete inFile;
 }
 
 /*
@@ -321,36 +1053,15 @@ idResourceContainer::ExtractResourceFile
 */
 void idResourceContainer::ExtractResourceFile( const char* _fileName, const char* _outPath, bool _copyWavs, bool _all )
 {
-	idFile* inFile = fileSystem->OpenFileRead( _fileName );
-
-	if( inFile == NULL )
+	idResourceContainer container;
+	if( !container.Init( _fileName ) )
 	{
-		idLib::Warning( "Unable to open resource file %s", _fileName );
-		return;
-	}
-
-	uint32 magic;
-	inFile->ReadBig( magic );
-	if( magic != RESOURCE_FILE_MAGIC )
-	{
-		delete inFile;
 		return;
 	}
 
 	common->Printf( "extracting resource file %s\n", _fileName );
 
-	int _tableOffset;
-	int _tableLength;
-	inFile->ReadBig( _tableOffset );
-	inFile->ReadBig( _tableLength );
-	// read this into a memory buffer with a single read
-	char* const buf = ( char* )Mem_Alloc( _tableLength, TAG_RESOURCE );
-	inFile->Seek( _tableOffset, FS_SEEK_SET );
-	inFile->Read( buf, _tableLength );
-	idFile_Memory memFile( "resourceHeader", ( const char* )buf, _tableLength );
-
-	int _numFileResources;
-	memFile.ReadBig( _numFileResources );
+	const int _numFileResources = container.cacheTable.Num();
 
 #if !defined( TYPEINFOPROJECT ) && !defined( DMAP )
 	CommandlineProgressBar progressBar( _numFileResources, renderSystem->GetWidth(), renderSystem->GetHeight() );
@@ -362,10 +1073,7 @@ void idResourceContainer::ExtractResourceFile( const char* _fileName, const char
 
 	for( int i = 0; i < _numFileResources; i++ )
 	{
-		idResourceCacheEntry rt;
-		rt.Read( &memFile );
-		rt.filename.BackSlashesToSlashes();
-		rt.filename.ToLower();
+		idResourceCacheEntry rt = container.cacheTable[ i ];
 		byte* fbuf = NULL;
 
 		if( _copyWavs && ( rt.filename.Find( ".idwav" ) >= 0 ||  rt.filename.Find( ".idxma" ) >= 0 ||  rt.filename.Find( ".idmsf" ) >= 0 ) )
@@ -467,9 +1175,12 @@ void idResourceContainer::ExtractResourceFile( const char* _fileName, const char
 				continue;
 			}
 
-			inFile->Seek( rt.offset, FS_SEEK_SET );
 			fbuf = ( byte* )Mem_Alloc( rt.length, TAG_RESOURCE );
-			inFile->Read( fbuf, rt.length );
+			if( !container.ReadEntry( rt, fbuf ) )
+			{
+				Mem_Free( fbuf );
+				continue;
+			}
 
 			idStr outName = _outPath;
 			outName.AppendPath( rt.filename );
@@ -489,8 +1200,6 @@ void idResourceContainer::ExtractResourceFile( const char* _fileName, const char
 		}
 #endif
 	}
-	delete inFile;
-	Mem_Free( buf );
 }
 
 
@@ -567,87 +1276,19 @@ void idResourceContainer::WriteResourceFile( const char* manifestName, const idS
 
 		idLib::Printf( "Writing resource file %s\n", fileName.c_str() );
 
-		int	tableOffset = 0;
-		int	tableLength = 0;
-		int	tableNewLength = 0;
-		uint32	resourceFileMagic = RESOURCE_FILE_MAGIC;
+		idResourceWriter writer( resFile, fs_compressResources.GetBool() );
+		writer.AddFiles( fileList );
 
-		resFile->WriteBig( resourceFileMagic );
-		resFile->WriteBig( tableOffset );
-		resFile->WriteBig( tableLength );
-
-		idList< idResourceCacheEntry > entries;
-
-		entries.Resize( fileList.Num() );
+		idLib::Printf( "\n" );
 
-		for( int i = 0; i < fileList.Num(); i++ )
+		if( writer.GetNumDuplicates() > 0 )
 		{
-			idResourceCacheEntry ent;
-
-			ent.filename = fileList[ i ];
-			ent.length = 0;
-			ent.offset = 0;
-
-			idFile* file = fileSystem->OpenFileReadMemory( ent.filename, false );
-			idFile_Memory* fm = dynamic_cast< idFile_Memory* >( file );
-			if( fm == NULL )
-			{
-				continue;
-			}
-			// if the entry is uncompressed, align the file pointer to a 16 byte boundary
-			// so it will be usable if memory mapped
-			ent.length = fm->Length();
-
-			// always get the offset, even if the file will have zero length
-			ent.offset = resFile->Tell();
-
-			entries.Append( ent );
-
-			if( ent.length == 0 )
-			{
-				ent.filename = "";
-				delete fm;
-				continue;
-			}
-
-			resFile->Write( fm->GetDataPtr(), ent.length );
-
-			delete fm;
-
-			// pacifier every ten megs
-			if( ( ent.offset + ent.length ) / 10000000 != ent.offset / 10000000 )
-			{
-				idLib::Printf( "." );
-			}
+			idLib::Printf( "%d duplicate files share their data, %lld bytes saved\n", writer.GetNumDuplicates(), writer.GetDuplicateBytes() );
 		}
 
-		idLib::Printf( "\n" );
-
 		// write the table out now that we have all the files
-		tableOffset = resFile->Tell();
-
-		// count how many we are going to write for this platform
-		int	numFileResources = entries.Num();
-
-		resFile->WriteBig( numFileResources );
-
-		// write the individual resource entries
-		for( int i = 0; i < entries.Num(); i++ )
-		{
-			entries[ i ].Write( resFile );
-			if( i + 1 == numFileResources )
-			{
-				// we just wrote out the last new entry
-				tableNewLength = resFile->Tell() - tableOffset;
-			}
-		}
+		writer.Finish();
 
-		// go back and write the header offsets again, now that we have file offsets and lengths
-		tableLength = resFile->Tell() - tableOffset;
-		resFile->Seek( 0, FS_SEEK_SET );
-		resFile->WriteBig( resourceFileMagic );
-		resFile->WriteBig( tableOffset );
-		resFile->WriteBig( tableLength );
 		delete resFile;
 	}
 }
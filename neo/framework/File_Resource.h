@@ -35,10 +35,40 @@ If you have questions concerning this license or the applicable additional terms
 
   Resource containers
 
+  Version 1 containers store every entry uncompressed. Version 2
+  containers split the entries in blocks of blockSize bytes that are
+  deflated one by one, every block is checked against the CRC32 of its
+  uncompressed data when it is read. Entries that don't shrink are kept
+  uncompressed and can still be read in place. The table of contents
+  starts on a RESOURCE_TABLE_ALIGNMENT boundary with the fixed size
+  block records in front of the entries.
+
 ==============================================================
 */
 class idResourceContainer;
 
+static const uint32 RESOURCE_FILE_MAGIC = 0xD000000D;
+static const uint32 RESOURCE_FILE_MAGIC_V2 = 0xD000020D;
+static const int RESOURCE_BLOCK_SIZE = 64 * 1024;
+static const int RESOURCE_TABLE_ALIGNMENT = 4096;
+static const int RESOURCE_DATA_ALIGNMENT = 16;
+
+struct resourceBlock_t
+{
+	int					offset;					// into the resource file
+	int					compressedLength;		// a block that didn't shrink is stored with its uncompressed length
+	uint32				checksum;				// CRC32 of the uncompressed data
+};
+
+struct resourceChecksum_t
+{
+	const byte* 		data;
+	int					length;
+	bool				withDigest;				// MD5 is only computed when asked for
+	uint32				crc;					// CRC32 of the data
+	byte				digest[16];				// MD5 of the data
+};
+
 class idResourceCacheEntry
 {
 public:
@@ -52,6 +82,8 @@ public:
 		offset = 0;
 		length = 0;
 		owner = NULL;
+		hash = 0;
+		firstBlock = -1;
 	}
 	size_t Read( idFile* f )
 	{
@@ -72,12 +104,13 @@ public:
 	idStrStatic< 256 >	filename;
 	int					offset;							// into the resource file
 	int 				length;
+	int					firstBlock;						// version 2 only, -1 if the entry is stored uncompressed at offset
 
 	// helpers only in memory
 	idResourceContainer* owner;
+	int					hash;							// idFlatHashIndex key of the lower case filename
 };
 
-static const uint32 RESOURCE_FILE_MAGIC = 0xD000000D;
 class idResourceContainer
 {
 	friend class	idFileSystemLocal;
@@ -89,10 +122,14 @@ public:
 		tableOffset = 0;
 		tableLength = 0;
 		resourceMagic = 0;
+		blockSize = RESOURCE_BLOCK_SIZE;
 		numFileResources = 0;
+		mappedData = NULL;
+		mappedLength = 0;
 	}
 	~idResourceContainer()
 	{
+		Sys_UnmapFile( mappedData, mappedLength );
 		delete resourceFile;
 		cacheTable.Clear();
 	}
@@ -102,6 +139,8 @@ public:
 	static int ReadManifestFile( const char* filename, idStrList& list );
 	static void ExtractResourceFile( const char* fileName, const char* outPath, bool copyWavs, bool all );
 	static void UpdateResourceFile( const char* filename, const idStrList& filesToAdd );
+	// fills in the checksums of all the data blocks on the job threads
+	static void ChecksumData( resourceChecksum_t* checksums, int num );
 	idFile* OpenFile( const char* fileName );
 	const char* GetFileName() const
 	{
@@ -113,6 +152,21 @@ public:
 	{
 		return numFileResources;
 	}
+	bool IsMapped() const
+	{
+		return mappedData != NULL;
+	}
+	// returns a read only file that reads straight from the mapping, NULL if the entry isn't mapped
+	idFile* OpenMappedFile( const idResourceCacheEntry& rc ) const;
+
+	bool IsCompressed( const idResourceCacheEntry& rc ) const
+	{
+		return rc.firstBlock >= 0;
+	}
+	// reads the whole entry into dest, which has to hold rc.length bytes, compressed blocks are inflated on the job threads
+	bool ReadEntry( const idResourceCacheEntry& rc, byte* dest );
+	// the bytes of the container an entry is read from, all of its blocks if it is compressed
+	void GetEntryRange( const idResourceCacheEntry& rc, int& offset, int& length ) const;
 private:
 	idStrStatic< 256 > fileName;
 	idFile* 	resourceFile;			// open file handle
@@ -121,9 +175,12 @@ private:
 	int		tableOffset;			// table offset
 	int		tableLength;			// table length
 	int		resourceMagic;			// magic
+	int		blockSize;				// uncompressed size of every block but the last of an entry
 	int		numFileResources;		// number of file resources in this container
 	idList< idResourceCacheEntry, TAG_RESOURCE>	cacheTable;
-	idHashIndex	cacheHash;
+	idList< resourceBlock_t, TAG_RESOURCE > blocks;
+	byte* 	mappedData;				// whole container mapped with fs_mapResources
+	int		mappedLength;
 };
 
 
@@ -518,6 +518,7 @@ void idCommonLocal::ProcessGameReturn( const gameReturn_t& ret )
 }
 
 extern idCVar com_forceGenericSIMD;
+extern idCVar com_forceSSESIMD;
 
 extern idCVar com_pause;
 
@@ -535,13 +536,18 @@ void idCommonLocal::Frame()
 		// This is the only place this is incremented
 		idLib::frameNumber++;
 
+		idTaskGraph::NextFrame();
+		Mem_FrameArenaNextFrame();
+		Mem_UpdateTagPeaks();
+
 		//OPTICK_TAG( "N", idLib::frameNumber );
 
 		// allow changing SIMD usage on the fly
-		if( com_forceGenericSIMD.IsModified() )
+		if( com_forceGenericSIMD.IsModified() || com_forceSSESIMD.IsModified() )
 		{
-			idSIMD::InitProcessor( "doom", com_forceGenericSIMD.GetBool() );
+			idSIMD::InitProcessor( "doom", com_forceGenericSIMD.GetBool(), com_forceSSESIMD.GetBool() );
 			com_forceGenericSIMD.ClearModified();
+			com_forceSSESIMD.ClearModified();
 		}
 
 		// RB begin
@@ -31,6 +31,57 @@ If you have questions concerning this license or the applicable additional terms
 
 idStrPool		idDict::globalKeys;
 idStrPool		idDict::globalValues;
+bool			idDict::keysInitialized = false;
+idDictKey* 		idDictKey::handles = NULL;
+
+// defined after the pools so it is destroyed before them, static idDictKey handles
+// that are destroyed later on must not hand their key back to the destroyed pool
+static bool		dictPoolsDestroyed = false;
+static struct dictPoolGuard_t
+{
+	~dictPoolGuard_t()
+	{
+		dictPoolsDestroyed = true;
+	}
+} dictPoolGuard;
+
+/*
+================
+idKeyValue::SetValue
+================
+*/
+void idKeyValue::SetValue( const idPoolStr* newValue )
+{
+	value = newValue;
+
+	const char* s = newValue->c_str();
+	intValue = atoi( s );
+	floatValue = atof( s );
+
+	// sscanf is slow, only call it if the first number can be converted
+	vectorValue.Zero();
+	while( *s == ' ' || ( *s >= '\t' && *s <= '\r' ) )
+	{
+		s++;
+	}
+	if( ( *s >= '0' && *s <= '9' ) || *s == '-' || *s == '+' || *s == '.' || *s == 'i' || *s == 'I' || *s == 'n' || *s == 'N' )
+	{
+		sscanf( s, "%f %f %f", &vectorValue.x, &vectorValue.y, &vectorValue.z );
+	}
+}
+
+/*
+================
+idKeyValue::SetValue
+================
+*/
+void idKeyValue::SetValue( const idPoolStr* newValue, const idKeyValue& parsed )
+{
+	value = newValue;
+	intValue = parsed.intValue;
+	floatValue = parsed.floatValue;
+	vectorValue = parsed.vectorValue;
+}
 
 /*
 ================
@@ -102,13 +153,13 @@ void idDict::Copy( const idDict& other )
 		{
 			// first set the new value and then free the old value to allow proper self copying
 			const idPoolStr* oldValue = args[found[i]].value;
-			args[found[i]].value = globalValues.CopyString( other.args[i].value );
+			args[found[i]].SetValue( globalValues.CopyString( other.args[i].value ), other.args[i] );
 			globalValues.FreeString( oldValue );
 		}
 		else
 		{
 			kv.key = globalKeys.CopyString( other.args[i].key );
-			kv.value = globalValues.CopyString( other.args[i].value );
+			kv.SetValue( globalValues.CopyString( other.args[i].value ), other.args[i] );
 			argHash.Add( argHash.GenerateKey( kv.GetKey(), false ), args.Append( kv ) );
 		}
 	}
@@ -142,8 +193,7 @@ void idDict::TransferKeyValues( idDict& other )
 	args.SetNum( n );
 	for( i = 0; i < n; i++ )
 	{
-		args[i].key = other.args[i].key;
-		args[i].value = other.args[i].value;
+		args[i] = other.args[i];
 	}
 	argHash = other.argHash;
 
@@ -213,7 +263,7 @@ void idDict::SetDefaults( const idDict* dict )
 		if( !kv )
 		{
 			newkv.key = globalKeys.CopyString( def->key );
-			newkv.value = globalValues.CopyString( def->value );
+			newkv.SetValue( globalValues.CopyString( def->value ), *def );
 			argHash.Add( argHash.GenerateKey( newkv.GetKey(), false ), args.Append( newkv ) );
 		}
 	}
@@ -324,13 +374,13 @@ void idDict::Set( const char* key, const char* value )
 	{
 		// first set the new value and then free the old value to allow proper self copying
 		const idPoolStr* oldValue = args[i].value;
-		args[i].value = globalValues.AllocString( value );
+		args[i].SetValue( globalValues.AllocString( value ) );
 		globalValues.FreeString( oldValue );
 	}
 	else
 	{
 		kv.key = globalKeys.AllocString( key );
-		kv.value = globalValues.AllocString( value );
+		kv.SetValue( globalValues.AllocString( value ) );
 		argHash.Add( argHash.GenerateKey( kv.GetKey(), false ), args.Append( kv ) );
 	}
 }
@@ -342,12 +392,14 @@ idDict::GetFloat
 */
 bool idDict::GetFloat( const char* key, const char* defaultString, float& out ) const
 {
-	const char*	s;
-	bool		found;
-
-	found = GetString( key, defaultString, &s );
-	out = atof( s );
-	return found;
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		out = kv->floatValue;
+		return true;
+	}
+	out = atof( defaultString );
+	return false;
 }
 
 /*
@@ -357,12 +409,14 @@ idDict::GetInt
 */
 bool idDict::GetInt( const char* key, const char* defaultString, int& out ) const
 {
-	const char*	s;
-	bool		found;
-
-	found = GetString( key, defaultString, &s );
-	out = atoi( s );
-	return found;
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		out = kv->intValue;
+		return true;
+	}
+	out = atoi( defaultString );
+	return false;
 }
 
 /*
@@ -372,12 +426,14 @@ idDict::GetBool
 */
 bool idDict::GetBool( const char* key, const char* defaultString, bool& out ) const
 {
-	const char*	s;
-	bool		found;
-
-	found = GetString( key, defaultString, &s );
-	out = ( atoi( s ) != 0 );
-	return found;
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		out = ( kv->intValue != 0 );
+		return true;
+	}
+	out = ( atoi( defaultString ) != 0 );
+	return false;
 }
 
 /*
@@ -390,7 +446,7 @@ bool idDict::GetFloat( const char* key, const float defaultFloat, float& out ) c
 	const idKeyValue* kv = FindKey( key );
 	if( kv )
 	{
-		out = atof( kv->GetValue() );
+		out = kv->floatValue;
 		return true;
 	}
 	else
@@ -410,7 +466,7 @@ bool idDict::GetInt( const char* key, const int defaultInt, int& out ) const
 	const idKeyValue* kv = FindKey( key );
 	if( kv )
 	{
-		out = atoi( kv->GetValue() );
+		out = kv->intValue;
 		return true;
 	}
 	else
@@ -430,7 +486,7 @@ bool idDict::GetBool( const char* key, const bool defaultBool, bool& out ) const
 	const idKeyValue* kv = FindKey( key );
 	if( kv )
 	{
-		out = ( atoi( kv->GetValue() ) != 0 );
+		out = ( kv->intValue != 0 );
 		return true;
 	}
 	else
@@ -468,18 +524,21 @@ idDict::GetVector
 */
 bool idDict::GetVector( const char* key, const char* defaultString, idVec3& out ) const
 {
-	bool		found;
-	const char*	s;
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		out = kv->vectorValue;
+		return true;
+	}
 
 	if( !defaultString )
 	{
 		defaultString = "0 0 0";
 	}
 
-	found = GetString( key, defaultString, &s );
 	out.Zero();
-	sscanf( s, "%f %f %f", &out.x, &out.y, &out.z );
-	return found;
+	sscanf( defaultString, "%f %f %f", &out.x, &out.y, &out.z );
+	return false;
 }
 
 /*
@@ -613,6 +672,158 @@ int idDict::FindKeyIndex( const char* key ) const
 	return -1;
 }
 
+/*
+================
+idDict::FindKey
+
+  the keys are interned in the case insensitive key pool so they can be compared by pointer
+================
+*/
+const idKeyValue* idDict::FindKey( const idDictKey& key ) const
+{
+	const idPoolStr* poolStr = key.GetPoolStr();
+	if( poolStr == NULL )
+	{
+		return FindKey( key.c_str() );
+	}
+
+	for( int i = argHash.First( argHash.GenerateKey( key.GetHash() ) ); i != -1; i = argHash.Next( i ) )
+	{
+		if( args[i].key == poolStr )
+		{
+			return &args[i];
+		}
+	}
+
+	return NULL;
+}
+
+/*
+================
+idDict::FindKeyIndex
+================
+*/
+int idDict::FindKeyIndex( const idDictKey& key ) const
+{
+	const idPoolStr* poolStr = key.GetPoolStr();
+	if( poolStr == NULL )
+	{
+		return FindKeyIndex( key.c_str() );
+	}
+
+	for( int i = argHash.First( argHash.GenerateKey( key.GetHash() ) ); i != -1; i = argHash.Next( i ) )
+	{
+		if( args[i].key == poolStr )
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/*
+================
+idDict::GetString
+================
+*/
+bool idDict::GetString( const idDictKey& key, const char* defaultString, const char** out ) const
+{
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		*out = kv->GetValue();
+		return true;
+	}
+	*out = defaultString;
+	return false;
+}
+
+/*
+================
+idDict::GetString
+================
+*/
+bool idDict::GetString( const idDictKey& key, const char* defaultString, idStr& out ) const
+{
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		out = kv->GetValue();
+		return true;
+	}
+	out = defaultString;
+	return false;
+}
+
+/*
+================
+idDict::GetFloat
+================
+*/
+bool idDict::GetFloat( const idDictKey& key, const float defaultFloat, float& out ) const
+{
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		out = kv->floatValue;
+		return true;
+	}
+	out = defaultFloat;
+	return false;
+}
+
+/*
+================
+idDict::GetInt
+================
+*/
+bool idDict::GetInt( const idDictKey& key, const int defaultInt, int& out ) const
+{
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		out = kv->intValue;
+		return true;
+	}
+	out = defaultInt;
+	return false;
+}
+
+/*
+================
+idDict::GetBool
+================
+*/
+bool idDict::GetBool( const idDictKey& key, const bool defaultBool, bool& out ) const
+{
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		out = ( kv->intValue != 0 );
+		return true;
+	}
+	out = defaultBool;
+	return false;
+}
+
+/*
+================
+idDict::GetVector
+================
+*/
+bool idDict::GetVector( const idDictKey& key, const idVec3& defaultVector, idVec3& out ) const
+{
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		out = kv->vectorValue;
+		return true;
+	}
+	out = defaultVector;
+	return false;
+}
+
 /*
 ================
 idDict::Delete
@@ -1049,6 +1260,12 @@ void idDict::Init()
 {
 	globalKeys.SetCaseSensitive( false );
 	globalValues.SetCaseSensitive( true );
+
+	keysInitialized = true;
+	for( idDictKey* key = idDictKey::handles; key != NULL; key = key->next )
+	{
+		key->Intern();
+	}
 }
 
 /*
@@ -1058,6 +1275,12 @@ idDict::Shutdown
 */
 void idDict::Shutdown()
 {
+	for( idDictKey* key = idDictKey::handles; key != NULL; key = key->next )
+	{
+		key->Release();
+	}
+	keysInitialized = false;
+
 	globalKeys.Clear();
 	globalValues.Clear();
 }
@@ -1114,3 +1337,228 @@ void idDict::ListValues_f( const idCmdArgs& args )
 	//}
 	//idLib::common->Printf( "%5d values\n", valueStrings.Num() );
 }
+
+/*
+================
+idDictKey::idDictKey
+================
+*/
+idDictKey::idDictKey( const char* name )
+{
+	this->name = name;
+	hash = idStr::IHash( name );
+	poolStr = NULL;
+	Link();
+}
+
+/*
+================
+idDictKey::idDictKey
+================
+*/
+idDictKey::idDictKey( const idDictKey& other )
+{
+	name = other.name;
+	hash = other.hash;
+	poolStr = NULL;
+	Link();
+}
+
+/*
+================
+idDictKey::~idDictKey
+================
+*/
+idDictKey::~idDictKey()
+{
+	Release();
+	Unlink();
+}
+
+/*
+================
+idDictKey::operator=
+================
+*/
+idDictKey& idDictKey::operator=( const idDictKey& other )
+{
+	if( this != &other )
+	{
+		Release();
+		name = other.name;
+		hash = other.hash;
+		if( idDict::keysInitialized )
+		{
+			Intern();
+		}
+	}
+	return *this;
+}
+
+/*
+================
+idDictKey::Link
+================
+*/
+void idDictKey::Link()
+{
+	next = handles;
+	handles = this;
+
+	// static handles are usually constructed before idDict::Init, which interns them
+	if( idDict::keysInitialized )
+	{
+		Intern();
+	}
+}
+
+/*
+================
+idDictKey::Unlink
+================
+*/
+void idDictKey::Unlink()
+{
+	for( idDictKey** link = &handles; *link != NULL; link = &( *link )->next )
+	{
+		if( *link == this )
+		{
+			*link = next;
+			break;
+		}
+	}
+}
+
+/*
+================
+idDictKey::Intern
+
+  keeps a reference on the pool string for as long as the handle lives
+================
+*/
+void idDictKey::Intern()
+{
+	// idDict::Init can be called again without a Shutdown, the old reference is still valid then
+	Release();
+	poolStr = idDict::globalKeys.AllocString( name );
+}
+
+/*
+================
+idDictKey::Release
+================
+*/
+void idDictKey::Release()
+{
+	// static handles are usually destroyed after the pools
+	if( poolStr != NULL && !dictPoolsDestroyed )
+	{
+		idDict::globalKeys.FreeString( poolStr );
+	}
+	poolStr = NULL;
+}
+
+/*
+================
+TestDictValues
+
+  compares the numbers stored with every key/value pair against parsing the value
+================
+*/
+static int TestDictValues( const idDict& dict, const char* operation )
+{
+	int numFailed = 0;
+	for( int i = 0; i < dict.GetNumKeyVals(); i++ )
+	{
+		const idKeyValue* kv = dict.GetKeyVal( i );
+		const char* key = kv->GetKey();
+		const char* value = kv->GetValue();
+		const idDictKey keyHandle( key );
+
+		const int intValue = atoi( value );
+		const float floatValue = atof( value );
+		idVec3 vectorValue( vec3_zero );
+		sscanf( value, "%f %f %f", &vectorValue.x, &vectorValue.y, &vectorValue.z );
+
+		const int getInt = dict.GetInt( key );
+		const float getFloat = dict.GetFloat( key );
+		const idVec3 getVector = dict.GetVector( key );
+		const float handleFloat = dict.GetFloat( keyHandle );
+		const idVec3 handleVector = dict.GetVector( keyHandle );
+
+		// compare the bits so nan values match
+		if( getInt != intValue || dict.GetInt( keyHandle ) != intValue || dict.GetBool( key ) != ( intValue != 0 )
+				|| memcmp( &getFloat, &floatValue, sizeof( float ) ) != 0 || memcmp( &handleFloat, &floatValue, sizeof( float ) ) != 0
+				|| memcmp( &getVector, &vectorValue, sizeof( idVec3 ) ) != 0 || memcmp( &handleVector, &vectorValue, sizeof( idVec3 ) ) != 0 )
+		{
+			idLib::Printf( "%s: \"%s\" \"%s\" reads %d %g ( %s ) instead of %d %g ( %s )\n", operation, key, value,
+						   getInt, getFloat, getVector.ToString(), intValue, floatValue, vectorValue.ToString() );
+			numFailed++;
+		}
+	}
+	return numFailed;
+}
+
+CONSOLE_COMMAND( testDictValues, "checks the numbers idDict stores with its values against parsing the values", 0 )
+{
+	static const char* values[][2] =
+	{
+		{ "int", "12" },
+		{ "negative", "-3.5" },
+		{ "vector", "1 2 3" },
+		{ "padded", " \t4.25 -5 6e2" },
+		{ "short", "7 8" },
+		{ "long", "1 2 3 4" },
+		{ "text", "abc" },
+		{ "trailing", "12abc" },
+		{ "empty", "" },
+		{ "hex", "0x1A" },
+		{ "fraction", ".5" },
+		{ "plus", "+9" },
+		{ "inf", "inf" },
+		{ "nan", "nan" },
+		{ "large", "3000000000" },
+	};
+
+	int numFailed = 0;
+
+	idDict set;
+	for( int i = 0; i < ARRAY_COUNT( values ); i++ )
+	{
+		set.Set( values[i][0], values[i][1] );
+	}
+	numFailed += TestDictValues( set, "Set" );
+
+	idDict copy;
+	copy.Set( "int", "99" );
+	copy.Set( "other", "5 5 5" );
+	copy.Copy( set );
+	numFailed += TestDictValues( copy, "Copy" );
+
+	idDict assigned;
+	assigned = set;
+	numFailed += TestDictValues( assigned, "operator=" );
+
+	idDict transferred;
+	transferred.Set( "int", "99" );
+	transferred.TransferKeyValues( assigned );
+	numFailed += TestDictValues( transferred, "TransferKeyValues" );
+
+	idDict defaults;
+	defaults.Set( "vector", "4 5 6" );
+	defaults.SetDefaults( &set );
+	numFailed += TestDictValues( defaults, "SetDefaults" );
+
+	set.Set( "vector", "-1 -2" );
+	set.Set( "text", "42" );
+	numFailed += TestDictValues( set, "Set again" );
+
+	if( numFailed > 0 )
+	{
+		idLib::Warning( "testDictValues: %d values differ", numFailed );
+	}
+	else
+	{
+		idLib::Printf( "testDictValues: all values match\n" );
+	}
+}
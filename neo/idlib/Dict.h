@@ -45,6 +45,16 @@ Keys are compared case-insensitive.
 
 Does not allocate memory until the first key/value pair is added.
 
+Keys that are looked up often can be wrapped in an idDictKey. The key name
+is interned in the global key pool once, so a lookup through the handle only
+compares pool pointers instead of hashing and comparing the name:
+
+	static const idDictKey healthKey( "health" );
+	health = spawnArgs.GetInt( healthKey, 100 );
+
+Every value is also parsed as an int, a float and a vector when it is set,
+so the numeric getters only read the stored numbers.
+
 ===============================================================================
 */
 
@@ -79,6 +89,66 @@ public:
 private:
 	const idPoolStr* 	key;
 	const idPoolStr* 	value;
+
+	// value parsed with atoi, atof and sscanf( "%f %f %f" ) whenever it is set
+	int					intValue;
+	float				floatValue;
+	idVec3				vectorValue;
+
+	void				SetValue( const idPoolStr* newValue );
+	// takes the numbers of a key/value pair with the same value instead of parsing them again
+	void				SetValue( const idPoolStr* newValue, const idKeyValue& parsed );
+};
+
+/*
+================================================
+idDictKey
+
+Precomputed key for idDict lookups. All handles are linked together so
+idDict::Init can intern the names of static handles that were constructed
+before the key pool was set up, and idDict::Shutdown can release them before
+the pool is cleared. Lookups never touch the key pool, but handles must be
+constructed and destroyed on the main thread.
+================================================
+*/
+class idDictKey
+{
+	friend class idDict;
+
+public:
+	explicit			idDictKey( const char* name );
+						idDictKey( const idDictKey& other );
+						~idDictKey();
+
+	idDictKey& 			operator=( const idDictKey& other );
+
+	const char* 		c_str() const
+	{
+		return name.c_str();
+	}
+	// returns the full case insensitive hash of the key name
+	int					GetHash() const
+	{
+		return hash;
+	}
+	// returns the key name interned in the global key pool, NULL before idDict::Init
+	const idPoolStr* 	GetPoolStr() const
+	{
+		return poolStr;
+	}
+
+private:
+	idStr				name;
+	int					hash;
+	const idPoolStr* 	poolStr;
+	idDictKey* 			next;			// next in the list of all handles
+
+	static idDictKey* 	handles;
+
+	void				Link();
+	void				Unlink();
+	void				Intern();
+	void				Release();
 };
 
 /*
@@ -97,6 +167,8 @@ public:
 
 class idDict
 {
+	friend class idDictKey;
+
 public:
 	idDict();
 	idDict( const idDict& other );	// allow declaration with assignment
@@ -105,6 +177,9 @@ public:
 	// set the granularity for the index
 	void				SetGranularity( int granularity );
 
+	// set the memory tag used for the key/value list
+	void				SetMemTag( memTag_t tag );
+
 	// set hash size
 	void				SetHashSize( int hashSize );
 
@@ -173,6 +248,22 @@ public:
 	bool				GetAngles( const char* key, const char* defaultString, idAngles& out ) const;
 	bool				GetMatrix( const char* key, const char* defaultString, idMat3& out ) const;
 
+	// lookups through precomputed keys, these compare pool pointers instead of strings
+	const idKeyValue* 	FindKey( const idDictKey& key ) const;
+	int					FindKeyIndex( const idDictKey& key ) const;
+	const char* 		GetString( const idDictKey& key, const char* defaultString = "" ) const;
+	float				GetFloat( const idDictKey& key, const float defaultFloat = 0.0f ) const;
+	int					GetInt( const idDictKey& key, const int defaultInt = 0 ) const;
+	bool				GetBool( const idDictKey& key, const bool defaultBool = false ) const;
+	idVec3				GetVector( const idDictKey& key, const idVec3& defaultVector = vec3_origin ) const;
+
+	bool				GetString( const idDictKey& key, const char* defaultString, const char** out ) const;
+	bool				GetString( const idDictKey& key, const char* defaultString, idStr& out ) const;
+	bool				GetFloat( const idDictKey& key, const float defaultFloat, float& out ) const;
+	bool				GetInt( const idDictKey& key, const int defaultInt, int& out ) const;
+	bool				GetBool( const idDictKey& key, const bool defaultBool, bool& out ) const;
+	bool				GetVector( const idDictKey& key, const idVec3& defaultVector, idVec3& out ) const;
+
 	int					GetNumKeyVals() const;
 	const idKeyValue* 	GetKeyVal( int index ) const;
 
@@ -225,6 +316,7 @@ private:
 
 	static idStrPool	globalKeys;
 	static idStrPool	globalValues;
+	static bool			keysInitialized;	// idDictKey handles are interned between Init and Shutdown
 };
 
 
@@ -251,6 +343,11 @@ ID_INLINE void idDict::SetGranularity( int granularity )
 	argHash.SetGranularity( granularity );
 }
 
+ID_INLINE void idDict::SetMemTag( memTag_t tag )
+{
+	args.SetMemTag( tag );
+}
+
 ID_INLINE void idDict::SetHashSize( int hashSize )
 {
 	if( args.Num() == 0 )
@@ -335,17 +432,32 @@ ID_INLINE const char* idDict::GetString( const char* key, const char* defaultStr
 
 ID_INLINE float idDict::GetFloat( const char* key, const char* defaultString ) const
 {
-	return atof( GetString( key, defaultString ) );
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		return kv->floatValue;
+	}
+	return atof( defaultString );
 }
 
 ID_INLINE int idDict::GetInt( const char* key, const char* defaultString ) const
 {
-	return atoi( GetString( key, defaultString ) );
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		return kv->intValue;
+	}
+	return atoi( defaultString );
 }
 
 ID_INLINE bool idDict::GetBool( const char* key, const char* defaultString ) const
 {
-	return ( atoi( GetString( key, defaultString ) ) != 0 );
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		return ( kv->intValue != 0 );
+	}
+	return ( atoi( defaultString ) != 0 );
 }
 
 ID_INLINE float idDict::GetFloat( const char* key, const float defaultFloat ) const
@@ -353,7 +465,7 @@ ID_INLINE float idDict::GetFloat( const char* key, const float defaultFloat ) co
 	const idKeyValue* kv = FindKey( key );
 	if( kv )
 	{
-		return atof( kv->GetValue() );
+		return kv->floatValue;
 	}
 	return defaultFloat;
 }
@@ -363,7 +475,7 @@ ID_INLINE int idDict::GetInt( const char* key, int defaultInt ) const
 	const idKeyValue* kv = FindKey( key );
 	if( kv )
 	{
-		return atoi( kv->GetValue() );
+		return kv->intValue;
 	}
 	return defaultInt;
 }
@@ -373,7 +485,7 @@ ID_INLINE bool idDict::GetBool( const char* key, const bool defaultBool ) const
 	const idKeyValue* kv = FindKey( key );
 	if( kv )
 	{
-		return atoi( kv->GetValue() ) != 0;
+		return kv->intValue != 0;
 	}
 	return defaultBool;
 }
@@ -413,6 +525,53 @@ ID_INLINE idMat3 idDict::GetMatrix( const char* key, const char* defaultString )
 	return out;
 }
 
+ID_INLINE const char* idDict::GetString( const idDictKey& key, const char* defaultString ) const
+{
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		return kv->GetValue();
+	}
+	return defaultString;
+}
+
+ID_INLINE float idDict::GetFloat( const idDictKey& key, const float defaultFloat ) const
+{
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		return kv->floatValue;
+	}
+	return defaultFloat;
+}
+
+ID_INLINE int idDict::GetInt( const idDictKey& key, const int defaultInt ) const
+{
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		return kv->intValue;
+	}
+	return defaultInt;
+}
+
+ID_INLINE bool idDict::GetBool( const idDictKey& key, const bool defaultBool ) const
+{
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		return kv->intValue != 0;
+	}
+	return defaultBool;
+}
+
+ID_INLINE idVec3 idDict::GetVector( const idDictKey& key, const idVec3& defaultVector ) const
+{
+	idVec3 out;
+	GetVector( key, defaultVector, out );
+	return out;
+}
+
 ID_INLINE int idDict::GetNumKeyVals() const
 {
 	return args.Num();
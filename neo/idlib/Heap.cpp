@@ -37,29 +37,164 @@ If you have questions concerning this license or the applicable additional terms
 //
 //===============================================================
 #include <stdlib.h>
+#include <atomic>
 #undef new
 
+// Small allocations are served from size class pools with a per-thread cache,
+// larger ones go straight to the system allocator. Undefine this to send all
+// allocations to the system allocator, e.g. for memory debugging tools.
+#define USE_POOLED_HEAP
+
+/*
+================================================================================================
+
+	Allocation header
+
+Every allocation is preceded by a 16 byte header so Mem_Free16 knows the size class
+and the memory tag of the block. This keeps the returned pointer 16 byte aligned.
+
+================================================================================================
+*/
+
+static const uint32	MEM_HEADER_MAGIC		= 0xC0DE1DEA;
+static const uint32	MEM_FREED_MAGIC			= 0xDEADF4EE;
+static const uint8	MEM_LARGE_BLOCK			= 0xFF;
+static const uint8	MEM_FRAME_BLOCK			= 0xFE;
+static const uint8	MEM_LEVEL_BLOCK			= 0xFD;
+
+struct memHeader_t
+{
+	uint64			size;			// requested size in bytes
+	uint32			magic;
+	uint8			tag;
+	uint8			sizeClass;		// MEM_LARGE_BLOCK for blocks from the system allocator, MEM_FRAME_BLOCK for the frame arena, MEM_LEVEL_BLOCK for level regions
+	uint16			pad;			// region and size class of level blocks
+};
+
+compile_time_assert( sizeof( memHeader_t ) == 16 );
+compile_time_assert( TAG_NUM_TAGS <= 256 );
+
+/*
+================================================================================================
+
+	Per tag statistics
+
+================================================================================================
+*/
+
+static const char* memTagNames[] =
+{
+#define MEM_TAG( x )	#x,
+#include "sys/sys_alloc_tags.h"
+};
+
+compile_time_assert( sizeof( memTagNames ) / sizeof( memTagNames[0] ) == TAG_NUM_TAGS );
+
+// Every thread counts into its own counters so tracking never writes memory shared with
+// other threads. A block freed on another thread than the one that allocated it moves the
+// counts of both threads, only the sum over all threads is meaningful. The peak is sampled
+// when the counters are summed up, once per frame and whenever the stats are read.
+struct memTagCounters_t
+{
+	std::atomic<int64>	liveBytes;
+	std::atomic<int64>	liveAllocs;
+	std::atomic<int64>	totalAllocs;
+};
+
+enum memThreadState_t
+{
+	MEM_THREAD_NEW,
+	MEM_THREAD_ACTIVE,
+	MEM_THREAD_EXITED
+};
+
+struct memThreadStats_t
+{
+	memTagCounters_t	tags[TAG_NUM_TAGS];
+	memThreadStats_t* 	next;
+	int					state;
+};
+
+static thread_local memThreadStats_t	memThreadStats;
+
+static void Mem_TrackShared( const memTag_t tag, const int64 bytes, const int64 allocs );
+
 /*
 ==================
-Mem_Alloc16
+Mem_AddOwnCounter
+
+Only the owning thread writes its counters, so this needs no atomic read-modify-write.
 ==================
 */
-// RB: 64 bit fixes, changed int to size_t
-void* Mem_Alloc16( const size_t size, const memTag_t tag )
-// RB end
+static ID_INLINE void Mem_AddOwnCounter( std::atomic<int64>& counter, const int64 value )
 {
-	if( !size )
+	counter.store( counter.load( std::memory_order_relaxed ) + value, std::memory_order_relaxed );
+}
+
+/*
+==================
+Mem_TrackAlloc
+==================
+*/
+static ID_INLINE void Mem_TrackAlloc( const memTag_t tag, const size_t size )
+{
+	memThreadStats_t& stats = memThreadStats;
+	if( stats.state != MEM_THREAD_ACTIVE )
 	{
-		return NULL;
+		Mem_TrackShared( tag, ( int64 )size, 1 );
+		return;
+	}
+
+	memTagCounters_t& counters = stats.tags[tag];
+	Mem_AddOwnCounter( counters.liveBytes, ( int64 )size );
+	Mem_AddOwnCounter( counters.liveAllocs, 1 );
+	Mem_AddOwnCounter( counters.totalAllocs, 1 );
+}
+
+/*
+==================
+Mem_TrackFree
+==================
+*/
+static ID_INLINE void Mem_TrackFree( const memTag_t tag, const size_t size )
+{
+	memThreadStats_t& stats = memThreadStats;
+	if( stats.state != MEM_THREAD_ACTIVE )
+	{
+		Mem_TrackShared( tag, -( int64 )size, -1 );
+		return;
 	}
-	const size_t paddedSize = ( size + 15 ) & ~15;
+
+	memTagCounters_t& counters = stats.tags[tag];
+	Mem_AddOwnCounter( counters.liveBytes, -( int64 )size );
+	Mem_AddOwnCounter( counters.liveAllocs, -1 );
+}
+
+/*
+================================================================================================
+
+	System allocator
+
+================================================================================================
+*/
+
+/*
+==================
+Mem_SysAlloc
+==================
+*/
+static void* Mem_SysAlloc( const size_t size )
+{
 #ifdef _WIN32
 	// this should work with MSVC and mingw, as long as __MSVCRT_VERSION__ >= 0x0700
-	return _aligned_malloc( paddedSize, 16 );
+	return _aligned_malloc( size, 16 );
 #else // not _WIN32
 	// DG: the POSIX solution for linux etc
 	void* ret;
-	posix_memalign( &ret, 16, paddedSize );
+	if( posix_memalign( &ret, 16, size ) != 0 )
+	{
+		return NULL;
+	}
 	return ret;
 	// DG end
 #endif // _WIN32
@@ -67,15 +202,11 @@ void* Mem_Alloc16( const size_t size, const memTag_t tag )
 
 /*
 ==================
-Mem_Free16
+Mem_SysFree
 ==================
 */
-void Mem_Free16( void* ptr )
+static void Mem_SysFree( void* ptr )
 {
-	if( ptr == NULL )
-	{
-		return;
-	}
 #ifdef _WIN32
 	_aligned_free( ptr );
 #else // not _WIN32
@@ -86,6 +217,1167 @@ void Mem_Free16( void* ptr )
 #endif // _WIN32
 }
 
+/*
+================================================================================================
+
+	Size class pools
+
+Blocks of each size class are carved from 64 kB pages that are never returned to the
+system, so long sessions reuse the same pages instead of fragmenting the system heap.
+Each thread keeps a small cache of free blocks per size class and only takes the pool
+lock to move a whole batch of blocks between its cache and the shared free list.
+
+The heap is used before any static constructors run so everything here must be
+constant initialized.
+
+================================================================================================
+*/
+
+static const int	MEM_NUM_SIZE_CLASSES	= 19;
+static const int	MEM_MAX_SMALL_BLOCK		= 1024;
+static const int	MEM_POOL_PAGE_SIZE		= 64 * 1024;
+static const int	MEM_CACHE_BATCH			= 32;
+static const int	MEM_CACHE_MAX			= MEM_CACHE_BATCH * 2;
+
+// block sizes include the header
+static const int	memSizeClassBytes[MEM_NUM_SIZE_CLASSES] =
+{
+	32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640, 768, 896, 1024
+};
+
+// size class for each 16 byte step of the block size
+static const uint8	memSizeClassForSize[MEM_MAX_SMALL_BLOCK / 16 + 1] =
+{
+	0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 11, 11, 12, 12, 12, 12, 13, 13, 13, 13, 14, 14, 14,
+	14, 15, 15, 15, 15, 15, 15, 15, 15, 16, 16, 16, 16, 16, 16, 16, 16, 17, 17, 17, 17, 17, 17, 17, 17, 18, 18, 18,
+	18, 18, 18, 18, 18
+};
+
+struct memFreeBlock_t
+{
+	memFreeBlock_t* 	next;
+};
+
+class idHeapSpinLock
+{
+public:
+	void				Lock()
+	{
+		while( locked.exchange( 1, std::memory_order_acquire ) != 0 )
+		{
+			while( locked.load( std::memory_order_relaxed ) != 0 )
+			{
+				Sys_Yield();
+			}
+		}
+	}
+
+	void				Unlock()
+	{
+		locked.store( 0, std::memory_order_release );
+	}
+
+private:
+	std::atomic<int>	locked;
+};
+
+struct memSizeClassPool_t
+{
+	idHeapSpinLock		lock;
+	memFreeBlock_t* 	freeList;
+	byte* 				pageCursor;		// unused remainder of the last page
+	byte* 				pageEnd;
+	int					numPages;
+	int					numFree;
+};
+
+struct memThreadCache_t
+{
+	memFreeBlock_t* 	freeList[MEM_NUM_SIZE_CLASSES];
+	int					numFree[MEM_NUM_SIZE_CLASSES];
+};
+
+static memSizeClassPool_t				memPools[MEM_NUM_SIZE_CLASSES];
+static std::atomic<int64>				memPoolPageBytes;
+static thread_local memThreadCache_t	memThreadCache;
+
+/*
+==================
+Mem_RefillCache
+
+Moves a batch of free blocks from the shared pool into the cache of this thread.
+==================
+*/
+static bool Mem_RefillCache( memThreadCache_t& cache, const int sizeClass )
+{
+	memSizeClassPool_t& pool = memPools[sizeClass];
+	const int blockSize = memSizeClassBytes[sizeClass];
+
+	pool.lock.Lock();
+
+	int count = 0;
+	while( count < MEM_CACHE_BATCH )
+	{
+		memFreeBlock_t* block = pool.freeList;
+		if( block != NULL )
+		{
+			pool.freeList = block->next;
+			pool.numFree--;
+		}
+		else
+		{
+			if( pool.pageCursor == NULL || pool.pageCursor + blockSize > pool.pageEnd )
+			{
+				byte* page = ( byte* )Mem_SysAlloc( MEM_POOL_PAGE_SIZE );
+				if( page == NULL )
+				{
+					break;
+				}
+				pool.pageCursor = page;
+				pool.pageEnd = page + MEM_POOL_PAGE_SIZE;
+				pool.numPages++;
+				memPoolPageBytes.fetch_add( MEM_POOL_PAGE_SIZE, std::memory_order_relaxed );
+			}
+			block = ( memFreeBlock_t* )pool.pageCursor;
+			pool.pageCursor += blockSize;
+		}
+
+		block->next = cache.freeList[sizeClass];
+		cache.freeList[sizeClass] = block;
+		count++;
+	}
+
+	pool.lock.Unlock();
+
+	cache.numFree[sizeClass] += count;
+	return count > 0;
+}
+
+/*
+==================
+Mem_FlushCache
+
+Returns free blocks from the cache of this thread to the shared pool.
+==================
+*/
+static void Mem_FlushCache( memThreadCache_t& cache, const int sizeClass, const int count )
+{
+	if( count <= 0 )
+	{
+		return;
+	}
+
+	memFreeBlock_t* first = cache.freeList[sizeClass];
+	memFreeBlock_t* last = first;
+	for( int i = 1; i < count; i++ )
+	{
+		last = last->next;
+	}
+	cache.freeList[sizeClass] = last->next;
+	cache.numFree[sizeClass] -= count;
+
+	memSizeClassPool_t& pool = memPools[sizeClass];
+	pool.lock.Lock();
+	last->next = pool.freeList;
+	pool.freeList = first;
+	pool.numFree += count;
+	pool.lock.Unlock();
+}
+
+/*
+================================================================================================
+
+	Thread registration
+
+A thread is registered on its first allocation or free. When it exits, its cached blocks
+go back to the pools and its tag counts are folded into the counts of exited threads.
+Thread local destructors that run after that still work, their frees go straight back
+to the pools and their counts to the shared counters.
+
+================================================================================================
+*/
+
+struct memThreadExit_t
+{
+	~memThreadExit_t();
+};
+
+static void Mem_FrameArenaThreadExit();
+
+static idHeapSpinLock					memThreadStatsLock;
+static memThreadStats_t* 				memThreadStatsList;
+static memTagCounters_t					memExitedTagCounters[TAG_NUM_TAGS];
+static int64							memTagPeakBytes[TAG_NUM_TAGS];
+static thread_local memThreadExit_t		memThreadExit;
+
+/*
+==================
+Mem_TrackShared
+
+Tracks allocations of threads that are not registered yet or have already exited.
+==================
+*/
+static void Mem_TrackShared( const memTag_t tag, const int64 bytes, const int64 allocs )
+{
+	memThreadStats_t& stats = memThreadStats;
+	if( stats.state == MEM_THREAD_NEW )
+	{
+		// the first access of the exit object makes sure its destructor runs when the thread exits
+		( void )&memThreadExit;
+
+		memThreadStatsLock.Lock();
+		stats.next = memThreadStatsList;
+		memThreadStatsList = &stats;
+		stats.state = MEM_THREAD_ACTIVE;
+		memThreadStatsLock.Unlock();
+
+		if( allocs > 0 )
+		{
+			Mem_TrackAlloc( tag, ( size_t )bytes );
+		}
+		else
+		{
+			Mem_TrackFree( tag, ( size_t )( -bytes ) );
+		}
+		return;
+	}
+
+	memTagCounters_t& counters = memExitedTagCounters[tag];
+	counters.liveBytes.fetch_add( bytes, std::memory_order_relaxed );
+	counters.liveAllocs.fetch_add( allocs, std::memory_order_relaxed );
+	if( allocs > 0 )
+	{
+		counters.totalAllocs.fetch_add( allocs, std::memory_order_relaxed );
+	}
+}
+
+/*
+==================
+memThreadExit_t::~memThreadExit_t
+==================
+*/
+memThreadExit_t::~memThreadExit_t()
+{
+	Mem_FrameArenaThreadExit();
+
+	memThreadCache_t& cache = memThreadCache;
+	for( int i = 0; i < MEM_NUM_SIZE_CLASSES; i++ )
+	{
+		Mem_FlushCache( cache, i, cache.numFree[i] );
+	}
+
+	memThreadStats_t& stats = memThreadStats;
+	if( stats.state != MEM_THREAD_ACTIVE )
+	{
+		return;
+	}
+
+	memThreadStatsLock.Lock();
+	for( memThreadStats_t** link = &memThreadStatsList; *link != NULL; link = &( *link )->next )
+	{
+		if( *link == &stats )
+		{
+			*link = stats.next;
+			break;
+		}
+	}
+	for( int i = 0; i < TAG_NUM_TAGS; i++ )
+	{
+		memExitedTagCounters[i].liveBytes.fetch_add( stats.tags[i].liveBytes.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+		memExitedTagCounters[i].liveAllocs.fetch_add( stats.tags[i].liveAllocs.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+		memExitedTagCounters[i].totalAllocs.fetch_add( stats.tags[i].totalAllocs.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+	}
+	stats.state = MEM_THREAD_EXITED;
+	memThreadStatsLock.Unlock();
+}
+
+/*
+==================
+Mem_SumTagStats
+
+Must be called with memThreadStatsLock held.
+==================
+*/
+static void Mem_SumTagStats( const memTag_t tag, memTagStats_t& stats )
+{
+	const memTagCounters_t& exited = memExitedTagCounters[tag];
+	int64 liveBytes = exited.liveBytes.load( std::memory_order_relaxed );
+	int64 liveAllocs = exited.liveAllocs.load( std::memory_order_relaxed );
+	int64 totalAllocs = exited.totalAllocs.load( std::memory_order_relaxed );
+	for( const memThreadStats_t* thread = memThreadStatsList; thread != NULL; thread = thread->next )
+	{
+		const memTagCounters_t& counters = thread->tags[tag];
+		liveBytes += counters.liveBytes.load( std::memory_order_relaxed );
+		liveAllocs += counters.liveAllocs.load( std::memory_order_relaxed );
+		totalAllocs += counters.totalAllocs.load( std::memory_order_relaxed );
+	}
+
+	memTagPeakBytes[tag] = Max( memTagPeakBytes[tag], liveBytes );
+
+	stats.liveBytes = liveBytes;
+	stats.peakBytes = memTagPeakBytes[tag];
+	stats.liveAllocs = ( int )liveAllocs;
+	stats.totalAllocs = totalAllocs;
+}
+
+/*
+================================================================================================
+
+	Per-frame arena
+
+Allocations with TAG_FRAME are a pointer bump in an arena owned by the allocating
+thread and Mem_Free on them does nothing. Each thread has two buffers that are used
+in alternating frames, so memory stays valid until the end of the next frame. A
+buffer is rewound by its own thread on the first allocation in a new frame, which
+means no thread ever allocates from the arena of another thread. The usage counters
+are atomic because Mem_FrameArenaNextFrame and memFrameArenaStats read them from other
+threads. The arena of an exited thread is handed to the next new thread.
+
+================================================================================================
+*/
+
+static const size_t	MEM_FRAME_CHUNK_SIZE	= 1024 * 1024;
+
+struct memArenaChunk_t
+{
+	memArenaChunk_t* 	next;
+	size_t				size;		// including this header
+};
+
+compile_time_assert( sizeof( memArenaChunk_t ) == 16 );
+
+struct memFrameBuffer_t
+{
+	memArenaChunk_t* 			chunks;
+	memArenaChunk_t* 			current;
+	byte* 						cursor;
+	byte* 						end;
+	std::atomic<int>			frame;
+	std::atomic<size_t>			used;
+	std::atomic<size_t>			highWater;
+};
+
+struct memFrameArena_t
+{
+	memFrameBuffer_t	buffers[2];
+	memFrameArena_t* 	next;
+	bool				inUse;		// owned by a thread, protected by memFrameArenasLock
+};
+
+static std::atomic<int>					memFrameNumber;
+static std::atomic<int64>				memFrameChunkBytes;
+static int64							memFrameHighWater;
+static int64							memFrameLastBytes;
+static idHeapSpinLock					memFrameArenasLock;
+static memFrameArena_t* 				memFrameArenas;
+static thread_local memFrameArena_t* 	memThreadFrameArena;
+
+/*
+==================
+Mem_FrameArenaNewChunk
+==================
+*/
+static memArenaChunk_t* Mem_FrameArenaNewChunk( const size_t minSize )
+{
+	const size_t size = Max( MEM_FRAME_CHUNK_SIZE, minSize + sizeof( memArenaChunk_t ) );
+	memArenaChunk_t* chunk = ( memArenaChunk_t* )Mem_SysAlloc( size );
+	if( chunk == NULL )
+	{
+		return NULL;
+	}
+	chunk->next = NULL;
+	chunk->size = size;
+	memFrameChunkBytes.fetch_add( ( int64 )size, std::memory_order_relaxed );
+	return chunk;
+}
+
+/*
+==================
+Mem_FrameArenaSetChunk
+==================
+*/
+static void Mem_FrameArenaSetChunk( memFrameBuffer_t& buffer, memArenaChunk_t* chunk )
+{
+	buffer.current = chunk;
+	buffer.cursor = ( byte* )( chunk + 1 );
+	buffer.end = ( byte* )chunk + chunk->size;
+}
+
+/*
+==================
+Mem_FrameArenaAlloc
+==================
+*/
+static memHeader_t* Mem_FrameArenaAlloc( const size_t blockSize )
+{
+	memFrameArena_t* arena = memThreadFrameArena;
+	if( arena == NULL )
+	{
+		// the first access of the exit object makes sure the arena is handed back when the thread exits
+		( void )&memThreadExit;
+
+		memFrameArenasLock.Lock();
+		for( arena = memFrameArenas; arena != NULL && arena->inUse; arena = arena->next )
+		{
+		}
+		if( arena != NULL )
+		{
+			arena->inUse = true;
+		}
+		memFrameArenasLock.Unlock();
+
+		if( arena == NULL )
+		{
+			arena = ( memFrameArena_t* )Mem_SysAlloc( sizeof( memFrameArena_t ) );
+			if( arena == NULL )
+			{
+				return NULL;
+			}
+			memset( arena, 0, sizeof( *arena ) );
+			arena->buffers[0].frame.store( -1, std::memory_order_relaxed );
+			arena->buffers[1].frame.store( -1, std::memory_order_relaxed );
+			arena->inUse = true;
+
+			memFrameArenasLock.Lock();
+			arena->next = memFrameArenas;
+			memFrameArenas = arena;
+			memFrameArenasLock.Unlock();
+		}
+
+		memThreadFrameArena = arena;
+	}
+
+	const int frame = memFrameNumber.load( std::memory_order_relaxed );
+	memFrameBuffer_t& buffer = arena->buffers[frame & 1];
+	if( buffer.frame.load( std::memory_order_relaxed ) != frame )
+	{
+		// first allocation of this thread in a new frame, everything from two frames ago is dead
+		const size_t used = buffer.used.load( std::memory_order_relaxed );
+		buffer.highWater.store( Max( buffer.highWater.load( std::memory_order_relaxed ), used ), std::memory_order_relaxed );
+		buffer.used.store( 0, std::memory_order_relaxed );
+		buffer.frame.store( frame, std::memory_order_release );
+		if( buffer.chunks != NULL )
+		{
+			Mem_FrameArenaSetChunk( buffer, buffer.chunks );
+		}
+	}
+
+	if( buffer.chunks == NULL || buffer.cursor + blockSize > buffer.end )
+	{
+		// continue in the next chunk if it is large enough, otherwise insert a new one
+		memArenaChunk_t* next = ( buffer.chunks != NULL ) ? buffer.current->next : NULL;
+		if( next == NULL || next->size - sizeof( memArenaChunk_t ) < blockSize )
+		{
+			memArenaChunk_t* chunk = Mem_FrameArenaNewChunk( blockSize );
+			if( chunk == NULL )
+			{
+				return NULL;
+			}
+			if( buffer.chunks == NULL )
+			{
+				buffer.chunks = chunk;
+			}
+			else
+			{
+				chunk->next = buffer.current->next;
+				buffer.current->next = chunk;
+			}
+			next = chunk;
+		}
+		Mem_FrameArenaSetChunk( buffer, next );
+	}
+
+	memHeader_t* header = ( memHeader_t* )buffer.cursor;
+	buffer.cursor += blockSize;
+	buffer.used.store( buffer.used.load( std::memory_order_relaxed ) + blockSize, std::memory_order_relaxed );
+	return header;
+}
+
+/*
+==================
+Mem_FrameArenaThreadExit
+==================
+*/
+static void Mem_FrameArenaThreadExit()
+{
+	memFrameArena_t* arena = memThreadFrameArena;
+	if( arena == NULL )
+	{
+		return;
+	}
+
+	memFrameArenasLock.Lock();
+	arena->inUse = false;
+	memFrameArenasLock.Unlock();
+
+	memThreadFrameArena = NULL;
+}
+
+/*
+==================
+Mem_FrameArenaNextFrame
+==================
+*/
+void Mem_FrameArenaNextFrame()
+{
+	const int frame = memFrameNumber.load( std::memory_order_relaxed );
+
+	// sum up the frame that just ended, other threads may still be allocating so this is approximate
+	int64 total = 0;
+	memFrameArenasLock.Lock();
+	for( memFrameArena_t* arena = memFrameArenas; arena != NULL; arena = arena->next )
+	{
+		const memFrameBuffer_t& buffer = arena->buffers[frame & 1];
+		if( buffer.frame.load( std::memory_order_acquire ) == frame )
+		{
+			total += ( int64 )buffer.used.load( std::memory_order_relaxed );
+		}
+	}
+	memFrameArenasLock.Unlock();
+
+	memFrameLastBytes = total;
+	memFrameHighWater = Max( memFrameHighWater, total );
+
+	memFrameNumber.store( frame + 1, std::memory_order_relaxed );
+}
+
+/*
+==================
+memFrameArenaStats_f
+==================
+*/
+CONSOLE_COMMAND( memFrameArenaStats, "prints the usage of the per-frame arenas", 0 )
+{
+	const int frame = memFrameNumber.load( std::memory_order_relaxed );
+
+	int numArenas = 0;
+	memFrameArenasLock.Lock();
+	for( memFrameArena_t* arena = memFrameArenas; arena != NULL; arena = arena->next, numArenas++ )
+	{
+		const memFrameBuffer_t& previous = arena->buffers[( frame - 1 ) & 1];
+		size_t highWater = 0;
+		for( int i = 0; i < 2; i++ )
+		{
+			highWater = Max( highWater, arena->buffers[i].highWater.load( std::memory_order_relaxed ) );
+			highWater = Max( highWater, arena->buffers[i].used.load( std::memory_order_relaxed ) );
+		}
+		const size_t previousUsed = ( previous.frame.load( std::memory_order_relaxed ) == frame - 1 ) ? previous.used.load( std::memory_order_relaxed ) : 0;
+		idLib::Printf( "arena %2d: %8d kB last frame, %8d kB high water%s\n", numArenas,
+					   ( int )( previousUsed >> 10 ), ( int )( highWater >> 10 ), arena->inUse ? "" : " (free)" );
+	}
+	memFrameArenasLock.Unlock();
+
+	idLib::Printf( "%d thread arenas, %lld kB last frame, %lld kB high water, %lld kB in chunks\n", numArenas,
+				   ( long long )( memFrameLastBytes >> 10 ), ( long long )( memFrameHighWater >> 10 ),
+				   ( long long )( memFrameChunkBytes.load( std::memory_order_relaxed ) >> 10 ) );
+}
+
+/*
+================================================================================================
+
+	Level regions
+
+Allocations with a map lifetime tag are carved from the region of the level that was being
+loaded or played when they were made. Freed blocks go onto free lists of the region so cache
+churn during play reuses the same memory. Mem_BeginLevel retires the current region; a retired
+region hands all of its chunks back to the system in one operation when its last block is freed.
+Only tags whose owners are all torn down by the map shutdown or by the next map load use the
+regions, so a retired region is empty by the time the next level has loaded. Mem_EndLevelLoad
+warns about a retired region that still has live blocks, a block that outlived its level keeps
+the whole region alive. If every region slot is pinned that way level allocations fall back to
+the general heap until one drains.
+
+================================================================================================
+*/
+
+static const int	MEM_MAX_LEVEL_REGIONS	= 8;
+static const size_t	MEM_MAX_LEVEL_BLOCK		= 1024 * 1024;
+static const size_t	MEM_LEVEL_CHUNK_SIZE	= 4 * 1024 * 1024;
+// the small size classes followed by four steps per power of two from 1.25 kB up to
+// MEM_MAX_LEVEL_BLOCK, so a large block wastes at most a quarter of its class
+static const int	MEM_NUM_LEVEL_LARGE_STEPS	= 4;
+static const int	MEM_NUM_LEVEL_CLASSES	= MEM_NUM_SIZE_CLASSES + 10 * MEM_NUM_LEVEL_LARGE_STEPS;
+
+struct memLevelRegion_t
+{
+	memArenaChunk_t* 	chunks;
+	byte* 				cursor;
+	byte* 				end;
+	memFreeBlock_t* 	freeList[MEM_NUM_LEVEL_CLASSES];
+	int					level;
+	bool				inUse;
+	bool				retired;
+	int					liveBlocks;
+	int64				liveBytes;
+	int64				chunkBytes;
+	int64				loadBytes;		// live bytes when the level finished loading
+};
+
+static idHeapSpinLock					memLevelLock;
+static memLevelRegion_t					memLevelRegions[MEM_MAX_LEVEL_REGIONS];
+static std::atomic<int>					memLevelCurrent( -1 );
+static int								memLevelNumber;
+static int64							memLevelReleasedBytes;
+
+/*
+==================
+Mem_IsLevelTag
+
+The collision map is freed by the game map shutdown and the TAG_LEVEL render world and path
+allocators by the map shutdown or the next map load. AAS, clip model and entity allocations
+are left out, some of them are created at startup or carried over to the next map.
+==================
+*/
+static ID_INLINE bool Mem_IsLevelTag( const memTag_t tag )
+{
+	switch( tag )
+	{
+		case TAG_LEVEL:
+		case TAG_COLLISION:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+==================
+Mem_LevelClassBytes
+==================
+*/
+static ID_INLINE size_t Mem_LevelClassBytes( const int levelClass )
+{
+	if( levelClass < MEM_NUM_SIZE_CLASSES )
+	{
+		return ( size_t )memSizeClassBytes[levelClass];
+	}
+	const int largeClass = levelClass - MEM_NUM_SIZE_CLASSES;
+	const int step = largeClass % MEM_NUM_LEVEL_LARGE_STEPS;
+	return ( ( size_t )MEM_MAX_SMALL_BLOCK << ( largeClass / MEM_NUM_LEVEL_LARGE_STEPS ) ) * ( MEM_NUM_LEVEL_LARGE_STEPS + 1 + step ) / MEM_NUM_LEVEL_LARGE_STEPS;
+}
+
+/*
+==================
+Mem_LevelReleaseRegion
+
+Must be called with memLevelLock held.
+==================
+*/
+static void Mem_LevelReleaseRegion( memLevelRegion_t& region )
+{
+	memArenaChunk_t* chunk = region.chunks;
+	while( chunk != NULL )
+	{
+		memArenaChunk_t* next = chunk->next;
+		Mem_SysFree( chunk );
+		chunk = next;
+	}
+	memLevelReleasedBytes += region.chunkBytes;
+	memset( &region, 0, sizeof( region ) );
+}
+
+/*
+==================
+Mem_LevelAlloc
+
+Returns NULL if no level is active or the block is too large for a region.
+==================
+*/
+static memHeader_t* Mem_LevelAlloc( const size_t blockSize )
+{
+	if( memLevelCurrent.load( std::memory_order_relaxed ) < 0 || blockSize > MEM_MAX_LEVEL_BLOCK )
+	{
+		return NULL;
+	}
+
+	int levelClass;
+	if( blockSize <= MEM_MAX_SMALL_BLOCK )
+	{
+		levelClass = memSizeClassForSize[blockSize >> 4];
+	}
+	else
+	{
+		// skip to the first step of the power of two range of the block
+		levelClass = MEM_NUM_SIZE_CLASSES;
+		for( size_t octave = MEM_MAX_SMALL_BLOCK * 2; octave < blockSize; octave <<= 1 )
+		{
+			levelClass += MEM_NUM_LEVEL_LARGE_STEPS;
+		}
+		while( Mem_LevelClassBytes( levelClass ) < blockSize )
+		{
+			levelClass++;
+		}
+	}
+	const size_t classBytes = Mem_LevelClassBytes( levelClass );
+
+	memLevelLock.Lock();
+
+	const int regionNum = memLevelCurrent.load( std::memory_order_relaxed );
+	if( regionNum < 0 )
+	{
+		memLevelLock.Unlock();
+		return NULL;
+	}
+	memLevelRegion_t& region = memLevelRegions[regionNum];
+
+	memHeader_t* header;
+	if( region.freeList[levelClass] != NULL )
+	{
+		memFreeBlock_t* block = region.freeList[levelClass];
+		region.freeList[levelClass] = block->next;
+		header = ( memHeader_t* )block;
+	}
+	else
+	{
+		if( region.cursor + classBytes > region.end )
+		{
+			// the tail of the previous chunk is left unused
+			const size_t size = Max( MEM_LEVEL_CHUNK_SIZE, classBytes + sizeof( memArenaChunk_t ) );
+			memArenaChunk_t* chunk = ( memArenaChunk_t* )Mem_SysAlloc( size );
+			if( chunk == NULL )
+			{
+				memLevelLock.Unlock();
+				return NULL;
+			}
+			chunk->next = region.chunks;
+			chunk->size = size;
+			region.chunks = chunk;
+			region.cursor = ( byte* )( chunk + 1 );
+			region.end = ( byte* )chunk + size;
+			region.chunkBytes += ( int64 )size;
+		}
+		header = ( memHeader_t* )region.cursor;
+		region.cursor += classBytes;
+	}
+	region.liveBlocks++;
+	region.liveBytes += ( int64 )classBytes;
+
+	memLevelLock.Unlock();
+
+	header->sizeClass = MEM_LEVEL_BLOCK;
+	header->pad = ( uint16 )( ( regionNum << 8 ) | levelClass );
+	return header;
+}
+
+/*
+==================
+Mem_LevelFree
+==================
+*/
+static void Mem_LevelFree( memHeader_t* header )
+{
+	const int regionNum = header->pad >> 8;
+	const int levelClass = header->pad & 0xFF;
+	assert( regionNum < MEM_MAX_LEVEL_REGIONS && levelClass < MEM_NUM_LEVEL_CLASSES );
+
+	memLevelLock.Lock();
+
+	memLevelRegion_t& region = memLevelRegions[regionNum];
+	region.liveBlocks--;
+	region.liveBytes -= ( int64 )Mem_LevelClassBytes( levelClass );
+	if( region.retired && region.liveBlocks == 0 )
+	{
+		// last block of a finished level, the whole region goes back at once
+		Mem_LevelReleaseRegion( region );
+	}
+	else
+	{
+		memFreeBlock_t* block = ( memFreeBlock_t* )header;
+		block->next = region.freeList[levelClass];
+		region.freeList[levelClass] = block;
+	}
+
+	memLevelLock.Unlock();
+}
+
+/*
+==================
+Mem_BeginLevel
+==================
+*/
+void Mem_BeginLevel()
+{
+	memLevelLock.Lock();
+
+	const int current = memLevelCurrent.load( std::memory_order_relaxed );
+	if( current >= 0 )
+	{
+		memLevelRegion_t& region = memLevelRegions[current];
+		region.retired = true;
+		if( region.liveBlocks == 0 )
+		{
+			Mem_LevelReleaseRegion( region );
+		}
+	}
+
+	int next = -1;
+	for( int i = 0; i < MEM_MAX_LEVEL_REGIONS; i++ )
+	{
+		if( !memLevelRegions[i].inUse )
+		{
+			next = i;
+			break;
+		}
+	}
+	if( next >= 0 )
+	{
+		memLevelRegion_t& region = memLevelRegions[next];
+		memset( &region, 0, sizeof( region ) );
+		region.inUse = true;
+		region.level = ++memLevelNumber;
+	}
+	memLevelCurrent.store( next, std::memory_order_relaxed );
+
+	memLevelLock.Unlock();
+
+	if( next < 0 )
+	{
+		idLib::Warning( "Mem_BeginLevel: all %d level regions are still in use, level allocations go to the heap", MEM_MAX_LEVEL_REGIONS );
+	}
+}
+
+/*
+==================
+Mem_EndLevelLoad
+==================
+*/
+void Mem_EndLevelLoad()
+{
+	int pinnedRegions = 0;
+	int pinnedBlocks = 0;
+
+	memLevelLock.Lock();
+	const int current = memLevelCurrent.load( std::memory_order_relaxed );
+	if( current >= 0 )
+	{
+		memLevelRegions[current].loadBytes = memLevelRegions[current].liveBytes;
+	}
+	// everything of the previous levels should have been freed by now
+	for( int i = 0; i < MEM_MAX_LEVEL_REGIONS; i++ )
+	{
+		if( i != current && memLevelRegions[i].inUse )
+		{
+			pinnedRegions++;
+			pinnedBlocks += memLevelRegions[i].liveBlocks;
+		}
+	}
+	memLevelLock.Unlock();
+
+	if( pinnedRegions > 0 )
+	{
+		idLib::Warning( "Mem_EndLevelLoad: %d blocks keep %d previous level regions alive", pinnedBlocks, pinnedRegions );
+	}
+}
+
+/*
+==================
+memLevelStats_f
+==================
+*/
+CONSOLE_COMMAND( memLevelStats, "prints the usage of the level memory regions", 0 )
+{
+	memLevelRegion_t regions[MEM_MAX_LEVEL_REGIONS];
+
+	memLevelLock.Lock();
+	memcpy( regions, memLevelRegions, sizeof( regions ) );
+	const int current = memLevelCurrent.load( std::memory_order_relaxed );
+	const int64 releasedBytes = memLevelReleasedBytes;
+	memLevelLock.Unlock();
+
+	for( int i = 0; i < MEM_MAX_LEVEL_REGIONS; i++ )
+	{
+		const memLevelRegion_t& region = regions[i];
+		if( !region.inUse )
+		{
+			continue;
+		}
+		idLib::Printf( "level %3d%s: %8d blocks, %8d kB live, %8d kB after load, %8d kB in chunks\n", region.level,
+					   ( i == current ) ? " (current)" : "          ", region.liveBlocks, ( int )( region.liveBytes >> 10 ),
+					   ( int )( region.loadBytes >> 10 ), ( int )( region.chunkBytes >> 10 ) );
+	}
+	idLib::Printf( "%lld kB released by finished levels\n", ( long long )( releasedBytes >> 10 ) );
+}
+
+/*
+==================
+Mem_Alloc16
+==================
+*/
+// RB: 64 bit fixes, changed int to size_t
+void* Mem_Alloc16( const size_t size, const memTag_t tag )
+// RB end
+{
+	if( !size )
+	{
+		return NULL;
+	}
+	const size_t blockSize = ( ( size + 15 ) & ~15 ) + sizeof( memHeader_t );
+
+	memHeader_t* header;
+#ifdef USE_POOLED_HEAP
+	if( tag == TAG_FRAME )
+	{
+		header = Mem_FrameArenaAlloc( blockSize );
+		if( header == NULL )
+		{
+			return NULL;
+		}
+		header->size = size;
+		header->magic = MEM_HEADER_MAGIC;
+		header->tag = ( uint8 )tag;
+		header->sizeClass = MEM_FRAME_BLOCK;
+		header->pad = 0;
+		return header + 1;
+	}
+	else if( Mem_IsLevelTag( tag ) && ( header = Mem_LevelAlloc( blockSize ) ) != NULL )
+	{
+		// Mem_LevelAlloc filled in the size class and region
+	}
+	else if( blockSize <= MEM_MAX_SMALL_BLOCK )
+	{
+		const int sizeClass = memSizeClassForSize[blockSize >> 4];
+		memThreadCache_t& cache = memThreadCache;
+		if( cache.freeList[sizeClass] == NULL && !Mem_RefillCache( cache, sizeClass ) )
+		{
+			return NULL;
+		}
+		memFreeBlock_t* block = cache.freeList[sizeClass];
+		cache.freeList[sizeClass] = block->next;
+		cache.numFree[sizeClass]--;
+
+		header = ( memHeader_t* )block;
+		header->sizeClass = ( uint8 )sizeClass;
+		header->pad = 0;
+	}
+	else
+#endif
+	{
+		header = ( memHeader_t* )Mem_SysAlloc( blockSize );
+		if( header == NULL )
+		{
+			return NULL;
+		}
+		header->sizeClass = MEM_LARGE_BLOCK;
+		header->pad = 0;
+	}
+
+	header->size = size;
+	header->magic = MEM_HEADER_MAGIC;
+	header->tag = ( uint8 )tag;
+
+	Mem_TrackAlloc( tag, size );
+
+	return header + 1;
+}
+
+/*
+==================
+Mem_Free16
+==================
+*/
+void Mem_Free16( void* ptr )
+{
+	if( ptr == NULL )
+	{
+		return;
+	}
+
+	memHeader_t* header = ( ( memHeader_t* )ptr ) - 1;
+	if( header->magic != MEM_HEADER_MAGIC )
+	{
+		// a freed block keeps its header while it sits in a pool, a region or the frame arena,
+		// handing it to the system allocator would corrupt the system heap
+		assert( header->magic != MEM_FREED_MAGIC );
+		if( header->magic == MEM_FREED_MAGIC )
+		{
+			return;
+		}
+
+		// third party code that never saw our operator new may hand back memory
+		// from the system allocator, the magic never matches a malloc chunk header
+		Mem_SysFree( ptr );
+		return;
+	}
+	header->magic = MEM_FREED_MAGIC;
+
+	if( header->sizeClass == MEM_FRAME_BLOCK )
+	{
+		// released wholesale when the arena is rewound
+		return;
+	}
+
+	Mem_TrackFree( ( memTag_t )header->tag, ( size_t )header->size );
+
+	const int sizeClass = header->sizeClass;
+	if( sizeClass == MEM_LARGE_BLOCK )
+	{
+		Mem_SysFree( header );
+		return;
+	}
+	if( sizeClass == MEM_LEVEL_BLOCK )
+	{
+		Mem_LevelFree( header );
+		return;
+	}
+
+	memThreadCache_t& cache = memThreadCache;
+	memFreeBlock_t* block = ( memFreeBlock_t* )header;
+	block->next = cache.freeList[sizeClass];
+	cache.freeList[sizeClass] = block;
+	if( ++cache.numFree[sizeClass] > MEM_CACHE_MAX )
+	{
+		Mem_FlushCache( cache, sizeClass, MEM_CACHE_BATCH );
+	}
+	else if( memThreadStats.state == MEM_THREAD_EXITED )
+	{
+		// nothing flushes the cache of an exited thread again
+		Mem_FlushCache( cache, sizeClass, cache.numFree[sizeClass] );
+	}
+}
+
+/*
+==================
+Mem_Size
+==================
+*/
+size_t Mem_Size( const void* ptr )
+{
+	if( ptr == NULL )
+	{
+		return 0;
+	}
+	const memHeader_t* header = ( ( const memHeader_t* )ptr ) - 1;
+	return ( size_t )header->size;
+}
+
+/*
+==================
+Mem_GetTagName
+==================
+*/
+const char* Mem_GetTagName( const memTag_t tag )
+{
+	if( tag < 0 || tag >= TAG_NUM_TAGS )
+	{
+		return "UNKNOWN";
+	}
+	return memTagNames[tag];
+}
+
+/*
+==================
+Mem_GetTagStats
+==================
+*/
+void Mem_GetTagStats( const memTag_t tag, memTagStats_t& stats )
+{
+	memThreadStatsLock.Lock();
+	Mem_SumTagStats( tag, stats );
+	memThreadStatsLock.Unlock();
+}
+
+/*
+==================
+Mem_UpdateTagPeaks
+==================
+*/
+void Mem_UpdateTagPeaks()
+{
+	memTagStats_t stats;
+	memThreadStatsLock.Lock();
+	for( int i = 0; i < TAG_NUM_TAGS; i++ )
+	{
+		Mem_SumTagStats( ( memTag_t )i, stats );
+	}
+	memThreadStatsLock.Unlock();
+}
+
+/*
+==================
+Mem_GetPoolBytes
+==================
+*/
+size_t Mem_GetPoolBytes()
+{
+	return ( size_t )memPoolPageBytes.load( std::memory_order_relaxed );
+}
+
+/*
+==================
+memTagStats_f
+
+usage: memTagStats [ peak | count ]
+==================
+*/
+CONSOLE_COMMAND( memTagStats, "lists live and peak bytes and allocation counts per memory tag", 0 )
+{
+	struct tagLine_t
+	{
+		int				tag;
+		memTagStats_t	stats;
+	};
+
+	int sortMode = 0;
+	if( args.Argc() > 1 )
+	{
+		if( idStr::Icmp( args.Argv( 1 ), "peak" ) == 0 )
+		{
+			sortMode = 1;
+		}
+		else if( idStr::Icmp( args.Argv( 1 ), "count" ) == 0 )
+		{
+			sortMode = 2;
+		}
+		else
+		{
+			idLib::Printf( "usage: memTagStats [ peak | count ]\n" );
+			return;
+		}
+	}
+
+	tagLine_t lines[TAG_NUM_TAGS];
+	int numLines = 0;
+	int64 totalLive = 0;
+	int64 totalAllocs = 0;
+	for( int i = 0; i < TAG_NUM_TAGS; i++ )
+	{
+		tagLine_t& line = lines[numLines];
+		line.tag = i;
+		Mem_GetTagStats( ( memTag_t )i, line.stats );
+		if( line.stats.totalAllocs == 0 )
+		{
+			continue;
+		}
+		totalLive += line.stats.liveBytes;
+		totalAllocs += line.stats.liveAllocs;
+		numLines++;
+	}
+
+	std::sort( lines, lines + numLines, [sortMode]( const tagLine_t & a, const tagLine_t & b )
+	{
+		if( sortMode == 1 )
+		{
+			return a.stats.peakBytes > b.stats.peakBytes;
+		}
+		if( sortMode == 2 )
+		{
+			return a.stats.totalAllocs > b.stats.totalAllocs;
+		}
+		return a.stats.liveBytes > b.stats.liveBytes;
+	} );
+
+	idLib::Printf( "%-24s %10s %10s %10s %12s\n", "tag", "live kB", "peak kB", "live", "total" );
+	for( int i = 0; i < numLines; i++ )
+	{
+		const tagLine_t& line = lines[i];
+		idLib::Printf( "%-24s %10lld %10lld %10d %12lld\n", memTagNames[line.tag],
+					   ( long long )( line.stats.liveBytes >> 10 ), ( long long )( line.stats.peakBytes >> 10 ),
+					   line.stats.liveAllocs, ( long long )line.stats.totalAllocs );
+	}
+	idLib::Printf( "%lld kB in %lld live allocations, %lld kB in small block pool pages\n",
+				   ( long long )( totalLive >> 10 ), ( long long )totalAllocs, ( long long )( Mem_GetPoolBytes() >> 10 ) );
+}
+
 /*
 ==================
 Mem_ClearedAlloc
@@ -67,6 +67,37 @@ void* 		Mem_ClearedAlloc( const size_t size, const memTag_t tag );
 char* 		Mem_CopyString( const char* in );
 // RB end
 
+struct memTagStats_t
+{
+	int64		liveBytes;		// bytes currently allocated with this tag
+	int64		peakBytes;		// highest number of live bytes seen by Mem_UpdateTagPeaks or Mem_GetTagStats
+	int			liveAllocs;		// number of allocations currently alive
+	int64		totalAllocs;	// number of allocations since startup
+};
+
+// returns the requested size of a block returned by Mem_Alloc
+size_t		Mem_Size( const void* ptr );
+const char* Mem_GetTagName( const memTag_t tag );
+void		Mem_GetTagStats( const memTag_t tag, memTagStats_t& stats );
+// samples the live bytes of every tag into its peak, called once per frame
+void		Mem_UpdateTagPeaks();
+// returns the number of bytes in small block pool pages, including free blocks
+size_t		Mem_GetPoolBytes();
+
+// Allocations with TAG_FRAME come from a per-thread linear arena and are only valid until
+// the end of the next frame. Mem_Free on them is allowed but does not release anything.
+// This advances the arenas to the next frame and must only be called once per frame.
+void		Mem_FrameArenaNextFrame();
+
+// Allocations with TAG_LEVEL and TAG_COLLISION are carved from a region that belongs to the
+// map being loaded. The blocks are still freed one at a time, but the region pages go back to
+// the system in one go once the last block of a finished level is freed, so nothing from the
+// previous map fragments the heap of the next. Mem_BeginLevel retires the current region and
+// starts a new one, Mem_EndLevelLoad records how much the load used and warns about previous
+// regions that are still alive. Without an active level these tags use the general heap.
+void		Mem_BeginLevel();
+void		Mem_EndLevelLoad();
+
 #ifdef _MSC_VER						// SRS: #pragma warning is MSVC specific
 	#pragma warning( push )
 	#pragma warning( disable : 4595 )	// C4595: non-member operator new or delete functions may not be declared inline
@@ -91,6 +122,18 @@ ID_INLINE void operator delete[]( void* p ) noexcept
 {
 	Mem_Free( p );
 }
+
+// C++14 compilers call the sized versions when the type is known, these
+// must not fall through to the CRT because Mem_Alloc may hand out pooled blocks
+ID_INLINE void operator delete( void* p, size_t s ) noexcept
+{
+	Mem_Free( p );
+}
+
+ID_INLINE void operator delete[]( void* p, size_t s ) noexcept
+{
+	Mem_Free( p );
+}
 #ifdef _MSC_VER
 	#pragma warning( pop )
 #endif
@@ -136,7 +179,8 @@ class idTempArray
 {
 public:
 	idTempArray( idTempArray<T>& other );
-	idTempArray( unsigned int num );
+	// pass TAG_FRAME to allocate from the per-frame arena
+	idTempArray( unsigned int num, memTag_t tag = TAG_TEMP );
 
 	~idTempArray();
 
@@ -199,10 +243,10 @@ idTempArray::idTempArray
 ========================
 */
 template < class T >
-ID_INLINE idTempArray<T>::idTempArray( unsigned int num )
+ID_INLINE idTempArray<T>::idTempArray( unsigned int num, memTag_t tag )
 {
 	this->num = num;
-	buffer = ( T* )Mem_Alloc( num * sizeof( T ), TAG_TEMP );
+	buffer = ( T* )Mem_Alloc( num * sizeof( T ), tag );
 }
 
 /*
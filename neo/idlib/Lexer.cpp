@@ -112,6 +112,162 @@ int default_nextpunctuation[sizeof( default_punctuations ) / sizeof( punctuation
 int default_setup;
 
 char idLexer::baseFolder[ 256 ];
+bool idLexer::fastScan = true;
+
+#if defined(USE_INTRINSICS_SSE)
+
+/*
+================
+Lexer_LowestBit
+================
+*/
+static ID_INLINE int Lexer_LowestBit( const unsigned int mask )
+{
+	assert( mask != 0 );
+#if defined(_MSC_VER)
+	unsigned long bit;
+	_BitScanForward( &bit, mask );
+	return ( int )bit;
+#else
+	return __builtin_ctz( mask );
+#endif
+}
+
+/*
+================
+Lexer_InRange
+
+Returns a bit for every byte in the given range, the bytes are compared signed like a char.
+================
+*/
+static ID_INLINE unsigned int Lexer_InRange( const __m128i v, const char lo, const char hi )
+{
+	const __m128i above = _mm_cmpgt_epi8( v, _mm_set1_epi8( lo - 1 ) );
+	const __m128i below = _mm_cmplt_epi8( v, _mm_set1_epi8( hi + 1 ) );
+	return ( unsigned int )_mm_movemask_epi8( _mm_and_si128( above, below ) );
+}
+
+/*
+================
+Lexer_Match
+================
+*/
+static ID_INLINE unsigned int Lexer_Match( const __m128i v, const char c )
+{
+	return ( unsigned int )_mm_movemask_epi8( _mm_cmpeq_epi8( v, _mm_set1_epi8( c ) ) );
+}
+
+/*
+================
+Lexer_SkipSpaces
+
+Skips 16 bytes at a time up to the first character > ' ' or the terminating zero,
+the remaining bytes are left to the scalar loops. Counts the newlines skipped.
+================
+*/
+static ID_INLINE const char* Lexer_SkipSpaces( const char* p, const char* end, int& lines )
+{
+	const __m128i space = _mm_set1_epi8( ' ' );
+	const __m128i zero = _mm_setzero_si128();
+
+	while( p + 16 <= end )
+	{
+		const __m128i v = _mm_loadu_si128( ( const __m128i* )p );
+		const unsigned int stop = ( unsigned int )_mm_movemask_epi8( _mm_or_si128( _mm_cmpgt_epi8( v, space ), _mm_cmpeq_epi8( v, zero ) ) );
+		const unsigned int newlines = Lexer_Match( v, '\n' );
+		if( stop != 0 )
+		{
+			lines += idMath::BitCount( newlines & ( ( 1u << Lexer_LowestBit( stop ) ) - 1 ) );
+			return p + Lexer_LowestBit( stop );
+		}
+		lines += idMath::BitCount( newlines );
+		p += 16;
+	}
+	return p;
+}
+
+/*
+================
+Lexer_SkipUntil
+
+Skips up to the first of the three stop characters or the terminating zero. Counts the newlines skipped.
+================
+*/
+static ID_INLINE const char* Lexer_SkipUntil( const char* p, const char* end, const char a, const char b, const char c, int& lines )
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	while( p + 16 <= end )
+	{
+		const __m128i v = _mm_loadu_si128( ( const __m128i* )p );
+		const unsigned int stop = Lexer_Match( v, a ) | Lexer_Match( v, b ) | Lexer_Match( v, c ) | ( unsigned int )_mm_movemask_epi8( _mm_cmpeq_epi8( v, zero ) );
+		const unsigned int newlines = Lexer_Match( v, '\n' );
+		if( stop != 0 )
+		{
+			lines += idMath::BitCount( newlines & ( ( 1u << Lexer_LowestBit( stop ) ) - 1 ) );
+			return p + Lexer_LowestBit( stop );
+		}
+		lines += idMath::BitCount( newlines );
+		p += 16;
+	}
+	return p;
+}
+
+/*
+================
+Lexer_SkipNameChars
+================
+*/
+static ID_INLINE const char* Lexer_SkipNameChars( const char* p, const char* end, const int flags )
+{
+	while( p + 16 <= end )
+	{
+		const __m128i v = _mm_loadu_si128( ( const __m128i* )p );
+		unsigned int name = Lexer_InRange( v, 'a', 'z' ) | Lexer_InRange( v, 'A', 'Z' ) | Lexer_InRange( v, '0', '9' ) | Lexer_Match( v, '_' );
+		if( flags & LEXFL_ONLYSTRINGS )
+		{
+			name |= Lexer_Match( v, '-' );
+		}
+		if( flags & LEXFL_ALLOWPATHNAMES )
+		{
+			name |= Lexer_Match( v, '/' ) | Lexer_Match( v, '\\' ) | Lexer_Match( v, ':' ) | Lexer_Match( v, '.' );
+		}
+		if( name != 0xFFFF )
+		{
+			return p + Lexer_LowestBit( ~name );
+		}
+		p += 16;
+	}
+	return p;
+}
+
+/*
+================
+Lexer_SkipDigits
+
+Skips decimal digits and dots, counting the dots.
+================
+*/
+static ID_INLINE const char* Lexer_SkipDigits( const char* p, const char* end, int& dots )
+{
+	while( p + 16 <= end )
+	{
+		const __m128i v = _mm_loadu_si128( ( const __m128i* )p );
+		const unsigned int dot = Lexer_Match( v, '.' );
+		const unsigned int number = Lexer_InRange( v, '0', '9' ) | dot;
+		if( number != 0xFFFF )
+		{
+			const int n = Lexer_LowestBit( ~number );
+			dots += idMath::BitCount( dot & ( ( 1u << n ) - 1 ) );
+			return p + n;
+		}
+		dots += idMath::BitCount( dot );
+		p += 16;
+	}
+	return p;
+}
+
+#endif
 
 /*
 ================
@@ -270,6 +426,8 @@ void idLexer::Warning( const char* str, ... )
 	char text[MAX_STRING_CHARS];
 	va_list ap;
 
+	hadWarning = true;
+
 	if( idLexer::flags & LEXFL_NOWARNINGS )
 	{
 		return;
@@ -320,6 +478,12 @@ int idLexer::ReadWhiteSpace()
 {
 	while( 1 )
 	{
+#if defined(USE_INTRINSICS_SSE)
+		if( fastScan )
+		{
+			idLexer::script_p = Lexer_SkipSpaces( idLexer::script_p, idLexer::end_p, idLexer::line );
+		}
+#endif
 		// skip white space
 		while( *idLexer::script_p <= ' ' )
 		{
@@ -343,6 +507,12 @@ int idLexer::ReadWhiteSpace()
 				do
 				{
 					idLexer::script_p++;
+#if defined(USE_INTRINSICS_SSE)
+					if( fastScan )
+					{
+						idLexer::script_p = Lexer_SkipUntil( idLexer::script_p, idLexer::end_p, '\n', '\n', '\n', idLexer::line );
+					}
+#endif
 					if( !*idLexer::script_p )
 					{
 						return 0;
@@ -364,6 +534,12 @@ int idLexer::ReadWhiteSpace()
 				while( 1 )
 				{
 					idLexer::script_p++;
+#if defined(USE_INTRINSICS_SSE)
+					if( fastScan )
+					{
+						idLexer::script_p = Lexer_SkipUntil( idLexer::script_p, idLexer::end_p, '/', '/', '/', idLexer::line );
+					}
+#endif
 					if( !*idLexer::script_p )
 					{
 						return 0;
@@ -714,6 +890,20 @@ int idLexer::ReadString( idToken* token, int quote )
 		}
 		else
 		{
+#if defined(USE_INTRINSICS_SSE)
+			if( fastScan )
+			{
+				// copy everything up to the next quote, escape character or newline at once
+				int newlines = 0;
+				const char* run = Lexer_SkipUntil( idLexer::script_p, idLexer::end_p, quote, '\\', '\n', newlines );
+				if( run > idLexer::script_p )
+				{
+					token->AppendDirty( idLexer::script_p, run - idLexer::script_p );
+					idLexer::script_p = run;
+					continue;
+				}
+			}
+#endif
 			if( *idLexer::script_p == '\0' )
 			{
 				idLexer::Error( "missing trailing quote" );
@@ -761,6 +951,14 @@ int idLexer::ReadName( idToken* token )
 	do
 	{
 		token->AppendDirty( *idLexer::script_p++ );
+#if defined(USE_INTRINSICS_SSE)
+		if( fastScan )
+		{
+			const char* run = Lexer_SkipNameChars( idLexer::script_p, idLexer::end_p, idLexer::flags );
+			token->AppendDirty( idLexer::script_p, run - idLexer::script_p );
+			idLexer::script_p = run;
+		}
+#endif
 		c = *idLexer::script_p;
 	}
 	while( ( c >= 'a' && c <= 'z' ) ||
@@ -864,6 +1062,15 @@ int idLexer::ReadNumber( idToken* token )
 		dot = 0;
 		while( 1 )
 		{
+#if defined(USE_INTRINSICS_SSE)
+			if( fastScan )
+			{
+				const char* run = Lexer_SkipDigits( idLexer::script_p, idLexer::end_p, dot );
+				token->AppendDirty( idLexer::script_p, run - idLexer::script_p );
+				idLexer::script_p = run;
+				c = *idLexer::script_p;
+			}
+#endif
 			if( c >= '0' && c <= '9' )
 			{
 			}
@@ -2356,6 +2563,7 @@ idLexer::idLexer()
 	idLexer::token = "";
 	idLexer::next = NULL;
 	idLexer::hadError = false;
+	idLexer::hadWarning = false;
 }
 
 /*
@@ -2378,6 +2586,7 @@ idLexer::idLexer( int flags )
 	idLexer::token = "";
 	idLexer::next = NULL;
 	idLexer::hadError = false;
+	idLexer::hadWarning = false;
 }
 
 /*
@@ -2394,6 +2603,7 @@ idLexer::idLexer( const char* filename, int flags, bool OSPath )
 	idLexer::token = "";
 	idLexer::next = NULL;
 	idLexer::hadError = false;
+	idLexer::hadWarning = false;
 	idLexer::LoadFile( filename, OSPath );
 }
 
@@ -2411,6 +2621,7 @@ idLexer::idLexer( const char* ptr, int length, const char* name, int flags )
 	idLexer::token = "";
 	idLexer::next = NULL;
 	idLexer::hadError = false;
+	idLexer::hadWarning = false;
 	idLexer::LoadMemory( ptr, length, name );
 }
 
@@ -2434,6 +2645,16 @@ void idLexer::SetBaseFolder( const char* path )
 	idStr::Copynz( baseFolder, path, sizeof( baseFolder ) );
 }
 
+/*
+================
+idLexer::SetFastScan
+================
+*/
+void idLexer::SetFastScan( bool enable )
+{
+	fastScan = enable;
+}
+
 /*
 ================
 idLexer::HadError
@@ -2444,3 +2665,13 @@ bool idLexer::HadError() const
 	return hadError;
 }
 
+/*
+================
+idLexer::HadWarning
+================
+*/
+bool idLexer::HadWarning() const
+{
+	return hadWarning;
+}
+
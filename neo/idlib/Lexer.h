@@ -257,9 +257,13 @@ public:
 	void			Warning( VERIFY_FORMAT_STRING const char* str, ... );
 	// returns true if Error() was called with LEXFL_NOFATALERRORS or LEXFL_NOERRORS set
 	bool			HadError() const;
+	// returns true if Warning() was called, even with LEXFL_NOWARNINGS set
+	bool			HadWarning() const;
 
 	// set the base folder to load files from
 	static void		SetBaseFolder( const char* path );
+	// scan white space, comments, strings, names and numbers 16 bytes at a time where the CPU supports it
+	static void		SetFastScan( bool enable );
 
 private:
 	int				loaded;					// set when a script file is loaded from file or memory
@@ -284,8 +288,10 @@ private:
 	idToken			token;					// available token
 	idLexer* 		next;					// next script in a chain
 	bool			hadError;				// set by idLexer::Error, even if the error is supressed
+	bool			hadWarning;				// set by idLexer::Warning, even if the warning is supressed
 
 	static char		baseFolder[ 256 ];		// base folder to load files from
+	static bool		fastScan;				// use the SIMD scanning loops
 
 private:
 	void			CreatePunctuationTable( const punctuation_t* punctuations );
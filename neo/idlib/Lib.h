@@ -308,6 +308,7 @@ public:
 #include "containers/BTree.h"
 #include "containers/BinSearch.h"
 #include "containers/HashIndex.h"
+#include "containers/FlatHashIndex.h"
 #include "containers/HashTable.h"
 #include "containers/StaticList.h"
 #include "containers/LinkList.h"
@@ -335,6 +336,7 @@ public:
 #include "Swap.h"
 #include "Callback.h"
 #include "ParallelJobList.h"
+#include "TaskGraph.h"
 #include "SoftwareCache.h"
 #include "TileMap.h" // RB
 
@@ -141,6 +141,7 @@ idParallelJobList_Threads
 */
 
 static idCVar jobs_longJobMicroSec( "jobs_longJobMicroSec", "10000", CVAR_INTEGER, "print a warning for jobs that take more than this number of microseconds" );
+static idCVar jobs_workStealing( "jobs_workStealing", "1", CVAR_BOOL | CVAR_NOCHEAT, "split job lists without sync points over per-thread deques and let idle job threads steal single jobs" );
 
 
 const static int		MAX_THREADS	= 32;
@@ -170,6 +171,7 @@ struct threadStats_t
 {
 	unsigned int	numExecutedJobs;
 	unsigned int	numExecutedSyncs;
+	unsigned int	numStolenJobs;
 	uint64			submitTime;
 	uint64			startTime;
 	uint64			endTime;
@@ -202,6 +204,10 @@ public:
 	{
 		return threadStats.numExecutedSyncs;
 	}
+	unsigned int			GetNumStolenJobs() const
+	{
+		return threadStats.numStolenJobs;
+	}
 	uint64					GetSubmitTimeMicroSec() const
 	{
 		return threadStats.submitTime;
@@ -238,6 +244,9 @@ public:
 
 	bool					WaitForOtherJobList();
 
+	// called by the manager before the job list is handed to the job threads
+	void					PrepareWorkStealing( int numThreads );
+
 	//------------------------
 	// This is thread safe and called from the job threads.
 	//------------------------
@@ -282,7 +291,25 @@ private:
 	threadStats_t						deferredThreadStats;
 	threadStats_t						threadStats;
 
+	// When work stealing is enabled the jobs of a list without sync points are split into
+	// contiguous ranges, one per job thread. The owner pops jobs from the front of its range
+	// and threads that run out of work steal single jobs from the back of other ranges.
+	// Both ends are packed into one interlocked integer so a single compare-exchange updates a range.
+	static const int		MAX_STEALING_JOBS = 0x7FFF;
+	struct jobDeque_t
+	{
+		idSysInterlockedInteger	range;		// ( end << 16 ) | begin
+		byte					pad[CACHE_LINE_SIZE - sizeof( idSysInterlockedInteger )];
+	};
+	jobDeque_t							jobDeques[MAX_THREADS];
+	int									numJobDeques;
+	idSysInterlockedInteger				numStolenJobs;
+
 	int						RunJobsInternal( unsigned int threadNum, threadJobListState_t& state, bool singleJob );
+	int						RunJobsStealing( unsigned int threadNum, bool singleJob );
+	void					ExecuteJob( unsigned int threadNum, int jobIndex );
+	bool					PopJob( unsigned int threadNum, int& jobIndex );
+	bool					StealJob( unsigned int threadNum, int& jobIndex );
 
 	static void				Nop( void* data ) {}
 
@@ -310,7 +337,8 @@ idParallelJobList_Threads::idParallelJobList_Threads( jobListId_t id, jobListPri
 	lastSignalJob( 0 ),
 	waitForGuard( NULL ),
 	currentDoneGuard( 0 ),
-	jobList()
+	jobList(),
+	numJobDeques( 0 )
 {
 
 	assert( listPriority != JOBLIST_PRIORITY_NONE );
@@ -446,6 +474,8 @@ void idParallelJobList_Threads::Submit( idParallelJobList_Threads* waitForJobLis
 
 	done = false;
 	currentJob.SetValue( 0 );
+	numJobDeques = 0;
+	numStolenJobs.SetValue( 0 );
 
 	memset( &deferredThreadStats, 0, sizeof( deferredThreadStats ) );
 	deferredThreadStats.numExecutedJobs = jobList.Num() - numSyncs * 2;
@@ -527,6 +557,8 @@ void idParallelJobList_Threads::Wait()
 		signalJobCount.SetNum( 0 );
 		numSyncs = 0;
 		lastSignalJob = 0;
+		numJobDeques = 0;
+		deferredThreadStats.numStolenJobs = numStolenJobs.GetValue();
 
 		uint64 waitEnd = Sys_Microseconds();
 		deferredThreadStats.waitTime = waited ? ( waitEnd - waitStart ) : 0;
@@ -624,6 +656,180 @@ uint64 idParallelJobList_Threads::GetUnitWastedTimeMicroSec( int unit ) const
 	volatile void* longJobData;
 #endif
 
+/*
+========================
+idParallelJobList_Threads::ExecuteJob
+========================
+*/
+void idParallelJobList_Threads::ExecuteJob( unsigned int threadNum, int jobIndex )
+{
+	uint64 jobStart = Sys_Microseconds();
+
+	jobList[jobIndex].function( jobList[jobIndex].data );
+	jobList[jobIndex].executed = 1;
+
+	uint64 jobEnd = Sys_Microseconds();
+	deferredThreadStats.threadExecTime[threadNum] += jobEnd - jobStart;
+
+#ifndef _DEBUG
+	if( jobs_longJobMicroSec.GetInteger() > 0 )
+	{
+		if( jobEnd - jobStart > jobs_longJobMicroSec.GetInteger()
+				&& GetId() != JOBLIST_UTILITY )
+		{
+			longJobTime = ( jobEnd - jobStart ) * ( 1.0f / 1000.0f );
+			longJobFunc = jobList[jobIndex].function;
+			longJobData = jobList[jobIndex].data;
+			const char* jobName = GetJobName( jobList[jobIndex].function );
+			const char* jobListName = GetJobListName( GetId() );
+			idLib::Printf( "%1.1f milliseconds for a single '%s' job from job list %s on thread %d\n", longJobTime, jobName, jobListName, threadNum );
+		}
+	}
+#endif
+}
+
+/*
+========================
+idParallelJobList_Threads::PrepareWorkStealing
+========================
+*/
+void idParallelJobList_Threads::PrepareWorkStealing( int numThreads )
+{
+	// the last job is the JOB_LIST_DONE marker
+	const int numJobs = jobList.Num() - 1;
+
+	// Submit adds the signal count of the JOB_LIST_DONE marker, any other one comes from a
+	// sync point, which a SYNC_SIGNAL without a SYNC_SYNCHRONIZE doesn't add to numSyncs
+	const bool hasSyncPoints = signalJobCount.Num() > 1;
+
+	numJobDeques = 0;
+	if( !jobs_workStealing.GetBool() || hasSyncPoints || numJobs <= 0 || numJobs > MAX_STEALING_JOBS )
+	{
+		return;
+	}
+
+	const int numDeques = Min( Min( numThreads, MAX_THREADS ), numJobs );
+	for( int i = 0; i < numDeques; i++ )
+	{
+		const int begin = ( numJobs * i ) / numDeques;
+		const int end = ( numJobs * ( i + 1 ) ) / numDeques;
+		jobDeques[i].range.SetValue( ( end << 16 ) | begin );
+	}
+	numJobDeques = numDeques;
+}
+
+/*
+========================
+idParallelJobList_Threads::PopJob
+
+Takes the next job from the front of the deque owned by this thread.
+========================
+*/
+bool idParallelJobList_Threads::PopJob( unsigned int threadNum, int& jobIndex )
+{
+	if( threadNum >= ( unsigned int ) numJobDeques )
+	{
+		return false;
+	}
+
+	idSysInterlockedInteger& range = jobDeques[threadNum].range;
+	for( ; ; )
+	{
+		const int current = range.GetValue();
+		const int begin = current & 0xFFFF;
+		const int end = current >> 16;
+		if( begin >= end )
+		{
+			return false;
+		}
+		if( range.CompareExchange( current, ( end << 16 ) | ( begin + 1 ) ) == current )
+		{
+			jobIndex = begin;
+			return true;
+		}
+	}
+}
+
+/*
+========================
+idParallelJobList_Threads::StealJob
+
+Takes a single job from the back of the fullest deque owned by another thread.
+========================
+*/
+bool idParallelJobList_Threads::StealJob( unsigned int threadNum, int& jobIndex )
+{
+	for( ; ; )
+	{
+		int victim = -1;
+		int victimRange = 0;
+		int victimCount = 0;
+		for( int i = 0; i < numJobDeques; i++ )
+		{
+			if( i == ( int ) threadNum )
+			{
+				continue;
+			}
+			const int current = jobDeques[i].range.GetValue();
+			const int count = ( current >> 16 ) - ( current & 0xFFFF );
+			if( count > victimCount )
+			{
+				victim = i;
+				victimRange = current;
+				victimCount = count;
+			}
+		}
+		if( victim < 0 )
+		{
+			return false;
+		}
+
+		const int begin = victimRange & 0xFFFF;
+		const int end = victimRange >> 16;
+		if( jobDeques[victim].range.CompareExchange( victimRange, ( ( end - 1 ) << 16 ) | begin ) == victimRange )
+		{
+			numStolenJobs.Increment();
+			jobIndex = end - 1;
+			return true;
+		}
+	}
+}
+
+/*
+========================
+idParallelJobList_Threads::RunJobsStealing
+========================
+*/
+int idParallelJobList_Threads::RunJobsStealing( unsigned int threadNum, bool singleJob )
+{
+	int result = RUN_OK;
+
+	do
+	{
+		int jobIndex;
+		if( !PopJob( threadNum, jobIndex ) && !StealJob( threadNum, jobIndex ) )
+		{
+			// nothing left to fetch, the remaining jobs are executing on other threads
+			return ( result | RUN_DONE );
+		}
+
+		ExecuteJob( threadNum, jobIndex );
+
+		result |= RUN_PROGRESS;
+
+		// there are no sync points so there is only a single signal for the whole list
+		if( signalJobCount[0].Decrement() == 0 )
+		{
+			deferredThreadStats.endTime = Sys_Microseconds();
+			doneGuards[currentDoneGuard].Decrement();
+			return ( result | RUN_DONE );
+		}
+	}
+	while( ! singleJob );
+
+	return result;
+}
+
 /*
 ========================
 idParallelJobList_Threads::RunJobsInternal
@@ -644,6 +850,11 @@ int idParallelJobList_Threads::RunJobsInternal( unsigned int threadNum, threadJo
 		deferredThreadStats.startTime = Sys_Microseconds();	// first time any thread is running jobs from this list
 	}
 
+	if( numJobDeques > 0 )
+	{
+		return RunJobsStealing( threadNum, singleJob );
+	}
+
 	int result = RUN_OK;
 
 	do
@@ -738,31 +949,7 @@ int idParallelJobList_Threads::RunJobsInternal( unsigned int threadNum, threadJo
 		}
 
 		// execute the next job
-		{
-			uint64 jobStart = Sys_Microseconds();
-
-			jobList[state.nextJobIndex].function( jobList[state.nextJobIndex].data );
-			jobList[state.nextJobIndex].executed = 1;
-
-			uint64 jobEnd = Sys_Microseconds();
-			deferredThreadStats.threadExecTime[threadNum] += jobEnd - jobStart;
-
-#ifndef _DEBUG
-			if( jobs_longJobMicroSec.GetInteger() > 0 )
-			{
-				if( jobEnd - jobStart > jobs_longJobMicroSec.GetInteger()
-						&& GetId() != JOBLIST_UTILITY )
-				{
-					longJobTime = ( jobEnd - jobStart ) * ( 1.0f / 1000.0f );
-					longJobFunc = jobList[state.nextJobIndex].function;
-					longJobData = jobList[state.nextJobIndex].data;
-					const char* jobName = GetJobName( jobList[state.nextJobIndex].function );
-					const char* jobListName = GetJobListName( GetId() );
-					idLib::Printf( "%1.1f milliseconds for a single '%s' job from job list %s on thread %d\n", longJobTime, jobName, jobListName, threadNum );
-				}
-			}
-#endif
-		}
+		ExecuteJob( threadNum, state.nextJobIndex );
 
 		result |= RUN_PROGRESS;
 
@@ -950,6 +1137,16 @@ unsigned int idParallelJobList::GetNumSyncs() const
 	return jobListThreads->GetNumSyncs();
 }
 
+/*
+========================
+idParallelJobList::GetNumStolenJobs
+========================
+*/
+unsigned int idParallelJobList::GetNumStolenJobs() const
+{
+	return jobListThreads->GetNumStolenJobs();
+}
+
 /*
 ========================
 idParallelJobList::GetSubmitTimeMicroSec
@@ -1145,6 +1342,9 @@ idJobThread::Run
 */
 int idJobThread::Run()
 {
+	// implemented in TaskGraph.cpp
+	bool TaskGraph_RunTasks( int threadNum );
+
 	threadJobListState_t threadJobListState[MAX_JOBLISTS];
 	int numJobLists = 0;
 	int lastStalledJobList = -1;
@@ -1165,6 +1365,11 @@ int idJobThread::Run()
 		}
 		if( numJobLists == 0 )
 		{
+			// no job lists left so help out with any queued tasks
+			if( TaskGraph_RunTasks( threadNum ) )
+			{
+				continue;
+			}
 			break;
 		}
 
@@ -1300,10 +1505,12 @@ public:
 	virtual void				WaitForAllJobLists();
 
 	void						Submit( idParallelJobList_Threads* jobList, int parallelism );
+	void						SignalThreads( int numTasks );
 
 private:
 	idJobThread						threads[MAX_JOB_THREADS];
 	unsigned int					maxThreads;
+	idSysInterlockedInteger			nextSignalThread;
 	int								numPhysicalCpuCores;
 	int								numLogicalCpuCores;
 	int								numCpuPackages;
@@ -1323,6 +1530,16 @@ void SubmitJobList( idParallelJobList_Threads* jobList, int parallelism )
 	parallelJobManagerLocal.Submit( jobList, parallelism );
 }
 
+/*
+========================
+SignalJobThreads
+========================
+*/
+void SignalJobThreads( int numTasks )
+{
+	parallelJobManagerLocal.SignalThreads( numTasks );
+}
+
 /*
 ========================
 idParallelJobManagerLocal::Init
@@ -1487,6 +1704,7 @@ void idParallelJobManagerLocal::Submit( idParallelJobList_Threads* jobList, int
 	{
 		numThreads = parallelism;
 	}
+	numThreads = Min( numThreads, MAX_JOB_THREADS );
 
 	if( numThreads <= 0 )
 	{
@@ -1495,9 +1713,28 @@ void idParallelJobManagerLocal::Submit( idParallelJobList_Threads* jobList, int
 		return;
 	}
 
+	jobList->PrepareWorkStealing( numThreads );
+
 	for( int i = 0; i < numThreads; i++ )
 	{
 		threads[i].AddJobList( jobList );
 		threads[i].SignalWork();
 	}
 }
+
+/*
+========================
+idParallelJobManagerLocal::SignalThreads
+
+Wakes up job threads in round robin order to execute queued tasks.
+========================
+*/
+void idParallelJobManagerLocal::SignalThreads( int numTasks )
+{
+	const int numThreads = Min( numTasks, ( int ) maxThreads );
+	for( int i = 0; i < numThreads; i++ )
+	{
+		const int thread = ( nextSignalThread.Increment() & 0x7FFFFFFF ) % maxThreads;
+		threads[thread].SignalWork();
+	}
+}
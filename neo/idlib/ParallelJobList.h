@@ -113,6 +113,9 @@ public:
 	// Get the number of sync points.
 	unsigned int			GetNumSyncs() const;
 
+	// Get the number of jobs that were stolen from another thread's deque.
+	unsigned int			GetNumStolenJobs() const;
+
 	// Time at which the job list was submitted.
 	uint64					GetSubmitTimeMicroSec() const;
 
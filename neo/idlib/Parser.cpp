@@ -36,6 +36,15 @@ If you have questions concerning this license or the applicable additional terms
 
 #define TOKEN_FL_RECURSIVE_DEFINE	1
 
+// sources smaller than this are lexed faster than a cache file is found
+#define TOKEN_CACHE_MIN_LENGTH		8192
+#define MAX_TOKEN_CACHE_FILES		1024
+
+static const byte BTOKENS_VERSION = 1;
+static const unsigned int BTOKENS_MAGIC = ( 'B' << 24 ) | ( 'T' << 16 ) | ( 'O' << 8 ) | BTOKENS_VERSION;
+
+idCVar parser_tokenCache( "parser_tokenCache", "1", CVAR_SYSTEM | CVAR_BOOL, "store the preprocessed tokens of large sources in generated/tokens and read them back while the sources are unchanged" );
+
 define_t* idParser::globaldefines;
 
 /*
@@ -463,6 +472,12 @@ void idParser::PushScript( idLexer* script )
 	//push the script on the script stack
 	script->next = idParser::scriptstack;
 	idParser::scriptstack = script;
+
+	// included files are part of the cache key
+	if( cacheState == TOKENCACHE_RECORDING )
+	{
+		AddCachedFile( script );
+	}
 }
 
 /*
@@ -516,6 +531,11 @@ int idParser::ReadSourceToken( idToken* token )
 		// remove the script and return to the previous one
 		script = idParser::scriptstack;
 		idParser::scriptstack = idParser::scriptstack->next;
+		// warnings wouldn't be printed when the tokens are read from the cache
+		if( cacheState == TOKENCACHE_RECORDING && ( script->HadWarning() || script->HadError() ) )
+		{
+			StopTokenCache();
+		}
 		delete script;
 	}
 	// copy the already available token
@@ -863,6 +883,11 @@ int idParser::ExpandBuiltinDefine( idToken* deftoken, define_t* define, idToken*
 		}
 		case BUILTIN_DATE:
 		{
+			// changes every build, don't cache it
+			if( cacheState == TOKENCACHE_RECORDING )
+			{
+				StopTokenCache();
+			}
 			*token = PreProcessorDate();
 			token->type = TT_STRING;
 			token->subtype = token->Length();
@@ -875,6 +900,11 @@ int idParser::ExpandBuiltinDefine( idToken* deftoken, define_t* define, idToken*
 		}
 		case BUILTIN_TIME:
 		{
+			// changes every build, don't cache it
+			if( cacheState == TOKENCACHE_RECORDING )
+			{
+				StopTokenCache();
+			}
 			*token = PreProcessorTime();
 			token->type = TT_STRING;
 			token->subtype = token->Length();
@@ -1444,6 +1474,10 @@ int idParser::AddDefine( const char* string )
 {
 	define_t* define;
 
+	if( cacheState != TOKENCACHE_PENDING )
+	{
+		StopTokenCache();
+	}
 	define = DefineFromString( string );
 	if( !define )
 	{
@@ -2939,10 +2973,12 @@ int idParser::ReadDollarDirective()
 
 /*
 ================
-idParser::ReadToken
+idParser::ReadParsedToken
+
+Reads a token from the source with all directives and defines handled.
 ================
 */
-int idParser::ReadToken( idToken* token )
+int idParser::ReadParsedToken( idToken* token )
 {
 	define_t* define;
 
@@ -2971,7 +3007,7 @@ int idParser::ReadToken( idToken* token )
 		if( token->type == TT_STRING && !( idParser::scriptstack->GetFlags() & LEXFL_NOSTRINGCONCAT ) )
 		{
 			idToken newtoken;
-			if( idParser::ReadToken( &newtoken ) )
+			if( idParser::ReadParsedToken( &newtoken ) )
 			{
 				if( newtoken.type == TT_STRING )
 				{
@@ -3017,6 +3053,49 @@ int idParser::ReadToken( idToken* token )
 	}
 }
 
+/*
+================
+idParser::ReadToken
+================
+*/
+int idParser::ReadToken( idToken* token )
+{
+	if( cacheState == TOKENCACHE_PENDING )
+	{
+		StartTokenCache();
+	}
+
+	if( cacheState == TOKENCACHE_REPLAYING )
+	{
+		if( cachePos >= cachedTokens.Num() )
+		{
+			return false;
+		}
+		ReplayToken( token );
+		return true;
+	}
+
+	if( !idParser::ReadParsedToken( token ) )
+	{
+		if( cacheState == TOKENCACHE_RECORDING )
+		{
+			// only cache sources that parse without any warnings
+			if( !scriptstack->HadWarning() && !scriptstack->HadError() )
+			{
+				WriteTokenCache();
+			}
+			StopTokenCache();
+		}
+		return false;
+	}
+
+	if( cacheState == TOKENCACHE_RECORDING )
+	{
+		RecordToken( token );
+	}
+	return true;
+}
+
 /*
 ================
 idParser::ExpectTokenString
@@ -3176,7 +3255,7 @@ int idParser::CheckTokenString( const char* string )
 		return true;
 	}
 
-	UnreadSourceToken( &tok );
+	UnreadToken( &tok );
 	return false;
 }
 
@@ -3200,7 +3279,7 @@ int idParser::CheckTokenType( int type, int subtype, idToken* token )
 		return true;
 	}
 
-	UnreadSourceToken( &tok );
+	UnreadToken( &tok );
 	return false;
 }
 
@@ -3218,7 +3297,7 @@ int idParser::PeekTokenString( const char* string )
 		return false;
 	}
 
-	UnreadSourceToken( &tok );
+	UnreadToken( &tok );
 
 	// if the token is available
 	if( tok == string )
@@ -3242,7 +3321,7 @@ int idParser::PeekTokenType( int type, int subtype, idToken* token )
 		return false;
 	}
 
-	UnreadSourceToken( &tok );
+	UnreadToken( &tok );
 
 	// if the type matches
 	if( tok.type == type && ( tok.subtype & subtype ) == subtype )
@@ -3285,7 +3364,7 @@ int idParser::SkipRestOfLine()
 	{
 		if( token.linesCrossed )
 		{
-			idParser::UnreadSourceToken( &token );
+			idParser::UnreadToken( &token );
 			return true;
 		}
 	}
@@ -3341,6 +3420,7 @@ Maintains the exact formating of the braced section
 */
 const char* idParser::ParseBracedSectionExact( idStr& out, int tabs )
 {
+	StopTokenCache();
 	return scriptstack->ParseBracedSectionExact( out, tabs );
 }
 
@@ -3450,7 +3530,7 @@ const char* idParser::ParseRestOfLine( idStr& out )
 	{
 		if( token.linesCrossed )
 		{
-			idParser::UnreadSourceToken( &token );
+			idParser::UnreadToken( &token );
 			break;
 		}
 		if( out.Length() )
@@ -3469,6 +3549,23 @@ idParser::UnreadToken
 */
 void idParser::UnreadToken( idToken* token )
 {
+	if( cacheState == TOKENCACHE_RECORDING || cacheState == TOKENCACHE_REPLAYING )
+	{
+		if( cachePos > 0 )
+		{
+			// the token is read again from the cache position
+			cachePos--;
+			if( cacheState == TOKENCACHE_REPLAYING )
+			{
+				return;
+			}
+		}
+		else
+		{
+			// a token that was never read changes the stream
+			StopTokenCache();
+		}
+	}
 	idParser::UnreadSourceToken( token );
 }
 
@@ -3492,7 +3589,7 @@ int idParser::ReadTokenOnLine( idToken* token )
 		return true;
 	}
 	//
-	idParser::UnreadSourceToken( &tok );
+	idParser::UnreadToken( &tok );
 	return false;
 }
 
@@ -3654,8 +3751,9 @@ int idParser::Parse3DMatrix( int z, int y, int x, float* m )
 idParser::GetLastWhiteSpace
 ================
 */
-int idParser::GetLastWhiteSpace( idStr& whiteSpace ) const
+int idParser::GetLastWhiteSpace( idStr& whiteSpace )
 {
+	StopTokenCache();
 	if( scriptstack )
 	{
 		scriptstack->GetLastWhiteSpace( whiteSpace );
@@ -3674,6 +3772,7 @@ idParser::SetMarker
 */
 void idParser::SetMarker()
 {
+	StopTokenCache();
 	marker_p = NULL;
 }
 
@@ -3689,6 +3788,7 @@ void idParser::GetStringFromMarker( idStr& out, bool clean )
 	char*	p;
 	char	save;
 
+	StopTokenCache();
 	if( marker_p == NULL )
 	{
 		marker_p = scriptstack->buffer;
@@ -3733,6 +3833,10 @@ idParser::SetIncludePath
 */
 void idParser::SetIncludePath( const char* path )
 {
+	if( cacheState != TOKENCACHE_PENDING )
+	{
+		StopTokenCache();
+	}
 	idParser::includepath = path;
 	// add trailing path seperator
 	if( idParser::includepath[idParser::includepath.Length() - 1] != '\\' &&
@@ -3749,6 +3853,10 @@ idParser::SetPunctuations
 */
 void idParser::SetPunctuations( const punctuation_t* p )
 {
+	if( cacheState != TOKENCACHE_PENDING )
+	{
+		StopTokenCache();
+	}
 	idParser::punctuations = p;
 }
 
@@ -3761,6 +3869,10 @@ void idParser::SetFlags( int flags )
 {
 	idLexer* s;
 
+	if( cacheState != TOKENCACHE_PENDING )
+	{
+		StopTokenCache();
+	}
 	idParser::flags = flags;
 	for( s = idParser::scriptstack; s; s = s->next )
 	{
@@ -3815,6 +3927,7 @@ int idParser::LoadFile( const char* filename, bool OSPath )
 		idParser::definehash = ( define_t** ) Mem_ClearedAlloc( DEFINEHASHSIZE * sizeof( define_t* ), TAG_IDLIB_PARSER );
 		idParser::AddGlobalDefinesToSource();
 	}
+	idParser::InitTokenCache();
 	return true;
 }
 
@@ -3854,6 +3967,7 @@ int idParser::LoadMemory( const char* ptr, int length, const char* name )
 		idParser::definehash = ( define_t** ) Mem_ClearedAlloc( DEFINEHASHSIZE * sizeof( define_t* ), TAG_IDLIB_PARSER );
 		idParser::AddGlobalDefinesToSource();
 	}
+	idParser::InitTokenCache();
 	return true;
 }
 
@@ -3891,6 +4005,13 @@ void idParser::FreeSource( bool keepDefines )
 		indentstack = indentstack->next;
 		Mem_Free( indent );
 	}
+	// drop the token cache
+	cacheState = TOKENCACHE_OFF;
+	cachePos = 0;
+	cachedTokens.Clear();
+	cachedText.Clear();
+	cachedFiles.Clear();
+	cachedFileChecksums.Clear();
 	if( !keepDefines )
 	{
 		// free hash table
@@ -3981,6 +4102,10 @@ idParser::idParser()
 	this->defines = NULL;
 	this->tokens = NULL;
 	this->marker_p = NULL;
+	this->cacheState = TOKENCACHE_OFF;
+	this->cacheKey = 0;
+	this->cacheStartLine = 1;
+	this->cachePos = 0;
 }
 
 /*
@@ -4000,6 +4125,10 @@ idParser::idParser( int flags )
 	this->defines = NULL;
 	this->tokens = NULL;
 	this->marker_p = NULL;
+	this->cacheState = TOKENCACHE_OFF;
+	this->cacheKey = 0;
+	this->cacheStartLine = 1;
+	this->cachePos = 0;
 }
 
 /*
@@ -4019,6 +4148,10 @@ idParser::idParser( const char* filename, int flags, bool OSPath )
 	this->defines = NULL;
 	this->tokens = NULL;
 	this->marker_p = NULL;
+	this->cacheState = TOKENCACHE_OFF;
+	this->cacheKey = 0;
+	this->cacheStartLine = 1;
+	this->cachePos = 0;
 	LoadFile( filename, OSPath );
 }
 
@@ -4039,6 +4172,10 @@ idParser::idParser( const char* ptr, int length, const char* name, int flags )
 	this->defines = NULL;
 	this->tokens = NULL;
 	this->marker_p = NULL;
+	this->cacheState = TOKENCACHE_OFF;
+	this->cacheKey = 0;
+	this->cacheStartLine = 1;
+	this->cachePos = 0;
 	LoadMemory( ptr, length, name );
 }
 
@@ -4059,6 +4196,10 @@ idParser::EndOfFile
 */
 bool idParser::EndOfFile()
 {
+	if( cacheState == TOKENCACHE_REPLAYING )
+	{
+		return ( cachePos >= cachedTokens.Num() );
+	}
 	if( scriptstack != NULL )
 	{
 		return ( bool ) scriptstack->EndOfFile();
@@ -4066,3 +4207,333 @@ bool idParser::EndOfFile()
 	return true;
 }
 
+/*
+================
+idParser::InitTokenCache
+================
+*/
+void idParser::InitTokenCache()
+{
+	cacheState = TOKENCACHE_OFF;
+	cachePos = 0;
+
+	if( !parser_tokenCache.GetBool() || idLib::fileSystem == NULL || filename.IsEmpty() || scriptstack->length < TOKEN_CACHE_MIN_LENGTH )
+	{
+		return;
+	}
+
+	// the same file can be loaded with different paths, the hash keeps them apart
+	idStr baseName = filename;
+	baseName.StripPath();
+	baseName.StripFileExtension();
+	cacheName = va( "generated/tokens/%s_%08x.btokens", baseName.c_str(), MD5_BlockChecksum( filename.c_str(), filename.Length() ) );
+	cacheState = TOKENCACHE_PENDING;
+}
+
+/*
+================
+idParser::StartTokenCache
+
+Called on the first read, the flags, defines and unread tokens are final by now.
+================
+*/
+void idParser::StartTokenCache()
+{
+	cacheKey = GetTokenCacheKey();
+	cachePos = 0;
+	cacheStartLine = scriptstack->line;
+
+	if( LoadTokenCache() )
+	{
+		cacheState = TOKENCACHE_REPLAYING;
+		return;
+	}
+
+	cachedTokens.Clear();
+	cachedText.Clear();
+	cachedFiles.Clear();
+	cachedFileChecksums.Clear();
+	AddCachedFile( scriptstack );
+	cacheState = TOKENCACHE_RECORDING;
+}
+
+/*
+================
+idParser::StopTokenCache
+
+Continues with the source itself when the tokens can't be cached or replayed.
+================
+*/
+void idParser::StopTokenCache()
+{
+	if( cacheState == TOKENCACHE_REPLAYING )
+	{
+		// lex the source up to the token that was read from the cache last
+		cacheState = TOKENCACHE_OFF;
+		scriptstack->filename = cachedFiles[0];
+		scriptstack->line = cacheStartLine;
+
+		idToken token;
+		for( int i = 0; i < cachePos; i++ )
+		{
+			if( !idParser::ReadParsedToken( &token ) )
+			{
+				break;
+			}
+		}
+	}
+
+	cacheState = TOKENCACHE_OFF;
+	cachePos = 0;
+	cachedTokens.Clear();
+	cachedText.Clear();
+	cachedFiles.Clear();
+	cachedFileChecksums.Clear();
+}
+
+/*
+================
+idParser::GetTokenCacheKey
+================
+*/
+unsigned int idParser::GetTokenCacheKey() const
+{
+	idStr key;
+
+	key += va( "%u %d %d %s\n", MD5_BlockChecksum( scriptstack->buffer, scriptstack->length ), flags, OSPath, includepath.c_str() );
+
+	if( punctuations != NULL )
+	{
+		for( int i = 0; punctuations[i].p; i++ )
+		{
+			key += va( "%s %d ", punctuations[i].p, punctuations[i].n );
+		}
+		key += "\n";
+	}
+
+	for( int i = 0; i < DEFINEHASHSIZE; i++ )
+	{
+		for( define_t* define = definehash[i]; define; define = define->hashnext )
+		{
+			key += va( "%s %d %d %d", define->name, define->flags, define->builtin, define->numparms );
+			for( idToken* t = define->parms; t; t = t->next )
+			{
+				key += " ";
+				key += *t;
+			}
+			key += " :";
+			for( idToken* t = define->tokens; t; t = t->next )
+			{
+				key += va( " %d ", t->type );
+				key += *t;
+			}
+			key += "\n";
+		}
+	}
+
+	// tokens unread before the first read are part of the source
+	for( idToken* t = tokens; t; t = t->next )
+	{
+		key += va( "%d %d ", t->type, t->subtype );
+		key += *t;
+		key += "\n";
+	}
+
+	return MD5_BlockChecksum( key.c_str(), key.Length() );
+}
+
+/*
+================
+idParser::AddCachedFile
+================
+*/
+int idParser::AddCachedFile( idLexer* script )
+{
+	for( int i = cachedFiles.Num() - 1; i >= 0; i-- )
+	{
+		if( cachedFiles[i].Cmp( script->GetFileName() ) == 0 )
+		{
+			return i;
+		}
+	}
+	cachedFileChecksums.Append( MD5_BlockChecksum( script->buffer, script->length ) );
+	return cachedFiles.Append( script->GetFileName() );
+}
+
+/*
+================
+idParser::RecordToken
+================
+*/
+void idParser::RecordToken( const idToken* token )
+{
+	if( cachePos < cachedTokens.Num() )
+	{
+		// reading an unread token again, it has to be the same token
+		const cachedToken_t& cached = cachedTokens[cachePos];
+		if( cached.type != token->type || idStr::Cmp( &cachedText[cached.text], token->c_str() ) != 0 )
+		{
+			StopTokenCache();
+			return;
+		}
+		cachePos++;
+		return;
+	}
+
+	cachedToken_t& cached = cachedTokens.Alloc();
+	cached.text = cachedText.Num();
+	cached.type = token->type;
+	cached.subtype = token->subtype & ~TT_VALUESVALID;
+	cached.line = token->line;
+	cached.linesCrossed = token->linesCrossed;
+	cached.flags = token->flags;
+	cached.fileNum = AddCachedFile( scriptstack );
+	cached.lineNum = scriptstack->GetLineNum();
+	cached.fileOffset = scriptstack->GetFileOffset();
+
+	const int length = token->Length();
+	cachedText.SetNum( cached.text + length + 1 );
+	memcpy( &cachedText[cached.text], token->c_str(), length + 1 );
+
+	cachePos = cachedTokens.Num();
+}
+
+/*
+================
+idParser::ReplayToken
+================
+*/
+void idParser::ReplayToken( idToken* token )
+{
+	const cachedToken_t& cached = cachedTokens[cachePos++];
+
+	*token = &cachedText[cached.text];
+	token->type = cached.type;
+	token->subtype = cached.subtype;
+	token->line = cached.line;
+	token->linesCrossed = cached.linesCrossed;
+	token->flags = cached.flags;
+	token->whiteSpaceStart_p = NULL;
+	token->whiteSpaceEnd_p = NULL;
+
+	// errors and warnings of the client are reported by the source at the position of the token
+	if( cachePos == 1 || cachedTokens[cachePos - 2].fileNum != cached.fileNum )
+	{
+		scriptstack->filename = cachedFiles[cached.fileNum];
+	}
+	scriptstack->line = cached.lineNum;
+}
+
+/*
+================
+idParser::LoadTokenCache
+================
+*/
+bool idParser::LoadTokenCache()
+{
+	idFile* file = idLib::fileSystem->OpenFileReadMemory( cacheName );
+	if( file == NULL )
+	{
+		return false;
+	}
+
+	bool valid = false;
+	unsigned int magic = 0;
+	unsigned int key = 0;
+	file->ReadBig( magic );
+	file->ReadBig( key );
+	if( magic == BTOKENS_MAGIC && key == cacheKey )
+	{
+		int numFiles = 0;
+		file->ReadBig( numFiles );
+		if( numFiles <= 0 || numFiles > MAX_TOKEN_CACHE_FILES )
+		{
+			idLib::fileSystem->CloseFile( file );
+			return false;
+		}
+		cachedFiles.SetNum( numFiles );
+		cachedFileChecksums.SetNum( numFiles );
+		valid = true;
+		for( int i = 0; i < numFiles; i++ )
+		{
+			file->ReadString( cachedFiles[i] );
+			file->ReadBig( cachedFileChecksums[i] );
+
+			// the source itself is checked by the key, the included files have to be read again
+			if( i > 0 && valid )
+			{
+				idLexer include;
+				if( !include.LoadFile( cachedFiles[i], true ) && !include.LoadFile( cachedFiles[i], false ) )
+				{
+					valid = false;
+				}
+				else if( MD5_BlockChecksum( include.buffer, include.length ) != cachedFileChecksums[i] )
+				{
+					valid = false;
+				}
+			}
+		}
+		cachedFiles[0] = scriptstack->GetFileName();
+
+		int numTokens = 0;
+		int textLength = 0;
+		file->ReadBig( numTokens );
+		file->ReadBig( textLength );
+		if( valid && numTokens >= 0 && textLength >= 0 && file->Length() - file->Tell() == textLength + numTokens * ( int )sizeof( cachedToken_t ) )
+		{
+			cachedText.SetNum( textLength );
+			file->Read( cachedText.Ptr(), textLength );
+			cachedTokens.SetNum( numTokens );
+			file->ReadBigArray( ( int* )cachedTokens.Ptr(), numTokens * sizeof( cachedToken_t ) / sizeof( int ) );
+
+			for( int i = 0; i < numTokens && valid; i++ )
+			{
+				const cachedToken_t& cached = cachedTokens[i];
+				valid = ( cached.text >= 0 && cached.text < textLength && cached.fileNum >= 0 && cached.fileNum < numFiles );
+			}
+			valid = valid && ( textLength == 0 || cachedText[textLength - 1] == '\0' );
+		}
+		else
+		{
+			valid = false;
+		}
+	}
+	idLib::fileSystem->CloseFile( file );
+
+	if( !valid )
+	{
+		cachedTokens.Clear();
+		cachedText.Clear();
+		cachedFiles.Clear();
+		cachedFileChecksums.Clear();
+	}
+	return valid;
+}
+
+/*
+================
+idParser::WriteTokenCache
+================
+*/
+void idParser::WriteTokenCache()
+{
+	idFile* file = idLib::fileSystem->OpenFileWrite( cacheName );
+	if( file == NULL )
+	{
+		return;
+	}
+
+	file->WriteBig( BTOKENS_MAGIC );
+	file->WriteBig( cacheKey );
+	file->WriteBig( cachedFiles.Num() );
+	for( int i = 0; i < cachedFiles.Num(); i++ )
+	{
+		file->WriteString( cachedFiles[i] );
+		file->WriteBig( cachedFileChecksums[i] );
+	}
+	file->WriteBig( cachedTokens.Num() );
+	file->WriteBig( cachedText.Num() );
+	file->Write( cachedText.Ptr(), cachedText.Num() );
+	file->WriteBigArray( ( const int* )cachedTokens.Ptr(), cachedTokens.Num() * sizeof( cachedToken_t ) / sizeof( int ) );
+	idLib::fileSystem->CloseFile( file );
+}
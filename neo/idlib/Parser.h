@@ -75,6 +75,29 @@ typedef struct indent_s
 	struct indent_s*	next;						// next indent on the indent stack
 } indent_t;
 
+// state of the token cache of a source
+typedef enum
+{
+	TOKENCACHE_OFF,								// the source is parsed as usual
+	TOKENCACHE_PENDING,							// decided on the first read, until then the source can still be set up
+	TOKENCACHE_RECORDING,						// the preprocessed tokens are stored and written at the end of the source
+	TOKENCACHE_REPLAYING						// the tokens are read from the cache instead of the source
+} tokenCacheState_t;
+
+// preprocessed token as stored in the token cache
+typedef struct cachedToken_s
+{
+	int				text;						// offset of the token text in the cached text
+	int				type;						// token type
+	int				subtype;					// token sub type
+	int				line;						// line in script the token was on
+	int				linesCrossed;				// number of lines crossed in white space before token
+	int				flags;						// token flags
+	int				fileNum;					// index of the file the token was read from
+	int				lineNum;					// line number of that file after reading the token
+	int				fileOffset;					// offset in that file after reading the token
+} cachedToken_t;
+
 
 class idParser
 {
@@ -142,7 +165,7 @@ public:
 	int				Parse2DMatrix( int y, int x, float* m );
 	int				Parse3DMatrix( int z, int y, int x, float* m );
 	// get the white space before the last read token
-	int				GetLastWhiteSpace( idStr& whiteSpace ) const;
+	int				GetLastWhiteSpace( idStr& whiteSpace );
 	// Set a marker in the source file (there is only one marker)
 	void			SetMarker();
 	// Get the string from the marker to the current position
@@ -205,6 +228,29 @@ protected:
 
 	static define_t* globaldefines;				// list with global defines added to every source loaded
 
+	// large sources store their preprocessed tokens in generated/tokens and read them back
+	// as long as the text, the included files and the defines they start with are the same
+	tokenCacheState_t	cacheState;
+	idStr			cacheName;					// file the tokens are cached in
+	unsigned int	cacheKey;					// checksum of everything the tokens depend on
+	int				cachePos;					// number of cached tokens read, unread tokens move it back
+	int				cacheStartLine;				// line of the source the first token is read from
+	idList< cachedToken_t, TAG_IDLIB_PARSER >	cachedTokens;
+	idList< char, TAG_IDLIB_PARSER >			cachedText;
+	idList< idStr, TAG_IDLIB_PARSER >			cachedFiles;			// source first, then the included files
+	idList< unsigned int, TAG_IDLIB_PARSER >	cachedFileChecksums;
+
+	void			InitTokenCache();
+	void			StartTokenCache();
+	void			StopTokenCache();
+	unsigned int	GetTokenCacheKey() const;
+	bool			LoadTokenCache();
+	void			WriteTokenCache();
+	int				AddCachedFile( idLexer* script );
+	void			RecordToken( const idToken* token );
+	void			ReplayToken( idToken* token );
+	int				ReadParsedToken( idToken* token );
+
 	void			PushIndent( int type, int skip );
 	void			PopIndent( int* type, int* skip );
 	void			PushScript( idLexer* script );
@@ -259,6 +305,10 @@ protected:
 
 ID_INLINE const char* idParser::GetFileName() const
 {
+	if( cacheState == TOKENCACHE_REPLAYING && cachePos > 0 )
+	{
+		return cachedFiles[ cachedTokens[ cachePos - 1 ].fileNum ].c_str();
+	}
 	if( idParser::scriptstack )
 	{
 		return idParser::scriptstack->GetFileName();
@@ -271,6 +321,10 @@ ID_INLINE const char* idParser::GetFileName() const
 
 ID_INLINE const int idParser::GetFileOffset() const
 {
+	if( cacheState == TOKENCACHE_REPLAYING && cachePos > 0 )
+	{
+		return cachedTokens[ cachePos - 1 ].fileOffset;
+	}
 	if( idParser::scriptstack )
 	{
 		return idParser::scriptstack->GetFileOffset();
@@ -295,6 +349,10 @@ ID_INLINE const ID_TIME_T idParser::GetFileTime() const
 
 ID_INLINE const int idParser::GetLineNum() const
 {
+	if( cacheState == TOKENCACHE_REPLAYING && cachePos > 0 )
+	{
+		return cachedTokens[ cachePos - 1 ].lineNum;
+	}
 	if( idParser::scriptstack )
 	{
 		return idParser::scriptstack->GetLineNum();
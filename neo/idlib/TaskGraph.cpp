@@ -0,0 +1,622 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+#include "precompiled.h"
+#pragma hdrstop
+#include "TaskGraph.h"
+
+/*
+================================================================================================
+
+	idTask
+
+================================================================================================
+*/
+
+static const int TASK_EXTERNAL_QUEUE	= 32;						// shared by all threads that are not job threads
+static const int MAX_TASK_QUEUES		= TASK_EXTERNAL_QUEUE + 1;
+
+class idTask
+{
+public:
+	jobRun_t					function;
+	void* 						data;
+	idTaskGraph* 				graph;
+	idTask* 					parent;
+	idSysInterlockedInteger		numDependencies;	// predecessors that are not done yet, plus one until the graph is submitted
+	idSysInterlockedInteger		numUnfinished;		// one for the task itself plus one for each unfinished child
+	idList< idTask*, TAG_JOBLIST >	successors;
+};
+
+static idSysMutex			taskAllocMutex;
+static idBlockAlloc< idTask, 64, TAG_JOBLIST >	taskAllocator;
+
+/*
+================================================================================================
+
+	idTaskQueue
+
+The owning thread pushes and pops tasks at the back so it keeps working on
+recently spawned, cache-warm tasks, while other threads steal from the front.
+
+================================================================================================
+*/
+
+class idTaskQueue
+{
+public:
+	idTaskQueue() : head( 0 ) {}
+
+	void						Push( idTask* task )
+	{
+		idScopedCriticalSection lock( mutex );
+		tasks.Append( task );
+	}
+
+	idTask* 					Pop()
+	{
+		idScopedCriticalSection lock( mutex );
+		if( head >= tasks.Num() )
+		{
+			return NULL;
+		}
+		idTask* task = tasks[tasks.Num() - 1];
+		tasks.SetNum( tasks.Num() - 1 );
+		Compact();
+		return task;
+	}
+
+	idTask* 					Steal()
+	{
+		idScopedCriticalSection lock( mutex );
+		if( head >= tasks.Num() )
+		{
+			return NULL;
+		}
+		idTask* task = tasks[head++];
+		Compact();
+		return task;
+	}
+
+	void						Clear()
+	{
+		idScopedCriticalSection lock( mutex );
+		tasks.Clear();
+		head = 0;
+	}
+
+private:
+	idSysMutex					mutex;
+	idList< idTask*, TAG_JOBLIST >	tasks;
+	int							head;
+
+	void						Compact()
+	{
+		if( head >= tasks.Num() )
+		{
+			tasks.SetNum( 0 );
+			head = 0;
+		}
+	}
+};
+
+static idTaskQueue				taskQueues[MAX_TASK_QUEUES];
+static idSysInterlockedInteger	numQueuedTasks;
+
+static ID_TLS					currentTask;
+static ID_TLS					currentQueue;		// job thread number plus one, zero for other threads
+
+static idSysInterlockedInteger	frameSpawned;
+static idSysInterlockedInteger	frameStolen;
+static idSysInterlockedInteger	frameWaited;
+static idSysInterlockedInteger	frameWaitMicroSec;
+static taskGraphStats_t			lastFrameStats;
+
+static idCVar jobs_showTaskStats( "jobs_showTaskStats", "0", CVAR_BOOL | CVAR_NOCHEAT, "print the number of spawned, stolen and waited tasks every frame" );
+
+// implemented in ParallelJobList.cpp
+void SignalJobThreads( int numTasks );
+
+/*
+========================
+GetTaskQueue
+========================
+*/
+static int GetTaskQueue()
+{
+	const int queue = ( int )( ptrdiff_t ) currentQueue;
+	return ( queue > 0 ) ? ( queue - 1 ) : TASK_EXTERNAL_QUEUE;
+}
+
+/*
+========================
+ScheduleTask
+========================
+*/
+static void ScheduleTask( idTask* task )
+{
+	numQueuedTasks.Increment();
+	taskQueues[GetTaskQueue()].Push( task );
+	SignalJobThreads( 1 );
+}
+
+/*
+========================
+FindTask
+========================
+*/
+static idTask* FindTask( int queue )
+{
+	if( numQueuedTasks.GetValue() <= 0 )
+	{
+		return NULL;
+	}
+
+	idTask* task = taskQueues[queue].Pop();
+	if( task == NULL )
+	{
+		for( int i = 1; i < MAX_TASK_QUEUES && task == NULL; i++ )
+		{
+			task = taskQueues[( queue + i ) % MAX_TASK_QUEUES].Steal();
+		}
+		if( task != NULL )
+		{
+			frameStolen.Increment();
+		}
+	}
+	if( task != NULL )
+	{
+		numQueuedTasks.Decrement();
+	}
+	return task;
+}
+
+/*
+========================
+idTaskGraph::FinishTask
+
+Called when the task itself or one of its children is done.
+========================
+*/
+void idTaskGraph::FinishTask( idTask* task )
+{
+	if( task->numUnfinished.Decrement() != 0 )
+	{
+		return;
+	}
+
+	for( int i = 0; i < task->successors.Num(); i++ )
+	{
+		idTask* successor = task->successors[i];
+		if( successor->numDependencies.Decrement() == 0 )
+		{
+			ScheduleTask( successor );
+		}
+	}
+
+	idTaskGraph* graph = task->graph;
+	if( task->parent != NULL )
+	{
+		FinishTask( task->parent );
+	}
+
+	// this must be last because the graph may be reset as soon as the count reaches zero
+	graph->numUnfinished.Decrement();
+}
+
+/*
+========================
+ExecuteTask
+========================
+*/
+static void ExecuteTask( idTask* task, int queue )
+{
+	// tasks may wait on other graphs so save the outer task
+	const ptrdiff_t outerTask = currentTask;
+	const ptrdiff_t outerQueue = currentQueue;
+
+	currentTask = ( ptrdiff_t ) task;
+	currentQueue = queue + 1;
+
+	task->function( task->data );
+
+	currentTask = outerTask;
+	currentQueue = outerQueue;
+
+	idTaskGraph::FinishTask( task );
+}
+
+/*
+========================
+TaskGraph_RunTasks
+
+Called by the job threads when they have no job lists to work on.
+Returns true if any task was executed.
+========================
+*/
+bool TaskGraph_RunTasks( int threadNum )
+{
+	assert( threadNum >= 0 && threadNum < TASK_EXTERNAL_QUEUE );
+
+	bool executed = false;
+	for( idTask* task = FindTask( threadNum ); task != NULL; task = FindTask( threadNum ) )
+	{
+		ExecuteTask( task, threadNum );
+		executed = true;
+	}
+	return executed;
+}
+
+/*
+================================================================================================
+
+	idTaskGraph
+
+================================================================================================
+*/
+
+/*
+========================
+idTaskGraph::idTaskGraph
+========================
+*/
+idTaskGraph::idTaskGraph( const char* name_ ) :
+	name( name_ ),
+	submitted( false )
+{
+}
+
+/*
+========================
+idTaskGraph::~idTaskGraph
+========================
+*/
+idTaskGraph::~idTaskGraph()
+{
+	Reset();
+}
+
+/*
+========================
+idTaskGraph::AllocTask
+========================
+*/
+idTask* idTaskGraph::AllocTask( jobRun_t function, void* data, idTask* parent )
+{
+	idTask* task;
+	{
+		idScopedCriticalSection lock( taskAllocMutex );
+		task = taskAllocator.Alloc();
+	}
+	task->function = function;
+	task->data = data;
+	task->graph = this;
+	task->parent = parent;
+	task->numDependencies.SetValue( 0 );
+	task->numUnfinished.SetValue( 1 );
+
+	{
+		idScopedCriticalSection lock( tasksMutex );
+		tasks.Append( task );
+	}
+	numUnfinished.Increment();
+	frameSpawned.Increment();
+	return task;
+}
+
+/*
+========================
+idTaskGraph::AddTask
+========================
+*/
+idTask* idTaskGraph::AddTask( jobRun_t function, void* data )
+{
+	assert( !submitted );
+	idTask* task = AllocTask( function, data, NULL );
+	// hold the task back until the graph is submitted
+	task->numDependencies.SetValue( 1 );
+	return task;
+}
+
+/*
+========================
+idTaskGraph::AddDependency
+========================
+*/
+void idTaskGraph::AddDependency( idTask* task, idTask* dependency )
+{
+	assert( !submitted );
+	assert( task->graph == this && dependency->graph == this );
+	assert( task != dependency );
+	dependency->successors.Append( task );
+	task->numDependencies.Increment();
+}
+
+/*
+========================
+idTaskGraph::AddContinuation
+========================
+*/
+idTask* idTaskGraph::AddContinuation( idTask* task, jobRun_t function, void* data )
+{
+	idTask* continuation = AddTask( function, data );
+	AddDependency( continuation, task );
+	return continuation;
+}
+
+/*
+========================
+idTaskGraph::Submit
+========================
+*/
+void idTaskGraph::Submit()
+{
+	assert( !submitted );
+	submitted = true;
+
+	// tasks may be spawned while scheduling so iterate over a copy
+	idList< idTask*, TAG_JOBLIST > roots;
+	{
+		idScopedCriticalSection lock( tasksMutex );
+		roots = tasks;
+	}
+	for( int i = 0; i < roots.Num(); i++ )
+	{
+		if( roots[i]->numDependencies.Decrement() == 0 )
+		{
+			ScheduleTask( roots[i] );
+		}
+	}
+}
+
+/*
+========================
+idTaskGraph::Wait
+========================
+*/
+void idTaskGraph::Wait()
+{
+	if( !submitted || numUnfinished.GetValue() <= 0 )
+	{
+		return;
+	}
+
+	const uint64 waitStart = Sys_Microseconds();
+	const int queue = GetTaskQueue();
+
+	while( numUnfinished.GetValue() > 0 )
+	{
+		idTask* task = FindTask( queue );
+		if( task != NULL )
+		{
+			ExecuteTask( task, queue );
+		}
+		else
+		{
+			Sys_Yield();
+		}
+	}
+
+	frameWaited.Increment();
+	frameWaitMicroSec.Add( ( int )( Sys_Microseconds() - waitStart ) );
+}
+
+/*
+========================
+idTaskGraph::TryWait
+========================
+*/
+bool idTaskGraph::TryWait() const
+{
+	return numUnfinished.GetValue() <= 0;
+}
+
+/*
+========================
+idTaskGraph::Reset
+========================
+*/
+void idTaskGraph::Reset()
+{
+	if( submitted )
+	{
+		Wait();
+	}
+	else if( tasks.Num() > 0 )
+	{
+		// never submitted so nothing can be running
+		numUnfinished.SetValue( 0 );
+	}
+
+	{
+		idScopedCriticalSection lock( taskAllocMutex );
+		for( int i = 0; i < tasks.Num(); i++ )
+		{
+			taskAllocator.Free( tasks[i] );
+		}
+	}
+	tasks.Clear();
+	submitted = false;
+}
+
+/*
+========================
+idTaskGraph::SpawnChild
+========================
+*/
+idTask* idTaskGraph::SpawnChild( jobRun_t function, void* data )
+{
+	idTask* parent = GetCurrentTask();
+	if( parent == NULL )
+	{
+		idLib::Error( "idTaskGraph::SpawnChild: called outside of a running task" );
+		return NULL;
+	}
+
+	parent->numUnfinished.Increment();
+	idTask* task = parent->graph->AllocTask( function, data, parent );
+	ScheduleTask( task );
+	return task;
+}
+
+/*
+========================
+idTaskGraph::GetCurrentTask
+========================
+*/
+idTask* idTaskGraph::GetCurrentTask()
+{
+	return ( idTask* )( ptrdiff_t ) currentTask;
+}
+
+/*
+================================================================================================
+
+	ParallelFor
+
+The range is split recursively: each split task spawns a child for the upper half
+and keeps processing the lower half itself until the range fits the grain size.
+The split nodes are stored as an implicit binary tree so no allocations are needed
+while the tasks are running.
+
+================================================================================================
+*/
+
+struct parallelForNode_t
+{
+	idTaskGraph::parallelForRun_t	function;
+	void* 							data;
+	parallelForNode_t* 				nodes;
+	int								node;
+	int								begin;
+	int								end;
+	int								grainSize;
+};
+
+/*
+========================
+ParallelForSplit
+========================
+*/
+static void ParallelForSplit( void* data )
+{
+	parallelForNode_t* range = ( parallelForNode_t* ) data;
+
+	int node = range->node;
+	int begin = range->begin;
+	int end = range->end;
+
+	while( end - begin > range->grainSize )
+	{
+		const int mid = begin + ( end - begin ) / 2;
+
+		parallelForNode_t& upper = range->nodes[node * 2 + 2];
+		upper = *range;
+		upper.node = node * 2 + 2;
+		upper.begin = mid;
+		upper.end = end;
+		idTaskGraph::SpawnChild( ParallelForSplit, &upper );
+
+		node = node * 2 + 1;
+		end = mid;
+	}
+
+	range->function( range->data, begin, end );
+}
+
+/*
+========================
+idTaskGraph::ParallelFor
+========================
+*/
+void idTaskGraph::ParallelFor( int num, int grainSize, parallelForRun_t function, void* data )
+{
+	if( num <= 0 )
+	{
+		return;
+	}
+
+	grainSize = Max( grainSize, 1 );
+	if( num <= grainSize )
+	{
+		function( data, 0, num );
+		return;
+	}
+
+	// a binary tree over ceil( num / grainSize ) leaves never has more than 4 times that many nodes
+	const int numLeaves = ( num + grainSize - 1 ) / grainSize;
+	idList< parallelForNode_t, TAG_JOBLIST > nodes;
+	nodes.SetNum( numLeaves * 4 );
+
+	parallelForNode_t& root = nodes[0];
+	root.function = function;
+	root.data = data;
+	root.nodes = nodes.Ptr();
+	root.node = 0;
+	root.begin = 0;
+	root.end = num;
+	root.grainSize = grainSize;
+
+	idTaskGraph graph( "ParallelFor" );
+	graph.AddTask( ParallelForSplit, &root );
+	graph.Submit();
+	graph.Wait();
+}
+
+/*
+========================
+idTaskGraph::NextFrame
+========================
+*/
+void idTaskGraph::NextFrame()
+{
+	lastFrameStats.numSpawned = frameSpawned.GetValue();
+	lastFrameStats.numStolen = frameStolen.GetValue();
+	lastFrameStats.numWaited = frameWaited.GetValue();
+	lastFrameStats.waitMicroSec = ( uint64 ) frameWaitMicroSec.GetValue();
+
+	frameSpawned.Sub( lastFrameStats.numSpawned );
+	frameStolen.Sub( lastFrameStats.numStolen );
+	frameWaited.Sub( lastFrameStats.numWaited );
+	frameWaitMicroSec.Sub( ( int ) lastFrameStats.waitMicroSec );
+
+	if( jobs_showTaskStats.GetBool() && lastFrameStats.numSpawned > 0 )
+	{
+		idLib::Printf( "tasks: %4d spawned, %4d stolen, %3d waited (%5d us)\n",
+					   lastFrameStats.numSpawned, lastFrameStats.numStolen, lastFrameStats.numWaited, ( int ) lastFrameStats.waitMicroSec );
+	}
+}
+
+/*
+========================
+idTaskGraph::GetFrameStats
+========================
+*/
+const taskGraphStats_t& idTaskGraph::GetFrameStats()
+{
+	return lastFrameStats;
+}
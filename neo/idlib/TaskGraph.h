@@ -0,0 +1,139 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+#ifndef __TASKGRAPH_H__
+#define __TASKGRAPH_H__
+
+class idTask;
+
+struct taskGraphStats_t
+{
+	int				numSpawned;		// tasks added to graphs or spawned from running tasks
+	int				numStolen;		// tasks taken from the queue of another thread
+	int				numWaited;		// calls to idTaskGraph::Wait that had to wait for unfinished tasks
+	uint64			waitMicroSec;	// time spent in those waits
+};
+
+/*
+================================================
+idTaskGraph
+
+A graph of tasks with explicit dependencies that is executed by
+the job threads of the idParallelJobManager.
+
+Tasks are added and connected before the graph is submitted. Once
+a task is scheduled it may spawn child tasks with SpawnChild(). A
+task is not considered done, and its successors are not started,
+until all of its children are done as well.
+
+All idTask pointers stay valid until the graph is reset.
+
+	idTaskGraph graph( "load" );
+	idTask* parse = graph.AddTask( Parse, &data );
+	idTask* build = graph.AddContinuation( parse, Build, &data );
+	graph.AddContinuation( build, Upload, &data );
+	graph.Submit();
+	// do other work
+	graph.Wait();
+================================================
+*/
+class idTaskGraph
+{
+public:
+	typedef void ( * parallelForRun_t )( void* data, int begin, int end );
+
+	idTaskGraph( const char* name );
+	~idTaskGraph();
+
+	// Adds a task that is scheduled once the graph is submitted and all its dependencies are done.
+	idTask* 				AddTask( jobRun_t function, void* data );
+
+	// The task will not start before the dependency and all its children are done.
+	void					AddDependency( idTask* task, idTask* dependency );
+
+	// Adds a task that runs after the given task and all its children are done.
+	idTask* 				AddContinuation( idTask* task, jobRun_t function, void* data );
+
+	// Schedules all tasks without pending dependencies.
+	void					Submit();
+
+	// Waits for all tasks in the graph, including spawned children, to finish.
+	// The calling thread executes queued tasks while waiting.
+	void					Wait();
+
+	// Returns true if all tasks in the graph are done, without waiting.
+	bool					TryWait() const;
+
+	// Returns true if the graph has been submitted and not yet reset.
+	bool					IsSubmitted() const
+	{
+		return submitted;
+	}
+
+	// Number of tasks in the graph, including spawned children.
+	int						GetNumTasks() const
+	{
+		return tasks.Num();
+	}
+
+	// Waits for the graph and releases all tasks so the graph can be filled again.
+	void					Reset();
+
+	// Can only be called from inside a running task. The new task becomes a child of the running task.
+	static idTask* 			SpawnChild( jobRun_t function, void* data );
+
+	// Returns the task that is running on the calling thread or NULL.
+	static idTask* 			GetCurrentTask();
+
+	// Fork/join helper that calls function( data, begin, end ) on sub-ranges of [0, num)
+	// that are at most grainSize large. Returns once the whole range has been processed.
+	// Can be called from any thread, including from inside a running task.
+	static void				ParallelFor( int num, int grainSize, parallelForRun_t function, void* data );
+
+	// Starts a new frame for the task counters.
+	static void				NextFrame();
+
+	// Task counters of the last completed frame.
+	static const taskGraphStats_t& GetFrameStats();
+
+	// Called by the job threads when a task or one of its children is done.
+	static void				FinishTask( idTask* task );
+
+private:
+	const char* 			name;
+	bool					submitted;
+	idSysMutex				tasksMutex;
+	idList< idTask*, TAG_JOBLIST >	tasks;
+	idSysInterlockedInteger	numUnfinished;
+
+	idTask* 				AllocTask( jobRun_t function, void* data, idTask* parent );
+
+	idTaskGraph( const idTaskGraph& ) {}
+	void					operator=( const idTaskGraph& ) {}
+};
+
+#endif // !__TASKGRAPH_H__
@@ -167,6 +167,12 @@ public:
 		return Sys_InterlockedSub( value, ( interlockedInt_t ) v );
 	}
 
+	// atomically sets the integer to 'exchange' only if it currently equals 'comparand', returns the previous value
+	int					CompareExchange( int comparand, int exchange )
+	{
+		return Sys_InterlockedCompareExchange( value, ( interlockedInt_t ) comparand, ( interlockedInt_t ) exchange );
+	}
+
 	// returns the current value of the integer
 	int					GetValue() const
 	{
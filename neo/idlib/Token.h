@@ -108,6 +108,7 @@ private:
 	idToken* 		next;								// next token in chain, only used by idParser
 
 	void			AppendDirty( const char a );		// append character without adding trailing zero
+	void			AppendDirty( const char* text, int l );	// append characters without adding trailing zero
 };
 
 ID_INLINE idToken::idToken() : type(), subtype(), line(), linesCrossed(), flags()
@@ -180,4 +181,11 @@ ID_INLINE void idToken::AppendDirty( const char a )
 	data[len++] = a;
 }
 
+ID_INLINE void idToken::AppendDirty( const char* text, int l )
+{
+	EnsureAlloced( len + l + 1, true );
+	memcpy( data + len, text, l );
+	len += l;
+}
+
 #endif /* !__TOKEN_H__ */
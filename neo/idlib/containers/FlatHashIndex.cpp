@@ -0,0 +1,310 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "precompiled.h"
+#pragma hdrstop
+
+/*
+================
+idFlatHashIndex::Allocated
+================
+*/
+size_t idFlatHashIndex::Allocated() const
+{
+	return capacity * ( sizeof( ctrl[0] ) + sizeof( slots[0] ) );
+}
+
+/*
+================
+idFlatHashIndex::operator=
+================
+*/
+idFlatHashIndex& idFlatHashIndex::operator=( const idFlatHashIndex& other )
+{
+	if( this == &other )
+	{
+		return *this;
+	}
+
+	Free();
+	initialSize = other.initialSize;
+
+	if( other.capacity != 0 )
+	{
+		Rehash( other.capacity );
+		memcpy( ctrl, other.ctrl, capacity * ( sizeof( ctrl[0] ) + sizeof( slots[0] ) ) );
+		num = other.num;
+		numDeleted = other.numDeleted;
+	}
+	return *this;
+}
+
+/*
+================
+idFlatHashIndex::FindFreeSlot
+================
+*/
+int idFlatHashIndex::FindFreeSlot( const unsigned int hash ) const
+{
+	int group = ( int )( hash >> 7 ) & groupMask;
+	for( int probe = 1; ; probe++ )
+	{
+		const unsigned int free = MatchFree( ctrl + group * GROUP_SIZE );
+		if( free != 0 )
+		{
+			return group * GROUP_SIZE + LowestBit( free );
+		}
+		// the load factor guarantees there is a free slot somewhere
+		assert( probe <= groupMask );
+		group = ( group + probe ) & groupMask;
+	}
+}
+
+/*
+================
+idFlatHashIndex::Add
+================
+*/
+void idFlatHashIndex::Add( const int key, const int index )
+{
+	assert( index >= 0 );
+
+	// keep at least 1/8 of the slots empty so every probe sequence ends
+	if( ( num + numDeleted + 1 ) * 8 > capacity * 7 )
+	{
+		int newCapacity = Max( capacity, idMath::CeilPowerOfTwo( Max( initialSize, ( int )GROUP_SIZE ) ) );
+		while( ( num + 1 ) * 16 > newCapacity * 7 )
+		{
+			newCapacity <<= 1;
+		}
+		Rehash( newCapacity );
+	}
+
+	const unsigned int hash = Mix( key );
+	const int i = FindFreeSlot( hash );
+	if( ctrl[i] == CTRL_DELETED )
+	{
+		numDeleted--;
+	}
+	ctrl[i] = Tag( hash );
+	slots[i].key = key;
+	slots[i].index = index;
+	num++;
+}
+
+/*
+================
+idFlatHashIndex::Remove
+================
+*/
+void idFlatHashIndex::Remove( const int key, const int index )
+{
+	if( num == 0 )
+	{
+		return;
+	}
+
+	const unsigned int hash = Mix( key );
+	const byte tag = Tag( hash );
+	int group = ( int )( hash >> 7 ) & groupMask;
+	for( int probe = 1; probe <= groupMask + 1; probe++ )
+	{
+		byte* groupCtrl = ctrl + group * GROUP_SIZE;
+		const unsigned int empty = MatchEmpty( groupCtrl );
+
+		for( unsigned int matches = MatchTag( groupCtrl, tag ); matches != 0; matches &= matches - 1 )
+		{
+			const int bit = LowestBit( matches );
+			const slot_t& slot = slots[group * GROUP_SIZE + bit];
+			if( slot.key == key && slot.index == index )
+			{
+				// a group that was never full can't be part of another key's probe sequence
+				if( empty != 0 )
+				{
+					groupCtrl[bit] = CTRL_EMPTY;
+				}
+				else
+				{
+					groupCtrl[bit] = CTRL_DELETED;
+					numDeleted++;
+				}
+				num--;
+				return;
+			}
+		}
+
+		if( empty != 0 )
+		{
+			return;
+		}
+		group = ( group + probe ) & groupMask;
+	}
+}
+
+/*
+================
+idFlatHashIndex::RemoveIndex
+================
+*/
+void idFlatHashIndex::RemoveIndex( const int key, const int index )
+{
+	Remove( key, index );
+
+	for( int i = 0; i < capacity; i++ )
+	{
+		if( ( ctrl[i] & 0x80 ) == 0 && slots[i].index > index )
+		{
+			slots[i].index--;
+		}
+	}
+}
+
+/*
+================
+idFlatHashIndex::Clear
+================
+*/
+void idFlatHashIndex::Clear()
+{
+	if( capacity != 0 )
+	{
+		memset( ctrl, CTRL_EMPTY, capacity );
+	}
+	num = 0;
+	numDeleted = 0;
+}
+
+/*
+================
+idFlatHashIndex::Free
+================
+*/
+void idFlatHashIndex::Free()
+{
+	if( ctrl != NULL )
+	{
+		Mem_Free16( ctrl );
+		ctrl = NULL;
+		slots = NULL;
+	}
+	capacity = 0;
+	groupMask = 0;
+	num = 0;
+	numDeleted = 0;
+}
+
+/*
+================
+idFlatHashIndex::Reserve
+================
+*/
+void idFlatHashIndex::Reserve( const int count )
+{
+	int newCapacity = Max( capacity, ( int )GROUP_SIZE );
+	while( count * 8 > newCapacity * 7 )
+	{
+		newCapacity <<= 1;
+	}
+	if( newCapacity != capacity )
+	{
+		Rehash( newCapacity );
+	}
+}
+
+/*
+================
+idFlatHashIndex::Rehash
+
+Moves all key/index pairs into a table with the given number of slots, this also drops the deleted slots.
+================
+*/
+void idFlatHashIndex::Rehash( const int newCapacity )
+{
+	assert( idMath::IsPowerOfTwo( newCapacity ) && newCapacity >= GROUP_SIZE );
+
+	byte* oldCtrl = ctrl;
+	slot_t* oldSlots = slots;
+	const int oldCapacity = capacity;
+
+	// one allocation with the control bytes first so they stay 16 byte aligned
+	ctrl = ( byte* )Mem_Alloc16( newCapacity * ( sizeof( ctrl[0] ) + sizeof( slots[0] ) ), TAG_IDLIB_HASH );
+	slots = ( slot_t* )( ctrl + newCapacity );
+	memset( ctrl, CTRL_EMPTY, newCapacity );
+	capacity = newCapacity;
+	groupMask = newCapacity / GROUP_SIZE - 1;
+	numDeleted = 0;
+
+	for( int i = 0; i < oldCapacity; i++ )
+	{
+		if( ( oldCtrl[i] & 0x80 ) == 0 )
+		{
+			const unsigned int hash = Mix( oldSlots[i].key );
+			const int j = FindFreeSlot( hash );
+			ctrl[j] = oldCtrl[i];
+			slots[j] = oldSlots[i];
+		}
+	}
+
+	if( oldCtrl != NULL )
+	{
+		Mem_Free16( oldCtrl );
+	}
+}
+
+/*
+================
+idFlatHashIndex::GetAverageProbe
+================
+*/
+int idFlatHashIndex::GetAverageProbe() const
+{
+	if( num == 0 )
+	{
+		return 100;
+	}
+
+	int total = 0;
+	for( int i = 0; i < capacity; i++ )
+	{
+		if( ( ctrl[i] & 0x80 ) != 0 )
+		{
+			continue;
+		}
+
+		const int home = ( int )( Mix( slots[i].key ) >> 7 ) & groupMask;
+		int group = home;
+		int probe = 1;
+		while( group != i / GROUP_SIZE )
+		{
+			group = ( group + probe ) & groupMask;
+			probe++;
+		}
+		total += probe;
+	}
+	return total * 100 / num;
+}
@@ -0,0 +1,416 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __FLATHASHINDEX_H__
+#define __FLATHASHINDEX_H__
+
+/*
+===============================================================================
+
+	Open addressing hash table for indexes and arrays.
+
+	A drop in alternative to idHashIndex for lookup heavy tables. Instead of
+	chaining through separate hash and index arrays, every key/index pair
+	lives in one flat slot array. The slots are split in groups of 16 with a
+	control byte per slot holding 7 bits of the hash, so a lookup tests a
+	whole group with a single SSE2 compare and only visits slots that are
+	likely to match. The full 32 bit key is stored with every index which
+	rejects nearly all remaining collisions before the caller compares names.
+
+	Keys are full 32 bit hashes, GenerateKey does not mask them with the table
+	size. Iterating the indexes for a key needs a small iterator:
+
+	idFlatHashIndex::iterator_t it;
+	for( int i = hash.First( key, it ); i != -1; i = hash.Next( it ) ) {
+		...
+	}
+
+	The iterator is invalidated by Add and Remove.
+	Does not allocate memory until the first key/index pair is added.
+
+===============================================================================
+*/
+
+class idFlatHashIndex
+{
+public:
+	static const int NULL_INDEX = -1;
+	static const int GROUP_SIZE = 16;
+
+	struct iterator_t
+	{
+		int				key;
+		int				group;			// group being probed
+		int				probe;			// number of groups probed so far
+		unsigned int	matches;		// candidate slots left in the group
+		byte			tag;			// control byte the candidates must have
+	};
+
+	idFlatHashIndex();
+	explicit idFlatHashIndex( const int initialSize );
+	idFlatHashIndex( const idFlatHashIndex& other );
+	~idFlatHashIndex();
+
+	// returns total size of allocated memory
+	size_t			Allocated() const;
+	// returns total size of allocated memory including size of hash index type
+	size_t			Size() const;
+
+	idFlatHashIndex& operator=( const idFlatHashIndex& other );
+	// add an index to the hash, assumes the index has not yet been added to the hash
+	void			Add( const int key, const int index );
+	// remove an index from the hash
+	void			Remove( const int key, const int index );
+	// get the first index for the key, returns -1 if there is none
+	int				First( const int key, iterator_t& it ) const;
+	// get the next index for the key, returns -1 if there are no more
+	int				Next( iterator_t& it ) const;
+
+	// remove an entry from the index and remove it from the hash, decreasing all indexes > index
+	void			RemoveIndex( const int key, const int index );
+	// clear the hash but keep the memory
+	void			Clear();
+	// free allocated memory
+	void			Free();
+	// make room for the given number of entries without growing
+	void			Reserve( const int count );
+	// get the number of key/index pairs
+	int				Num() const;
+	// get the number of slots
+	int				GetCapacity() const;
+	// returns the average number of groups a successful lookup probes times 100
+	int				GetAverageProbe() const;
+	// returns a full key for a string
+	static int		GenerateKey( const char* string, bool caseSensitive = true );
+	// returns a full key for a single integer
+	static int		GenerateKey( const int n );
+
+private:
+	static const byte CTRL_EMPTY = 0x80;
+	static const byte CTRL_DELETED = 0xFE;
+
+	struct slot_t
+	{
+		int				key;
+		int				index;
+	};
+
+	byte* 			ctrl;			// control byte per slot, 16 byte aligned
+	slot_t* 		slots;			// stored right behind the control bytes
+	int				capacity;		// number of slots, power of two and a multiple of GROUP_SIZE
+	int				groupMask;
+	int				num;			// slots in use
+	int				numDeleted;		// slots that still count for the probe sequences
+	int				initialSize;
+
+	void			Rehash( const int newCapacity );
+	int				FindFreeSlot( const unsigned int hash ) const;
+
+	static unsigned int	Mix( const int key );
+	static byte		Tag( const unsigned int hash );
+	static unsigned int	MatchTag( const byte* group, const byte tag );
+	static unsigned int	MatchEmpty( const byte* group );
+	static unsigned int	MatchFree( const byte* group );
+	static int		LowestBit( const unsigned int mask );
+};
+
+/*
+================
+idFlatHashIndex::idFlatHashIndex
+================
+*/
+ID_INLINE idFlatHashIndex::idFlatHashIndex()
+{
+	ctrl = NULL;
+	slots = NULL;
+	capacity = 0;
+	groupMask = 0;
+	num = 0;
+	numDeleted = 0;
+	initialSize = GROUP_SIZE * 4;
+}
+
+/*
+================
+idFlatHashIndex::idFlatHashIndex
+================
+*/
+ID_INLINE idFlatHashIndex::idFlatHashIndex( const int initialSize )
+{
+	ctrl = NULL;
+	slots = NULL;
+	capacity = 0;
+	groupMask = 0;
+	num = 0;
+	numDeleted = 0;
+	this->initialSize = initialSize;
+}
+
+/*
+================
+idFlatHashIndex::idFlatHashIndex
+================
+*/
+ID_INLINE idFlatHashIndex::idFlatHashIndex( const idFlatHashIndex& other )
+{
+	ctrl = NULL;
+	slots = NULL;
+	capacity = 0;
+	groupMask = 0;
+	num = 0;
+	numDeleted = 0;
+	initialSize = other.initialSize;
+	*this = other;
+}
+
+/*
+================
+idFlatHashIndex::~idFlatHashIndex
+================
+*/
+ID_INLINE idFlatHashIndex::~idFlatHashIndex()
+{
+	Free();
+}
+
+/*
+================
+idFlatHashIndex::Size
+================
+*/
+ID_INLINE size_t idFlatHashIndex::Size() const
+{
+	return sizeof( *this ) + Allocated();
+}
+
+/*
+================
+idFlatHashIndex::Num
+================
+*/
+ID_INLINE int idFlatHashIndex::Num() const
+{
+	return num;
+}
+
+/*
+================
+idFlatHashIndex::GetCapacity
+================
+*/
+ID_INLINE int idFlatHashIndex::GetCapacity() const
+{
+	return capacity;
+}
+
+/*
+================
+idFlatHashIndex::Mix
+
+The string hashes are poorly distributed in the low bits, so every key is
+run through the murmur3 finalizer before it picks a group and a tag.
+================
+*/
+ID_INLINE unsigned int idFlatHashIndex::Mix( const int key )
+{
+	unsigned int h = ( unsigned int )key;
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+	return h;
+}
+
+/*
+================
+idFlatHashIndex::Tag
+================
+*/
+ID_INLINE byte idFlatHashIndex::Tag( const unsigned int hash )
+{
+	return ( byte )( hash & 0x7F );
+}
+
+/*
+================
+idFlatHashIndex::MatchTag
+
+Returns a bit for every slot in the group with the given control byte.
+================
+*/
+ID_INLINE unsigned int idFlatHashIndex::MatchTag( const byte* group, const byte tag )
+{
+#if defined(USE_INTRINSICS_SSE)
+	const __m128i g = _mm_load_si128( ( const __m128i* )group );
+	return ( unsigned int )_mm_movemask_epi8( _mm_cmpeq_epi8( g, _mm_set1_epi8( ( char )tag ) ) );
+#else
+	unsigned int mask = 0;
+	for( int i = 0; i < GROUP_SIZE; i++ )
+	{
+		mask |= ( unsigned int )( group[i] == tag ) << i;
+	}
+	return mask;
+#endif
+}
+
+/*
+================
+idFlatHashIndex::MatchEmpty
+================
+*/
+ID_INLINE unsigned int idFlatHashIndex::MatchEmpty( const byte* group )
+{
+	return MatchTag( group, CTRL_EMPTY );
+}
+
+/*
+================
+idFlatHashIndex::MatchFree
+
+Returns a bit for every empty or deleted slot, these are the only control bytes with the high bit set.
+================
+*/
+ID_INLINE unsigned int idFlatHashIndex::MatchFree( const byte* group )
+{
+#if defined(USE_INTRINSICS_SSE)
+	return ( unsigned int )_mm_movemask_epi8( _mm_load_si128( ( const __m128i* )group ) );
+#else
+	unsigned int mask = 0;
+	for( int i = 0; i < GROUP_SIZE; i++ )
+	{
+		mask |= ( unsigned int )( group[i] >> 7 ) << i;
+	}
+	return mask;
+#endif
+}
+
+/*
+================
+idFlatHashIndex::LowestBit
+================
+*/
+ID_INLINE int idFlatHashIndex::LowestBit( const unsigned int mask )
+{
+	assert( mask != 0 );
+#if defined(_MSC_VER)
+	unsigned long bit;
+	_BitScanForward( &bit, mask );
+	return ( int )bit;
+#else
+	return __builtin_ctz( mask );
+#endif
+}
+
+/*
+================
+idFlatHashIndex::First
+================
+*/
+ID_INLINE int idFlatHashIndex::First( const int key, iterator_t& it ) const
+{
+	if( num == 0 )
+	{
+		it.matches = 0;
+		it.probe = groupMask + 1;
+		return NULL_INDEX;
+	}
+
+	const unsigned int hash = Mix( key );
+	it.key = key;
+	it.tag = Tag( hash );
+	it.group = ( int )( hash >> 7 ) & groupMask;
+	it.probe = 0;
+	it.matches = MatchTag( ctrl + it.group * GROUP_SIZE, it.tag );
+	return Next( it );
+}
+
+/*
+================
+idFlatHashIndex::Next
+================
+*/
+ID_INLINE int idFlatHashIndex::Next( iterator_t& it ) const
+{
+	while( it.probe <= groupMask )
+	{
+		while( it.matches != 0 )
+		{
+			const int bit = LowestBit( it.matches );
+			it.matches &= it.matches - 1;
+
+			const slot_t& slot = slots[it.group * GROUP_SIZE + bit];
+			if( slot.key == it.key )
+			{
+				return slot.index;
+			}
+		}
+
+		// a key never probes past a group that still has an empty slot
+		if( MatchEmpty( ctrl + it.group * GROUP_SIZE ) != 0 )
+		{
+			break;
+		}
+
+		it.probe++;
+		it.group = ( it.group + it.probe ) & groupMask;
+		it.matches = MatchTag( ctrl + it.group * GROUP_SIZE, it.tag );
+	}
+
+	it.probe = groupMask + 1;
+	return NULL_INDEX;
+}
+
+/*
+================
+idFlatHashIndex::GenerateKey
+================
+*/
+ID_INLINE int idFlatHashIndex::GenerateKey( const char* string, bool caseSensitive )
+{
+	if( caseSensitive )
+	{
+		return idStr::Hash( string );
+	}
+	else
+	{
+		return idStr::IHash( string );
+	}
+}
+
+/*
+================
+idFlatHashIndex::GenerateKey
+================
+*/
+ID_INLINE int idFlatHashIndex::GenerateKey( const int n )
+{
+	return n;
+}
+
+#endif /* !__FLATHASHINDEX_H__ */
@@ -48,17 +48,17 @@ If you have questions concerning this license or the applicable additional terms
 idListArrayNew
 ========================
 */
-template< typename _type_, memTag_t _tag_ >
-ID_INLINE void* idListArrayNew( int num, bool zeroBuffer )
+template< typename _type_ >
+ID_INLINE void* idListArrayNew( int num, bool zeroBuffer, memTag_t tag )
 {
 	_type_ * ptr = NULL;
 	if( zeroBuffer )
 	{
-		ptr = ( _type_* )Mem_ClearedAlloc( sizeof( _type_ ) * num, _tag_ );
+		ptr = ( _type_* )Mem_ClearedAlloc( sizeof( _type_ ) * num, tag );
 	}
 	else
 	{
-		ptr = ( _type_* )Mem_Alloc( sizeof( _type_ ) * num, _tag_ );
+		ptr = ( _type_* )Mem_Alloc( sizeof( _type_ ) * num, tag );
 	}
 	for( int i = 0; i < num; i++ )
 	{
@@ -88,14 +88,14 @@ ID_INLINE void idListArrayDelete( void* ptr, int num )
 idListArrayResize
 ========================
 */
-template< typename _type_, memTag_t _tag_ >
-ID_INLINE void* idListArrayResize( void* voldptr, int oldNum, int newNum, bool zeroBuffer )
+template< typename _type_ >
+ID_INLINE void* idListArrayResize( void* voldptr, int oldNum, int newNum, bool zeroBuffer, memTag_t tag )
 {
 	_type_ * oldptr = ( _type_* )voldptr;
 	_type_ * newptr = NULL;
 	if( newNum > 0 )
 	{
-		newptr = ( _type_* )idListArrayNew<_type_, _tag_>( newNum, zeroBuffer );
+		newptr = ( _type_* )idListArrayNew<_type_>( newNum, zeroBuffer, tag );
 		int overlap = Min( oldNum, newNum );
 		for( int i = 0; i < overlap; i++ )
 		{
@@ -195,8 +195,8 @@ public:
 	//------------------------
 	// memTag
 	//
-	// Changing the memTag when the list has an allocated buffer will
-	// result in corruption of the memory statistics.
+	// The memTag is used for all allocations made after it is set,
+	// a buffer that is already allocated keeps the tag it was made with.
 	//------------------------
 	memTag_t		GetMemTag() const
 	{
@@ -575,7 +575,7 @@ ID_INLINE void idList<_type_, _tag_>::Resize( int newsize )
 		return;
 	}
 
-	list = ( _type_* )idListArrayResize< _type_, _tag_ >( list, size, newsize, false );
+	list = ( _type_* )idListArrayResize< _type_ >( list, size, newsize, false, ( memTag_t )memTag );
 	size = newsize;
 	if( size < num )
 	{
@@ -606,7 +606,7 @@ ID_INLINE void idList<_type_, _tag_>::Resize( int newsize, int newgranularity )
 		return;
 	}
 
-	list = ( _type_* )idListArrayResize< _type_, _tag_ >( list, size, newsize, false );
+	list = ( _type_* )idListArrayResize< _type_ >( list, size, newsize, false, ( memTag_t )memTag );
 	size = newsize;
 	if( size < num )
 	{
@@ -757,7 +757,7 @@ ID_INLINE idList<_type_, _tag_>& idList<_type_, _tag_>::operator=( const idList<
 
 	if( size )
 	{
-		list = ( _type_* )idListArrayNew< _type_, _tag_ >( size, false );
+		list = ( _type_* )idListArrayNew< _type_ >( size, false, ( memTag_t )memTag );
 		for( i = 0; i < num; i++ )
 		{
 			list[ i ] = other.list[ i ];
@@ -48,16 +48,8 @@ If you have questions concerning this license or the applicable additional terms
 //lint -e550
 
 #define RENDER_MATRIX_INVERSE_EPSILON		1e-16f	// JDC: changed from 1e-14f to allow full wasteland parallel light projections to invert
-#define RENDER_MATRIX_INFINITY				1e30f	// NOTE: cannot initiaize a vec_float4 with idMath::INFINITUM on the SPU
 #define RENDER_MATRIX_PROJECTION_EPSILON	0.1f
 
-//#define CLIP_SPACE_OGL		// the OpenGL clip space Z is in the range [-1, 1]
-
-// RB: DX12 & Vulkan require the clip space Z is in the range [0, 1]
-// This change is especially important for all kinds of light bounding box -> clip space transformations so
-// the depth bounding tests clipping tests work properly
-#define CLIP_SPACE_D3D	1
-
 /*
 ================================================================================================
 
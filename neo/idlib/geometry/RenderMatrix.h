@@ -29,6 +29,16 @@ If you have questions concerning this license or the applicable additional terms
 #ifndef __RENDERMATRIX_H__
 #define __RENDERMATRIX_H__
 
+#define RENDER_MATRIX_INFINITY				1e30f	// NOTE: cannot initiaize a vec_float4 with idMath::INFINITUM on the SPU
+
+//#define CLIP_SPACE_OGL		// the OpenGL clip space Z is in the range [-1, 1]
+
+// RB: DX12 & Vulkan require the clip space Z is in the range [0, 1]
+// This change is especially important for all kinds of light bounding box -> clip space transformations so
+// the depth bounding tests clipping tests work properly
+// NOTE: the idSIMDProcessor culling routines use the same clip space
+#define CLIP_SPACE_D3D	1
+
 static const int NUM_FRUSTUM_CORNERS	= 8;
 
 struct frustumCorners_t
@@ -112,9 +112,10 @@ int idWinding::Split( const idPlane& plane, const float epsilon, idWinding** fro
 	counts[0] = counts[1] = counts[2] = 0;
 
 	// determine sides for each point
+	SIMDProcessor->Dot( dists, plane, p, numPoints );
 	for( i = 0; i < numPoints; i++ )
 	{
-		dists[i] = dot = plane.Distance( p[i].ToVec3() );
+		dot = dists[i];
 		if( dot > epsilon )
 		{
 			sides[i] = SIDE_FRONT;
@@ -289,9 +290,10 @@ idWinding* idWinding::Clip( const idPlane& plane, const float epsilon, const boo
 	counts[SIDE_FRONT] = counts[SIDE_BACK] = counts[SIDE_ON] = 0;
 
 	// determine sides for each point
+	SIMDProcessor->Dot( dists, plane, p, numPoints );
 	for( i = 0; i < numPoints; i++ )
 	{
-		dists[i] = dot = plane.Distance( p[i].ToVec3() );
+		dot = dists[i];
 		if( dot > epsilon )
 		{
 			sides[i] = SIDE_FRONT;
@@ -427,9 +429,10 @@ bool idWinding::ClipInPlace( const idPlane& plane, const float epsilon, const bo
 	counts[SIDE_FRONT] = counts[SIDE_BACK] = counts[SIDE_ON] = 0;
 
 	// determine sides for each point
+	SIMDProcessor->Dot( dists, plane, p, numPoints );
 	for( i = 0; i < numPoints; i++ )
 	{
-		dists[i] = dot = plane.Distance( p[i].ToVec3() );
+		dot = dists[i];
 		if( dot > epsilon )
 		{
 			sides[i] = SIDE_FRONT;
@@ -1811,9 +1814,10 @@ int idFixedWinding::Split( idFixedWinding* back, const idPlane& plane, const flo
 	counts[SIDE_FRONT] = counts[SIDE_BACK] = counts[SIDE_ON] = 0;
 
 	// determine sides for each point
+	SIMDProcessor->Dot( dists, plane, p, numPoints );
 	for( i = 0; i < numPoints; i++ )
 	{
-		dists[i] = dot = plane.Distance( p[i].ToVec3() );
+		dot = dists[i];
 		if( dot > epsilon )
 		{
 			sides[i] = SIDE_FRONT;
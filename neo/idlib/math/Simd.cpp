@@ -36,9 +36,11 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "Simd_Generic.h"
 #include "Simd_SSE.h"
+#include "Simd_AVX2.h"
 
 idSIMDProcessor*		processor = NULL;			// pointer to SIMD processor
 idSIMDProcessor* 	generic = NULL;				// pointer to generic SIMD implementation
+idSIMDProcessor* 	sseFallback = NULL;			// pointer to SSE implementation when the processor is AVX2
 idSIMDProcessor* 	SIMDProcessor = NULL;
 
 /*
@@ -59,7 +61,7 @@ void idSIMD::Init()
 idSIMD::InitProcessor
 ============
 */
-void idSIMD::InitProcessor( const char* module, bool forceGeneric )
+void idSIMD::InitProcessor( const char* module, bool forceGeneric, bool forceSSE )
 {
 	cpuid_t cpuid;
 	idSIMDProcessor* newProcessor;
@@ -77,6 +79,14 @@ void idSIMD::InitProcessor( const char* module, bool forceGeneric )
 
 		if( processor == NULL )
 		{
+#if defined(USE_INTRINSICS_AVX2)
+			if( idSIMD_AVX2::CPUSupported() )
+			{
+				cpuid = ( cpuid_t )( cpuid | CPUID_AVX2 | CPUID_FMA3 );
+				processor = new( TAG_MATH ) idSIMD_AVX2;
+			}
+			else
+#endif
 #if defined(USE_INTRINSICS_SSE)
 			if( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) )
 			{
@@ -91,6 +101,18 @@ void idSIMD::InitProcessor( const char* module, bool forceGeneric )
 		}
 
 		newProcessor = processor;
+
+#if defined(USE_INTRINSICS_AVX2)
+		if( forceSSE && ( processor->cpuid & CPUID_AVX2 ) )
+		{
+			if( sseFallback == NULL )
+			{
+				sseFallback = new( TAG_MATH ) idSIMD_SSE;
+				sseFallback->cpuid = ( cpuid_t )( processor->cpuid & ~( CPUID_AVX2 | CPUID_FMA3 ) );
+			}
+			newProcessor = sseFallback;
+		}
+#endif
 	}
 
 	if( newProcessor != SIMDProcessor )
@@ -123,9 +145,11 @@ void idSIMD::Shutdown()
 	{
 		delete processor;
 	}
+	delete sseFallback;
 	delete generic;
 	generic = NULL;
 	processor = NULL;
+	sseFallback = NULL;
 	SIMDProcessor = NULL;
 }
 
@@ -956,6 +980,265 @@ void TestUntransformJoints()
 	PrintClocks( va( "   simd->UntransformJoints() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
 }
 
+/*
+============
+TestCullBoundsToMVP
+============
+*/
+void TestCullBoundsToMVP()
+{
+	int i;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	idTempArray< idBounds > bounds( COUNT );
+	ALIGN16( byte culled1[COUNT] );
+	ALIGN16( byte culled2[COUNT] );
+	ALIGN16( float min1[COUNT] );
+	ALIGN16( float max1[COUNT] );
+	ALIGN16( float min2[COUNT] );
+	ALIGN16( float max2[COUNT] );
+	idRenderMatrix mvp;
+	const char* result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	for( i = 0; i < 16; i++ )
+	{
+		mvp[i >> 2][i & 3] = srnd.CRandomFloat();
+	}
+	for( i = 0; i < COUNT; i++ )
+	{
+		idVec3 center( srnd.CRandomFloat() * 10.0f, srnd.CRandomFloat() * 10.0f, srnd.CRandomFloat() * 10.0f );
+		idVec3 extents( srnd.RandomFloat() * 2.0f, srnd.RandomFloat() * 2.0f, srnd.RandomFloat() * 2.0f );
+		bounds[i][0] = center - extents;
+		bounds[i][1] = center + extents;
+	}
+
+	bestClocksGeneric = 0;
+	for( i = 0; i < NUMTESTS; i++ )
+	{
+		StartRecordTime( start );
+		p_generic->CullBoundsToMVP( culled1, mvp, bounds.Ptr(), COUNT, false );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->CullBoundsToMVP()", COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for( i = 0; i < NUMTESTS; i++ )
+	{
+		StartRecordTime( start );
+		p_simd->CullBoundsToMVP( culled2, mvp, bounds.Ptr(), COUNT, false );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for( i = 0; i < COUNT; i++ )
+	{
+		if( culled1[i] != culled2[i] )
+		{
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "   simd->CullBoundsToMVP() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+
+	bestClocksGeneric = 0;
+	for( i = 0; i < NUMTESTS; i++ )
+	{
+		StartRecordTime( start );
+		p_generic->DepthBoundsForBounds( min1, max1, mvp, bounds.Ptr(), COUNT, true );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->DepthBoundsForBounds()", COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for( i = 0; i < NUMTESTS; i++ )
+	{
+		StartRecordTime( start );
+		p_simd->DepthBoundsForBounds( min2, max2, mvp, bounds.Ptr(), COUNT, true );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for( i = 0; i < COUNT; i++ )
+	{
+		if( idMath::Fabs( min1[i] - min2[i] ) > 1e-4f || idMath::Fabs( max1[i] - max2[i] ) > 1e-4f )
+		{
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "   simd->DepthBoundsForBounds() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+}
+
+/*
+============
+TestDot
+============
+*/
+void TestDot()
+{
+	int i;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	ALIGN16( float fdst0[COUNT] );
+	ALIGN16( float fdst1[COUNT] );
+	ALIGN16( idPlane planes[COUNT] );
+	ALIGN16( idVec5 v5src0[COUNT] );
+	idVec3 constant;
+	idPlane plane;
+	const char* result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	for( i = 0; i < COUNT; i++ )
+	{
+		planes[i].SetNormal( idVec3( srnd.CRandomFloat(), srnd.CRandomFloat(), srnd.CRandomFloat() ) );
+		planes[i].Normalize();
+		planes[i].SetDist( srnd.CRandomFloat() * 10.0f );
+		for( int j = 0; j < 5; j++ )
+		{
+			v5src0[i][j] = srnd.CRandomFloat() * 10.0f;
+		}
+	}
+	constant.Set( srnd.CRandomFloat() * 10.0f, srnd.CRandomFloat() * 10.0f, srnd.CRandomFloat() * 10.0f );
+	plane = planes[0];
+
+	bestClocksGeneric = 0;
+	for( i = 0; i < NUMTESTS; i++ )
+	{
+		StartRecordTime( start );
+		p_generic->Dot( fdst0, constant, planes, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->Dot( idVec3 * idPlane[] )", COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for( i = 0; i < NUMTESTS; i++ )
+	{
+		StartRecordTime( start );
+		p_simd->Dot( fdst1, constant, planes, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for( i = 0; i < COUNT; i++ )
+	{
+		if( idMath::Fabs( fdst0[i] - fdst1[i] ) > 1e-4f )
+		{
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "   simd->Dot( idVec3 * idPlane[] ) %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+
+	bestClocksGeneric = 0;
+	for( i = 0; i < NUMTESTS; i++ )
+	{
+		StartRecordTime( start );
+		p_generic->Dot( fdst0, plane, v5src0, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->Dot( idPlane * idVec5[] )", COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for( i = 0; i < NUMTESTS; i++ )
+	{
+		StartRecordTime( start );
+		p_simd->Dot( fdst1, plane, v5src0, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for( i = 0; i < COUNT; i++ )
+	{
+		if( idMath::Fabs( fdst0[i] - fdst1[i] ) > 1e-4f )
+		{
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "   simd->Dot( idPlane * idVec5[] ) %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+}
+
+/*
+============
+TestDeriveTangentFrames
+============
+*/
+void TestDeriveTangentFrames()
+{
+	int i;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	idTempArray< idDrawVert > drawVerts( COUNT );
+	idTempArray< triIndex_t > indexes( COUNT );
+	idTempArray< idVec3 > normals1( COUNT );
+	idTempArray< idVec3 > tangents1( COUNT );
+	idTempArray< idVec3 > bitangents1( COUNT );
+	idTempArray< idVec3 > normals2( COUNT );
+	idTempArray< idVec3 > tangents2( COUNT );
+	idTempArray< idVec3 > bitangents2( COUNT );
+	const char* result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	for( i = 0; i < COUNT; i++ )
+	{
+		drawVerts[i].Clear();
+		drawVerts[i].xyz.Set( srnd.CRandomFloat() * 10.0f, srnd.CRandomFloat() * 10.0f, srnd.CRandomFloat() * 10.0f );
+		drawVerts[i].SetTexCoord( srnd.CRandomFloat(), srnd.CRandomFloat() );
+	}
+	// COUNT is a multiple of three
+	for( i = 0; i < COUNT; i += 3 )
+	{
+		indexes[i + 0] = i + 0;
+		indexes[i + 1] = srnd.RandomInt( COUNT );
+		indexes[i + 2] = srnd.RandomInt( COUNT );
+		if( indexes[i + 1] == indexes[i + 0] || indexes[i + 2] == indexes[i + 0] || indexes[i + 1] == indexes[i + 2] )
+		{
+			indexes[i + 1] = ( i + 1 ) % COUNT;
+			indexes[i + 2] = ( i + 2 ) % COUNT;
+		}
+	}
+
+	bestClocksGeneric = 0;
+	for( i = 0; i < NUMTESTS; i++ )
+	{
+		normals1.Zero();
+		tangents1.Zero();
+		bitangents1.Zero();
+		StartRecordTime( start );
+		p_generic->DeriveTangentFrames( normals1.Ptr(), tangents1.Ptr(), bitangents1.Ptr(), drawVerts.Ptr(), indexes.Ptr(), COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->DeriveTangentFrames()", COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for( i = 0; i < NUMTESTS; i++ )
+	{
+		normals2.Zero();
+		tangents2.Zero();
+		bitangents2.Zero();
+		StartRecordTime( start );
+		p_simd->DeriveTangentFrames( normals2.Ptr(), tangents2.Ptr(), bitangents2.Ptr(), drawVerts.Ptr(), indexes.Ptr(), COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for( i = 0; i < COUNT; i++ )
+	{
+		if( !normals1[i].Compare( normals2[i], 1e-3f ) || !tangents1[i].Compare( tangents2[i], 1e-3f ) || !bitangents1[i].Compare( bitangents2[i], 1e-3f ) )
+		{
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "   simd->DeriveTangentFrames() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+}
+
 /*
 ============
 TestMath
@@ -1379,62 +1662,113 @@ void idSIMD::Test_f( const idCmdArgs& args )
 #endif
 	// RB end
 
-	p_simd = processor;
+	// every backend that is tested is compared against the generic code
+	idSIMDProcessor* testProcessors[2];
+	int numTestProcessors = 0;
+
 	p_generic = generic;
 
-	if( idStr::Length( args.Argv( 1 ) ) != 0 )
-	{
-		cpuid_t cpuid = idLib::sys->GetProcessorId();
-		idStr argString = args.Args();
+	cpuid_t cpuid = idLib::sys->GetProcessorId();
+	idStr argString = args.Args();
+	argString.Replace( " ", "" );
 
-		argString.Replace( " ", "" );
+#if defined(USE_INTRINSICS_AVX2)
+	const bool avx2 = idSIMD_AVX2::CPUSupported();
+#else
+	const bool avx2 = false;
+#endif
 
+	if( argString.Length() != 0 )
+	{
 #if defined(USE_INTRINSICS_SSE)
 		if( idStr::Icmp( argString, "SSE" ) == 0 )
 		{
-			if( !( cpuid & CPUID_MMX ) || !( cpuid & CPUID_SSE ) )
+			if( !avx2 && ( !( cpuid & CPUID_MMX ) || !( cpuid & CPUID_SSE ) ) )
 			{
 				common->Printf( "CPU does not support MMX & SSE\n" );
 				return;
 			}
-			p_simd = new( TAG_MATH ) idSIMD_SSE;
+			testProcessors[numTestProcessors++] = new( TAG_MATH ) idSIMD_SSE;
 		}
 		else
 #endif
+#if defined(USE_INTRINSICS_AVX2)
+		if( idStr::Icmp( argString, "AVX2" ) == 0 )
 		{
-			common->Printf( "invalid argument, use: MMX, 3DNow, SSE, SSE2, SSE3, AltiVec\n" );
+			if( !avx2 )
+			{
+				common->Printf( "CPU does not support AVX2 & FMA\n" );
+				return;
+			}
+			testProcessors[numTestProcessors++] = new( TAG_MATH ) idSIMD_AVX2;
+		}
+		else
+#endif
+		{
+			common->Printf( "invalid argument, use: SSE, AVX2\n" );
 			return;
 		}
 	}
+	else
+	{
+#if defined(USE_INTRINSICS_SSE)
+		if( avx2 || ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) ) )
+		{
+			testProcessors[numTestProcessors++] = new( TAG_MATH ) idSIMD_SSE;
+		}
+#endif
+#if defined(USE_INTRINSICS_AVX2)
+		if( avx2 )
+		{
+			testProcessors[numTestProcessors++] = new( TAG_MATH ) idSIMD_AVX2;
+		}
+#endif
+		if( numTestProcessors == 0 )
+		{
+			testProcessors[numTestProcessors++] = processor;
+		}
+	}
 
 	idLib::common->SetRefreshOnPrint( true );
 
-	idLib::common->Printf( "using %s for SIMD processing\n", p_simd->GetName() );
-
 	GetBaseClocks();
 
-	TestMath();
-	TestMinMax();
-	TestMemcpy();
-	TestMemset();
+	for( int i = 0; i < numTestProcessors; i++ )
+	{
+		p_simd = testProcessors[i];
 
-	idLib::common->Printf( "====================================\n" );
+		idLib::common->Printf( "using %s for SIMD processing\n", p_simd->GetName() );
 
-	TestBlendJoints();
-	TestBlendJointsFast();
-	TestConvertJointQuatsToJointMats();
-	TestConvertJointMatsToJointQuats();
-	TestTransformJoints();
-	TestUntransformJoints();
+		TestMath();
+		TestMinMax();
+		TestMemcpy();
+		TestMemset();
 
-	idLib::common->Printf( "====================================\n" );
+		idLib::common->Printf( "====================================\n" );
 
-	idLib::common->SetRefreshOnPrint( false );
+		TestBlendJoints();
+		TestBlendJointsFast();
+		TestConvertJointQuatsToJointMats();
+		TestConvertJointMatsToJointQuats();
+		TestTransformJoints();
+		TestUntransformJoints();
 
-	if( p_simd != processor )
-	{
-		delete p_simd;
+		idLib::common->Printf( "====================================\n" );
+
+		TestCullBoundsToMVP();
+		TestDot();
+		TestDeriveTangentFrames();
+
+		idLib::common->Printf( "====================================\n" );
+
+		if( p_simd != processor )
+		{
+			delete p_simd;
+		}
 	}
+
+	idLib::common->SetRefreshOnPrint( false );
+
 	p_simd = NULL;
 	p_generic = NULL;
 
@@ -44,7 +44,7 @@ class idSIMD
 {
 public:
 	static void			Init();
-	static void			InitProcessor( const char* module, bool forceGeneric );
+	static void			InitProcessor( const char* module, bool forceGeneric, bool forceSSE = false );
 	static void			Shutdown();
 	static void			Test_f( const class idCmdArgs& args );
 };
@@ -79,6 +79,8 @@ class idMat5;
 class idMat6;
 class idMatX;
 class idPlane;
+class idBounds;
+class idRenderMatrix;
 class idDrawVert;
 class idJointQuat;
 class idJointMat;
@@ -114,6 +116,17 @@ public:
 	virtual void VPCALL ConvertJointMatsToJointQuats( idJointQuat* jointQuats, const idJointMat* jointMats, const int numJoints ) = 0;
 	virtual void VPCALL TransformJoints( idJointMat* jointMats, const int* parents, const int firstJoint, const int lastJoint ) = 0;
 	virtual void VPCALL UntransformJoints( idJointMat* jointMats, const int* parents, const int firstJoint, const int lastJoint ) = 0;
+
+	// culling, culled[i] is set to 1 when bounds[i] is completely outside the clip space of the MVP, see idRenderMatrix::CullBoundsToMVP
+	virtual void VPCALL CullBoundsToMVP( byte* culled, const idRenderMatrix& mvp, const idBounds* bounds, const int count, const bool zeroToOne ) = 0;
+	virtual void VPCALL DepthBoundsForBounds( float* min, float* max, const idRenderMatrix& mvp, const idBounds* bounds, const int count, const bool windowSpace ) = 0;
+
+	// plane distances, dst[i] = src[i].Distance( constant ) and dst[i] = constant.Distance( src[i].ToVec3() )
+	virtual void VPCALL Dot( float* dst, const idVec3& constant, const idPlane* src, const int count ) = 0;
+	virtual void VPCALL Dot( float* dst, const idPlane& constant, const idVec5* src, const int count ) = 0;
+
+	// adds the unit normal, tangent and bitangent of every triangle to the three vertices of the triangle
+	virtual void VPCALL DeriveTangentFrames( idVec3* normals, idVec3* tangents, idVec3* bitangents, const idDrawVert* verts, const triIndex_t* indexes, const int numIndexes ) = 0;
 };
 
 // pointer to SIMD processor
@@ -0,0 +1,1153 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "precompiled.h"
+#pragma hdrstop
+#include "Simd_Generic.h"
+#include "Simd_SSE.h"
+#include "Simd_AVX2.h"
+
+//===============================================================
+//
+//	AVX2 & FMA implementation of idSIMDProcessor
+//
+//===============================================================
+
+#if defined(USE_INTRINSICS_AVX2)
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+	#define ID_AVX2_TARGET
+#else
+	#include <cpuid.h>
+	#define ID_AVX2_TARGET		__attribute__( ( target( "avx2,fma" ) ) )
+#endif
+
+#ifndef M_PI // DG: this is already defined in math.h
+	#define M_PI	3.14159265358979323846f
+#endif
+
+/*
+============
+idSIMD_AVX2::CPUSupported
+============
+*/
+bool idSIMD_AVX2::CPUSupported()
+{
+	unsigned int regs[4];
+
+#if defined(_MSC_VER)
+	__cpuid( ( int* )regs, 0 );
+	if( regs[0] < 7 )
+	{
+		return false;
+	}
+	__cpuid( ( int* )regs, 1 );
+#else
+	if( __get_cpuid_max( 0, NULL ) < 7 )
+	{
+		return false;
+	}
+	__cpuid( 1, regs[0], regs[1], regs[2], regs[3] );
+#endif
+
+	const unsigned int fma = 1u << 12;
+	const unsigned int osxsave = 1u << 27;
+	const unsigned int avx = 1u << 28;
+	if( ( regs[2] & ( fma | osxsave | avx ) ) != ( fma | osxsave | avx ) )
+	{
+		return false;
+	}
+
+	// the OS has to save the upper halves of the YMM registers on a context switch
+#if defined(_MSC_VER)
+	const unsigned long long xcr0 = _xgetbv( 0 );
+#else
+	unsigned int xcr0Lo, xcr0Hi;
+	__asm__ __volatile__( "xgetbv" : "=a"( xcr0Lo ), "=d"( xcr0Hi ) : "c"( 0 ) );
+	const unsigned long long xcr0 = xcr0Lo | ( ( unsigned long long )xcr0Hi << 32 );
+#endif
+	if( ( xcr0 & 6 ) != 6 )
+	{
+		return false;
+	}
+
+#if defined(_MSC_VER)
+	__cpuidex( ( int* )regs, 7, 0 );
+#else
+	__cpuid_count( 7, 0, regs[0], regs[1], regs[2], regs[3] );
+#endif
+	const unsigned int avx2 = 1u << 5;
+	return ( regs[1] & avx2 ) != 0;
+}
+
+/*
+============
+idSIMD_AVX2::GetName
+============
+*/
+const char* idSIMD_AVX2::GetName() const
+{
+	return "AVX2 & FMA";
+}
+
+/*
+============
+Transpose8x8
+
+Swaps rows and columns of an 8x8 float matrix. Used to turn eight idJointQuats
+into one register per component and back.
+============
+*/
+ID_AVX2_TARGET static ID_INLINE void Transpose8x8( __m256 r[8] )
+{
+	__m256 t0 = _mm256_unpacklo_ps( r[0], r[1] );
+	__m256 t1 = _mm256_unpackhi_ps( r[0], r[1] );
+	__m256 t2 = _mm256_unpacklo_ps( r[2], r[3] );
+	__m256 t3 = _mm256_unpackhi_ps( r[2], r[3] );
+	__m256 t4 = _mm256_unpacklo_ps( r[4], r[5] );
+	__m256 t5 = _mm256_unpackhi_ps( r[4], r[5] );
+	__m256 t6 = _mm256_unpacklo_ps( r[6], r[7] );
+	__m256 t7 = _mm256_unpackhi_ps( r[6], r[7] );
+
+	__m256 u0 = _mm256_shuffle_ps( t0, t2, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+	__m256 u1 = _mm256_shuffle_ps( t0, t2, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+	__m256 u2 = _mm256_shuffle_ps( t1, t3, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+	__m256 u3 = _mm256_shuffle_ps( t1, t3, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+	__m256 u4 = _mm256_shuffle_ps( t4, t6, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+	__m256 u5 = _mm256_shuffle_ps( t4, t6, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+	__m256 u6 = _mm256_shuffle_ps( t5, t7, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+	__m256 u7 = _mm256_shuffle_ps( t5, t7, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+
+	r[0] = _mm256_permute2f128_ps( u0, u4, 0x20 );
+	r[1] = _mm256_permute2f128_ps( u1, u5, 0x20 );
+	r[2] = _mm256_permute2f128_ps( u2, u6, 0x20 );
+	r[3] = _mm256_permute2f128_ps( u3, u7, 0x20 );
+	r[4] = _mm256_permute2f128_ps( u0, u4, 0x31 );
+	r[5] = _mm256_permute2f128_ps( u1, u5, 0x31 );
+	r[6] = _mm256_permute2f128_ps( u2, u6, 0x31 );
+	r[7] = _mm256_permute2f128_ps( u3, u7, 0x31 );
+}
+
+/*
+============
+HorizontalMin / HorizontalMax
+============
+*/
+ID_AVX2_TARGET static ID_INLINE __m128 HorizontalMin( const __m256 v )
+{
+	__m128 m = _mm_min_ps( _mm256_castps256_ps128( v ), _mm256_extractf128_ps( v, 1 ) );
+	m = _mm_min_ps( m, _mm_shuffle_ps( m, m, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+	return _mm_min_ss( m, _mm_shuffle_ps( m, m, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+}
+
+ID_AVX2_TARGET static ID_INLINE __m128 HorizontalMax( const __m256 v )
+{
+	__m128 m = _mm_max_ps( _mm256_castps256_ps128( v ), _mm256_extractf128_ps( v, 1 ) );
+	m = _mm_max_ps( m, _mm_shuffle_ps( m, m, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+	return _mm_max_ss( m, _mm_shuffle_ps( m, m, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MinMax( float& min, float& max, const float* src, const int count )
+{
+	__m256 vmin = _mm256_set1_ps( idMath::INFINITUM );
+	__m256 vmax = _mm256_set1_ps( -idMath::INFINITUM );
+
+	int i = 0;
+	for( ; i + 8 <= count; i += 8 )
+	{
+		__m256 v = _mm256_loadu_ps( src + i );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+
+	min = _mm_cvtss_f32( HorizontalMin( vmin ) );
+	max = _mm_cvtss_f32( HorizontalMax( vmax ) );
+
+	for( ; i < count; i++ )
+	{
+		if( src[i] < min )
+		{
+			min = src[i];
+		}
+		if( src[i] > max )
+		{
+			max = src[i];
+		}
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MinMax( idVec2& min, idVec2& max, const idVec2* src, const int count )
+{
+	__m256 vmin = _mm256_set1_ps( idMath::INFINITUM );
+	__m256 vmax = _mm256_set1_ps( -idMath::INFINITUM );
+
+	// four vectors per register, even lanes are x and odd lanes are y
+	const float* f = src->ToFloatPtr();
+	int i = 0;
+	for( ; i + 4 <= count; i += 4 )
+	{
+		__m256 v = _mm256_loadu_ps( f + i * 2 );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+
+	__m128 m = _mm_min_ps( _mm256_castps256_ps128( vmin ), _mm256_extractf128_ps( vmin, 1 ) );
+	__m128 n = _mm_max_ps( _mm256_castps256_ps128( vmax ), _mm256_extractf128_ps( vmax, 1 ) );
+	m = _mm_min_ps( m, _mm_movehl_ps( m, m ) );
+	n = _mm_max_ps( n, _mm_movehl_ps( n, n ) );
+
+	ALIGN16( float mm[4] );
+	ALIGN16( float nn[4] );
+	_mm_store_ps( mm, m );
+	_mm_store_ps( nn, n );
+	min.Set( mm[0], mm[1] );
+	max.Set( nn[0], nn[1] );
+
+	for( ; i < count; i++ )
+	{
+		const idVec2& v = src[i];
+		if( v[0] < min[0] )
+		{
+			min[0] = v[0];
+		}
+		if( v[0] > max[0] )
+		{
+			max[0] = v[0];
+		}
+		if( v[1] < min[1] )
+		{
+			min[1] = v[1];
+		}
+		if( v[1] > max[1] )
+		{
+			max[1] = v[1];
+		}
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MinMax( idVec3& min, idVec3& max, const idVec3* src, const int count )
+{
+	const __m256 inf = _mm256_set1_ps( idMath::INFINITUM );
+	const __m256 negInf = _mm256_set1_ps( -idMath::INFINITUM );
+
+	// eight vectors are three registers: xyzxyzxy zxyzxyzx yzxyzxyz
+	__m256 min0 = inf, min1 = inf, min2 = inf;
+	__m256 max0 = negInf, max1 = negInf, max2 = negInf;
+
+	const float* f = src->ToFloatPtr();
+	int i = 0;
+	for( ; i + 8 <= count; i += 8 )
+	{
+		__m256 v0 = _mm256_loadu_ps( f + i * 3 + 0 );
+		__m256 v1 = _mm256_loadu_ps( f + i * 3 + 8 );
+		__m256 v2 = _mm256_loadu_ps( f + i * 3 + 16 );
+		min0 = _mm256_min_ps( min0, v0 );
+		min1 = _mm256_min_ps( min1, v1 );
+		min2 = _mm256_min_ps( min2, v2 );
+		max0 = _mm256_max_ps( max0, v0 );
+		max1 = _mm256_max_ps( max1, v1 );
+		max2 = _mm256_max_ps( max2, v2 );
+	}
+
+	ALIGN16( float mins[24] );
+	ALIGN16( float maxs[24] );
+	_mm256_storeu_ps( mins + 0, min0 );
+	_mm256_storeu_ps( mins + 8, min1 );
+	_mm256_storeu_ps( mins + 16, min2 );
+	_mm256_storeu_ps( maxs + 0, max0 );
+	_mm256_storeu_ps( maxs + 8, max1 );
+	_mm256_storeu_ps( maxs + 16, max2 );
+
+	min.Set( idMath::INFINITUM, idMath::INFINITUM, idMath::INFINITUM );
+	max.Set( -idMath::INFINITUM, -idMath::INFINITUM, -idMath::INFINITUM );
+	for( int j = 0; j < 24; j++ )
+	{
+		min[j % 3] = Min( min[j % 3], mins[j] );
+		max[j % 3] = Max( max[j % 3], maxs[j] );
+	}
+
+	for( ; i < count; i++ )
+	{
+		const idVec3& v = src[i];
+		for( int j = 0; j < 3; j++ )
+		{
+			if( v[j] < min[j] )
+			{
+				min[j] = v[j];
+			}
+			if( v[j] > max[j] )
+			{
+				max[j] = v[j];
+			}
+		}
+	}
+}
+
+/*
+============
+LoadDrawVertPair
+
+The four floats at the position of a vertex are xyz and the texture coordinates,
+the last lane of each half is ignored.
+============
+*/
+ID_AVX2_TARGET static ID_INLINE __m256 LoadDrawVertPair( const idDrawVert& a, const idDrawVert& b )
+{
+	return _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( a.xyz.ToFloatPtr() ) ), _mm_loadu_ps( b.xyz.ToFloatPtr() ), 1 );
+}
+
+/*
+============
+StoreMinMaxPairs
+============
+*/
+ID_AVX2_TARGET static ID_INLINE void StoreMinMaxPairs( idVec3& min, idVec3& max, const __m256 vmin, const __m256 vmax )
+{
+	__m128 m = _mm_min_ps( _mm256_castps256_ps128( vmin ), _mm256_extractf128_ps( vmin, 1 ) );
+	__m128 n = _mm_max_ps( _mm256_castps256_ps128( vmax ), _mm256_extractf128_ps( vmax, 1 ) );
+
+	ALIGN16( float mm[4] );
+	ALIGN16( float nn[4] );
+	_mm_store_ps( mm, m );
+	_mm_store_ps( nn, n );
+	min.Set( mm[0], mm[1], mm[2] );
+	max.Set( nn[0], nn[1], nn[2] );
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MinMax( idVec3& min, idVec3& max, const idDrawVert* src, const int count )
+{
+	__m256 vmin = _mm256_set1_ps( idMath::INFINITUM );
+	__m256 vmax = _mm256_set1_ps( -idMath::INFINITUM );
+
+	int i = 0;
+	for( ; i + 2 <= count; i += 2 )
+	{
+		__m256 v = LoadDrawVertPair( src[i + 0], src[i + 1] );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+	if( i < count )
+	{
+		__m256 v = LoadDrawVertPair( src[i], src[i] );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+
+	StoreMinMaxPairs( min, max, vmin, vmax );
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MinMax( idVec3& min, idVec3& max, const idDrawVert* src, const triIndex_t* indexes, const int count )
+{
+	__m256 vmin = _mm256_set1_ps( idMath::INFINITUM );
+	__m256 vmax = _mm256_set1_ps( -idMath::INFINITUM );
+
+	int i = 0;
+	for( ; i + 2 <= count; i += 2 )
+	{
+		__m256 v = LoadDrawVertPair( src[indexes[i + 0]], src[indexes[i + 1]] );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+	if( i < count )
+	{
+		__m256 v = LoadDrawVertPair( src[indexes[i]], src[indexes[i]] );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+
+	StoreMinMaxPairs( min, max, vmin, vmax );
+}
+
+/*
+============
+idSIMD_AVX2::BlendJoints
+
+Eight joints are transposed so each register holds one component of all of them.
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::BlendJoints( idJointQuat* joints, const idJointQuat* blendJoints, const float lerp, const int* index, const int numJoints )
+{
+	if( lerp <= 0.0f )
+	{
+		return;
+	}
+	else if( lerp >= 1.0f )
+	{
+		for( int i = 0; i < numJoints; i++ )
+		{
+			int j = index[i];
+			joints[j] = blendJoints[j];
+		}
+		return;
+	}
+
+	const __m256 vlerp					= _mm256_set1_ps( lerp );
+
+	const __m256 vector_float_zero		= _mm256_setzero_ps();
+	const __m256 vector_float_one		= _mm256_set1_ps( 1.0f );
+	const __m256 vector_float_sign_bit	= _mm256_castsi256_ps( _mm256_set1_epi32( 0x80000000 ) );
+	const __m256 vector_float_rsqrt_c0	= _mm256_set1_ps( -3.0f );
+	const __m256 vector_float_rsqrt_c1	= _mm256_set1_ps( -0.5f );
+	const __m256 vector_float_tiny		= _mm256_set1_ps( 1e-10f );
+	const __m256 vector_float_half_pi	= _mm256_set1_ps( M_PI * 0.5f );
+
+	const __m256 vector_float_sin_c0	= _mm256_set1_ps( -2.39e-08f );
+	const __m256 vector_float_sin_c1	= _mm256_set1_ps( 2.7526e-06f );
+	const __m256 vector_float_sin_c2	= _mm256_set1_ps( -1.98409e-04f );
+	const __m256 vector_float_sin_c3	= _mm256_set1_ps( 8.3333315e-03f );
+	const __m256 vector_float_sin_c4	= _mm256_set1_ps( -1.666666664e-01f );
+
+	const __m256 vector_float_atan_c0	= _mm256_set1_ps( 0.0028662257f );
+	const __m256 vector_float_atan_c1	= _mm256_set1_ps( -0.0161657367f );
+	const __m256 vector_float_atan_c2	= _mm256_set1_ps( 0.0429096138f );
+	const __m256 vector_float_atan_c3	= _mm256_set1_ps( -0.0752896400f );
+	const __m256 vector_float_atan_c4	= _mm256_set1_ps( 0.1065626393f );
+	const __m256 vector_float_atan_c5	= _mm256_set1_ps( -0.1420889944f );
+	const __m256 vector_float_atan_c6	= _mm256_set1_ps( 0.1999355085f );
+	const __m256 vector_float_atan_c7	= _mm256_set1_ps( -0.3333314528f );
+
+	int i = 0;
+	for( ; i + 8 <= numJoints; i += 8 )
+	{
+		__m256 j[8];
+		__m256 b[8];
+		for( int k = 0; k < 8; k++ )
+		{
+			j[k] = _mm256_loadu_ps( joints[index[i + k]].q.ToFloatPtr() );
+			b[k] = _mm256_loadu_ps( blendJoints[index[i + k]].q.ToFloatPtr() );
+		}
+		Transpose8x8( j );
+		Transpose8x8( b );
+
+		// j[0-3] = quaternion xyzw, j[4-6] = translation, j[7] = w
+		j[4] = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( b[4], j[4] ), j[4] );
+		j[5] = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( b[5], j[5] ), j[5] );
+		j[6] = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( b[6], j[6] ), j[6] );
+		j[7] = vector_float_zero;
+
+		__m256 cosom = _mm256_mul_ps( j[0], b[0] );
+		cosom = _mm256_fmadd_ps( j[1], b[1], cosom );
+		cosom = _mm256_fmadd_ps( j[2], b[2], cosom );
+		cosom = _mm256_fmadd_ps( j[3], b[3], cosom );
+
+		__m256 sign = _mm256_and_ps( cosom, vector_float_sign_bit );
+		cosom = _mm256_xor_ps( cosom, sign );
+
+		__m256 ss = _mm256_fnmadd_ps( cosom, cosom, vector_float_one );
+		ss = _mm256_max_ps( ss, vector_float_tiny );
+
+		__m256 rs = _mm256_rsqrt_ps( ss );
+		__m256 sq = _mm256_mul_ps( rs, rs );
+		__m256 sh = _mm256_mul_ps( rs, vector_float_rsqrt_c1 );
+		__m256 sx = _mm256_fmadd_ps( ss, sq, vector_float_rsqrt_c0 );
+		__m256 sinom = _mm256_mul_ps( sh, sx );						// sinom = 1 / sqrt( ss );
+
+		ss = _mm256_mul_ps( ss, sinom );
+
+		__m256 min = _mm256_min_ps( ss, cosom );
+		__m256 max = _mm256_max_ps( ss, cosom );
+		__m256 mask = _mm256_cmp_ps( min, cosom, _CMP_EQ_OQ );
+		__m256 masksign = _mm256_and_ps( mask, vector_float_sign_bit );
+		__m256 maskPI = _mm256_and_ps( mask, vector_float_half_pi );
+
+		__m256 rcpa = _mm256_rcp_ps( max );
+		__m256 rcpb = _mm256_mul_ps( max, rcpa );
+		__m256 rcpd = _mm256_add_ps( rcpa, rcpa );
+		__m256 rcp = _mm256_fnmadd_ps( rcpb, rcpa, rcpd );			// 1 / y or 1 / x
+		__m256 ata = _mm256_mul_ps( min, rcp );						// x / y or y / x
+
+		__m256 atb = _mm256_xor_ps( ata, masksign );					// -x / y or y / x
+		__m256 atc = _mm256_mul_ps( atb, atb );
+		__m256 atd = _mm256_fmadd_ps( atc, vector_float_atan_c0, vector_float_atan_c1 );
+
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c2 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c3 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c4 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c5 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c6 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c7 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_one );
+
+		__m256 omega_a = _mm256_fmadd_ps( atd, atb, maskPI );
+		__m256 omega_b = _mm256_mul_ps( vlerp, omega_a );
+		omega_a = _mm256_sub_ps( omega_a, omega_b );
+
+		__m256 sinsa = _mm256_mul_ps( omega_a, omega_a );
+		__m256 sinsb = _mm256_mul_ps( omega_b, omega_b );
+		__m256 sina = _mm256_fmadd_ps( sinsa, vector_float_sin_c0, vector_float_sin_c1 );
+		__m256 sinb = _mm256_fmadd_ps( sinsb, vector_float_sin_c0, vector_float_sin_c1 );
+		sina = _mm256_fmadd_ps( sina, sinsa, vector_float_sin_c2 );
+		sinb = _mm256_fmadd_ps( sinb, sinsb, vector_float_sin_c2 );
+		sina = _mm256_fmadd_ps( sina, sinsa, vector_float_sin_c3 );
+		sinb = _mm256_fmadd_ps( sinb, sinsb, vector_float_sin_c3 );
+		sina = _mm256_fmadd_ps( sina, sinsa, vector_float_sin_c4 );
+		sinb = _mm256_fmadd_ps( sinb, sinsb, vector_float_sin_c4 );
+		sina = _mm256_fmadd_ps( sina, sinsa, vector_float_one );
+		sinb = _mm256_fmadd_ps( sinb, sinsb, vector_float_one );
+		sina = _mm256_mul_ps( sina, omega_a );
+		sinb = _mm256_mul_ps( sinb, omega_b );
+		__m256 scalea = _mm256_mul_ps( sina, sinom );
+		__m256 scaleb = _mm256_mul_ps( sinb, sinom );
+
+		scaleb = _mm256_xor_ps( scaleb, sign );
+
+		j[0] = _mm256_fmadd_ps( b[0], scaleb, _mm256_mul_ps( j[0], scalea ) );
+		j[1] = _mm256_fmadd_ps( b[1], scaleb, _mm256_mul_ps( j[1], scalea ) );
+		j[2] = _mm256_fmadd_ps( b[2], scaleb, _mm256_mul_ps( j[2], scalea ) );
+		j[3] = _mm256_fmadd_ps( b[3], scaleb, _mm256_mul_ps( j[3], scalea ) );
+
+		Transpose8x8( j );
+		for( int k = 0; k < 8; k++ )
+		{
+			_mm256_storeu_ps( joints[index[i + k]].q.ToFloatPtr(), j[k] );
+		}
+	}
+
+	if( i < numJoints )
+	{
+		idSIMD_SSE::BlendJoints( joints, blendJoints, lerp, index + i, numJoints - i );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::BlendJointsFast
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::BlendJointsFast( idJointQuat* joints, const idJointQuat* blendJoints, const float lerp, const int* index, const int numJoints )
+{
+	if( lerp <= 0.0f )
+	{
+		return;
+	}
+	else if( lerp >= 1.0f )
+	{
+		for( int i = 0; i < numJoints; i++ )
+		{
+			int j = index[i];
+			joints[j] = blendJoints[j];
+		}
+		return;
+	}
+
+	const __m256 vector_float_zero		= _mm256_setzero_ps();
+	const __m256 vector_float_sign_bit	= _mm256_castsi256_ps( _mm256_set1_epi32( 0x80000000 ) );
+	const __m256 vector_float_rsqrt_c0	= _mm256_set1_ps( -3.0f );
+	const __m256 vector_float_rsqrt_c1	= _mm256_set1_ps( -0.5f );
+
+	const float scaledLerp = lerp / ( 1.0f - lerp );
+	const __m256 vlerp = _mm256_set1_ps( lerp );
+	const __m256 vscaledLerp = _mm256_set1_ps( scaledLerp );
+
+	int i = 0;
+	for( ; i + 8 <= numJoints; i += 8 )
+	{
+		__m256 j[8];
+		__m256 b[8];
+		for( int k = 0; k < 8; k++ )
+		{
+			j[k] = _mm256_loadu_ps( joints[index[i + k]].q.ToFloatPtr() );
+			b[k] = _mm256_loadu_ps( blendJoints[index[i + k]].q.ToFloatPtr() );
+		}
+		Transpose8x8( j );
+		Transpose8x8( b );
+
+		j[4] = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( b[4], j[4] ), j[4] );
+		j[5] = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( b[5], j[5] ), j[5] );
+		j[6] = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( b[6], j[6] ), j[6] );
+		j[7] = vector_float_zero;
+
+		__m256 cosom = _mm256_mul_ps( j[0], b[0] );
+		cosom = _mm256_fmadd_ps( j[1], b[1], cosom );
+		cosom = _mm256_fmadd_ps( j[2], b[2], cosom );
+		cosom = _mm256_fmadd_ps( j[3], b[3], cosom );
+
+		__m256 scale = _mm256_xor_ps( vscaledLerp, _mm256_and_ps( cosom, vector_float_sign_bit ) );
+
+		j[0] = _mm256_fmadd_ps( scale, b[0], j[0] );
+		j[1] = _mm256_fmadd_ps( scale, b[1], j[1] );
+		j[2] = _mm256_fmadd_ps( scale, b[2], j[2] );
+		j[3] = _mm256_fmadd_ps( scale, b[3], j[3] );
+
+		__m256 d = _mm256_mul_ps( j[0], j[0] );
+		d = _mm256_fmadd_ps( j[1], j[1], d );
+		d = _mm256_fmadd_ps( j[2], j[2], d );
+		d = _mm256_fmadd_ps( j[3], j[3], d );
+
+		__m256 rs = _mm256_rsqrt_ps( d );
+		__m256 sq = _mm256_mul_ps( rs, rs );
+		__m256 sh = _mm256_mul_ps( rs, vector_float_rsqrt_c1 );
+		__m256 sx = _mm256_fmadd_ps( d, sq, vector_float_rsqrt_c0 );
+		__m256 s = _mm256_mul_ps( sh, sx );
+
+		j[0] = _mm256_mul_ps( j[0], s );
+		j[1] = _mm256_mul_ps( j[1], s );
+		j[2] = _mm256_mul_ps( j[2], s );
+		j[3] = _mm256_mul_ps( j[3], s );
+
+		Transpose8x8( j );
+		for( int k = 0; k < 8; k++ )
+		{
+			_mm256_storeu_ps( joints[index[i + k]].q.ToFloatPtr(), j[k] );
+		}
+	}
+
+	if( i < numJoints )
+	{
+		idSIMD_SSE::BlendJointsFast( joints, blendJoints, lerp, index + i, numJoints - i );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::ConvertJointQuatsToJointMats
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::ConvertJointQuatsToJointMats( idJointMat* jointMats, const idJointQuat* jointQuats, const int numJoints )
+{
+	assert( sizeof( idJointQuat ) == JOINTQUAT_SIZE );
+	assert( sizeof( idJointMat ) == JOINTMAT_SIZE );
+
+	const __m256 vector_float_one = _mm256_set1_ps( 1.0f );
+	const __m256 vector_float_zero = _mm256_setzero_ps();
+
+	int i = 0;
+	for( ; i + 8 <= numJoints; i += 8 )
+	{
+		__m256 q[8];
+		for( int k = 0; k < 8; k++ )
+		{
+			q[k] = _mm256_loadu_ps( jointQuats[i + k].q.ToFloatPtr() );
+		}
+		Transpose8x8( q );
+
+		const __m256 x2 = _mm256_add_ps( q[0], q[0] );
+		const __m256 y2 = _mm256_add_ps( q[1], q[1] );
+		const __m256 z2 = _mm256_add_ps( q[2], q[2] );
+
+		const __m256 xx2 = _mm256_mul_ps( q[0], x2 );
+		const __m256 yy2 = _mm256_mul_ps( q[1], y2 );
+		const __m256 zz2 = _mm256_mul_ps( q[2], z2 );
+		const __m256 xy2 = _mm256_mul_ps( q[0], y2 );
+		const __m256 xz2 = _mm256_mul_ps( q[0], z2 );
+		const __m256 yz2 = _mm256_mul_ps( q[1], z2 );
+		const __m256 wx2 = _mm256_mul_ps( q[3], x2 );
+		const __m256 wy2 = _mm256_mul_ps( q[3], y2 );
+		const __m256 wz2 = _mm256_mul_ps( q[3], z2 );
+
+		// the first two rows of all joints, then the third row, the joint matrix is the
+		// transpose of idQuat::ToMat3
+		__m256 m[8];
+		m[0] = _mm256_sub_ps( _mm256_sub_ps( vector_float_one, yy2 ), zz2 );
+		m[1] = _mm256_add_ps( xy2, wz2 );
+		m[2] = _mm256_sub_ps( xz2, wy2 );
+		m[3] = q[4];
+		m[4] = _mm256_sub_ps( xy2, wz2 );
+		m[5] = _mm256_sub_ps( _mm256_sub_ps( vector_float_one, xx2 ), zz2 );
+		m[6] = _mm256_add_ps( yz2, wx2 );
+		m[7] = q[5];
+
+		__m256 r[8];
+		r[0] = _mm256_add_ps( xz2, wy2 );
+		r[1] = _mm256_sub_ps( yz2, wx2 );
+		r[2] = _mm256_sub_ps( _mm256_sub_ps( vector_float_one, xx2 ), yy2 );
+		r[3] = q[6];
+		r[4] = r[5] = r[6] = r[7] = vector_float_zero;
+
+		Transpose8x8( m );
+		Transpose8x8( r );
+
+		float* mat = jointMats[i].ToFloatPtr();
+		for( int k = 0; k < 8; k++ )
+		{
+			_mm256_storeu_ps( mat + k * 12 + 0, m[k] );
+			_mm_store_ps( mat + k * 12 + 8, _mm256_castps256_ps128( r[k] ) );
+		}
+	}
+
+	if( i < numJoints )
+	{
+		idSIMD_SSE::ConvertJointQuatsToJointMats( jointMats + i, jointQuats + i, numJoints - i );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::TransformJoints
+
+Every joint depends on its parent so this stays one joint at a time, it only
+gains from the fused multiply-adds.
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::TransformJoints( idJointMat* jointMats, const int* parents, const int firstJoint, const int lastJoint )
+{
+	const __m128 vector_float_mask_keep_last	= _mm_castsi128_ps( _mm_set_epi32( 0xFFFFFFFF, 0x00000000, 0x00000000, 0x00000000 ) );
+
+	const float* __restrict firstMatrix = jointMats->ToFloatPtr() + ( firstJoint + firstJoint + firstJoint - 3 ) * 4;
+
+	__m128 pma = _mm_load_ps( firstMatrix + 0 );
+	__m128 pmb = _mm_load_ps( firstMatrix + 4 );
+	__m128 pmc = _mm_load_ps( firstMatrix + 8 );
+
+	for( int joint = firstJoint; joint <= lastJoint; joint++ )
+	{
+		const int parent = parents[joint];
+		const float* __restrict parentMatrix = jointMats->ToFloatPtr() + ( parent + parent + parent ) * 4;
+		float* __restrict childMatrix = jointMats->ToFloatPtr() + ( joint + joint + joint ) * 4;
+
+		if( parent != joint - 1 )
+		{
+			pma = _mm_load_ps( parentMatrix + 0 );
+			pmb = _mm_load_ps( parentMatrix + 4 );
+			pmc = _mm_load_ps( parentMatrix + 8 );
+		}
+
+		__m128 cma = _mm_load_ps( childMatrix + 0 );
+		__m128 cmb = _mm_load_ps( childMatrix + 4 );
+		__m128 cmc = _mm_load_ps( childMatrix + 8 );
+
+		__m128 ta = _mm_permute_ps( pma, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+		__m128 tb = _mm_permute_ps( pmb, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+		__m128 tc = _mm_permute_ps( pmc, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+
+		__m128 td = _mm_permute_ps( pma, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+		__m128 te = _mm_permute_ps( pmb, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+		__m128 tf = _mm_permute_ps( pmc, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+
+		__m128 tg = _mm_permute_ps( pma, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+		__m128 th = _mm_permute_ps( pmb, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+		__m128 ti = _mm_permute_ps( pmc, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+
+		pma = _mm_fmadd_ps( ta, cma, _mm_and_ps( pma, vector_float_mask_keep_last ) );
+		pmb = _mm_fmadd_ps( tb, cma, _mm_and_ps( pmb, vector_float_mask_keep_last ) );
+		pmc = _mm_fmadd_ps( tc, cma, _mm_and_ps( pmc, vector_float_mask_keep_last ) );
+
+		pma = _mm_fmadd_ps( td, cmb, pma );
+		pmb = _mm_fmadd_ps( te, cmb, pmb );
+		pmc = _mm_fmadd_ps( tf, cmb, pmc );
+
+		pma = _mm_fmadd_ps( tg, cmc, pma );
+		pmb = _mm_fmadd_ps( th, cmc, pmb );
+		pmc = _mm_fmadd_ps( ti, cmc, pmc );
+
+		_mm_store_ps( childMatrix + 0, pma );
+		_mm_store_ps( childMatrix + 4, pmb );
+		_mm_store_ps( childMatrix + 8, pmc );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::UntransformJoints
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::UntransformJoints( idJointMat* jointMats, const int* parents, const int firstJoint, const int lastJoint )
+{
+	const __m128 vector_float_mask_keep_last	= _mm_castsi128_ps( _mm_set_epi32( 0xFFFFFFFF, 0x00000000, 0x00000000, 0x00000000 ) );
+
+	for( int joint = lastJoint; joint >= firstJoint; joint-- )
+	{
+		assert( parents[joint] < joint );
+		const int parent = parents[joint];
+		const float* __restrict parentMatrix = jointMats->ToFloatPtr() + ( parent + parent + parent ) * 4;
+		float* __restrict childMatrix = jointMats->ToFloatPtr() + ( joint + joint + joint ) * 4;
+
+		__m128 pma = _mm_load_ps( parentMatrix + 0 );
+		__m128 pmb = _mm_load_ps( parentMatrix + 4 );
+		__m128 pmc = _mm_load_ps( parentMatrix + 8 );
+
+		__m128 cma = _mm_load_ps( childMatrix + 0 );
+		__m128 cmb = _mm_load_ps( childMatrix + 4 );
+		__m128 cmc = _mm_load_ps( childMatrix + 8 );
+
+		__m128 ta = _mm_permute_ps( pma, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+		__m128 tb = _mm_permute_ps( pma, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+		__m128 tc = _mm_permute_ps( pma, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+
+		__m128 td = _mm_permute_ps( pmb, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+		__m128 te = _mm_permute_ps( pmb, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+		__m128 tf = _mm_permute_ps( pmb, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+
+		__m128 tg = _mm_permute_ps( pmc, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+		__m128 th = _mm_permute_ps( pmc, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+		__m128 ti = _mm_permute_ps( pmc, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+
+		cma = _mm_sub_ps( cma, _mm_and_ps( pma, vector_float_mask_keep_last ) );
+		cmb = _mm_sub_ps( cmb, _mm_and_ps( pmb, vector_float_mask_keep_last ) );
+		cmc = _mm_sub_ps( cmc, _mm_and_ps( pmc, vector_float_mask_keep_last ) );
+
+		pma = _mm_mul_ps( ta, cma );
+		pmb = _mm_mul_ps( tb, cma );
+		pmc = _mm_mul_ps( tc, cma );
+
+		pma = _mm_fmadd_ps( td, cmb, pma );
+		pmb = _mm_fmadd_ps( te, cmb, pmb );
+		pmc = _mm_fmadd_ps( tf, cmb, pmc );
+
+		pma = _mm_fmadd_ps( tg, cmc, pma );
+		pmb = _mm_fmadd_ps( th, cmc, pmb );
+		pmc = _mm_fmadd_ps( ti, cmc, pmc );
+
+		_mm_store_ps( childMatrix + 0, pma );
+		_mm_store_ps( childMatrix + 4, pmb );
+		_mm_store_ps( childMatrix + 8, pmc );
+	}
+}
+
+/*
+============
+LoadBoxCorners
+
+The eight corners of a box as one register per axis.
+============
+*/
+ID_AVX2_TARGET static ID_INLINE void LoadBoxCorners( const idBounds& bounds, __m256& vx, __m256& vy, __m256& vz )
+{
+	__m128 b0 = _mm_loadu_bounds_0( bounds );
+	__m128 b1 = _mm_loadu_bounds_1( bounds );
+
+	__m128 vxy = _mm_unpacklo_ps( b0, b1 );						// min X, max X, min Y, max Y
+	__m128 vx4 = _mm_shuffle_ps( vxy, vxy, _MM_SHUFFLE( 1, 0, 1, 0 ) );	// min X, max X, min X, max X
+	__m128 vy4 = _mm_shuffle_ps( vxy, vxy, _MM_SHUFFLE( 3, 3, 2, 2 ) );	// min Y, min Y, max Y, max Y
+
+	vx = _mm256_insertf128_ps( _mm256_castps128_ps256( vx4 ), vx4, 1 );
+	vy = _mm256_insertf128_ps( _mm256_castps128_ps256( vy4 ), vy4, 1 );
+	vz = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_shuffle_ps( b0, b0, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ), _mm_shuffle_ps( b1, b1, _MM_SHUFFLE( 2, 2, 2, 2 ) ), 1 );
+}
+
+/*
+============
+idSIMD_AVX2::CullBoundsToMVP
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::CullBoundsToMVP( byte* culled, const idRenderMatrix& mvp, const idBounds* bounds, const int count, const bool zeroToOne )
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 minMul = _mm256_set1_ps( zeroToOne ? 0.0f : -1.0f );
+
+	__m256 m[4][4];
+	for( int r = 0; r < 4; r++ )
+	{
+		for( int c = 0; c < 4; c++ )
+		{
+			m[r][c] = _mm256_set1_ps( mvp[r][c] );
+		}
+	}
+
+	for( int i = 0; i < count; i++ )
+	{
+		__m256 vx, vy, vz;
+		LoadBoxCorners( bounds[i], vx, vy, vz );
+
+		// transform all eight corners at once
+		__m256 x = _mm256_fmadd_ps( vz, m[0][2], _mm256_fmadd_ps( vy, m[0][1], _mm256_fmadd_ps( vx, m[0][0], m[0][3] ) ) );
+		__m256 y = _mm256_fmadd_ps( vz, m[1][2], _mm256_fmadd_ps( vy, m[1][1], _mm256_fmadd_ps( vx, m[1][0], m[1][3] ) ) );
+		__m256 z = _mm256_fmadd_ps( vz, m[2][2], _mm256_fmadd_ps( vy, m[2][1], _mm256_fmadd_ps( vx, m[2][0], m[2][3] ) ) );
+		__m256 w = _mm256_fmadd_ps( vz, m[3][2], _mm256_fmadd_ps( vy, m[3][1], _mm256_fmadd_ps( vx, m[3][0], m[3][3] ) ) );
+
+		__m256 minW = _mm256_mul_ps( w, minMul );
+#if defined( CLIP_SPACE_D3D )	// the D3D clip space Z is in the range [0,1] so always compare Z vs zero whether 'zeroToOne' is true or false
+		__m256 minZ = zero;
+#else
+		__m256 minZ = minW;
+#endif
+
+		// the bounds are culled when all corners are outside the same side
+		culled[i] = ( _mm256_movemask_ps( _mm256_cmp_ps( x, minW, _CMP_GT_OQ ) ) == 0 ) |
+					( _mm256_movemask_ps( _mm256_cmp_ps( w, x, _CMP_GT_OQ ) ) == 0 ) |
+					( _mm256_movemask_ps( _mm256_cmp_ps( y, minW, _CMP_GT_OQ ) ) == 0 ) |
+					( _mm256_movemask_ps( _mm256_cmp_ps( w, y, _CMP_GT_OQ ) ) == 0 ) |
+					( _mm256_movemask_ps( _mm256_cmp_ps( z, minZ, _CMP_GT_OQ ) ) == 0 ) |	// NOTE: using minZ
+					( _mm256_movemask_ps( _mm256_cmp_ps( w, z, _CMP_GT_OQ ) ) == 0 );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::DepthBoundsForBounds
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::DepthBoundsForBounds( float* min, float* max, const idRenderMatrix& mvp, const idBounds* bounds, const int count, const bool windowSpace )
+{
+	const __m256 smallestNonDenorm = _mm256_set1_ps( idMath::FLT_SMALLEST_NON_DENORMAL );
+	const __m256 negInfinity = _mm256_set1_ps( -RENDER_MATRIX_INFINITY );
+
+	__m256 m[2][4];
+	for( int r = 0; r < 2; r++ )
+	{
+		for( int c = 0; c < 4; c++ )
+		{
+			m[r][c] = _mm256_set1_ps( mvp[2 + r][c] );
+		}
+	}
+
+	for( int i = 0; i < count; i++ )
+	{
+		__m256 vx, vy, vz;
+		LoadBoxCorners( bounds[i], vx, vy, vz );
+
+		__m256 z = _mm256_fmadd_ps( vz, m[0][2], _mm256_fmadd_ps( vy, m[0][1], _mm256_fmadd_ps( vx, m[0][0], m[0][3] ) ) );
+		__m256 w = _mm256_fmadd_ps( vz, m[1][2], _mm256_fmadd_ps( vy, m[1][1], _mm256_fmadd_ps( vx, m[1][0], m[1][3] ) ) );
+
+		// corners behind the near plane push the minimum depth to minus infinity
+		__m256 behind = _mm256_cmp_ps( w, smallestNonDenorm, _CMP_LE_OQ );
+		w = _mm256_blendv_ps( w, smallestNonDenorm, behind );
+		z = _mm256_blendv_ps( _mm256_div_ps( z, w ), negInfinity, behind );
+
+		__m128 minv = HorizontalMin( z );
+		__m128 maxv = HorizontalMax( z );
+
+		if( windowSpace )
+		{
+#if !defined( CLIP_SPACE_D3D )	// the D3D clip space Z is already in the range [0,1]
+			minv = _mm_fmadd_ss( minv, _mm_set_ss( 0.5f ), _mm_set_ss( 0.5f ) );
+			maxv = _mm_fmadd_ss( maxv, _mm_set_ss( 0.5f ), _mm_set_ss( 0.5f ) );
+#endif
+			minv = _mm_max_ss( minv, _mm_setzero_ps() );
+			maxv = _mm_min_ss( maxv, _mm_set_ss( 1.0f ) );
+		}
+
+		_mm_store_ss( min + i, minv );
+		_mm_store_ss( max + i, maxv );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::Dot
+
+  dst[i] = src[i].Normal() * constant + src[i][3];
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::Dot( float* dst, const idVec3& constant, const idPlane* src, const int count )
+{
+	const __m256 cx = _mm256_set1_ps( constant.x );
+	const __m256 cy = _mm256_set1_ps( constant.y );
+	const __m256 cz = _mm256_set1_ps( constant.z );
+
+	int i = 0;
+	for( ; i + 8 <= count; i += 8 )
+	{
+		// planes 0-3 in the low lanes and 4-7 in the high lanes, then a 4x4 transpose per lane
+		__m256 p0 = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( src[i + 0].ToFloatPtr() ) ), _mm_loadu_ps( src[i + 4].ToFloatPtr() ), 1 );
+		__m256 p1 = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( src[i + 1].ToFloatPtr() ) ), _mm_loadu_ps( src[i + 5].ToFloatPtr() ), 1 );
+		__m256 p2 = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( src[i + 2].ToFloatPtr() ) ), _mm_loadu_ps( src[i + 6].ToFloatPtr() ), 1 );
+		__m256 p3 = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( src[i + 3].ToFloatPtr() ) ), _mm_loadu_ps( src[i + 7].ToFloatPtr() ), 1 );
+
+		__m256 t0 = _mm256_unpacklo_ps( p0, p1 );
+		__m256 t1 = _mm256_unpacklo_ps( p2, p3 );
+		__m256 t2 = _mm256_unpackhi_ps( p0, p1 );
+		__m256 t3 = _mm256_unpackhi_ps( p2, p3 );
+
+		__m256 nx = _mm256_shuffle_ps( t0, t1, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+		__m256 ny = _mm256_shuffle_ps( t0, t1, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+		__m256 nz = _mm256_shuffle_ps( t2, t3, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+		__m256 d = _mm256_shuffle_ps( t2, t3, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+
+		// no fused multiply-add, the distances have to be bit identical to idPlane::Distance
+		__m256 dot = _mm256_add_ps( _mm256_mul_ps( nx, cx ), _mm256_mul_ps( ny, cy ) );
+		dot = _mm256_add_ps( dot, _mm256_mul_ps( nz, cz ) );
+		d = _mm256_add_ps( dot, d );
+
+		_mm256_storeu_ps( dst + i, d );
+	}
+	for( ; i < count; i++ )
+	{
+		dst[i] = src[i].Normal() * constant + src[i][3];
+	}
+}
+
+/*
+============
+idSIMD_AVX2::Dot
+
+  dst[i] = constant.Normal() * src[i].ToVec3() + constant[3];
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::Dot( float* dst, const idPlane& constant, const idVec5* src, const int count )
+{
+	const __m256 cx = _mm256_set1_ps( constant[0] );
+	const __m256 cy = _mm256_set1_ps( constant[1] );
+	const __m256 cz = _mm256_set1_ps( constant[2] );
+	const __m256 cd = _mm256_set1_ps( constant[3] );
+
+	// offsets of eight consecutive idVec5 in floats
+	const __m256i offsets = _mm256_setr_epi32( 0, 5, 10, 15, 20, 25, 30, 35 );
+
+	int i = 0;
+	for( ; i + 8 <= count; i += 8 )
+	{
+		const float* f = src[i].ToFloatPtr();
+		__m256 x = _mm256_i32gather_ps( f + 0, offsets, 4 );
+		__m256 y = _mm256_i32gather_ps( f + 1, offsets, 4 );
+		__m256 z = _mm256_i32gather_ps( f + 2, offsets, 4 );
+
+		// no fused multiply-add, the distances have to be bit identical to idPlane::Distance
+		__m256 d = _mm256_add_ps( _mm256_mul_ps( x, cx ), _mm256_mul_ps( y, cy ) );
+		d = _mm256_add_ps( d, _mm256_mul_ps( z, cz ) );
+		d = _mm256_add_ps( d, cd );
+
+		_mm256_storeu_ps( dst + i, d );
+	}
+	for( ; i < count; i++ )
+	{
+		dst[i] = constant.Normal() * src[i].ToVec3() + constant[3];
+	}
+}
+
+/*
+============
+idSIMD_AVX2::DeriveTangentFrames
+
+  Derives the frames of eight triangles at a time and scatters them in triangle order.
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::DeriveTangentFrames( idVec3* normals, idVec3* tangents, idVec3* bitangents, const idDrawVert* verts, const triIndex_t* indexes, const int numIndexes )
+{
+	const __m256 one = _mm256_set1_ps( 1.0f );
+	const __m256 signMask = _mm256_set1_ps( -0.0f );
+	const __m256 smallestNonDenorm = _mm256_set1_ps( idMath::FLT_SMALLEST_NON_DENORMAL );
+	const __m256 infinity = _mm256_set1_ps( idMath::INFINITUM );
+
+	const int numTris = numIndexes / 3;
+
+	int t = 0;
+	for( ; t + 8 <= numTris; t += 8 )
+	{
+		// gather the position and texture coordinate of the three corners of eight triangles
+		float corners[3][5][8];
+		for( int j = 0; j < 8; j++ )
+		{
+			for( int k = 0; k < 3; k++ )
+			{
+				const idDrawVert& v = verts[indexes[( t + j ) * 3 + k]];
+				const idVec2 st = v.GetTexCoord();
+				corners[k][0][j] = v.xyz.x;
+				corners[k][1][j] = v.xyz.y;
+				corners[k][2][j] = v.xyz.z;
+				corners[k][3][j] = st.x;
+				corners[k][4][j] = st.y;
+			}
+		}
+
+		__m256 d0[5];
+		__m256 d1[5];
+		for( int k = 0; k < 5; k++ )
+		{
+			const __m256 a = _mm256_loadu_ps( corners[0][k] );
+			d0[k] = _mm256_sub_ps( _mm256_loadu_ps( corners[1][k] ), a );
+			d1[k] = _mm256_sub_ps( _mm256_loadu_ps( corners[2][k] ), a );
+		}
+
+		__m256 n0 = _mm256_fmsub_ps( d1[1], d0[2], _mm256_mul_ps( d1[2], d0[1] ) );
+		__m256 n1 = _mm256_fmsub_ps( d1[2], d0[0], _mm256_mul_ps( d1[0], d0[2] ) );
+		__m256 n2 = _mm256_fmsub_ps( d1[0], d0[1], _mm256_mul_ps( d1[1], d0[0] ) );
+
+		__m256 t0 = _mm256_fmsub_ps( d0[0], d1[4], _mm256_mul_ps( d0[4], d1[0] ) );
+		__m256 t1 = _mm256_fmsub_ps( d0[1], d1[4], _mm256_mul_ps( d0[4], d1[1] ) );
+		__m256 t2 = _mm256_fmsub_ps( d0[2], d1[4], _mm256_mul_ps( d0[4], d1[2] ) );
+
+		__m256 b0 = _mm256_fmsub_ps( d0[3], d1[0], _mm256_mul_ps( d0[0], d1[3] ) );
+		__m256 b1 = _mm256_fmsub_ps( d0[3], d1[1], _mm256_mul_ps( d0[1], d1[3] ) );
+		__m256 b2 = _mm256_fmsub_ps( d0[3], d1[2], _mm256_mul_ps( d0[2], d1[3] ) );
+
+		// area sign bit
+		__m256 area = _mm256_fmsub_ps( d0[3], d1[4], _mm256_mul_ps( d0[4], d1[3] ) );
+		__m256 signBit = _mm256_and_ps( area, signMask );
+
+		// same as idMath::InvSqrt
+		__m256 ln = _mm256_fmadd_ps( n2, n2, _mm256_fmadd_ps( n1, n1, _mm256_mul_ps( n0, n0 ) ) );
+		__m256 lt = _mm256_fmadd_ps( t2, t2, _mm256_fmadd_ps( t1, t1, _mm256_mul_ps( t0, t0 ) ) );
+		__m256 lb = _mm256_fmadd_ps( b2, b2, _mm256_fmadd_ps( b1, b1, _mm256_mul_ps( b0, b0 ) ) );
+
+		__m256 fn = _mm256_blendv_ps( _mm256_sqrt_ps( _mm256_div_ps( one, ln ) ), infinity, _mm256_cmp_ps( ln, smallestNonDenorm, _CMP_LE_OQ ) );
+		__m256 ft = _mm256_blendv_ps( _mm256_sqrt_ps( _mm256_div_ps( one, lt ) ), infinity, _mm256_cmp_ps( lt, smallestNonDenorm, _CMP_LE_OQ ) );
+		__m256 fb = _mm256_blendv_ps( _mm256_sqrt_ps( _mm256_div_ps( one, lb ) ), infinity, _mm256_cmp_ps( lb, smallestNonDenorm, _CMP_LE_OQ ) );
+
+		ft = _mm256_xor_ps( ft, signBit );
+		fb = _mm256_xor_ps( fb, signBit );
+
+		float frames[9][8];
+		_mm256_storeu_ps( frames[0], _mm256_mul_ps( n0, fn ) );
+		_mm256_storeu_ps( frames[1], _mm256_mul_ps( n1, fn ) );
+		_mm256_storeu_ps( frames[2], _mm256_mul_ps( n2, fn ) );
+		_mm256_storeu_ps( frames[3], _mm256_mul_ps( t0, ft ) );
+		_mm256_storeu_ps( frames[4], _mm256_mul_ps( t1, ft ) );
+		_mm256_storeu_ps( frames[5], _mm256_mul_ps( t2, ft ) );
+		_mm256_storeu_ps( frames[6], _mm256_mul_ps( b0, fb ) );
+		_mm256_storeu_ps( frames[7], _mm256_mul_ps( b1, fb ) );
+		_mm256_storeu_ps( frames[8], _mm256_mul_ps( b2, fb ) );
+
+		for( int j = 0; j < 8; j++ )
+		{
+			const idVec3 normal( frames[0][j], frames[1][j], frames[2][j] );
+			const idVec3 tangent( frames[3][j], frames[4][j], frames[5][j] );
+			const idVec3 bitangent( frames[6][j], frames[7][j], frames[8][j] );
+
+			for( int k = 0; k < 3; k++ )
+			{
+				const int v = indexes[( t + j ) * 3 + k];
+				normals[v] += normal;
+				tangents[v] += tangent;
+				bitangents[v] += bitangent;
+			}
+		}
+	}
+
+	idSIMD_SSE::DeriveTangentFrames( normals, tangents, bitangents, verts, indexes + t * 3, numIndexes - t * 3 );
+}
+
+#endif // #if defined(USE_INTRINSICS_AVX2)
@@ -235,3 +235,231 @@ void VPCALL idSIMD_Generic::UntransformJoints( idJointMat* jointMats, const int*
 		jointMats[i] /= jointMats[parents[i]];
 	}
 }
+
+/*
+============
+idSIMD_Generic::CullBoundsToMVP
+============
+*/
+void VPCALL idSIMD_Generic::CullBoundsToMVP( byte* culled, const idRenderMatrix& mvp, const idBounds* bounds, const int count, const bool zeroToOne )
+{
+	for( int n = 0; n < count; n++ )
+	{
+		int bits = 0;
+
+		idVec3 v;
+		for( int x = 0; x < 2; x++ )
+		{
+			v[0] = bounds[n][x][0];
+			for( int y = 0; y < 2; y++ )
+			{
+				v[1] = bounds[n][y][1];
+				for( int z = 0; z < 2; z++ )
+				{
+					v[2] = bounds[n][z][2];
+
+					idVec4 c;
+					for( int i = 0; i < 4; i++ )
+					{
+						c[i] = v[0] * mvp[i][0] + v[1] * mvp[i][1] + v[2] * mvp[i][2] + mvp[i][3];
+					}
+
+					const float minW = zeroToOne ? 0.0f : -c[3];
+					const float maxW = c[3];
+#if defined( CLIP_SPACE_D3D )	// the D3D clip space Z is in the range [0,1] so always compare Z vs zero whether 'zeroToOne' is true or false
+					const float minZ = 0.0f;
+#else
+					const float minZ = minW;
+#endif
+
+					bits |= ( c[0] > minW ) << 0;
+					bits |= ( c[0] < maxW ) << 1;
+					bits |= ( c[1] > minW ) << 2;
+					bits |= ( c[1] < maxW ) << 3;
+					bits |= ( c[2] > minZ ) << 4;	// NOTE: using minZ
+					bits |= ( c[2] < maxW ) << 5;
+				}
+			}
+		}
+
+		// if any bits weren't set, the bounds are completely off one side of the frustum
+		culled[n] = ( bits != 63 );
+	}
+}
+
+/*
+============
+idSIMD_Generic::DepthBoundsForBounds
+============
+*/
+void VPCALL idSIMD_Generic::DepthBoundsForBounds( float* min, float* max, const idRenderMatrix& mvp, const idBounds* bounds, const int count, const bool windowSpace )
+{
+	for( int n = 0; n < count; n++ )
+	{
+		float localMin = RENDER_MATRIX_INFINITY;
+		float localMax = -RENDER_MATRIX_INFINITY;
+
+		idVec3 v;
+		for( int x = 0; x < 2; x++ )
+		{
+			v[0] = bounds[n][x][0];
+			for( int y = 0; y < 2; y++ )
+			{
+				v[1] = bounds[n][y][1];
+				for( int z = 0; z < 2; z++ )
+				{
+					v[2] = bounds[n][z][2];
+
+					float tz = v[0] * mvp[2][0] + v[1] * mvp[2][1] + v[2] * mvp[2][2] + mvp[2][3];
+					float tw = v[0] * mvp[3][0] + v[1] * mvp[3][1] + v[2] * mvp[3][2] + mvp[3][3];
+
+					if( tw > idMath::FLT_SMALLEST_NON_DENORMAL )
+					{
+						tz = tz / tw;
+					}
+					else
+					{
+						tz = -RENDER_MATRIX_INFINITY;
+					}
+
+					localMin = Min( localMin, tz );
+					localMax = Max( localMax, tz );
+				}
+			}
+		}
+
+		if( windowSpace )
+		{
+			// convert to window coords
+#if !defined( CLIP_SPACE_D3D )	// the D3D clip space Z is already in the range [0,1]
+			localMin = localMin * 0.5f + 0.5f;
+			localMax = localMax * 0.5f + 0.5f;
+#endif
+			// clamp to the [0, 1] range
+			localMin = Max( localMin, 0.0f );
+			localMax = Min( localMax, 1.0f );
+		}
+
+		min[n] = localMin;
+		max[n] = localMax;
+	}
+}
+
+/*
+============
+idSIMD_Generic::Dot
+
+  dst[i] = src[i].Normal() * constant + src[i][3];
+============
+*/
+void VPCALL idSIMD_Generic::Dot( float* dst, const idVec3& constant, const idPlane* src, const int count )
+{
+#define OPER(X) dst[(X)] = src[(X)].Normal() * constant + src[(X)][3];
+	UNROLL4( OPER )
+#undef OPER
+}
+
+/*
+============
+idSIMD_Generic::Dot
+
+  dst[i] = constant.Normal() * src[i].ToVec3() + constant[3];
+============
+*/
+void VPCALL idSIMD_Generic::Dot( float* dst, const idPlane& constant, const idVec5* src, const int count )
+{
+#define OPER(X) dst[(X)] = constant.Normal() * src[(X)].ToVec3() + constant[3];
+	UNROLL4( OPER )
+#undef OPER
+}
+
+/*
+============
+idSIMD_Generic::DeriveTangentFrames
+
+  The normal, tangent and bitangent of each triangle are normalized and then added to
+  the three vertices of the triangle. The caller has to clear the vertex frames first.
+============
+*/
+void VPCALL idSIMD_Generic::DeriveTangentFrames( idVec3* normals, idVec3* tangents, idVec3* bitangents, const idDrawVert* verts, const triIndex_t* indexes, const int numIndexes )
+{
+	for( int i = 0; i < numIndexes; i += 3 )
+	{
+		const int v0 = indexes[i + 0];
+		const int v1 = indexes[i + 1];
+		const int v2 = indexes[i + 2];
+
+		const idDrawVert* a = verts + v0;
+		const idDrawVert* b = verts + v1;
+		const idDrawVert* c = verts + v2;
+
+		const idVec2 aST = a->GetTexCoord();
+		const idVec2 bST = b->GetTexCoord();
+		const idVec2 cST = c->GetTexCoord();
+
+		float d0[5];
+		d0[0] = b->xyz[0] - a->xyz[0];
+		d0[1] = b->xyz[1] - a->xyz[1];
+		d0[2] = b->xyz[2] - a->xyz[2];
+		d0[3] = bST[0] - aST[0];
+		d0[4] = bST[1] - aST[1];
+
+		float d1[5];
+		d1[0] = c->xyz[0] - a->xyz[0];
+		d1[1] = c->xyz[1] - a->xyz[1];
+		d1[2] = c->xyz[2] - a->xyz[2];
+		d1[3] = cST[0] - aST[0];
+		d1[4] = cST[1] - aST[1];
+
+		idVec3 normal;
+		normal[0] = d1[1] * d0[2] - d1[2] * d0[1];
+		normal[1] = d1[2] * d0[0] - d1[0] * d0[2];
+		normal[2] = d1[0] * d0[1] - d1[1] * d0[0];
+
+		const float f0 = idMath::InvSqrt( normal.x * normal.x + normal.y * normal.y + normal.z * normal.z );
+
+		normal.x *= f0;
+		normal.y *= f0;
+		normal.z *= f0;
+
+		// area sign bit
+		const float area = d0[3] * d1[4] - d0[4] * d1[3];
+		unsigned int signBit = ( *( unsigned int* )&area ) & ( 1 << 31 );
+
+		idVec3 tangent;
+		tangent[0] = d0[0] * d1[4] - d0[4] * d1[0];
+		tangent[1] = d0[1] * d1[4] - d0[4] * d1[1];
+		tangent[2] = d0[2] * d1[4] - d0[4] * d1[2];
+
+		const float f1 = idMath::InvSqrt( tangent.x * tangent.x + tangent.y * tangent.y + tangent.z * tangent.z );
+		*( unsigned int* )&f1 ^= signBit;
+
+		tangent.x *= f1;
+		tangent.y *= f1;
+		tangent.z *= f1;
+
+		idVec3 bitangent;
+		bitangent[0] = d0[3] * d1[0] - d0[0] * d1[3];
+		bitangent[1] = d0[3] * d1[1] - d0[1] * d1[3];
+		bitangent[2] = d0[3] * d1[2] - d0[2] * d1[3];
+
+		const float f2 = idMath::InvSqrt( bitangent.x * bitangent.x + bitangent.y * bitangent.y + bitangent.z * bitangent.z );
+		*( unsigned int* )&f2 ^= signBit;
+
+		bitangent.x *= f2;
+		bitangent.y *= f2;
+		bitangent.z *= f2;
+
+		normals[v0] += normal;
+		tangents[v0] += tangent;
+		bitangents[v0] += bitangent;
+
+		normals[v1] += normal;
+		tangents[v1] += tangent;
+		bitangents[v1] += bitangent;
+
+		normals[v2] += normal;
+		tangents[v2] += tangent;
+		bitangents[v2] += bitangent;
+	}
+}
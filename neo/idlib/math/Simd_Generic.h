@@ -57,6 +57,14 @@ public:
 	virtual void VPCALL ConvertJointMatsToJointQuats( idJointQuat* jointQuats, const idJointMat* jointMats, const int numJoints );
 	virtual void VPCALL TransformJoints( idJointMat* jointMats, const int* parents, const int firstJoint, const int lastJoint );
 	virtual void VPCALL UntransformJoints( idJointMat* jointMats, const int* parents, const int firstJoint, const int lastJoint );
+
+	virtual void VPCALL CullBoundsToMVP( byte* culled, const idRenderMatrix& mvp, const idBounds* bounds, const int count, const bool zeroToOne );
+	virtual void VPCALL DepthBoundsForBounds( float* min, float* max, const idRenderMatrix& mvp, const idBounds* bounds, const int count, const bool windowSpace );
+
+	virtual void VPCALL Dot( float* dst, const idVec3& constant, const idPlane* src, const int count );
+	virtual void VPCALL Dot( float* dst, const idPlane& constant, const idVec5* src, const int count );
+
+	virtual void VPCALL DeriveTangentFrames( idVec3* normals, idVec3* tangents, idVec3* bitangents, const idDrawVert* verts, const triIndex_t* indexes, const int numIndexes );
 };
 
 #endif /* !__MATH_SIMD_GENERIC_H__ */
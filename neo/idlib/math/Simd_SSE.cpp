@@ -974,5 +974,372 @@ void VPCALL idSIMD_SSE::UntransformJoints( idJointMat* jointMats, const int* par
 	}
 }
 
+/*
+============
+idSIMD_SSE::CullBoundsToMVP
+
+  Same test as idRenderMatrix::CullBoundsToMVP with the MVP rows splatted once for all bounds.
+============
+*/
+void VPCALL idSIMD_SSE::CullBoundsToMVP( byte* culled, const idRenderMatrix& mvp, const idBounds* bounds, const int count, const bool zeroToOne )
+{
+	const __m128 vector_float_zero		= _mm_setzero_ps();
+	const __m128 vector_float_neg_one	= { -1.0f, -1.0f, -1.0f, -1.0f };
+
+	const __m128 mvp0 = _mm_loadu_ps( mvp[0] );
+	const __m128 mvp1 = _mm_loadu_ps( mvp[1] );
+	const __m128 mvp2 = _mm_loadu_ps( mvp[2] );
+	const __m128 mvp3 = _mm_loadu_ps( mvp[3] );
+
+	const __m128 mvp0X = _mm_splat_ps( mvp0, 0 );
+	const __m128 mvp1X = _mm_splat_ps( mvp1, 0 );
+	const __m128 mvp2X = _mm_splat_ps( mvp2, 0 );
+	const __m128 mvp3X = _mm_splat_ps( mvp3, 0 );
+
+	const __m128 mvp0Y = _mm_splat_ps( mvp0, 1 );
+	const __m128 mvp1Y = _mm_splat_ps( mvp1, 1 );
+	const __m128 mvp2Y = _mm_splat_ps( mvp2, 1 );
+	const __m128 mvp3Y = _mm_splat_ps( mvp3, 1 );
+
+	const __m128 mvp0Z = _mm_splat_ps( mvp0, 2 );
+	const __m128 mvp1Z = _mm_splat_ps( mvp1, 2 );
+	const __m128 mvp2Z = _mm_splat_ps( mvp2, 2 );
+	const __m128 mvp3Z = _mm_splat_ps( mvp3, 2 );
+
+	const __m128 mvp0W = _mm_splat_ps( mvp0, 3 );
+	const __m128 mvp1W = _mm_splat_ps( mvp1, 3 );
+	const __m128 mvp2W = _mm_splat_ps( mvp2, 3 );
+	const __m128 mvp3W = _mm_splat_ps( mvp3, 3 );
+
+	const __m128 minMul = zeroToOne ? vector_float_zero : vector_float_neg_one;
+
+	for( int i = 0; i < count; i++ )
+	{
+		const idBounds& b = bounds[i];
+
+		__m128 b0 = _mm_loadu_bounds_0( b );
+		__m128 b1 = _mm_loadu_bounds_1( b );
+
+		// take the four points on the X-Y plane
+		__m128 vxy = _mm_unpacklo_ps( b0, b1 );						// min X, max X, min Y, max Y
+		__m128 vx = _mm_perm_ps( vxy, _MM_SHUFFLE( 1, 0, 1, 0 ) );	// min X, max X, min X, max X
+		__m128 vy = _mm_perm_ps( vxy, _MM_SHUFFLE( 3, 3, 2, 2 ) );	// min Y, min Y, max Y, max Y
+
+		__m128 vz0 = _mm_splat_ps( b0, 2 );							// min Z, min Z, min Z, min Z
+		__m128 vz1 = _mm_splat_ps( b1, 2 );							// max Z, max Z, max Z, max Z
+
+		// compute four partial X,Y,Z,W values
+		__m128 parx = _mm_madd_ps( vx, mvp0X, mvp0W );
+		__m128 pary = _mm_madd_ps( vx, mvp1X, mvp1W );
+		__m128 parz = _mm_madd_ps( vx, mvp2X, mvp2W );
+		__m128 parw = _mm_madd_ps( vx, mvp3X, mvp3W );
+
+		parx = _mm_madd_ps( vy, mvp0Y, parx );
+		pary = _mm_madd_ps( vy, mvp1Y, pary );
+		parz = _mm_madd_ps( vy, mvp2Y, parz );
+		parw = _mm_madd_ps( vy, mvp3Y, parw );
+
+		// compute full X,Y,Z,W values
+		__m128 x0 = _mm_madd_ps( vz0, mvp0Z, parx );
+		__m128 y0 = _mm_madd_ps( vz0, mvp1Z, pary );
+		__m128 z0 = _mm_madd_ps( vz0, mvp2Z, parz );
+		__m128 w0 = _mm_madd_ps( vz0, mvp3Z, parw );
+
+		__m128 x1 = _mm_madd_ps( vz1, mvp0Z, parx );
+		__m128 y1 = _mm_madd_ps( vz1, mvp1Z, pary );
+		__m128 z1 = _mm_madd_ps( vz1, mvp2Z, parz );
+		__m128 w1 = _mm_madd_ps( vz1, mvp3Z, parw );
+
+		__m128 minW0 = _mm_mul_ps( w0, minMul );
+		__m128 minW1 = _mm_mul_ps( w1, minMul );
+#if defined( CLIP_SPACE_D3D )	// the D3D clip space Z is in the range [0,1] so always compare Z vs zero whether 'zeroToOne' is true or false
+		__m128 minZ0 = vector_float_zero;
+		__m128 minZ1 = vector_float_zero;
+#else
+		__m128 minZ0 = minW0;
+		__m128 minZ1 = minW1;
+#endif
+
+		// for each side, a lane is set when at least one of the two corners is on the inside
+		__m128 in0 = _mm_or_ps( _mm_cmpgt_ps( x0, minW0 ), _mm_cmpgt_ps( x1, minW1 ) );
+		__m128 in1 = _mm_or_ps( _mm_cmpgt_ps( w0, x0 ), _mm_cmpgt_ps( w1, x1 ) );
+		__m128 in2 = _mm_or_ps( _mm_cmpgt_ps( y0, minW0 ), _mm_cmpgt_ps( y1, minW1 ) );
+		__m128 in3 = _mm_or_ps( _mm_cmpgt_ps( w0, y0 ), _mm_cmpgt_ps( w1, y1 ) );
+		__m128 in4 = _mm_or_ps( _mm_cmpgt_ps( z0, minZ0 ), _mm_cmpgt_ps( z1, minZ1 ) );	// NOTE: using minZ
+		__m128 in5 = _mm_or_ps( _mm_cmpgt_ps( w0, z0 ), _mm_cmpgt_ps( w1, z1 ) );
+
+		// the bounds are culled when all corners are outside the same side
+		culled[i] = ( _mm_movemask_ps( in0 ) == 0 ) | ( _mm_movemask_ps( in1 ) == 0 ) | ( _mm_movemask_ps( in2 ) == 0 ) |
+					( _mm_movemask_ps( in3 ) == 0 ) | ( _mm_movemask_ps( in4 ) == 0 ) | ( _mm_movemask_ps( in5 ) == 0 );
+	}
+}
+
+/*
+============
+idSIMD_SSE::DepthBoundsForBounds
+
+  Same as idRenderMatrix::DepthBoundsForBounds with the MVP rows splatted once for all bounds.
+============
+*/
+void VPCALL idSIMD_SSE::DepthBoundsForBounds( float* min, float* max, const idRenderMatrix& mvp, const idBounds* bounds, const int count, const bool windowSpace )
+{
+	const __m128 vector_float_zero					= _mm_setzero_ps();
+	const __m128 vector_float_half					= { 0.5f, 0.5f, 0.5f, 0.5f };
+	const __m128 vector_float_one					= { 1.0f, 1.0f, 1.0f, 1.0f };
+	const __m128 vector_float_smallest_non_denorm	= { 1.1754944e-038f, 1.1754944e-038f, 1.1754944e-038f, 1.1754944e-038f };
+	const __m128 vector_float_neg_infinity			= { -RENDER_MATRIX_INFINITY, -RENDER_MATRIX_INFINITY, -RENDER_MATRIX_INFINITY, -RENDER_MATRIX_INFINITY };
+
+	const __m128 mvp2 = _mm_loadu_ps( mvp[2] );
+	const __m128 mvp3 = _mm_loadu_ps( mvp[3] );
+
+	const __m128 mvp2X = _mm_splat_ps( mvp2, 0 );
+	const __m128 mvp3X = _mm_splat_ps( mvp3, 0 );
+	const __m128 mvp2Y = _mm_splat_ps( mvp2, 1 );
+	const __m128 mvp3Y = _mm_splat_ps( mvp3, 1 );
+	const __m128 mvp2Z = _mm_splat_ps( mvp2, 2 );
+	const __m128 mvp3Z = _mm_splat_ps( mvp3, 2 );
+	const __m128 mvp2W = _mm_splat_ps( mvp2, 3 );
+	const __m128 mvp3W = _mm_splat_ps( mvp3, 3 );
+
+	for( int i = 0; i < count; i++ )
+	{
+		const idBounds& b = bounds[i];
+
+		__m128 b0 = _mm_loadu_bounds_0( b );
+		__m128 b1 = _mm_loadu_bounds_1( b );
+
+		// take the four points on the X-Y plane
+		__m128 vxy = _mm_unpacklo_ps( b0, b1 );						// min X, max X, min Y, max Y
+		__m128 vx = _mm_perm_ps( vxy, _MM_SHUFFLE( 1, 0, 1, 0 ) );	// min X, max X, min X, max X
+		__m128 vy = _mm_perm_ps( vxy, _MM_SHUFFLE( 3, 3, 2, 2 ) );	// min Y, min Y, max Y, max Y
+
+		__m128 vz0 = _mm_splat_ps( b0, 2 );							// min Z, min Z, min Z, min Z
+		__m128 vz1 = _mm_splat_ps( b1, 2 );							// max Z, max Z, max Z, max Z
+
+		// compute four partial Z,W values
+		__m128 parz = _mm_madd_ps( vx, mvp2X, mvp2W );
+		__m128 parw = _mm_madd_ps( vx, mvp3X, mvp3W );
+
+		parz = _mm_madd_ps( vy, mvp2Y, parz );
+		parw = _mm_madd_ps( vy, mvp3Y, parw );
+
+		__m128 z0 = _mm_madd_ps( vz0, mvp2Z, parz );
+		__m128 w0 = _mm_madd_ps( vz0, mvp3Z, parw );
+
+		__m128 z1 = _mm_madd_ps( vz1, mvp2Z, parz );
+		__m128 w1 = _mm_madd_ps( vz1, mvp3Z, parw );
+
+		__m128 s0 = _mm_cmpgt_ps( vector_float_smallest_non_denorm, w0 );
+		w0 = _mm_or_ps( w0, _mm_and_ps( vector_float_smallest_non_denorm, s0 ) );
+
+		__m128 rw0 = _mm_rcp32_ps( w0 );
+		z0 = _mm_mul_ps( z0, rw0 );
+		z0 = _mm_sel_ps( z0, vector_float_neg_infinity, s0 );
+
+		__m128 s1 = _mm_cmpgt_ps( vector_float_smallest_non_denorm, w1 );
+		w1 = _mm_or_ps( w1, _mm_and_ps( vector_float_smallest_non_denorm, s1 ) );
+
+		__m128 rw1 = _mm_rcp32_ps( w1 );
+		z1 = _mm_mul_ps( z1, rw1 );
+		z1 = _mm_sel_ps( z1, vector_float_neg_infinity, s1 );
+
+		__m128 minv = _mm_min_ps( z0, z1 );
+		__m128 maxv = _mm_max_ps( z0, z1 );
+
+		minv = _mm_min_ps( minv, _mm_perm_ps( minv, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+		minv = _mm_min_ps( minv, _mm_perm_ps( minv, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+
+		maxv = _mm_max_ps( maxv, _mm_perm_ps( maxv, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+		maxv = _mm_max_ps( maxv, _mm_perm_ps( maxv, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+
+		if( windowSpace )
+		{
+#if !defined( CLIP_SPACE_D3D )	// the D3D clip space Z is already in the range [0,1]
+			minv = _mm_madd_ps( minv, vector_float_half, vector_float_half );
+			maxv = _mm_madd_ps( maxv, vector_float_half, vector_float_half );
+#endif
+			minv = _mm_max_ps( minv, vector_float_zero );
+			maxv = _mm_min_ps( maxv, vector_float_one );
+		}
+
+		_mm_store_ss( min + i, minv );
+		_mm_store_ss( max + i, maxv );
+	}
+}
+
+/*
+============
+idSIMD_SSE::Dot
+
+  dst[i] = src[i].Normal() * constant + src[i][3];
+============
+*/
+void VPCALL idSIMD_SSE::Dot( float* dst, const idVec3& constant, const idPlane* src, const int count )
+{
+	const __m128 cx = _mm_set1_ps( constant.x );
+	const __m128 cy = _mm_set1_ps( constant.y );
+	const __m128 cz = _mm_set1_ps( constant.z );
+
+	int i = 0;
+	for( ; i + 4 <= count; i += 4 )
+	{
+		// load four planes and transpose them into one register per component
+		__m128 p0 = _mm_loadu_ps( src[i + 0].ToFloatPtr() );
+		__m128 p1 = _mm_loadu_ps( src[i + 1].ToFloatPtr() );
+		__m128 p2 = _mm_loadu_ps( src[i + 2].ToFloatPtr() );
+		__m128 p3 = _mm_loadu_ps( src[i + 3].ToFloatPtr() );
+
+		_MM_TRANSPOSE4_PS( p0, p1, p2, p3 );
+
+		// same order of operations as idPlane::Distance so the results are bit identical
+		__m128 d = _mm_add_ps( _mm_mul_ps( p0, cx ), _mm_mul_ps( p1, cy ) );
+		d = _mm_add_ps( d, _mm_mul_ps( p2, cz ) );
+		d = _mm_add_ps( d, p3 );
+
+		_mm_storeu_ps( dst + i, d );
+	}
+	for( ; i < count; i++ )
+	{
+		dst[i] = src[i].Normal() * constant + src[i][3];
+	}
+}
+
+/*
+============
+idSIMD_SSE::Dot
+
+  dst[i] = constant.Normal() * src[i].ToVec3() + constant[3];
+============
+*/
+void VPCALL idSIMD_SSE::Dot( float* dst, const idPlane& constant, const idVec5* src, const int count )
+{
+	const __m128 cx = _mm_set1_ps( constant[0] );
+	const __m128 cy = _mm_set1_ps( constant[1] );
+	const __m128 cz = _mm_set1_ps( constant[2] );
+	const __m128 cd = _mm_set1_ps( constant[3] );
+
+	int i = 0;
+	for( ; i + 4 <= count; i += 4 )
+	{
+		__m128 x = _mm_setr_ps( src[i + 0].x, src[i + 1].x, src[i + 2].x, src[i + 3].x );
+		__m128 y = _mm_setr_ps( src[i + 0].y, src[i + 1].y, src[i + 2].y, src[i + 3].y );
+		__m128 z = _mm_setr_ps( src[i + 0].z, src[i + 1].z, src[i + 2].z, src[i + 3].z );
+
+		// same order of operations as idPlane::Distance so the results are bit identical
+		__m128 d = _mm_add_ps( _mm_mul_ps( x, cx ), _mm_mul_ps( y, cy ) );
+		d = _mm_add_ps( d, _mm_mul_ps( z, cz ) );
+		d = _mm_add_ps( d, cd );
+
+		_mm_storeu_ps( dst + i, d );
+	}
+	for( ; i < count; i++ )
+	{
+		dst[i] = constant.Normal() * src[i].ToVec3() + constant[3];
+	}
+}
+
+/*
+============
+idSIMD_SSE::DeriveTangentFrames
+
+  Derives the frames of four triangles at a time. The vertices are gathered and the results
+  are scattered in triangle order so the sums come out the same as with the generic code.
+============
+*/
+void VPCALL idSIMD_SSE::DeriveTangentFrames( idVec3* normals, idVec3* tangents, idVec3* bitangents, const idDrawVert* verts, const triIndex_t* indexes, const int numIndexes )
+{
+	const __m128 vector_float_one					= { 1.0f, 1.0f, 1.0f, 1.0f };
+	const __m128 vector_float_sign_bit				= __m128c( _mm_set_epi32( 0x80000000, 0x80000000, 0x80000000, 0x80000000 ) );
+	const __m128 vector_float_smallest_non_denorm	= { 1.1754944e-038f, 1.1754944e-038f, 1.1754944e-038f, 1.1754944e-038f };
+	const __m128 vector_float_infinity				= { idMath::INFINITUM, idMath::INFINITUM, idMath::INFINITUM, idMath::INFINITUM };
+
+	const int numTris = numIndexes / 3;
+
+	int t = 0;
+	for( ; t + 4 <= numTris; t += 4 )
+	{
+		// gather the position and texture coordinate of the three corners of four triangles
+		ALIGN16( float corners[3][5][4] );
+		for( int j = 0; j < 4; j++ )
+		{
+			for( int k = 0; k < 3; k++ )
+			{
+				const idDrawVert& v = verts[indexes[( t + j ) * 3 + k]];
+				const idVec2 st = v.GetTexCoord();
+				corners[k][0][j] = v.xyz.x;
+				corners[k][1][j] = v.xyz.y;
+				corners[k][2][j] = v.xyz.z;
+				corners[k][3][j] = st.x;
+				corners[k][4][j] = st.y;
+			}
+		}
+
+		__m128 d0[5];
+		__m128 d1[5];
+		for( int k = 0; k < 5; k++ )
+		{
+			const __m128 a = _mm_load_ps( corners[0][k] );
+			d0[k] = _mm_sub_ps( _mm_load_ps( corners[1][k] ), a );
+			d1[k] = _mm_sub_ps( _mm_load_ps( corners[2][k] ), a );
+		}
+
+		__m128 n0 = _mm_sub_ps( _mm_mul_ps( d1[1], d0[2] ), _mm_mul_ps( d1[2], d0[1] ) );
+		__m128 n1 = _mm_sub_ps( _mm_mul_ps( d1[2], d0[0] ), _mm_mul_ps( d1[0], d0[2] ) );
+		__m128 n2 = _mm_sub_ps( _mm_mul_ps( d1[0], d0[1] ), _mm_mul_ps( d1[1], d0[0] ) );
+
+		__m128 t0 = _mm_sub_ps( _mm_mul_ps( d0[0], d1[4] ), _mm_mul_ps( d0[4], d1[0] ) );
+		__m128 t1 = _mm_sub_ps( _mm_mul_ps( d0[1], d1[4] ), _mm_mul_ps( d0[4], d1[1] ) );
+		__m128 t2 = _mm_sub_ps( _mm_mul_ps( d0[2], d1[4] ), _mm_mul_ps( d0[4], d1[2] ) );
+
+		__m128 b0 = _mm_sub_ps( _mm_mul_ps( d0[3], d1[0] ), _mm_mul_ps( d0[0], d1[3] ) );
+		__m128 b1 = _mm_sub_ps( _mm_mul_ps( d0[3], d1[1] ), _mm_mul_ps( d0[1], d1[3] ) );
+		__m128 b2 = _mm_sub_ps( _mm_mul_ps( d0[3], d1[2] ), _mm_mul_ps( d0[2], d1[3] ) );
+
+		// area sign bit
+		__m128 area = _mm_sub_ps( _mm_mul_ps( d0[3], d1[4] ), _mm_mul_ps( d0[4], d1[3] ) );
+		__m128 signBit = _mm_and_ps( area, vector_float_sign_bit );
+
+		// same as idMath::InvSqrt
+		__m128 ln = _mm_add_ps( _mm_add_ps( _mm_mul_ps( n0, n0 ), _mm_mul_ps( n1, n1 ) ), _mm_mul_ps( n2, n2 ) );
+		__m128 lt = _mm_add_ps( _mm_add_ps( _mm_mul_ps( t0, t0 ), _mm_mul_ps( t1, t1 ) ), _mm_mul_ps( t2, t2 ) );
+		__m128 lb = _mm_add_ps( _mm_add_ps( _mm_mul_ps( b0, b0 ), _mm_mul_ps( b1, b1 ) ), _mm_mul_ps( b2, b2 ) );
+
+		__m128 fn = _mm_sel_ps( _mm_sqrt_ps( _mm_div_ps( vector_float_one, ln ) ), vector_float_infinity, _mm_cmple_ps( ln, vector_float_smallest_non_denorm ) );
+		__m128 ft = _mm_sel_ps( _mm_sqrt_ps( _mm_div_ps( vector_float_one, lt ) ), vector_float_infinity, _mm_cmple_ps( lt, vector_float_smallest_non_denorm ) );
+		__m128 fb = _mm_sel_ps( _mm_sqrt_ps( _mm_div_ps( vector_float_one, lb ) ), vector_float_infinity, _mm_cmple_ps( lb, vector_float_smallest_non_denorm ) );
+
+		ft = _mm_xor_ps( ft, signBit );
+		fb = _mm_xor_ps( fb, signBit );
+
+		ALIGN16( float frames[9][4] );
+		_mm_store_ps( frames[0], _mm_mul_ps( n0, fn ) );
+		_mm_store_ps( frames[1], _mm_mul_ps( n1, fn ) );
+		_mm_store_ps( frames[2], _mm_mul_ps( n2, fn ) );
+		_mm_store_ps( frames[3], _mm_mul_ps( t0, ft ) );
+		_mm_store_ps( frames[4], _mm_mul_ps( t1, ft ) );
+		_mm_store_ps( frames[5], _mm_mul_ps( t2, ft ) );
+		_mm_store_ps( frames[6], _mm_mul_ps( b0, fb ) );
+		_mm_store_ps( frames[7], _mm_mul_ps( b1, fb ) );
+		_mm_store_ps( frames[8], _mm_mul_ps( b2, fb ) );
+
+		for( int j = 0; j < 4; j++ )
+		{
+			const idVec3 normal( frames[0][j], frames[1][j], frames[2][j] );
+			const idVec3 tangent( frames[3][j], frames[4][j], frames[5][j] );
+			const idVec3 bitangent( frames[6][j], frames[7][j], frames[8][j] );
+
+			for( int k = 0; k < 3; k++ )
+			{
+				const int v = indexes[( t + j ) * 3 + k];
+				normals[v] += normal;
+				tangents[v] += tangent;
+				bitangents[v] += bitangent;
+			}
+		}
+	}
+
+	idSIMD_Generic::DeriveTangentFrames( normals, tangents, bitangents, verts, indexes + t * 3, numIndexes - t * 3 );
+}
+
 #endif // #if defined(USE_INTRINSICS_SSE)
 
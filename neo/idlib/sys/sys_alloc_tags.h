@@ -43,6 +43,8 @@ MEM_TAG( TRI_DUP_VERT )
 MEM_TAG( TRI_MOC_VERT )
 MEM_TAG( SRFTRIS )
 MEM_TAG( TEMP )			// Temp data which should be automatically freed at the end of the function
+MEM_TAG( FRAME )		// Transient data from the per-frame arena, only valid until the end of the next frame
+MEM_TAG( LEVEL )		// Data that lives exactly as long as the current map, from the level region
 MEM_TAG( PAGE )
 MEM_TAG( DEFRAG_BLOCK )
 MEM_TAG( MATH )
@@ -32,6 +32,11 @@ void			Sys_Mkdir( const char* path );
 bool			Sys_Rmdir( const char* path );
 bool			Sys_IsFileWritable( const char* path );
 
+// maps a whole file into memory, writes to the mapping are private to the process and never reach the file
+// returns NULL if the file can't be mapped
+byte* 			Sys_MapFile( const char* path, int& length );
+void			Sys_UnmapFile( byte* data, int length );
+
 enum sysFolder_t
 {
 	FOLDER_ERROR	= -1,
@@ -42,6 +47,10 @@ enum sysFolder_t
 // returns FOLDER_YES if the specified path is a folder
 sysFolder_t		Sys_IsFolder( const char* path );
 
+// gets the modification time and length of a regular file without opening it
+// returns false if the path doesn't exist or isn't a regular file
+bool			Sys_FileStat( const char* path, ID_TIME_T& timestamp, int& length );
+
 // use fs_debug to verbose Sys_ListFiles
 // returns -1 if directory was not found (the list is cleared)
 int				Sys_ListFiles( const char* directory, const char* extension, idList<class idStr>& list );
@@ -0,0 +1,345 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "precompiled.h"
+#pragma hdrstop
+
+#include "RenderCommon.h"
+
+/*
+===============
+R_BoundsCost
+
+Half the surface area of the bounds, the insertion cost used to pick inner nodes.
+===============
+*/
+static ID_INLINE float R_BoundsCost( const idBounds& bounds )
+{
+	const idVec3 size = bounds[1] - bounds[0];
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+/*
+===============
+R_UnionBounds
+===============
+*/
+static ID_INLINE idBounds R_UnionBounds( const idBounds& a, const idBounds& b )
+{
+	idBounds result = a;
+	result.AddBounds( b );
+	return result;
+}
+
+/*
+===============
+idAreaRefTree::Init
+===============
+*/
+void idAreaRefTree::Init()
+{
+	nodes = NULL;
+	maxNodes = 0;
+	freeNodes = -1;
+	root = -1;
+	numLeaves = 0;
+}
+
+/*
+===============
+idAreaRefTree::Shutdown
+===============
+*/
+void idAreaRefTree::Shutdown()
+{
+	if( nodes != NULL )
+	{
+		R_StaticFree( nodes );
+	}
+	Init();
+}
+
+/*
+===============
+idAreaRefTree::AllocNode
+===============
+*/
+int idAreaRefTree::AllocNode()
+{
+	if( freeNodes == -1 )
+	{
+		// grow the node array and chain all the new nodes on the free list
+		const int newMaxNodes = Max( maxNodes * 2, 16 );
+		node_t* newNodes = ( node_t* )R_StaticAlloc( newMaxNodes * sizeof( node_t ) );
+		if( nodes != NULL )
+		{
+			memcpy( newNodes, nodes, maxNodes * sizeof( node_t ) );
+			R_StaticFree( nodes );
+		}
+		nodes = newNodes;
+
+		for( int i = maxNodes; i < newMaxNodes - 1; i++ )
+		{
+			nodes[i].parent = i + 1;
+		}
+		nodes[newMaxNodes - 1].parent = -1;
+		freeNodes = maxNodes;
+		maxNodes = newMaxNodes;
+	}
+
+	const int nodeNum = freeNodes;
+	node_t& node = nodes[nodeNum];
+	freeNodes = node.parent;
+
+	node.parent = -1;
+	node.children[0] = -1;
+	node.children[1] = -1;
+	node.height = 0;
+	node.ref = NULL;
+	return nodeNum;
+}
+
+/*
+===============
+idAreaRefTree::FreeNode
+===============
+*/
+void idAreaRefTree::FreeNode( const int nodeNum )
+{
+	nodes[nodeNum].parent = freeNodes;
+	nodes[nodeNum].height = -1;
+	nodes[nodeNum].ref = NULL;
+	freeNodes = nodeNum;
+}
+
+/*
+===============
+idAreaRefTree::Insert
+===============
+*/
+void idAreaRefTree::Insert( areaReference_t* ref, const idBounds& bounds )
+{
+	const int leaf = AllocNode();
+	nodes[leaf].bounds = bounds;
+	nodes[leaf].ref = ref;
+	ref->treeNode = leaf;
+	numLeaves++;
+
+	if( root == -1 )
+	{
+		root = leaf;
+		return;
+	}
+
+	// walk down to the sibling that makes the tree grow the least,
+	// every node on the way will have its bounds enlarged by the new leaf
+	int sibling = root;
+	while( !IsLeaf( nodes[sibling] ) )
+	{
+		const node_t& node = nodes[sibling];
+		const float combinedCost = R_BoundsCost( R_UnionBounds( node.bounds, bounds ) );
+
+		// cost of pairing the leaf with this node
+		const float cost = 2.0f * combinedCost;
+		// cost of pushing the leaf further down
+		const float inheritedCost = 2.0f * ( combinedCost - R_BoundsCost( node.bounds ) );
+
+		float childCost[2];
+		for( int i = 0; i < 2; i++ )
+		{
+			const node_t& child = nodes[node.children[i]];
+			childCost[i] = R_BoundsCost( R_UnionBounds( child.bounds, bounds ) ) + inheritedCost;
+			if( !IsLeaf( child ) )
+			{
+				childCost[i] -= R_BoundsCost( child.bounds );
+			}
+		}
+
+		if( cost < childCost[0] && cost < childCost[1] )
+		{
+			break;
+		}
+		sibling = ( childCost[0] < childCost[1] ) ? node.children[0] : node.children[1];
+	}
+
+	// create a new parent for the sibling and the leaf
+	const int oldParent = nodes[sibling].parent;
+	const int newParent = AllocNode();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].children[0] = sibling;
+	nodes[newParent].children[1] = leaf;
+	nodes[newParent].bounds = R_UnionBounds( nodes[sibling].bounds, bounds );
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if( oldParent == -1 )
+	{
+		root = newParent;
+	}
+	else if( nodes[oldParent].children[0] == sibling )
+	{
+		nodes[oldParent].children[0] = newParent;
+	}
+	else
+	{
+		nodes[oldParent].children[1] = newParent;
+	}
+
+	// the new parent can be out of balance itself when the sibling is an inner node
+	Refit( newParent );
+}
+
+/*
+===============
+idAreaRefTree::Remove
+===============
+*/
+void idAreaRefTree::Remove( areaReference_t* ref )
+{
+	const int leaf = ref->treeNode;
+	assert( leaf >= 0 && leaf < maxNodes && nodes[leaf].ref == ref );
+	ref->treeNode = -1;
+	numLeaves--;
+
+	if( leaf == root )
+	{
+		root = -1;
+		FreeNode( leaf );
+		return;
+	}
+
+	// the sibling takes the place of the parent
+	const int parent = nodes[leaf].parent;
+	const int grandParent = nodes[parent].parent;
+	const int sibling = ( nodes[parent].children[0] == leaf ) ? nodes[parent].children[1] : nodes[parent].children[0];
+
+	nodes[sibling].parent = grandParent;
+	if( grandParent == -1 )
+	{
+		root = sibling;
+	}
+	else if( nodes[grandParent].children[0] == parent )
+	{
+		nodes[grandParent].children[0] = sibling;
+	}
+	else
+	{
+		nodes[grandParent].children[1] = sibling;
+	}
+
+	FreeNode( parent );
+	FreeNode( leaf );
+
+	Refit( grandParent );
+}
+
+/*
+===============
+idAreaRefTree::Refit
+
+Rebalances and recalculates the bounds and heights from a node up to the root.
+===============
+*/
+void idAreaRefTree::Refit( int nodeNum )
+{
+	while( nodeNum != -1 )
+	{
+		nodeNum = Balance( nodeNum );
+
+		node_t& node = nodes[nodeNum];
+		const node_t& child0 = nodes[node.children[0]];
+		const node_t& child1 = nodes[node.children[1]];
+		node.height = 1 + Max( child0.height, child1.height );
+		node.bounds = R_UnionBounds( child0.bounds, child1.bounds );
+
+		nodeNum = node.parent;
+	}
+}
+
+/*
+===============
+idAreaRefTree::Balance
+
+If one child of the node is more than one level higher than the other,
+rotates that child up to take the place of the node.
+Returns the node that is now at the position of the given node.
+===============
+*/
+int idAreaRefTree::Balance( const int nodeNum )
+{
+	node_t& a = nodes[nodeNum];
+	if( IsLeaf( a ) )
+	{
+		return nodeNum;
+	}
+
+	const int balance = nodes[a.children[1]].height - nodes[a.children[0]].height;
+	if( balance >= -1 && balance <= 1 )
+	{
+		return nodeNum;
+	}
+
+	// the higher child is rotated up, the lower one stays below the old node
+	const int up = ( balance > 1 ) ? 1 : 0;
+	const int upNum = a.children[up];
+	node_t& b = nodes[upNum];
+	const node_t& lower = nodes[a.children[up ^ 1]];
+
+	b.parent = a.parent;
+	a.parent = upNum;
+	if( b.parent == -1 )
+	{
+		root = upNum;
+	}
+	else if( nodes[b.parent].children[0] == nodeNum )
+	{
+		nodes[b.parent].children[0] = upNum;
+	}
+	else
+	{
+		nodes[b.parent].children[1] = upNum;
+	}
+
+	// the higher grandchild stays with the rotated node, the other one moves below the old node
+	const int keep = ( nodes[b.children[0]].height > nodes[b.children[1]].height ) ? 0 : 1;
+	const int keepNum = b.children[keep];
+	const int moveNum = b.children[keep ^ 1];
+
+	b.children[0] = nodeNum;
+	b.children[1] = keepNum;
+	a.children[up] = moveNum;
+	nodes[moveNum].parent = nodeNum;
+
+	a.bounds = R_UnionBounds( lower.bounds, nodes[moveNum].bounds );
+	a.height = 1 + Max( lower.height, nodes[moveNum].height );
+	b.bounds = R_UnionBounds( a.bounds, nodes[keepNum].bounds );
+	b.height = 1 + Max( a.height, nodes[keepNum].height );
+
+	return upNum;
+}
@@ -0,0 +1,119 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+#ifndef __AREAREFTREE_H__
+#define __AREAREFTREE_H__
+
+struct areaReference_t;
+
+/*
+===============================================================================
+
+	Area reference tree
+
+	Bounding volume hierarchy over the entity or light references of a single
+	portal area, so a portal chain can reject a whole group of references with
+	one box test instead of culling every reference on its own.
+
+	The tree is updated incrementally: a leaf is inserted whenever a reference
+	is added to the area and removed when the reference is freed. The inner
+	nodes are picked with a surface area heuristic and kept balanced with tree
+	rotations, so the height stays logarithmic no matter in which order the
+	references come in.
+
+	The bounds of a reference must not change while it is in the tree, which
+	holds because entities and lights always recreate their references when
+	their bounds change.
+
+===============================================================================
+*/
+
+class idAreaRefTree
+{
+public:
+	struct node_t
+	{
+		idBounds				bounds;
+		int						parent;			// -1 for the root, next node on the free list
+		int						children[2];	// -1 for leaves
+		int						height;			// 0 for leaves
+		areaReference_t* 		ref;			// only set for leaves
+	};
+
+	// must be called before the first Insert, the area allocation is only cleared to zero
+	void					Init();
+	// free all nodes
+	void					Shutdown();
+
+	// adds a leaf for the reference, bounds are in global space
+	void					Insert( areaReference_t* ref, const idBounds& bounds );
+	// removes the leaf of a reference added with Insert
+	void					Remove( areaReference_t* ref );
+
+	// returns -1 if the tree is empty
+	int						GetRoot() const
+	{
+		return root;
+	}
+	const node_t& 			GetNode( const int nodeNum ) const
+	{
+		return nodes[nodeNum];
+	}
+	static bool				IsLeaf( const node_t& node )
+	{
+		return node.children[0] == -1;
+	}
+
+	// number of references in the tree
+	int						Num() const
+	{
+		return numLeaves;
+	}
+	int						GetHeight() const
+	{
+		return ( root == -1 ) ? 0 : nodes[root].height;
+	}
+	// returns total size of allocated memory
+	size_t					Allocated() const
+	{
+		return maxNodes * sizeof( node_t );
+	}
+
+private:
+	node_t* 				nodes;
+	int						maxNodes;
+	int						freeNodes;			// head of the free list
+	int						root;
+	int						numLeaves;
+
+	int						AllocNode();
+	void					FreeNode( const int nodeNum );
+	void					Refit( int nodeNum );
+	int						Balance( const int nodeNum );
+};
+
+#endif /* !__AREAREFTREE_H__ */
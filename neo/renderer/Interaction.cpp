@@ -417,14 +417,13 @@ idInteraction* idInteraction::AllocAndLink( idRenderEntityLocal* edef, idRenderL
 	}
 
 	// update the interaction table
-	if( renderWorld->interactionTable != NULL )
+	if( renderWorld->interactionTable.IsActive() )
 	{
-		int index = ldef->index * renderWorld->interactionTableWidth + edef->index;
-		if( renderWorld->interactionTable[index] != NULL )
+		if( renderWorld->interactionTable.Find( ldef->index, edef->index ) != NULL )
 		{
 			common->Error( "idInteraction::AllocAndLink: non NULL table entry" );
 		}
-		renderWorld->interactionTable[ index ] = interaction;
+		renderWorld->interactionTable.Set( ldef->index, edef->index, interaction );
 	}
 
 	return interaction;
@@ -510,14 +509,14 @@ void idInteraction::UnlinkAndFree()
 	// clear the table pointer
 	idRenderWorldLocal* renderWorld = this->lightDef->world;
 	// RB: added check for NULL
-	if( renderWorld->interactionTable != NULL )
+	if( renderWorld->interactionTable.IsActive() )
 	{
-		int index = this->lightDef->index * renderWorld->interactionTableWidth + this->entityDef->index;
-		if( renderWorld->interactionTable[index] != this && renderWorld->interactionTable[index] != INTERACTION_EMPTY )
+		const idInteraction* inter = renderWorld->interactionTable.Find( this->lightDef->index, this->entityDef->index );
+		if( inter != this && inter != INTERACTION_EMPTY )
 		{
 			common->Error( "idInteraction::UnlinkAndFree: interactionTable wasn't set" );
 		}
-		renderWorld->interactionTable[index] = NULL;
+		renderWorld->interactionTable.Remove( this->lightDef->index, this->entityDef->index );
 	}
 	// RB end
 
@@ -574,9 +573,8 @@ void idInteraction::MakeEmpty()
 	}
 
 	// store the special marker in the interaction table
-	const int interactionIndex = lightDef->index * entityDef->world->interactionTableWidth + entityDef->index;
-	assert( entityDef->world->interactionTable[ interactionIndex ] == this );
-	entityDef->world->interactionTable[ interactionIndex ] = INTERACTION_EMPTY;
+	assert( entityDef->world->interactionTable.Find( lightDef->index, entityDef->index ) == this );
+	entityDef->world->interactionTable.Set( lightDef->index, entityDef->index, INTERACTION_EMPTY );
 }
 
 /*
@@ -773,3 +771,251 @@ void R_ShowInteractionMemory_f( const idCmdArgs& args )
 	common->Printf( "%i maxInteractionsForEntity\n", maxInteractionsForEntity );
 	common->Printf( "%i maxInteractionsForLight\n", maxInteractionsForLight );
 }
+
+/*
+===========================================================================
+
+idInteractionTable
+
+===========================================================================
+*/
+
+/*
+===============
+idInteractionTable::idInteractionTable
+===============
+*/
+idInteractionTable::idInteractionTable()
+{
+	slots = NULL;
+	capacity = 0;
+	num = 0;
+	active = false;
+}
+
+/*
+===============
+idInteractionTable::~idInteractionTable
+===============
+*/
+idInteractionTable::~idInteractionTable()
+{
+	Shutdown();
+}
+
+/*
+===============
+idInteractionTable::Init
+===============
+*/
+void idInteractionTable::Init()
+{
+	Shutdown();
+	Resize( MIN_CAPACITY );
+	active = true;
+}
+
+/*
+===============
+idInteractionTable::Shutdown
+===============
+*/
+void idInteractionTable::Shutdown()
+{
+	if( slots != NULL )
+	{
+		R_StaticFree( slots );
+		slots = NULL;
+	}
+	capacity = 0;
+	num = 0;
+	active = false;
+}
+
+/*
+===============
+idInteractionTable::Resize
+===============
+*/
+void idInteractionTable::Resize( const int newCapacity )
+{
+	assert( idMath::IsPowerOfTwo( newCapacity ) && newCapacity > num );
+
+	slot_t* oldSlots = slots;
+	const int oldCapacity = capacity;
+
+	slots = ( slot_t* )R_ClearedStaticAlloc( newCapacity * sizeof( slot_t ) );
+	capacity = newCapacity;
+
+	for( int i = 0; i < oldCapacity; i++ )
+	{
+		const slot_t& slot = oldSlots[i];
+		if( slot.interaction == NULL )
+		{
+			continue;
+		}
+		int j = HomeSlot( slot.lightIndex, slot.entityIndex );
+		while( slots[j].interaction != NULL )
+		{
+			j = ( j + 1 ) & ( capacity - 1 );
+		}
+		slots[j] = slot;
+	}
+
+	if( oldSlots != NULL )
+	{
+		R_StaticFree( oldSlots );
+	}
+}
+
+/*
+===============
+idInteractionTable::Set
+===============
+*/
+void idInteractionTable::Set( const int lightIndex, const int entityIndex, idInteraction* interaction )
+{
+	assert( active && interaction != NULL );
+
+	// keep the table at most 3/4 full so the probe sequences stay short
+	if( ( num + 1 ) * 4 > capacity * 3 )
+	{
+		Resize( Max( capacity * 2, ( int )MIN_CAPACITY ) );
+	}
+
+	int i = HomeSlot( lightIndex, entityIndex );
+	while( slots[i].interaction != NULL )
+	{
+		if( slots[i].lightIndex == lightIndex && slots[i].entityIndex == entityIndex )
+		{
+			slots[i].interaction = interaction;
+			return;
+		}
+		i = ( i + 1 ) & ( capacity - 1 );
+	}
+
+	slots[i].lightIndex = lightIndex;
+	slots[i].entityIndex = entityIndex;
+	slots[i].interaction = interaction;
+	num++;
+}
+
+/*
+===============
+idInteractionTable::Remove
+===============
+*/
+void idInteractionTable::Remove( const int lightIndex, const int entityIndex )
+{
+	if( num == 0 )
+	{
+		return;
+	}
+
+	const int mask = capacity - 1;
+	int i = HomeSlot( lightIndex, entityIndex );
+	while( slots[i].lightIndex != lightIndex || slots[i].entityIndex != entityIndex )
+	{
+		if( slots[i].interaction == NULL )
+		{
+			return;
+		}
+		i = ( i + 1 ) & mask;
+	}
+	if( slots[i].interaction == NULL )
+	{
+		return;
+	}
+
+	// move back every following slot of the run that would no longer be found past the hole
+	for( int j = ( i + 1 ) & mask; slots[j].interaction != NULL; j = ( j + 1 ) & mask )
+	{
+		const int home = HomeSlot( slots[j].lightIndex, slots[j].entityIndex );
+		if( ( ( j - home ) & mask ) >= ( ( j - i ) & mask ) )
+		{
+			slots[i] = slots[j];
+			i = j;
+		}
+	}
+	slots[i].interaction = NULL;
+	num--;
+
+	// give the memory back after a lot of interactions went away
+	if( capacity > MIN_CAPACITY && num * 8 < capacity )
+	{
+		Resize( capacity / 2 );
+	}
+}
+
+/*
+===============
+idInteractionTable::GetAverageProbe
+===============
+*/
+int idInteractionTable::GetAverageProbe() const
+{
+	if( num == 0 )
+	{
+		return 100;
+	}
+
+	int total = 0;
+	for( int i = 0; i < capacity; i++ )
+	{
+		if( slots[i].interaction != NULL )
+		{
+			total += ( ( i - HomeSlot( slots[i].lightIndex, slots[i].entityIndex ) ) & ( capacity - 1 ) ) + 1;
+		}
+	}
+	return total * 100 / num;
+}
+
+/*
+===============
+R_ShowInteractionTable_f
+
+Compares the interaction table with the dense lightDefs * entityDefs table it replaced.
+===============
+*/
+void R_ShowInteractionTable_f( const idCmdArgs& args )
+{
+	const idRenderWorldLocal* world = tr.primaryWorld;
+	if( world == NULL )
+	{
+		common->Printf( "no primary world\n" );
+		return;
+	}
+
+	const idInteractionTable& table = world->interactionTable;
+	if( !table.IsActive() )
+	{
+		common->Printf( "interactions haven't been generated\n" );
+		return;
+	}
+
+	int emptyInteractions = 0;
+	for( int i = 0; i < world->lightDefs.Num(); i++ )
+	{
+		const idRenderLightLocal* light = world->lightDefs[i];
+		if( light == NULL )
+		{
+			continue;
+		}
+		for( const idInteraction* inter = light->firstInteraction; inter != NULL; inter = inter->lightNext )
+		{
+			if( table.Find( i, inter->entityDef->index ) == INTERACTION_EMPTY )
+			{
+				emptyInteractions++;
+			}
+		}
+	}
+
+	// the dense table was padded by 100 on both sides
+	const size_t denseSize = ( size_t )( world->entityDefs.Num() + 100 ) * ( world->lightDefs.Num() + 100 ) * sizeof( idInteraction* );
+
+	common->Printf( "%i lightDefs, %i entityDefs\n", world->lightDefs.Num(), world->entityDefs.Num() );
+	common->Printf( "%i interactions, %i of them empty\n", table.Num(), emptyInteractions );
+	common->Printf( "%i slots, %.1f%% used, %.2f average probe\n", table.GetCapacity(), table.Num() * 100.0f / Max( table.GetCapacity(), 1 ), table.GetAverageProbe() / 100.0f );
+	common->Printf( "sparse table: %i kB\n", ( int )( table.Allocated() >> 10 ) );
+	common->Printf( "dense table:  %i kB\n", ( int )( denseSize >> 10 ) );
+}
@@ -146,6 +146,125 @@ private:
 	void					Unlink();
 };
 
+/*
+===============================================================================
+
+	Light / entity interaction table
+
+	Maps a lightDef / entityDef index pair to its idInteraction, which may be
+	INTERACTION_EMPTY for pairs that were checked and don't interact. Only the
+	pairs that have an interaction are stored, in a single open addressing
+	table with linear probing, so the memory grows with the number of
+	interactions instead of lightDefs * entityDefs and adding a def never
+	rebuilds the table. Remove shifts the following slots back, so no deleted
+	markers build up as lights and entities move around.
+
+	Lookups don't change the table and can be done from the front end jobs,
+	as long as no interactions are added or removed at the same time.
+
+===============================================================================
+*/
+
+class idInteractionTable
+{
+public:
+	idInteractionTable();
+	~idInteractionTable();
+
+	// start storing interactions, called by GenerateAllInteractions
+	void					Init();
+	// free the table and stop storing interactions
+	void					Shutdown();
+	// returns true between Init and Shutdown
+	bool					IsActive() const
+	{
+		return active;
+	}
+
+	// returns the interaction for the pair, or NULL if it hasn't been tested yet
+	idInteraction* 			Find( const int lightIndex, const int entityIndex ) const;
+	// adds or replaces the interaction for the pair
+	void					Set( const int lightIndex, const int entityIndex, idInteraction* interaction );
+	// removes the interaction for the pair
+	void					Remove( const int lightIndex, const int entityIndex );
+
+	// number of pairs stored
+	int						Num() const
+	{
+		return num;
+	}
+	// number of slots allocated
+	int						GetCapacity() const
+	{
+		return capacity;
+	}
+	// returns total size of allocated memory
+	size_t					Allocated() const
+	{
+		return capacity * sizeof( slot_t );
+	}
+	// returns the average number of slots a successful lookup probes times 100
+	int						GetAverageProbe() const;
+
+private:
+	static const int		MIN_CAPACITY = 1024;
+
+	struct slot_t
+	{
+		int					lightIndex;
+		int					entityIndex;
+		idInteraction* 		interaction;			// NULL for an empty slot
+	};
+
+	slot_t* 				slots;
+	int						capacity;				// power of two
+	int						num;
+	bool					active;
+
+	void					Resize( const int newCapacity );
+	int						HomeSlot( const int lightIndex, const int entityIndex ) const;
+};
+
+/*
+===============
+idInteractionTable::HomeSlot
+===============
+*/
+ID_INLINE int idInteractionTable::HomeSlot( const int lightIndex, const int entityIndex ) const
+{
+	unsigned int h = ( unsigned int )lightIndex * 0x9E3779B1u ^ ( unsigned int )entityIndex * 0x85EBCA6Bu;
+	h ^= h >> 16;
+	h *= 0x7FEB352Du;
+	h ^= h >> 15;
+	return ( int )( h & ( capacity - 1 ) );
+}
+
+/*
+===============
+idInteractionTable::Find
+===============
+*/
+ID_INLINE idInteraction* idInteractionTable::Find( const int lightIndex, const int entityIndex ) const
+{
+	if( num == 0 )
+	{
+		return NULL;
+	}
+	for( int i = HomeSlot( lightIndex, entityIndex ); ; i = ( i + 1 ) & ( capacity - 1 ) )
+	{
+		const slot_t& slot = slots[i];
+		if( slot.interaction == NULL )
+		{
+			return NULL;
+		}
+		if( slot.lightIndex == lightIndex && slot.entityIndex == entityIndex )
+		{
+			return slot.interaction;
+		}
+	}
+}
+
 void R_ShowInteractionMemory_f( const idCmdArgs& args );
+void R_ShowInteractionTable_f( const idCmdArgs& args );
 
 #endif /* !__INTERACTION_H__ */
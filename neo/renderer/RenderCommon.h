@@ -116,6 +116,7 @@ struct areaReference_t
 	RenderEnvprobeLocal*	envprobe;				// only one of entity / light / envprobe will be non-NULL
 
 	struct portalArea_s*		area;				// so owners can find all the areas they are in
+	int						treeNode;				// leaf in the entity or light tree of the area
 };
 
 
@@ -1115,6 +1116,7 @@ extern idCVar r_useLightPortalCulling;		// 0 = none, 1 = box, 2 = exact clip of
 extern idCVar r_useLightAreaCulling;		// 0 = off, 1 = on
 extern idCVar r_useLightScissors;			// 1 = use custom scissor rectangle for each light
 extern idCVar r_useEntityPortalCulling;		// 0 = none, 1 = box
+extern idCVar r_useAreaRefTrees;			// cull area references hierarchically before r_useEntityPortalCulling / r_useLightPortalCulling
 extern idCVar r_useCachedDynamicModels;		// 1 = cache snapshots of dynamic models
 extern idCVar r_useScissor;					// 1 = scissor clip as portals and lights are processed
 extern idCVar r_usePortals;					// 1 = use portals to perform area culling, otherwise draw everything
@@ -1184,6 +1186,8 @@ extern idCVar r_showCull;					// report sphere and box culling stats
 extern idCVar r_showAddModel;				// report stats from tr_addModel
 extern idCVar r_showSurfaces;				// report surface/light/shadow counts
 extern idCVar r_showPrimitives;				// report vertex/index/draw counts
+extern idCVar r_showSortDrawSurfs;			// report draw surface sort time and material changes
+extern idCVar r_sortDrawSurfsByMaterial;	// group opaque draw surfaces by material before depth
 extern idCVar r_showPortals;				// draw portal outlines in color based on passed / not passed
 extern idCVar r_showSkel;					// draw the skeleton when model animates
 extern idCVar r_showOverDraw;				// show overdraw
@@ -92,11 +92,20 @@ void idRenderSystemLocal::PrintPerformanceCounters()
 		common->Printf( "entityUpdates:%i  entityRefs:%i  lightUpdates:%i  lightRefs:%i\n",
 						pc.c_entityUpdates, pc.c_entityReferences,
 						pc.c_lightUpdates, pc.c_lightReferences );
+		common->Printf( "entityUpdates relinked:%i unchanged:%i kept refs:%i  lightUpdates relinked:%i unchanged:%i kept refs:%i\n",
+						pc.c_entityUpdates - pc.c_entityUpdatesSkipped - pc.c_entityUpdatesKept, pc.c_entityUpdatesSkipped, pc.c_entityUpdatesKept,
+						pc.c_lightUpdates - pc.c_lightUpdatesSkipped - pc.c_lightUpdatesKept, pc.c_lightUpdatesSkipped, pc.c_lightUpdatesKept );
 	}
 	if( r_showMemory.GetBool() )
 	{
 		common->Printf( "frameData: %i (%i)\n", frameData->frameMemoryAllocated.GetValue(), frameData->highWaterAllocated );
 	}
+	if( r_showSortDrawSurfs.GetBool() && pc.c_numViews > 0 )
+	{
+		common->Printf( "sortDrawSurfs: %i surfs, %i state changes, %i usec per view (%i views)\n",
+						pc.c_sortedDrawSurfs / pc.c_numViews, pc.c_sortStateChanges / pc.c_numViews,
+						( int )( pc.sortMicroSec / pc.c_numViews ), pc.c_numViews );
+	}
 
 	memset( &pc, 0, sizeof( pc ) );
 	memset( &backend.pc, 0, sizeof( backend.pc ) );
@@ -120,7 +120,11 @@ struct performanceCounters_t
 	int		c_deformedIndexes;	// idMD5Mesh::GenerateSurface
 	int		c_tangentIndexes;	// R_DeriveTangents()
 	int		c_entityUpdates;
+	int		c_entityUpdatesSkipped;	// nothing changed
+	int		c_entityUpdatesKept;	// area references and interactions kept
 	int		c_lightUpdates;
+	int		c_lightUpdatesSkipped;
+	int		c_lightUpdatesKept;
 	int		c_envprobeUpdates;
 	int		c_entityReferences;
 	int		c_lightReferences;
@@ -132,7 +136,11 @@ struct performanceCounters_t
 	int		c_mocCulledSurfaces;
 	int		c_mocCulledLights;
 
+	int		c_sortedDrawSurfs;	// R_SortDrawSurfs
+	int		c_sortStateChanges;	// material / skinning changes between the sorted surfaces
+
 	uint64	mocMicroSec;
+	uint64	sortMicroSec;
 	uint64	frontEndMicroSec;	// sum of time in all RE_RenderScene's in a frame
 };
 
@@ -156,10 +156,6 @@ idRenderWorldLocal::idRenderWorldLocal()
 	doublePortals = NULL;
 	numInterAreaPortals = 0;
 
-	interactionTable = 0;
-	interactionTableWidth = 0;
-	interactionTableHeight = 0;
-
 	for( int i = 0; i < decals.Num(); i++ )
 	{
 		decals[i].entityHandle = -1;
@@ -201,37 +197,6 @@ idRenderWorldLocal::~idRenderWorldLocal()
 	RB_ClearDebugText( 0 );
 }
 
-/*
-===================
-ResizeInteractionTable
-===================
-*/
-void idRenderWorldLocal::ResizeInteractionTable()
-{
-	// we overflowed the interaction table, so make it larger
-	common->Printf( "idRenderWorldLocal::ResizeInteractionTable: overflowed interactionTable, resizing\n" );
-
-	const int oldInteractionTableWidth = interactionTableWidth;
-	const int oldIinteractionTableHeight = interactionTableHeight;
-	idInteraction** oldInteractionTable = interactionTable;
-
-	// build the interaction table
-	// this will be dynamically resized if the entity / light counts grow too much
-	interactionTableWidth = entityDefs.Num() + 100;
-	interactionTableHeight = lightDefs.Num() + 100;
-	const int	size =  interactionTableWidth * interactionTableHeight * sizeof( *interactionTable );
-	interactionTable = ( idInteraction** )R_ClearedStaticAlloc( size );
-	for( int l = 0; l < oldIinteractionTableHeight; l++ )
-	{
-		for( int e = 0; e < oldInteractionTableWidth; e++ )
-		{
-			interactionTable[ l * interactionTableWidth + e ] = oldInteractionTable[ l * oldInteractionTableWidth + e ];
-		}
-	}
-
-	R_StaticFree( oldInteractionTable );
-}
-
 /*
 ===================
 AddEntityDef
@@ -244,11 +209,6 @@ qhandle_t idRenderWorldLocal::AddEntityDef( const renderEntity_t* re )
 	if( entityHandle == -1 )
 	{
 		entityHandle = entityDefs.Append( NULL );
-
-		if( interactionTable && entityDefs.Num() > interactionTableWidth )
-		{
-			ResizeInteractionTable();
-		}
 	}
 
 	UpdateEntityDef( entityHandle, re );
@@ -256,6 +216,43 @@ qhandle_t idRenderWorldLocal::AddEntityDef( const renderEntity_t* re )
 	return entityHandle;
 }
 
+/*
+==============
+R_EntityDefPlacementUnchanged
+
+Returns true if the entity would end up in the same areas with the same interactions,
+only shader parms, joints or other per frame values changed.
+==============
+*/
+static bool R_EntityDefPlacementUnchanged( const idRenderEntityLocal* def, const renderEntity_t* re )
+{
+	const renderEntity_t& parms = def->parms;
+
+	if( re->hModel != parms.hModel || re->callback != parms.callback )
+	{
+		return false;
+	}
+	if( re->origin != parms.origin || re->axis != parms.axis )
+	{
+		return false;
+	}
+
+	// these decide which surfaces create interactions and shadows
+	if( re->customShader != parms.customShader || re->referenceShader != parms.referenceShader || re->customSkin != parms.customSkin ||
+			re->noShadow != parms.noShadow || re->noSelfShadow != parms.noSelfShadow || re->noDynamicInteractions != parms.noDynamicInteractions ||
+			re->suppressShadowInLightID != parms.suppressShadowInLightID || re->numJoints != parms.numJoints )
+	{
+		return false;
+	}
+
+	// the same bounds R_CreateEntityRefs would derive, some models like beams take them from the shader parms
+	if( re->callback != NULL )
+	{
+		return ( re->bounds == def->localReferenceBounds );
+	}
+	return ( re->hModel->Bounds( re ) == def->localReferenceBounds );
+}
+
 /*
 ==============
 UpdateEntityDef
@@ -264,8 +261,6 @@ Does not write to the demo file, which will only be updated for
 visible entities
 ==============
 */
-int c_callbackUpdate;
-
 void idRenderWorldLocal::UpdateEntityDef( qhandle_t entityHandle, const renderEntity_t* re )
 {
 	if( r_skipUpdates.GetBool() )
@@ -300,30 +295,19 @@ void idRenderWorldLocal::UpdateEntityDef( qhandle_t entityHandle, const renderEn
 			// check for exact match (OPTIMIZE: check through pointers more)
 			if( !re->joints && !re->callbackData && !def->dynamicModel && !memcmp( re, &def->parms, sizeof( *re ) ) )
 			{
+				tr.pc.c_entityUpdatesSkipped++;
 				return;
 			}
 
-			// if the only thing that changed was shaderparms, we can just leave things as they are
-			// after updating parms
-
-			// if we have a callback function and the bounds, origin, axis and model match,
-			// then we can leave the references as they are
-			if( re->callback )
+			// if only shader parms, joints or a callback changed, the area references and
+			// interactions stay valid, only the dynamic model has to be generated again
+			if( R_EntityDefPlacementUnchanged( def, re ) )
 			{
-
-				bool axisMatch = ( re->axis == def->parms.axis );
-				bool originMatch = ( re->origin == def->parms.origin );
-				bool boundsMatch = ( re->bounds == def->localReferenceBounds );
-				bool modelMatch = ( re->hModel == def->parms.hModel );
-
-				if( boundsMatch && originMatch && axisMatch && modelMatch )
-				{
-					// only clear the dynamic model and interaction surfaces if they exist
-					c_callbackUpdate++;
-					R_ClearEntityDefDynamicModel( def );
-					def->parms = *re;
-					return;
-				}
+				// only clear the dynamic model and interaction surfaces if they exist
+				tr.pc.c_entityUpdatesKept++;
+				R_ClearEntityDefDynamicModel( def );
+				def->parms = *re;
+				return;
 			}
 		}
 
@@ -446,10 +430,6 @@ qhandle_t idRenderWorldLocal::AddLightDef( const renderLight_t* rlight )
 	if( lightHandle == -1 )
 	{
 		lightHandle = lightDefs.Append( NULL );
-		if( interactionTable && lightDefs.Num() > interactionTableHeight )
-		{
-			ResizeInteractionTable();
-		}
 	}
 	UpdateLightDef( lightHandle, rlight );
 
@@ -489,16 +469,28 @@ void idRenderWorldLocal::UpdateLightDef( qhandle_t lightHandle, const renderLigh
 	idRenderLightLocal* light = lightDefs[lightHandle];
 	if( light )
 	{
+		// spectrum lights are stored with noShadows forced on
+		const bool noShadows = rlight->noShadows || ( rlight->shader != NULL && rlight->shader->Spectrum() );
+
+		// check for exact match
+		if( !memcmp( rlight, &light->parms, sizeof( *rlight ) ) )
+		{
+			tr.pc.c_lightUpdatesSkipped++;
+			return;
+		}
+
 		// if the shape of the light stays the same, we don't need to dump
 		// any of our derived data, because shader parms are calculated every frame
+		// compare against the requested shader, lightShader is replaced by the default for NULL
 		if( rlight->axis == light->parms.axis && rlight->end == light->parms.end &&
 				rlight->lightCenter == light->parms.lightCenter && rlight->lightRadius == light->parms.lightRadius &&
-				rlight->noShadows == light->parms.noShadows && rlight->origin == light->parms.origin &&
+				noShadows == light->parms.noShadows && rlight->origin == light->parms.origin &&
 				rlight->parallel == light->parms.parallel && rlight->pointLight == light->parms.pointLight &&
 				rlight->right == light->parms.right && rlight->start == light->parms.start &&
 				rlight->target == light->parms.target && rlight->up == light->parms.up &&
-				rlight->shader == light->lightShader )
+				rlight->shader == light->parms.shader )
 		{
+			tr.pc.c_lightUpdatesKept++;
 			justUpdate = true;
 		}
 		else
@@ -1842,6 +1834,9 @@ void idRenderWorldLocal::AddEntityRefToArea( idRenderEntityLocal* def, portalAre
 	ref->areaPrev = area->entityRefs.areaPrev;
 	ref->areaNext->areaPrev = ref;
 	ref->areaPrev->areaNext = ref;
+
+	// the reference bounds are derived before the refs are created
+	area->entityTree.Insert( ref, def->globalReferenceBounds );
 }
 
 /*
@@ -1874,6 +1869,8 @@ void idRenderWorldLocal::AddLightRefToArea( idRenderLightLocal* light, portalAre
 	lref->areaNext = area->lightRefs.areaNext;
 	lref->areaPrev = &area->lightRefs;
 	area->lightRefs.areaNext = lref;
+
+	area->lightTree.Insert( lref, light->globalLightBounds );
 }
 
 // RB begin
@@ -1893,6 +1890,7 @@ void idRenderWorldLocal::AddEnvprobeRefToArea( RenderEnvprobeLocal* probe, porta
 	lref = areaReferenceAllocator.Alloc();
 	lref->envprobe = probe;
 	lref->area = area;
+	lref->treeNode = -1;
 	lref->ownerNext = probe->references;
 	probe->references = lref;
 	tr.pc.c_lightReferences++;
@@ -1928,12 +1926,8 @@ void idRenderWorldLocal::GenerateAllInteractions()
 	// try and do any view specific optimizations
 	tr.viewDef = NULL;
 
-	// build the interaction table
-	// this will be dynamically resized if the entity / light counts grow too much
-	interactionTableWidth = entityDefs.Num() + 100;
-	interactionTableHeight = lightDefs.Num() + 100;
-	int	size =  interactionTableWidth * interactionTableHeight * sizeof( *interactionTable );
-	interactionTable = ( idInteraction** )R_ClearedStaticAlloc( size );
+	// start the interaction table, it grows with the number of interactions
+	interactionTable.Init();
 
 	tr.commandList->open();
 
@@ -1997,7 +1991,7 @@ void idRenderWorldLocal::GenerateAllInteractions()
 	int	msec = end - start;
 
 	common->Printf( "idRenderWorld::GenerateAllInteractions, msec = %i\n", msec );
-	common->Printf( "interactionTable size: %i bytes\n", size );
+	common->Printf( "interactionTable size: %i bytes\n", ( int )interactionTable.Allocated() );
 	common->Printf( "%i interactions take %i bytes\n", count, count * sizeof( idInteraction ) );
 
 	// entities flagged as noDynamicInteractions will no longer make any
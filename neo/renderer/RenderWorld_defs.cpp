@@ -102,6 +102,7 @@ void R_FreeEntityDefDerivedData( idRenderEntityLocal* def, bool keepDecals, bool
 		// unlink from the area
 		ref->areaNext->areaPrev = ref->areaPrev;
 		ref->areaPrev->areaNext = ref->areaNext;
+		ref->area->entityTree.Remove( ref );
 
 		// put it back on the free list for reuse
 		def->world->areaReferenceAllocator.Free( ref );
@@ -498,6 +499,7 @@ void R_FreeLightDefDerivedData( idRenderLightLocal* ldef )
 		// unlink from the area
 		lref->areaNext->areaPrev = lref->areaPrev;
 		lref->areaPrev->areaNext = lref->areaNext;
+		lref->area->lightTree.Remove( lref );
 
 		// put it back on the free list for reuse
 		ldef->world->areaReferenceAllocator.Free( lref );
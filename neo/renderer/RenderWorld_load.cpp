@@ -69,6 +69,9 @@ void idRenderWorldLocal::FreeWorld()
 		{
 			common->Error( "FreeWorld: unexpected remaining entityRefs" );
 		}
+
+		area->entityTree.Shutdown();
+		area->lightTree.Shutdown();
 	}
 
 	if( portalAreas )
@@ -436,6 +439,9 @@ void idRenderWorldLocal::SetupAreaRefs()
 
 		portalAreas[i].envprobeRefs.areaNext =
 			portalAreas[i].envprobeRefs.areaPrev = &portalAreas[i].envprobeRefs;
+
+		portalAreas[i].entityTree.Init();
+		portalAreas[i].lightTree.Init();
 	}
 }
 
@@ -768,11 +774,7 @@ void idRenderWorldLocal::FreeDefs()
 {
 	generateAllInteractionsCalled = false;
 
-	if( interactionTable )
-	{
-		R_StaticFree( interactionTable );
-		interactionTable = NULL;
-	}
+	interactionTable.Shutdown();
 
 	// free all lightDefs
 	for( int i = 0; i < lightDefs.Num(); i++ )
@@ -32,6 +32,7 @@ If you have questions concerning this license or the applicable additional terms
 #define __RENDERWORLDLOCAL_H__
 
 #include "BoundsTrack.h"
+#include "AreaRefTree.h"
 
 // assume any lightDef or entityDef index above this is an internal error
 const int LUDICROUS_INDEX	= 10000;
@@ -126,6 +127,8 @@ typedef struct portalArea_s
 	areaReference_t	entityRefs;		// head/tail of doubly linked list, may change
 	areaReference_t	lightRefs;		// head/tail of doubly linked list, may change
 	areaReference_t	envprobeRefs;	// head/tail of doubly linked list, may change
+	idAreaRefTree	entityTree;		// bounding volume hierarchy over entityRefs
+	idAreaRefTree	lightTree;		// bounding volume hierarchy over lightRefs
 } portalArea_t;
 
 
@@ -246,8 +249,8 @@ public:
 	idList<idRenderLightLocal*, TAG_LIGHT>			lightDefs;
 	idList<RenderEnvprobeLocal*, TAG_ENVPROBE>		envprobeDefs; // RB
 
-	idBlockAlloc<areaReference_t, 1024> areaReferenceAllocator;
-	idBlockAlloc<idInteraction, 256>	interactionAllocator;
+	idBlockAlloc<areaReference_t, 1024, TAG_LEVEL> areaReferenceAllocator;
+	idBlockAlloc<idInteraction, 256, TAG_LEVEL>	interactionAllocator;
 
 #ifdef ID_PC
 	static const int MAX_DECAL_SURFACES = 32;
@@ -258,13 +261,8 @@ public:
 	idArray<reusableOverlay_t, MAX_DECAL_SURFACES>	overlays;
 
 	// all light / entity interactions are referenced here for fast lookup without
-	// having to crawl the doubly linked lists.  EnntityDefs are sequential for better
-	// cache access, because the table is accessed by light in idRenderWorldLocal::CreateLightDefInteractions()
-	// Growing this table is time consuming, so we add a pad value to the number
-	// of entityDefs and lightDefs
-	idInteraction** 		interactionTable;
-	int						interactionTableWidth;		// entityDefs
-	int						interactionTableHeight;		// lightDefs
+	// having to crawl the doubly linked lists, only the pairs that interact take up memory
+	idInteractionTable		interactionTable;
 
 	bool					generateAllInteractionsCalled;
 
@@ -306,9 +304,13 @@ public:
 	};
 
 	bool					CullEntityByPortals( const idRenderEntityLocal* entity, const portalStack_t* ps );
+	void					AddAreaViewEntity( idRenderEntityLocal* entity, const portalStack_t* ps, bool cullByPortals );
+	void					AddAreaTreeViewEntities_r( const idAreaRefTree& tree, int nodeNum, const portalStack_t* ps, int planeBits, bool exactCull );
 	void					AddAreaViewEntities( int areaNum, const portalStack_t* ps );
 
 	bool					CullLightByPortals( const idRenderLightLocal* light, const portalStack_t* ps );
+	void					AddAreaViewLight( idRenderLightLocal* light, const portalStack_t* ps, bool cullByPortals );
+	void					AddAreaTreeViewLights_r( const idAreaRefTree& tree, int nodeNum, const portalStack_t* ps, int planeBits, bool exactCull );
 	void					AddAreaViewLights( int areaNum, const portalStack_t* ps );
 
 	// RB begin
@@ -343,7 +345,6 @@ public:
 	//--------------------------
 	// RenderWorld.cpp
 
-	void					ResizeInteractionTable();
 
 	void					AddEntityRefToArea( idRenderEntityLocal* def, portalArea_t* area );
 	void					AddLightRefToArea( idRenderLightLocal* light, portalArea_t* area );
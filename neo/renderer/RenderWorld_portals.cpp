@@ -214,55 +214,147 @@ bool idRenderWorldLocal::CullEntityByPortals( const idRenderEntityLocal* entity,
 
 /*
 ===================
-AddAreaViewEntities
+R_CullBoundsToPortalPlanes
 
-Any models that are visible through the current portalStack will have their scissor rect updated.
+Tests bounds against the portal planes selected by planeBits.
+Returns -1 if the bounds are completely outside one of the planes,
+otherwise planeBits without the planes the bounds are completely inside of.
 ===================
 */
-void idRenderWorldLocal::AddAreaViewEntities( int areaNum, const portalStack_t* ps )
+static int R_CullBoundsToPortalPlanes( const idBounds& bounds, const idPlane* portalPlanes, int planeBits )
 {
-	portalArea_t* area = &portalAreas[ areaNum ];
+	const idVec3 center = ( bounds[0] + bounds[1] ) * 0.5f;
+	const idVec3 extents = bounds[1] - center;
 
-	for( areaReference_t* ref = area->entityRefs.areaNext; ref != &area->entityRefs; ref = ref->areaNext )
+	int remainingBits = planeBits;
+	for( int i = 0; ( planeBits >> i ) != 0; i++ )
 	{
-		idRenderEntityLocal*	 entity = ref->entity;
-
-		// debug tool to allow viewing of only one entity at a time
-		if( r_singleEntity.GetInteger() >= 0 && r_singleEntity.GetInteger() != entity->index )
+		if( ( planeBits & ( 1 << i ) ) == 0 )
 		{
 			continue;
 		}
+		const idPlane& plane = portalPlanes[i];
 
-		// remove decals that are completely faded away
-		R_FreeEntityDefFadedDecals( entity, tr.viewDef->renderView.time[0] );
+		const float d = plane.Distance( center );
+		const float r = idMath::Fabs( plane[0] ) * extents[0] + idMath::Fabs( plane[1] ) * extents[1] + idMath::Fabs( plane[2] ) * extents[2];
 
-		// check for completely suppressing the model
-		if( !r_skipSuppress.GetBool() )
+		// the positive side of the portal planes is outside the visible volume
+		if( d - r > ON_EPSILON )
 		{
-			if( entity->parms.suppressSurfaceInViewID
-					&& entity->parms.suppressSurfaceInViewID == tr.viewDef->renderView.viewID )
-			{
-				continue;
-			}
-			if( entity->parms.allowSurfaceInViewID
-					&& entity->parms.allowSurfaceInViewID != tr.viewDef->renderView.viewID )
-			{
-				continue;
-			}
+			return -1;
+		}
+		if( d + r < -ON_EPSILON )
+		{
+			remainingBits &= ~( 1 << i );
 		}
+	}
+	return remainingBits;
+}
+
+/*
+===================
+AddAreaViewEntity
+
+Updates the scissor rect of the entity if it is visible through the current portalStack.
+The portal culling can be skipped if the bounds are known to be inside all the portal planes.
+===================
+*/
+void idRenderWorldLocal::AddAreaViewEntity( idRenderEntityLocal* entity, const portalStack_t* ps, bool cullByPortals )
+{
+	// debug tool to allow viewing of only one entity at a time
+	if( r_singleEntity.GetInteger() >= 0 && r_singleEntity.GetInteger() != entity->index )
+	{
+		return;
+	}
 
-		// cull reference bounds
-		if( CullEntityByPortals( entity, ps ) )
+	// remove decals that are completely faded away
+	R_FreeEntityDefFadedDecals( entity, tr.viewDef->renderView.time[0] );
+
+	// check for completely suppressing the model
+	if( !r_skipSuppress.GetBool() )
+	{
+		if( entity->parms.suppressSurfaceInViewID
+				&& entity->parms.suppressSurfaceInViewID == tr.viewDef->renderView.viewID )
 		{
-			// we are culled out through this portal chain, but it might
-			// still be visible through others
-			continue;
+			return;
+		}
+		if( entity->parms.allowSurfaceInViewID
+				&& entity->parms.allowSurfaceInViewID != tr.viewDef->renderView.viewID )
+		{
+			return;
 		}
+	}
 
-		viewEntity_t* vEnt = R_SetEntityDefViewEntity( entity );
+	// cull reference bounds
+	if( cullByPortals && CullEntityByPortals( entity, ps ) )
+	{
+		// we are culled out through this portal chain, but it might
+		// still be visible through others
+		return;
+	}
+
+	viewEntity_t* vEnt = R_SetEntityDefViewEntity( entity );
 
-		// possibly expand the scissor rect
-		vEnt->scissorRect.Union( ps->rect );
+	// possibly expand the scissor rect
+	vEnt->scissorRect.Union( ps->rect );
+}
+
+/*
+===================
+AddAreaTreeViewEntities_r
+
+The box tests only reject references that CullEntityByPortals would reject as well,
+so the tree gives the same view entities as walking the area list.
+===================
+*/
+void idRenderWorldLocal::AddAreaTreeViewEntities_r( const idAreaRefTree& tree, int nodeNum, const portalStack_t* ps, int planeBits, bool exactCull )
+{
+	const idAreaRefTree::node_t& node = tree.GetNode( nodeNum );
+
+	planeBits = R_CullBoundsToPortalPlanes( node.bounds, ps->portalPlanes, planeBits );
+	if( planeBits == -1 )
+	{
+		return;
+	}
+
+	if( idAreaRefTree::IsLeaf( node ) )
+	{
+		// the frustum corners are inside the bounds, so they can't be culled
+		// to a plane the bounds are completely inside of
+		AddAreaViewEntity( node.ref->entity, ps, exactCull || planeBits != 0 );
+		return;
+	}
+
+	AddAreaTreeViewEntities_r( tree, node.children[0], ps, planeBits, exactCull );
+	AddAreaTreeViewEntities_r( tree, node.children[1], ps, planeBits, exactCull );
+}
+
+/*
+===================
+AddAreaViewEntities
+
+Any models that are visible through the current portalStack will have their scissor rect updated.
+===================
+*/
+void idRenderWorldLocal::AddAreaViewEntities( int areaNum, const portalStack_t* ps )
+{
+	portalArea_t* area = &portalAreas[ areaNum ];
+
+	const int cullMode = r_useEntityPortalCulling.GetInteger();
+	if( r_useAreaRefTrees.GetBool() && cullMode != 0 )
+	{
+		if( area->entityTree.GetRoot() != -1 )
+		{
+			// the exact clip doesn't use the last plane, which is the portal itself
+			const int numPlanes = ( cullMode >= 2 ) ? Max( ps->numPortalPlanes - 1, 0 ) : ps->numPortalPlanes;
+			AddAreaTreeViewEntities_r( area->entityTree, area->entityTree.GetRoot(), ps, ( 1 << numPlanes ) - 1, cullMode >= 2 );
+		}
+		return;
+	}
+
+	for( areaReference_t* ref = area->entityRefs.areaNext; ref != &area->entityRefs; ref = ref->areaNext )
+	{
+		AddAreaViewEntity( ref->entity, ps, true );
 	}
 }
 
@@ -355,49 +447,96 @@ bool idRenderWorldLocal::CullLightByPortals( const idRenderLightLocal* light, co
 
 /*
 ===================
-AddAreaViewLights
+AddAreaViewLight
 
 This is the only point where lights get added to the viewLights list.
-Any lights that are visible through the current portalStack will have their scissor rect updated.
+Updates the scissor rect of the light if it is visible through the current portalStack.
 ===================
 */
-void idRenderWorldLocal::AddAreaViewLights( int areaNum, const portalStack_t* ps )
+void idRenderWorldLocal::AddAreaViewLight( idRenderLightLocal* light, const portalStack_t* ps, bool cullByPortals )
 {
-	portalArea_t* area = &portalAreas[ areaNum ];
+	// debug tool to allow viewing of only one light at a time
+	// RB: use this elsewhere in the backend debug drawing code
+#if 0
+	if( r_singleLight.GetInteger() >= 0 && r_singleLight.GetInteger() != light->index )
+	{
+		return;
+	}
+#endif
 
-	for( areaReference_t* lref = area->lightRefs.areaNext; lref != &area->lightRefs; lref = lref->areaNext )
+	// check for being closed off behind a door
+	// a light that doesn't cast shadows will still light even if it is behind a door
+	if( r_useLightAreaCulling.GetBool() && !light->LightCastsShadows()
+			&& light->areaNum != -1 && !tr.viewDef->connectedAreas[ light->areaNum ] )
 	{
-		idRenderLightLocal* light = lref->light;
+		return;
+	}
 
-		// debug tool to allow viewing of only one light at a time
-		// RB: use this elsewhere in the backend debug drawing code
-#if 0
-		if( r_singleLight.GetInteger() >= 0 && r_singleLight.GetInteger() != light->index )
-		{
-			continue;
-		}
-#endif
+	// cull frustum
+	if( cullByPortals && CullLightByPortals( light, ps ) )
+	{
+		// we are culled out through this portal chain, but it might
+		// still be visible through others
+		return;
+	}
 
-		// check for being closed off behind a door
-		// a light that doesn't cast shadows will still light even if it is behind a door
-		if( r_useLightAreaCulling.GetBool() && !light->LightCastsShadows()
-				&& light->areaNum != -1 && !tr.viewDef->connectedAreas[ light->areaNum ] )
-		{
-			continue;
-		}
+	viewLight_t* vLight = R_SetLightDefViewLight( light );
+
+	// expand the scissor rect
+	vLight->scissorRect.Union( ps->rect );
+}
+
+/*
+===================
+AddAreaTreeViewLights_r
+===================
+*/
+void idRenderWorldLocal::AddAreaTreeViewLights_r( const idAreaRefTree& tree, int nodeNum, const portalStack_t* ps, int planeBits, bool exactCull )
+{
+	const idAreaRefTree::node_t& node = tree.GetNode( nodeNum );
+
+	planeBits = R_CullBoundsToPortalPlanes( node.bounds, ps->portalPlanes, planeBits );
+	if( planeBits == -1 )
+	{
+		return;
+	}
 
-		// cull frustum
-		if( CullLightByPortals( light, ps ) )
+	if( idAreaRefTree::IsLeaf( node ) )
+	{
+		AddAreaViewLight( node.ref->light, ps, exactCull || planeBits != 0 );
+		return;
+	}
+
+	AddAreaTreeViewLights_r( tree, node.children[0], ps, planeBits, exactCull );
+	AddAreaTreeViewLights_r( tree, node.children[1], ps, planeBits, exactCull );
+}
+
+/*
+===================
+AddAreaViewLights
+
+Any lights that are visible through the current portalStack will have their scissor rect updated.
+===================
+*/
+void idRenderWorldLocal::AddAreaViewLights( int areaNum, const portalStack_t* ps )
+{
+	portalArea_t* area = &portalAreas[ areaNum ];
+
+	const int cullMode = r_useLightPortalCulling.GetInteger();
+	if( r_useAreaRefTrees.GetBool() && cullMode != 0 )
+	{
+		if( area->lightTree.GetRoot() != -1 )
 		{
-			// we are culled out through this portal chain, but it might
-			// still be visible through others
-			continue;
+			// the exact clip doesn't use the last plane, which is the portal itself
+			const int numPlanes = ( cullMode >= 2 ) ? Max( ps->numPortalPlanes - 1, 0 ) : ps->numPortalPlanes;
+			AddAreaTreeViewLights_r( area->lightTree, area->lightTree.GetRoot(), ps, ( 1 << numPlanes ) - 1, cullMode >= 2 );
 		}
+		return;
+	}
 
-		viewLight_t* vLight = R_SetLightDefViewLight( light );
-
-		// expand the scissor rect
-		vLight->scissorRect.Union( ps->rect );
+	for( areaReference_t* lref = area->lightRefs.areaNext; lref != &area->lightRefs; lref = lref->areaNext )
+	{
+		AddAreaViewLight( lref->light, ps, true );
 	}
 }
 
@@ -472,7 +472,7 @@ static void R_AddSingleLight( viewLight_t* vLight )
 	// this bool array will be set true whenever the entity will visibly interact with the light
 	vLight->entityInteractionState = ( byte* )R_ClearedFrameAlloc( light->world->entityDefs.Num() * sizeof( vLight->entityInteractionState[0] ), FRAME_ALLOC_INTERACTION_STATE );
 
-	idInteraction** const interactionTableRow = light->world->interactionTable + light->index * light->world->interactionTableWidth;
+	const idInteractionTable& interactionTable = light->world->interactionTable;
 
 	for( areaReference_t* lref = light->references; lref != NULL; lref = lref->ownerNext )
 	{
@@ -503,8 +503,8 @@ static void R_AddSingleLight( viewLight_t* vLight )
 
 			// The table is updated at interaction::AllocAndLink() and interaction::UnlinkAndFree()
 
-			// TODO(Stephen): interactionTableRow is null if renderDef is used in a gui.sub
-			const idInteraction* inter = interactionTableRow[ edef->index ];
+			// the table is empty if renderDef is used in a gui.sub
+			const idInteraction* inter = interactionTable.Find( light->index, edef->index );
 
 			const renderEntity_t& eParms = edef->parms;
 			const idRenderModel* eModel = eParms.hModel;
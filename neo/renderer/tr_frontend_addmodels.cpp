@@ -375,7 +375,7 @@ void R_AddSingleModel( viewEntity_t* vEntity )
 				if( vLight->entityInteractionState[entityIndex] == viewLight_t::INTERACTION_YES )
 				{
 					contactedLights[numContactedLights] = vLight;
-					staticInteractions[numContactedLights] = world->interactionTable[vLight->lightDef->index * world->interactionTableWidth + entityIndex];
+					staticInteractions[numContactedLights] = world->interactionTable.Find( vLight->lightDef->index, entityIndex );
 					if( ++numContactedLights == MAX_CONTACTED_LIGHTS )
 					{
 						break;
@@ -431,7 +431,7 @@ void R_AddSingleModel( viewEntity_t* vEntity )
 				}
 			}
 			contactedLights[numContactedLights] = vLight;
-			staticInteractions[numContactedLights] = world->interactionTable[vLight->lightDef->index * world->interactionTableWidth + entityIndex];
+			staticInteractions[numContactedLights] = world->interactionTable.Find( vLight->lightDef->index, entityIndex );
 			if( ++numContactedLights == MAX_CONTACTED_LIGHTS )
 			{
 				break;
@@ -550,10 +550,55 @@ void R_AddSingleModel( viewEntity_t* vEntity )
 	idVec3 localViewOrigin;
 	R_GlobalPointToLocal( vEntity->modelMatrix, viewDef->renderView.vieworg, localViewOrigin );
 
+	//---------------------------
+	// view frustum cull the precise surface bounds of all surfaces in one batch,
+	// which is tighter than the entire entity reference bounds
+	// If the entire model wasn't visible, there is no need to check the
+	// individual surfaces.
+	//---------------------------
+	const int numSurfaces = model->NumSurfaces();
+	byte* surfaceCulled = ( byte* )_alloca16( numSurfaces * sizeof( surfaceCulled[0] ) );
+	if( modelIsVisible )
+	{
+		idBounds* cullBounds = ( idBounds* )_alloca16( numSurfaces * sizeof( cullBounds[0] ) );
+		int* cullSurfaces = ( int* )_alloca16( numSurfaces * sizeof( cullSurfaces[0] ) );
+		byte* cullResults = ( byte* )_alloca16( numSurfaces * sizeof( cullResults[0] ) );
+		int numCullSurfaces = 0;
+		for( int surfaceNum = 0; surfaceNum < numSurfaces; surfaceNum++ )
+		{
+			// only the surfaces the loop below doesn't skip right away
+			if( r_singleSurface.GetInteger() >= 0 && surfaceNum != r_singleSurface.GetInteger() )
+			{
+				continue;
+			}
+			const modelSurface_t* surf = model->Surface( surfaceNum );
+			const srfTriangles_t* tri = surf->geometry;
+			if( tri == NULL || tri->numIndexes == 0 || surf->shader == NULL )
+			{
+				continue;
+			}
+			// the LOD test below replaces the bounds of skeletal LOD surfaces with the entity bounds
+			if( tri->staticModelWithJoints && surf->shader->IsLOD() )
+			{
+				cullBounds[numCullSurfaces] = vEntity->entityDef->localReferenceBounds;
+			}
+			else
+			{
+				cullBounds[numCullSurfaces] = tri->bounds;
+			}
+			cullSurfaces[numCullSurfaces++] = surfaceNum;
+		}
+		SIMDProcessor->CullBoundsToMVP( cullResults, vEntity->mvp, cullBounds, numCullSurfaces, false );
+		for( int i = 0; i < numCullSurfaces; i++ )
+		{
+			surfaceCulled[cullSurfaces[i]] = cullResults[i];
+		}
+	}
+
 	//---------------------------
 	// add all the model surfaces
 	//---------------------------
-	for( int surfaceNum = 0; surfaceNum < model->NumSurfaces(); surfaceNum++ )
+	for( int surfaceNum = 0; surfaceNum < numSurfaces; surfaceNum++ )
 	{
 		const modelSurface_t* surf = model->Surface( surfaceNum );
 
@@ -672,11 +717,8 @@ void R_AddSingleModel( viewEntity_t* vEntity )
 			}
 		}
 
-		// view frustum culling for the precise surface bounds, which is tighter
-		// than the entire entity reference bounds
-		// If the entire model wasn't visible, there is no need to check the
-		// individual surfaces.
-		bool surfaceDirectlyVisible = modelIsVisible && !idRenderMatrix::CullBoundsToMVP( vEntity->mvp, tri->bounds );
+		// view frustum culling for the precise surface bounds was done before the loop
+		bool surfaceDirectlyVisible = modelIsVisible && !surfaceCulled[surfaceNum];
 
 		// RB: added check wether GPU skinning is available at all
 		const bool gpuSkinned = ( tri->staticModelWithJoints != NULL && r_useGPUSkinning.GetBool() );
@@ -944,9 +944,9 @@ static drawSurf_t* R_ParticleDeform( drawSurf_t* surf, bool useArea, nvrhi::ICom
 		return NULL;
 	}
 
-	idTempArray<byte> tempVerts( ALIGN( maxQuads * 4 * sizeof( idDrawVert ), 16 ) );
+	idTempArray<byte> tempVerts( ALIGN( maxQuads * 4 * sizeof( idDrawVert ), 16 ), TAG_FRAME );
 	idDrawVert* newVerts = ( idDrawVert* ) tempVerts.Ptr();
-	idTempArray<byte> tempIndex( ALIGN( maxQuads * 6 * sizeof( triIndex_t ), 16 ) );
+	idTempArray<byte> tempIndex( ALIGN( maxQuads * 6 * sizeof( triIndex_t ), 16 ), TAG_FRAME );
 	triIndex_t* newIndexes = ( triIndex_t* ) tempIndex.Ptr();
 
 	drawSurf_t* drawSurfList = NULL;
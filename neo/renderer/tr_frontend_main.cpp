@@ -250,113 +250,245 @@ FONT-END RENDERING
 /*
 =================
 R_SortDrawSurfs
+
+The surfaces are ordered by a 64 bit key in a stable LSD radix sort, ties keep the order they were added in.
+The high 32 bits hold the sort value. Opaque surfaces are grouped by material and skinning below that so the
+back end changes state less often, the rest is ordered by depth only to keep translucent blending correct.
 =================
 */
-static void R_SortDrawSurfs( drawSurf_t** drawSurfs, const int numDrawSurfs )
+static const int SORT_RADIX_BITS = 8;
+static const int SORT_RADIX_SIZE = 1 << SORT_RADIX_BITS;
+static const int SORT_RADIX_PASSES = 64 / SORT_RADIX_BITS;
+static const int SORT_PARALLEL_SURFACES = 16384;	// below this the job overhead is larger than the sort
+static const int SORT_MAX_BLOCKS = 16;
+
+struct sortDrawSurf_t
 {
-#if 1
+	uint64					key;
+	drawSurf_t* 			surf;
+};
 
-	uint64* indices = ( uint64* ) _alloca16( numDrawSurfs * sizeof( indices[0] ) );
+struct radixSortParms_t
+{
+	const sortDrawSurf_t* 	src;
+	sortDrawSurf_t* 		dst;
+	int						numSurfs;
+	int						numBlocks;
+	int						shift;
+	int						counts[SORT_MAX_BLOCKS][SORT_RADIX_SIZE];	// histogram per block, then the write offsets
+};
 
-	// sort the draw surfs based on:
-	// 1. sort value (largest first)
-	// 2. depth (smallest first)
-	// 3. index (largest first)
-	assert( numDrawSurfs <= 0xFFFF );
-	for( int i = 0; i < numDrawSurfs; i++ )
+/*
+=================
+R_SortStateForDrawSurf
+
+Identifies the material of a surface and whether it is skinned. The skinned bit is the
+only part of the binding layout that is in the state.
+=================
+*/
+static ID_INLINE uint64 R_SortStateForDrawSurf( const drawSurf_t* surf )
+{
+	const uint64 material = ( surf->material != NULL ) ? ( surf->material->Index() & 0x7FFF ) : 0x7FFF;
+	const uint64 skinned = ( surf->jointCache != 0 ) ? 0x8000 : 0;
+	return material | skinned;
+}
+
+/*
+=================
+R_RadixHistogram
+=================
+*/
+static void R_RadixHistogram( void* data, int begin, int end )
+{
+	radixSortParms_t* parms = ( radixSortParms_t* )data;
+	for( int block = begin; block < end; block++ )
 	{
-		float sort = SS_POST_PROCESS - drawSurfs[i]->sort;
-		assert( sort >= 0.0f );
+		const int first = ( int )( ( int64 )parms->numSurfs * block / parms->numBlocks );
+		const int last = ( int )( ( int64 )parms->numSurfs * ( block + 1 ) / parms->numBlocks );
 
-		uint64 dist = 0;
-		if( drawSurfs[i]->frontEndGeo != NULL )
+		int* counts = parms->counts[block];
+		memset( counts, 0, SORT_RADIX_SIZE * sizeof( counts[0] ) );
+		for( int i = first; i < last; i++ )
 		{
-			float min = 0.0f;
-			float max = 1.0f;
-			idRenderMatrix::DepthBoundsForBounds( min, max, drawSurfs[i]->space->mvp, drawSurfs[i]->frontEndGeo->bounds );
-			dist = idMath::Ftoui16( min * 0xFFFF );
+			counts[( parms->src[i].key >> parms->shift ) & ( SORT_RADIX_SIZE - 1 )]++;
 		}
+	}
+}
 
-		indices[i] = ( ( numDrawSurfs - i ) & 0xFFFF ) | ( dist << 16 ) | ( ( uint64 )( *( uint32* )&sort ) << 32 );
+/*
+=================
+R_RadixScatter
+=================
+*/
+static void R_RadixScatter( void* data, int begin, int end )
+{
+	radixSortParms_t* parms = ( radixSortParms_t* )data;
+	for( int block = begin; block < end; block++ )
+	{
+		const int first = ( int )( ( int64 )parms->numSurfs * block / parms->numBlocks );
+		const int last = ( int )( ( int64 )parms->numSurfs * ( block + 1 ) / parms->numBlocks );
+
+		int* offsets = parms->counts[block];
+		for( int i = first; i < last; i++ )
+		{
+			const sortDrawSurf_t& s = parms->src[i];
+			parms->dst[offsets[( s.key >> parms->shift ) & ( SORT_RADIX_SIZE - 1 )]++] = s;
+		}
 	}
+}
 
-	const int64 MAX_LEVELS = 128;
-	int64 lo[MAX_LEVELS];
-	int64 hi[MAX_LEVELS];
+/*
+=================
+R_RadixSortDrawSurfs
 
-	// Keep the top of the stack in registers to avoid load-hit-stores.
-	int64 st_lo = 0;
-	int64 st_hi = numDrawSurfs - 1;
-	int64 level = 0;
+Sorts on the digits that aren't the same for every surface, larger counts split the histogram and
+scatter passes over the job threads. Returns the buffer that holds the sorted surfaces.
+=================
+*/
+static sortDrawSurf_t* R_RadixSortDrawSurfs( sortDrawSurf_t* surfs, sortDrawSurf_t* temp, const int numSurfs )
+{
+	// a digit that is the same for every key doesn't need a pass
+	uint64 differingBits = 0;
+	for( int i = 1; i < numSurfs; i++ )
+	{
+		differingBits |= surfs[i].key ^ surfs[0].key;
+	}
+
+	radixSortParms_t sortParms;
+	radixSortParms_t* parms = &sortParms;
+	parms->numSurfs = numSurfs;
+	parms->numBlocks = ( numSurfs >= SORT_PARALLEL_SURFACES ) ? idMath::ClampInt( 1, SORT_MAX_BLOCKS, numSurfs / ( SORT_PARALLEL_SURFACES / 2 ) ) : 1;
 
-	for( ; ; )
+	for( int pass = 0; pass < SORT_RADIX_PASSES; pass++ )
 	{
-		int64 i = st_lo;
-		int64 j = st_hi;
-		if( j - i >= 4 && level < MAX_LEVELS - 1 )
+		parms->shift = pass * SORT_RADIX_BITS;
+		if( ( ( differingBits >> parms->shift ) & ( SORT_RADIX_SIZE - 1 ) ) == 0 )
 		{
-			uint64 pivot = indices[( i + j ) / 2];
-			do
+			continue;
+		}
+		parms->src = surfs;
+		parms->dst = temp;
+
+		idTaskGraph::ParallelFor( parms->numBlocks, 1, R_RadixHistogram, parms );
+
+		// turn the counts into write offsets, every block writes after the earlier blocks for the same digit
+		int offset = 0;
+		for( int digit = 0; digit < SORT_RADIX_SIZE; digit++ )
+		{
+			for( int block = 0; block < parms->numBlocks; block++ )
 			{
-				while( indices[i] > pivot )
-				{
-					i++;
-				}
-				while( indices[j] < pivot )
-				{
-					j--;
-				}
-				if( i > j )
-				{
-					break;
-				}
-				uint64 h = indices[i];
-				indices[i] = indices[j];
-				indices[j] = h;
+				const int count = parms->counts[block][digit];
+				parms->counts[block][digit] = offset;
+				offset += count;
 			}
-			while( ++i <= --j );
+		}
+
+		idTaskGraph::ParallelFor( parms->numBlocks, 1, R_RadixScatter, parms );
+
+		SwapValues( surfs, temp );
+	}
+	return surfs;
+}
+
+/*
+=================
+R_SortDrawSurfs
+=================
+*/
+static void R_SortDrawSurfs( drawSurf_t** drawSurfs, const int numDrawSurfs )
+{
+#if 1
 
-			// No need for these iterations because we are always sorting unique values.
-			//while ( indices[j] == pivot && st_lo < j ) j--;
-			//while ( indices[i] == pivot && i < st_hi ) i++;
+	if( numDrawSurfs <= 0 )
+	{
+		return;
+	}
+
+	const uint64 startTime = Sys_Microseconds();
+	const bool sortByState = r_sortDrawSurfsByMaterial.GetBool();
 
-			assert( level < MAX_LEVELS - 1 );
-			lo[level] = i;
-			hi[level] = st_hi;
-			st_hi = j;
-			level++;
+	sortDrawSurf_t* surfs = ( sortDrawSurf_t* )R_FrameAlloc( numDrawSurfs * 2 * sizeof( surfs[0] ), FRAME_ALLOC_DRAW_SURFACE_POINTER );
+
+	// sort the draw surfs based on:
+	// 1. sort value (smallest first)
+	// 2. material and skinning for opaque surfaces
+	// 3. depth (largest first)
+	// 4. the order they were added in
+
+	// the depth bounds are calculated in batches of consecutive surfaces that share the same space
+	const int MAX_DEPTH_BATCH = 64;
+	idBounds depthBounds[MAX_DEPTH_BATCH];
+	float depthMin[MAX_DEPTH_BATCH];
+	float depthMax[MAX_DEPTH_BATCH];
+
+	for( int first = 0; first < numDrawSurfs; )
+	{
+		const viewEntity_t* space = drawSurfs[first]->space;
+
+		int last = first;
+		int numBounds = 0;
+		for( ; last < numDrawSurfs && drawSurfs[last]->space == space && numBounds < MAX_DEPTH_BATCH; last++ )
+		{
+			if( drawSurfs[last]->frontEndGeo != NULL )
+			{
+				depthBounds[numBounds++] = drawSurfs[last]->frontEndGeo->bounds;
+			}
 		}
-		else
+
+		if( numBounds > 0 )
 		{
-			for( ; i < j; j-- )
+			SIMDProcessor->DepthBoundsForBounds( depthMin, depthMax, space->mvp, depthBounds, numBounds, true );
+		}
+
+		for( int i = first, b = 0; i < last; i++ )
+		{
+			drawSurf_t* surf = drawSurfs[i];
+
+			// flip the float bits so they sort like unsigned integers, negative sort values included
+			uint32 sort = *( const uint32* )&surf->sort;
+			sort = ( sort & 0x80000000 ) ? ~sort : ( sort | 0x80000000 );
+
+			uint64 dist = 0;
+			if( surf->frontEndGeo != NULL )
 			{
-				int64 m = i;
-				for( int64 k = i + 1; k <= j; k++ )
-				{
-					if( indices[k] < indices[m] )
-					{
-						m = k;
-					}
-				}
-				uint64 h = indices[m];
-				indices[m] = indices[j];
-				indices[j] = h;
+				dist = idMath::Ftoui16( depthMin[b++] * 0xFFFF );
 			}
-			if( --level < 0 )
+			dist = 0xFFFF - dist;
+
+			uint64 key = ( uint64 )sort << 32;
+			if( sortByState && surf->sort == SS_OPAQUE )
+			{
+				key |= ( R_SortStateForDrawSurf( surf ) << 16 ) | dist;
+			}
+			else
 			{
-				break;
+				key |= dist << 16;
 			}
-			st_lo = lo[level];
-			st_hi = hi[level];
+
+			surfs[i].key = key;
+			surfs[i].surf = surf;
 		}
+
+		first = last;
 	}
 
-	drawSurf_t** newDrawSurfs = ( drawSurf_t** ) indices;
-	for( int i = 0; i < numDrawSurfs; i++ )
+	const sortDrawSurf_t* sorted = R_RadixSortDrawSurfs( surfs, surfs + numDrawSurfs, numDrawSurfs );
+
+	// count the material and skinning changes the back end will see
+	int stateChanges = 1;
+	drawSurfs[0] = sorted[0].surf;
+	for( int i = 1; i < numDrawSurfs; i++ )
 	{
-		newDrawSurfs[i] = drawSurfs[numDrawSurfs - ( indices[i] & 0xFFFF )];
+		drawSurfs[i] = sorted[i].surf;
+		if( R_SortStateForDrawSurf( drawSurfs[i] ) != R_SortStateForDrawSurf( drawSurfs[i - 1] ) )
+		{
+			stateChanges++;
+		}
 	}
-	memcpy( drawSurfs, newDrawSurfs, numDrawSurfs * sizeof( drawSurfs[0] ) );
+
+	tr.pc.c_sortedDrawSurfs += numDrawSurfs;
+	tr.pc.c_sortStateChanges += stateChanges;
+	tr.pc.sortMicroSec += Sys_Microseconds() - startTime;
 
 #else
 
@@ -901,85 +901,7 @@ void R_DeriveNormalsAndTangents( srfTriangles_t* tri )
 	vertexTangents.Zero();
 	vertexBitangents.Zero();
 
-	for( int i = 0; i < tri->numIndexes; i += 3 )
-	{
-		const int v0 = tri->indexes[i + 0];
-		const int v1 = tri->indexes[i + 1];
-		const int v2 = tri->indexes[i + 2];
-
-		const idDrawVert* a = tri->verts + v0;
-		const idDrawVert* b = tri->verts + v1;
-		const idDrawVert* c = tri->verts + v2;
-
-		const idVec2 aST = a->GetTexCoord();
-		const idVec2 bST = b->GetTexCoord();
-		const idVec2 cST = c->GetTexCoord();
-
-		float d0[5];
-		d0[0] = b->xyz[0] - a->xyz[0];
-		d0[1] = b->xyz[1] - a->xyz[1];
-		d0[2] = b->xyz[2] - a->xyz[2];
-		d0[3] = bST[0] - aST[0];
-		d0[4] = bST[1] - aST[1];
-
-		float d1[5];
-		d1[0] = c->xyz[0] - a->xyz[0];
-		d1[1] = c->xyz[1] - a->xyz[1];
-		d1[2] = c->xyz[2] - a->xyz[2];
-		d1[3] = cST[0] - aST[0];
-		d1[4] = cST[1] - aST[1];
-
-		idVec3 normal;
-		normal[0] = d1[1] * d0[2] - d1[2] * d0[1];
-		normal[1] = d1[2] * d0[0] - d1[0] * d0[2];
-		normal[2] = d1[0] * d0[1] - d1[1] * d0[0];
-
-		const float f0 = idMath::InvSqrt( normal.x * normal.x + normal.y * normal.y + normal.z * normal.z );
-
-		normal.x *= f0;
-		normal.y *= f0;
-		normal.z *= f0;
-
-		// area sign bit
-		const float area = d0[3] * d1[4] - d0[4] * d1[3];
-		unsigned int signBit = ( *( unsigned int* )&area ) & ( 1 << 31 );
-
-		idVec3 tangent;
-		tangent[0] = d0[0] * d1[4] - d0[4] * d1[0];
-		tangent[1] = d0[1] * d1[4] - d0[4] * d1[1];
-		tangent[2] = d0[2] * d1[4] - d0[4] * d1[2];
-
-		const float f1 = idMath::InvSqrt( tangent.x * tangent.x + tangent.y * tangent.y + tangent.z * tangent.z );
-		*( unsigned int* )&f1 ^= signBit;
-
-		tangent.x *= f1;
-		tangent.y *= f1;
-		tangent.z *= f1;
-
-		idVec3 bitangent;
-		bitangent[0] = d0[3] * d1[0] - d0[0] * d1[3];
-		bitangent[1] = d0[3] * d1[1] - d0[1] * d1[3];
-		bitangent[2] = d0[3] * d1[2] - d0[2] * d1[3];
-
-		const float f2 = idMath::InvSqrt( bitangent.x * bitangent.x + bitangent.y * bitangent.y + bitangent.z * bitangent.z );
-		*( unsigned int* )&f2 ^= signBit;
-
-		bitangent.x *= f2;
-		bitangent.y *= f2;
-		bitangent.z *= f2;
-
-		vertexNormals[v0] += normal;
-		vertexTangents[v0] += tangent;
-		vertexBitangents[v0] += bitangent;
-
-		vertexNormals[v1] += normal;
-		vertexTangents[v1] += tangent;
-		vertexBitangents[v1] += bitangent;
-
-		vertexNormals[v2] += normal;
-		vertexTangents[v2] += tangent;
-		vertexBitangents[v2] += bitangent;
-	}
+	SIMDProcessor->DeriveTangentFrames( vertexNormals.Ptr(), vertexTangents.Ptr(), vertexBitangents.Ptr(), tri->verts, tri->indexes, tri->numIndexes );
 
 	// add the normal of a duplicated vertex to the normal of the first vertex with the same XYZ
 	for( int i = 0; i < tri->numDupVerts; i++ )
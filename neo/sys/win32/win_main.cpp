@@ -556,6 +556,63 @@ bool Sys_IsFileWritable( const char* path )
 	return ( st.st_mode & S_IWRITE ) != 0;
 }
 
+/*
+========================
+Sys_MapFile
+
+Copy on write views share the page cache until a page is written to,
+writes only go to a private copy of that page.
+========================
+*/
+byte* Sys_MapFile( const char* path, int& length )
+{
+	length = 0;
+
+	HANDLE file = CreateFile( path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( file == INVALID_HANDLE_VALUE )
+	{
+		return NULL;
+	}
+
+	LARGE_INTEGER size;
+	if( !GetFileSizeEx( file, &size ) || size.QuadPart <= 0 || size.QuadPart > INT_MAX )
+	{
+		CloseHandle( file );
+		return NULL;
+	}
+
+	// the view keeps the mapping and the file open after the handles are closed
+	HANDLE mapping = CreateFileMapping( file, NULL, PAGE_WRITECOPY, 0, 0, NULL );
+	CloseHandle( file );
+	if( mapping == NULL )
+	{
+		return NULL;
+	}
+
+	void* data = MapViewOfFile( mapping, FILE_MAP_COPY, 0, 0, 0 );
+	CloseHandle( mapping );
+	if( data == NULL )
+	{
+		return NULL;
+	}
+
+	length = ( int )size.QuadPart;
+	return ( byte* )data;
+}
+
+/*
+========================
+Sys_UnmapFile
+========================
+*/
+void Sys_UnmapFile( byte* data, int length )
+{
+	if( data != NULL )
+	{
+		UnmapViewOfFile( data );
+	}
+}
+
 /*
 ========================
 Sys_IsFolder
@@ -571,6 +628,23 @@ sysFolder_t Sys_IsFolder( const char* path )
 	return ( buffer.st_mode & _S_IFDIR ) != 0 ? FOLDER_YES : FOLDER_NO;
 }
 
+/*
+========================
+Sys_FileStat
+========================
+*/
+bool Sys_FileStat( const char* path, ID_TIME_T& timestamp, int& length )
+{
+	struct _stat64 buffer;
+	if( _stat64( path, &buffer ) < 0 || ( buffer.st_mode & _S_IFREG ) == 0 || buffer.st_size > INT_MAX )
+	{
+		return false;
+	}
+	timestamp = buffer.st_mtime;
+	length = ( int )buffer.st_size;
+	return true;
+}
+
 /*
 ==============
 Sys_Cwd
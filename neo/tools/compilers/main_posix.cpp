@@ -39,6 +39,8 @@ If you have questions concerning this license or the applicable additional terms
 #include <dirent.h>
 #include <fnmatch.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 
 #include "imtui/imtui.h"
 #include "imtui/imtui-impl-ncurses.h"
@@ -231,6 +233,56 @@ bool Sys_Rmdir( const char* path )
 	return ( rmdir( path ) == 0 );
 }
 
+/*
+========================
+Sys_MapFile
+
+Private mappings share the page cache until a page is written to,
+writes only go to a private copy of that page.
+========================
+*/
+byte* Sys_MapFile( const char* path, int& length )
+{
+	length = 0;
+
+	int fd = open( path, O_RDONLY );
+	if( fd == -1 )
+	{
+		return NULL;
+	}
+
+	struct stat st;
+	if( fstat( fd, &st ) == -1 || st.st_size <= 0 || st.st_size > INT_MAX )
+	{
+		close( fd );
+		return NULL;
+	}
+
+	// the mapping stays valid after the descriptor is closed
+	void* data = mmap( NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+	close( fd );
+	if( data == MAP_FAILED )
+	{
+		return NULL;
+	}
+
+	length = ( int )st.st_size;
+	return ( byte* )data;
+}
+
+/*
+========================
+Sys_UnmapFile
+========================
+*/
+void Sys_UnmapFile( byte* data, int length )
+{
+	if( data != NULL )
+	{
+		munmap( data, length );
+	}
+}
+
 /*
 ==============
 Sys_EXEPath
@@ -398,6 +450,25 @@ sysFolder_t Sys_IsFolder( const char* path )
 	return ( buffer.st_mode & S_IFDIR ) != 0 ? FOLDER_YES : FOLDER_NO;
 }
 
+/*
+========================
+Sys_FileStat
+========================
+*/
+bool Sys_FileStat( const char* path, ID_TIME_T& timestamp, int& length )
+{
+	struct stat buffer;
+
+	if( stat( path, &buffer ) < 0 || !S_ISREG( buffer.st_mode ) || buffer.st_size > INT_MAX )
+	{
+		return false;
+	}
+
+	timestamp = buffer.st_mtime;
+	length = ( int )buffer.st_size;
+	return true;
+}
+
 const char* Sys_DefaultSavePath()
 {
 	return "";
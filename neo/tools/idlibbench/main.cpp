@@ -0,0 +1,1718 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+#include "precompiled.h"
+#pragma hdrstop
+
+#include "math/Simd_Generic.h"
+#include "math/Simd_SSE.h"
+#include "math/Simd_AVX2.h"
+
+#include <chrono>
+
+/*
+===============================================================================
+
+	idlibbench
+
+	Headless micro-benchmarks for the idLib containers, text parsing,
+	message packing, math, SIMD processors, hashing and compression.
+
+	Every benchmark works on data generated from a fixed seed and runs a
+	fixed number of iterations, so the reported checksums are identical
+	between runs on the same machine and the timings can be compared
+	between commits. Each benchmark is run several times and both the best
+	and the median time per iteration are reported as JSON.
+
+	usage: idlibbench [-o <file.json>] [-r <repeat>] [-f <filter>] [-l]
+
+===============================================================================
+*/
+
+#define BENCH_VERSION			1
+#define BENCH_SEED				0x1d5eed
+#define BENCH_DEFAULT_REPEAT	7
+
+/*
+==============================================================
+
+	idSys
+
+==============================================================
+*/
+
+class idSysBench : public idSys
+{
+public:
+	virtual void			DebugPrintf( VERIFY_FORMAT_STRING const char* fmt, ... )
+	{
+		va_list argptr;
+
+		va_start( argptr, fmt );
+		vfprintf( stderr, fmt, argptr );
+		va_end( argptr );
+	}
+
+	virtual void			DebugVPrintf( const char* fmt, va_list arg )
+	{
+		vfprintf( stderr, fmt, arg );
+	}
+
+	virtual double			GetClockTicks()
+	{
+		return ( double )std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+	}
+
+	virtual double			ClockTicksPerSecond()
+	{
+		return 1000000000.0;
+	}
+
+	virtual cpuid_t			GetProcessorId()
+	{
+#if defined(USE_INTRINSICS_SSE)
+		return ( cpuid_t )( CPUID_GENERIC | CPUID_MMX | CPUID_SSE | CPUID_SSE2 );
+#else
+		return CPUID_GENERIC;
+#endif
+	}
+
+	virtual const char* 	GetProcessorString()
+	{
+		return NULL;
+	}
+	virtual const char* 	FPU_GetState()
+	{
+		return NULL;
+	}
+	virtual bool			FPU_StackIsEmpty()
+	{
+		return false;
+	}
+	virtual void			FPU_SetFTZ( bool enable ) {}
+	virtual void			FPU_SetDAZ( bool enable ) {}
+
+	virtual void			FPU_EnableExceptions( int exceptions ) {}
+
+	virtual bool			LockMemory( void* ptr, int bytes )
+	{
+		return false;
+	}
+	virtual bool			UnlockMemory( void* ptr, int bytes )
+	{
+		return false;
+	}
+
+	virtual int				DLL_Load( const char* dllName )
+	{
+		return 0;
+	}
+	virtual void* 			DLL_GetProcAddress( int dllHandle, const char* procName )
+	{
+		return NULL;
+	}
+	virtual void			DLL_Unload( int dllHandle ) {}
+	virtual void			DLL_GetFileName( const char* baseName, char* dllName, int maxLength ) {}
+
+	virtual sysEvent_t		GenerateMouseButtonEvent( int button, bool down )
+	{
+		sysEvent_t ev;
+		ev.evType = SE_NONE;
+		return ev;
+	}
+	virtual sysEvent_t		GenerateMouseMoveEvent( int deltax, int deltay )
+	{
+		sysEvent_t ev;
+		ev.evType = SE_NONE;
+		return ev;
+	}
+
+	virtual void			OpenURL( const char* url, bool quit ) {}
+	virtual void			StartProcess( const char* exeName, bool quit ) {}
+};
+
+idSysBench			idSysLocal;
+idSys* 				sys = &idSysLocal;
+
+// File.cpp and the idLib sources reference these, the benchmarks never
+// touch the file or cvar systems so they stay NULL
+idCVarSystem* 		cvarSystem = NULL;
+idFileSystem* 		fileSystem = NULL;
+idCVar* 			idCVar::staticVars = NULL;
+
+int Sys_Milliseconds()
+{
+	return ( int )( idSysLocal.GetClockTicks() / 1000000.0 );
+}
+
+ID_TIME_T Sys_FileTimeStamp( idFileHandle fp )
+{
+	return FILE_NOT_FOUND_TIMESTAMP;
+}
+
+/*
+==============================================================
+
+	idCommon
+
+	All console output goes to stderr so stdout only ever
+	contains the JSON report.
+
+==============================================================
+*/
+
+#define BENCH_PRINT( pre )			\
+	va_list argptr;					\
+	va_start( argptr, fmt );		\
+	fprintf( stderr, pre );			\
+	vfprintf( stderr, fmt, argptr );\
+	va_end( argptr )
+
+class idCommonLocal : public idCommon
+{
+public:
+	// Initialize everything.
+	// if the OS allows, pass argc/argv directly (without executable name)
+	// otherwise pass the command line in a single string (without executable name)
+	virtual void				Init( int argc, const char* const* argv, const char* cmdline ) {}
+
+	// Shuts down everything.
+	virtual void				Shutdown() {}
+	virtual bool				IsShuttingDown() const
+	{
+		return false;
+	};
+
+	virtual	void				CreateMainMenu() {}
+
+	// Shuts down everything.
+	virtual void				Quit() {}
+
+	// Returns true if common initialization is complete.
+	virtual bool				IsInitialized() const
+	{
+		return true;
+	};
+
+	// Called repeatedly as the foreground thread for rendering and game logic.
+	virtual void				Frame() {}
+
+	// Redraws the screen, handling games, guis, console, etc
+	// in a modal manner outside the normal frame loop
+	virtual void				UpdateScreen( bool captureToImage, bool releaseMouse = true ) {}
+
+	virtual void				UpdateLevelLoadPacifier() {}
+	virtual void				LoadPacifierInfo( VERIFY_FORMAT_STRING const char* fmt, ... ) {}
+	virtual void				LoadPacifierProgressTotal( int total ) {}
+	virtual void				LoadPacifierProgressIncrement( int step ) {}
+	virtual bool				LoadPacifierRunning()
+	{
+		return false;
+	}
+
+
+	// Checks for and removes command line "+set var arg" constructs.
+	// If match is NULL, all set commands will be executed, otherwise
+	// only a set with the exact name.
+	virtual void				StartupVariable( const char* match ) {}
+
+	// Begins redirection of console output to the given buffer.
+	virtual void				BeginRedirect( char* buffer, int buffersize, void ( *flush )( const char* ) ) {}
+
+	// Stops redirection of console output.
+	virtual void				EndRedirect() {}
+
+	// Update the screen with every message printed.
+	virtual void				SetRefreshOnPrint( bool set )
+{}
+
+	virtual void			Printf( const char* fmt, ... )
+	{
+		BENCH_PRINT( "" );
+	}
+
+	virtual void			VPrintf( const char* fmt, va_list arg )
+	{
+		vfprintf( stderr, fmt, arg );
+	}
+
+	virtual void			DPrintf( const char* fmt, ... ) {}
+
+	virtual void			VerbosePrintf( const char* fmt, ... ) {}
+
+	virtual void			Warning( const char* fmt, ... )
+	{
+		BENCH_PRINT( "WARNING: " );
+		fprintf( stderr, "\n" );
+	}
+
+	virtual void			DWarning( const char* fmt, ... ) {}
+
+	// Prints all queued warnings.
+	virtual void				PrintWarnings() {}
+
+	// Removes all queued warnings.
+	virtual void				ClearWarnings( const char* reason ) {}
+
+	virtual void			Error( const char* fmt, ... )
+	{
+		BENCH_PRINT( "ERROR: " );
+		fprintf( stderr, "\n" );
+		exit( 1 );
+	}
+
+	virtual void			FatalError( const char* fmt, ... )
+	{
+		BENCH_PRINT( "FATAL ERROR: " );
+		fprintf( stderr, "\n" );
+		exit( 1 );
+	}
+
+	// Returns key bound to the command
+	virtual const char* KeysFromBinding( const char* bind )
+	{
+		return NULL;
+	};
+
+	// Returns the binding bound to the key
+	virtual const char* BindingFromKey( const char* key )
+	{
+		return NULL;
+	};
+
+	// Directly sample a button.
+	virtual int					ButtonState( int key )
+	{
+		return 0;
+	};
+
+	// Directly sample a keystate.
+	virtual int					KeyState( int key )
+	{
+		return 0;
+	};
+
+	// Returns true if a multiplayer game is running.
+	// CVars and commands are checked differently in multiplayer mode.
+	virtual bool				IsMultiplayer()
+	{
+		return false;
+	};
+	virtual bool				IsServer()
+	{
+		return false;
+	};
+	virtual bool				IsClient()
+	{
+		return false;
+	};
+
+	// Returns true if the player has ever enabled the console
+	virtual bool				GetConsoleUsed()
+	{
+		return false;
+	};
+
+	// Returns the rate (in ms between snaps) that we want to generate snapshots
+	virtual int					GetSnapRate()
+	{
+		return 0;
+	};
+
+	virtual void				NetReceiveReliable( int peer, int type, idBitMsg& msg ) { };
+	virtual void				NetReceiveSnapshot( class idSnapShot& ss ) { };
+	virtual void				NetReceiveUsercmds( int peer, idBitMsg& msg ) { };
+
+	// Processes the given event.
+	virtual	bool				ProcessEvent( const sysEvent_t* event )
+	{
+		return false;
+	};
+
+	virtual bool				LoadGame( const char* saveName )
+	{
+		return false;
+	};
+	virtual bool				SaveGame( const char* saveName )
+	{
+		return false;
+	};
+
+	virtual idGame* Game()
+	{
+		return NULL;
+	};
+	virtual idRenderWorld* RW()
+	{
+		return NULL;
+	};
+	virtual idSoundWorld* SW()
+	{
+		return NULL;
+	};
+	virtual idSoundWorld* MenuSW()
+	{
+		return NULL;
+	};
+	virtual idSession* Session()
+	{
+		return NULL;
+	};
+	virtual idCommonDialog& Dialog()
+	{
+		static idCommonDialog useless;
+		return useless;
+	};
+
+	virtual void				OnSaveCompleted( idSaveLoadParms& parms ) {}
+	virtual void				OnLoadCompleted( idSaveLoadParms& parms ) {}
+	virtual void				OnLoadFilesCompleted( idSaveLoadParms& parms ) {}
+	virtual void				OnEnumerationCompleted( idSaveLoadParms& parms ) {}
+	virtual void				OnDeleteCompleted( idSaveLoadParms& parms ) {}
+	virtual void				TriggerScreenWipe( const char* _wipeMaterial, bool hold ) {}
+
+	virtual void				OnStartHosting( idMatchParameters& parms ) {}
+
+	virtual int					GetGameFrame()
+	{
+		return 0;
+	};
+
+	virtual void				LaunchExternalTitle( int titleIndex, int device, const lobbyConnectInfo_t* const connectInfo ) { };
+
+	virtual void				InitializeMPMapsModes() { };
+	virtual const idStrList& GetModeList() const
+	{
+		static idStrList useless;
+		return useless;
+	};
+	virtual const idStrList& GetModeDisplayList() const
+	{
+		static idStrList useless;
+		return useless;
+	};
+	virtual const idList<mpMap_t>& GetMapList() const
+	{
+		static idList<mpMap_t> useless;
+		return useless;
+	};
+
+	virtual void				ResetPlayerInput( int playerIndex ) {}
+
+	virtual bool				JapaneseCensorship() const
+	{
+		return false;
+	};
+
+	virtual void				QueueShowShell() { };		// Will activate the shell on the next frame.
+	virtual void				InitTool( const toolFlag_t, const idDict*, idEntity* ) {}
+
+	virtual void				LoadPacifierBinarizeFilename( const char* filename, const char* reason ) {}
+	virtual void				LoadPacifierBinarizeInfo( const char* info ) {}
+	virtual void				LoadPacifierBinarizeMiplevel( int level, int maxLevel ) {}
+	virtual void				LoadPacifierBinarizeProgress( float progress ) {}
+	virtual void				LoadPacifierBinarizeEnd() { };
+	virtual void				LoadPacifierBinarizeProgressTotal( int total ) {}
+	virtual void				LoadPacifierBinarizeProgressIncrement( int step ) {}
+
+	virtual void				DmapPacifierFilename( const char* filename, const char* reason ) {}
+	virtual void				DmapPacifierInfo( VERIFY_FORMAT_STRING const char* fmt, ... ) {}
+	virtual void				DmapPacifierCompileProgressTotal( int total ) {}
+	virtual void				DmapPacifierCompileProgressIncrement( int step ) {}
+};
+idCommonLocal		commonLocal;
+idCommon* 			common = &commonLocal;
+
+/*
+==============================================================
+
+	benchmark harness
+
+==============================================================
+*/
+
+// returns a checksum of the work done so the compiler can't discard it
+// and so a run can be compared against another one for correctness
+typedef unsigned int ( *benchFunc_t )( int iterations );
+
+struct benchmark_t
+{
+	const char* 		name;
+	benchFunc_t			func;
+	int					iterations;
+};
+
+struct benchResult_t
+{
+	idStr				name;
+	int					iterations;
+	double				bestNsec;
+	double				medianNsec;
+	unsigned int		checksum;
+	bool				stable;			// same checksum on every run
+};
+
+static idSIMDProcessor* 	benchSIMD;		// processor used by the simd benchmarks
+
+/*
+========================
+Bench_Nanoseconds
+========================
+*/
+static double Bench_Nanoseconds()
+{
+	return idLib::sys->GetClockTicks() * ( 1000000000.0 / idLib::sys->ClockTicksPerSecond() );
+}
+
+/*
+========================
+Bench_HashFloats
+========================
+*/
+static unsigned int Bench_HashFloats( const float* data, int count )
+{
+	return CRC32_BlockChecksum( data, count * sizeof( float ) );
+}
+
+/*
+========================
+Bench_Run
+========================
+*/
+static void Bench_Run( const char* name, benchFunc_t func, int iterations, int repeat, idList<benchResult_t>& results )
+{
+	idList<double> times;
+	times.SetNum( repeat );
+
+	// warm up caches and lazily allocated pools
+	unsigned int checksum = func( iterations );
+	bool stable = true;
+
+	for( int i = 0; i < repeat; i++ )
+	{
+		const double start = Bench_Nanoseconds();
+		const unsigned int sum = func( iterations );
+		times[i] = ( Bench_Nanoseconds() - start ) / iterations;
+		stable &= ( sum == checksum );
+	}
+
+	times.SortWithTemplate( idSort_Quick<double, idSort_QuickDefault<double> >() );
+
+	benchResult_t& result = results.Alloc();
+	result.name = name;
+	result.iterations = iterations;
+	result.bestNsec = times[0];
+	result.medianNsec = times[repeat / 2];
+	result.checksum = checksum;
+	result.stable = stable;
+
+	idLib::common->Printf( "%-40s %12.1f ns %12.1f ns  %08x%s\n", name, result.bestNsec, result.medianNsec, checksum, stable ? "" : " UNSTABLE" );
+}
+
+/*
+==============================================================
+
+	containers
+
+==============================================================
+*/
+
+static const int BENCH_NUM_ELEMENTS = 4096;
+static const int BENCH_NUM_KEYS = 256;
+static const int BENCH_NUM_NAMES = 4096;
+
+static idList<int>		benchInts;
+static idStrList		benchKeys;
+static idStrList		benchNames;		// cvar and decl like names for the hash lookups
+static idStr			benchText;
+static idStr			benchMapText;	// map files given with -m or a generated map
+
+/*
+========================
+Bench_InitData
+========================
+*/
+static void Bench_InitData()
+{
+	idRandom rnd( BENCH_SEED );
+
+	benchInts.SetNum( BENCH_NUM_ELEMENTS );
+	for( int i = 0; i < BENCH_NUM_ELEMENTS; i++ )
+	{
+		benchInts[i] = rnd.RandomInt();
+	}
+
+	static const char* words[] = { "model", "origin", "angle", "target", "light", "sound", "skin", "team", "spawn", "health", "speed", "wait" };
+	benchKeys.SetNum( BENCH_NUM_KEYS );
+	for( int i = 0; i < BENCH_NUM_KEYS; i++ )
+	{
+		benchKeys[i] = va( "%s_%s%d", words[rnd.RandomInt( 12 )], words[rnd.RandomInt( 12 )], i );
+	}
+
+	static const char* folders[] = { "models/mapobjects", "textures/base_wall", "sound/player", "gui/", "r_", "g_", "sys_" };
+	benchNames.SetNum( BENCH_NUM_NAMES );
+	for( int i = 0; i < BENCH_NUM_NAMES; i++ )
+	{
+		benchNames[i] = va( "%s%s_%s%d", folders[rnd.RandomInt( 7 )], words[rnd.RandomInt( 12 )], words[rnd.RandomInt( 12 )], i );
+	}
+
+	// a decl-like block of text for the lexer and parser
+	benchText.Clear();
+	benchText += "#define SCALE 2\n";
+	for( int i = 0; i < 256; i++ )
+	{
+		benchText += va( "entityDef bench_%d {\n", i );
+		for( int j = 0; j < 8; j++ )
+		{
+			const idStr& key = benchKeys[( i * 8 + j ) % BENCH_NUM_KEYS];
+			benchText += va( "\t\"%s\"\t\"%d %.3f %.3f\"\t// comment %d\n", key.c_str(), rnd.RandomInt( 1000 ), rnd.CRandomFloat() * 100.0f, rnd.RandomFloat(), j );
+		}
+		benchText += va( "\tscale ( SCALE * %d + 1 )\n}\n", i );
+	}
+}
+
+/*
+========================
+Bench_LoadMapText
+
+Appends a map file to the text of the map benchmarks.
+========================
+*/
+static bool Bench_LoadMapText( const char* fileName )
+{
+	FILE* f = fopen( fileName, "rb" );
+	if( f == NULL )
+	{
+		return false;
+	}
+	fseek( f, 0, SEEK_END );
+	const int length = ftell( f );
+	fseek( f, 0, SEEK_SET );
+
+	idTempArray<char> text( length + 1 );
+	const bool ok = ( fread( text.Ptr(), 1, length, f ) == ( size_t )length );
+	fclose( f );
+	text[length] = '\0';
+
+	if( ok )
+	{
+		benchMapText.Append( text.Ptr(), length );
+		benchMapText += "\n";
+	}
+	return ok;
+}
+
+/*
+========================
+Bench_InitMapText
+
+Without map files a map with the same token mix is generated, brushes with
+long runs of numbers and material paths, patches and entities with key/values.
+========================
+*/
+static void Bench_InitMapText()
+{
+	if( benchMapText.Length() > 0 )
+	{
+		return;
+	}
+
+	idRandom rnd( BENCH_SEED );
+
+	benchMapText += "Version 3\n// entity 0\n{\n\"classname\" \"worldspawn\"\n";
+	for( int i = 0; i < 1024; i++ )
+	{
+		benchMapText += va( "// primitive %d\n{\n brushDef3\n {\n", i );
+		for( int j = 0; j < 6; j++ )
+		{
+			benchMapText += va( "  ( %d %d %d %d ) ( ( 0.0078125 0 %.6f ) ( 0 0.0078125 %.6f ) ) \"textures/base_wall/%s_%d\" 0 0 0\n",
+								rnd.RandomInt( 3 ) - 1, rnd.RandomInt( 3 ) - 1, rnd.RandomInt( 3 ) - 1, rnd.RandomInt( 4096 ) - 2048, rnd.CRandomFloat(), rnd.CRandomFloat(), benchKeys[rnd.RandomInt( BENCH_NUM_KEYS )].c_str(), j );
+		}
+		benchMapText += " }\n}\n";
+	}
+	for( int i = 0; i < 128; i++ )
+	{
+		benchMapText += va( "// primitive %d\n{\n patchDef2\n {\n  \"textures/base_trim/%s\"\n  ( 3 3 0 0 0 )\n(\n", 1024 + i, benchKeys[i].c_str() );
+		for( int j = 0; j < 3; j++ )
+		{
+			benchMapText += "  ( ";
+			for( int k = 0; k < 3; k++ )
+			{
+				benchMapText += va( "( %.6f %.6f %.6f %.6f %.6f ) ", rnd.CRandomFloat() * 1024.0f, rnd.CRandomFloat() * 1024.0f, rnd.CRandomFloat() * 1024.0f, rnd.RandomFloat(), rnd.RandomFloat() );
+			}
+			benchMapText += ")\n";
+		}
+		benchMapText += ")\n }\n}\n";
+	}
+	benchMapText += "}\n";
+	for( int i = 0; i < 512; i++ )
+	{
+		benchMapText += va( "// entity %d\n{\n\"classname\" \"func_static\"\n\"name\" \"func_static_%d\"\n\"origin\" \"%.1f %.1f %.1f\"\n\"model\" \"models/mapobjects/%s.lwo\"\n}\n",
+							i + 1, i, rnd.CRandomFloat() * 4096.0f, rnd.CRandomFloat() * 4096.0f, rnd.CRandomFloat() * 512.0f, benchNames[i].c_str() );
+	}
+}
+
+static unsigned int Bench_HeapAllocFree( int iterations )
+{
+	void* blocks[256];
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		for( int i = 0; i < 256; i++ )
+		{
+			blocks[i] = Mem_Alloc( 8 + ( benchInts[i] & 255 ), TAG_IDLIB );
+		}
+		for( int i = 0; i < 256; i++ )
+		{
+			sum += ( ( uintptr_t )blocks[i] & 15 ) == 0;
+			Mem_Free( blocks[i] );
+		}
+	}
+	return sum;
+}
+
+static unsigned int Bench_ListAppend( int iterations )
+{
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		idList<int> list;
+		for( int i = 0; i < BENCH_NUM_ELEMENTS; i++ )
+		{
+			list.Append( benchInts[i] );
+		}
+		sum += list.Num();
+	}
+	return sum;
+}
+
+static unsigned int Bench_ListSort( int iterations )
+{
+	unsigned int sum = 0;
+	idList<int> list;
+	for( int it = 0; it < iterations; it++ )
+	{
+		list = benchInts;
+		list.SortWithTemplate( idSort_Quick<int, idSort_QuickDefault<int> >() );
+		sum += list[it % BENCH_NUM_ELEMENTS];
+	}
+	return sum;
+}
+
+static unsigned int Bench_ListFindIndex( int iterations )
+{
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		sum += benchInts.FindIndex( benchInts[( it * 257 ) % BENCH_NUM_ELEMENTS] );
+	}
+	return sum;
+}
+
+static unsigned int Bench_HashIndexAddFind( int iterations )
+{
+	unsigned int sum = 0;
+	idHashIndex hash;
+	for( int it = 0; it < iterations; it++ )
+	{
+		hash.Clear();
+		for( int i = 0; i < BENCH_NUM_KEYS; i++ )
+		{
+			hash.Add( hash.GenerateKey( benchKeys[i], false ), i );
+		}
+		for( int i = 0; i < BENCH_NUM_KEYS; i++ )
+		{
+			const char* key = benchKeys[( i * 7 ) % BENCH_NUM_KEYS];
+			for( int j = hash.First( hash.GenerateKey( key, false ) ); j != -1; j = hash.Next( j ) )
+			{
+				if( benchKeys[j].Icmp( key ) == 0 )
+				{
+					sum += j;
+					break;
+				}
+			}
+		}
+	}
+	return sum;
+}
+
+static unsigned int Bench_HashIndexLookup( int iterations )
+{
+	// same default table size as the cvar and decl hashes
+	idHashIndex hash;
+	for( int i = 0; i < BENCH_NUM_NAMES; i++ )
+	{
+		hash.Add( hash.GenerateKey( benchNames[i], false ), i );
+	}
+
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		for( int i = 0; i < BENCH_NUM_NAMES; i++ )
+		{
+			const char* name = benchNames[( i * 97 ) % BENCH_NUM_NAMES];
+			for( int j = hash.First( hash.GenerateKey( name, false ) ); j != -1; j = hash.Next( j ) )
+			{
+				if( benchNames[j].Icmp( name ) == 0 )
+				{
+					sum += j;
+					break;
+				}
+			}
+		}
+	}
+	return sum;
+}
+
+static unsigned int Bench_FlatHashIndexLookup( int iterations )
+{
+	idFlatHashIndex hash;
+	for( int i = 0; i < BENCH_NUM_NAMES; i++ )
+	{
+		hash.Add( hash.GenerateKey( benchNames[i], false ), i );
+	}
+
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		for( int i = 0; i < BENCH_NUM_NAMES; i++ )
+		{
+			const char* name = benchNames[( i * 97 ) % BENCH_NUM_NAMES];
+			idFlatHashIndex::iterator_t iter;
+			for( int j = hash.First( hash.GenerateKey( name, false ), iter ); j != -1; j = hash.Next( iter ) )
+			{
+				if( benchNames[j].Icmp( name ) == 0 )
+				{
+					sum += j;
+					break;
+				}
+			}
+		}
+	}
+	return sum;
+}
+
+static unsigned int Bench_FlatHashIndexAddFind( int iterations )
+{
+	unsigned int sum = 0;
+	idFlatHashIndex hash;
+	for( int it = 0; it < iterations; it++ )
+	{
+		hash.Clear();
+		for( int i = 0; i < BENCH_NUM_KEYS; i++ )
+		{
+			hash.Add( hash.GenerateKey( benchKeys[i], false ), i );
+		}
+		for( int i = 0; i < BENCH_NUM_KEYS; i++ )
+		{
+			const char* key = benchKeys[( i * 7 ) % BENCH_NUM_KEYS];
+			idFlatHashIndex::iterator_t iter;
+			for( int j = hash.First( hash.GenerateKey( key, false ), iter ); j != -1; j = hash.Next( iter ) )
+			{
+				if( benchKeys[j].Icmp( key ) == 0 )
+				{
+					sum += j;
+					break;
+				}
+			}
+		}
+	}
+	return sum;
+}
+
+static unsigned int Bench_DictSetGet( int iterations )
+{
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		idDict dict;
+		for( int i = 0; i < 64; i++ )
+		{
+			dict.SetInt( benchKeys[i], i );
+		}
+		for( int i = 0; i < 64; i++ )
+		{
+			sum += dict.GetInt( benchKeys[( i * 5 ) % 64] );
+		}
+	}
+	return sum;
+}
+
+static void Bench_FillSpawnDict( idDict& dict )
+{
+	for( int i = 0; i < 32; i++ )
+	{
+		if( i & 1 )
+		{
+			dict.SetVector( benchKeys[i], idVec3( i, i * 0.5f, -i ) );
+		}
+		else
+		{
+			dict.SetInt( benchKeys[i], i );
+		}
+	}
+}
+
+static unsigned int Bench_DictGetString( int iterations )
+{
+	idDict dict;
+	Bench_FillSpawnDict( dict );
+
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		for( int i = 0; i < 32; i += 2 )
+		{
+			sum += dict.GetInt( benchKeys[i] );
+			sum += ( unsigned int )dict.GetFloat( benchKeys[i] );
+			sum += ( unsigned int )dict.GetVector( benchKeys[i + 1] ).y;
+		}
+	}
+	return sum;
+}
+
+static unsigned int Bench_DictGetKeyHandle( int iterations )
+{
+	idDict dict;
+	Bench_FillSpawnDict( dict );
+
+	idDictKey* keys[32];
+	for( int i = 0; i < 32; i++ )
+	{
+		keys[i] = new idDictKey( benchKeys[i] );
+	}
+
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		for( int i = 0; i < 32; i += 2 )
+		{
+			sum += dict.GetInt( *keys[i] );
+			sum += ( unsigned int )dict.GetFloat( *keys[i] );
+			sum += ( unsigned int )dict.GetVector( *keys[i + 1] ).y;
+		}
+	}
+
+	for( int i = 0; i < 32; i++ )
+	{
+		delete keys[i];
+	}
+	return sum;
+}
+
+static unsigned int Bench_DictCopy( int iterations )
+{
+	idDict source;
+	for( int i = 0; i < 64; i++ )
+	{
+		source.SetInt( benchKeys[i], i );
+	}
+
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		idDict dict;
+		dict.Copy( source );
+		sum += dict.GetNumKeyVals();
+	}
+	return sum;
+}
+
+static unsigned int Bench_StrPoolAllocFree( int iterations )
+{
+	unsigned int sum = 0;
+	idStrPool pool;
+	idList<const idPoolStr*> strings;
+	strings.SetNum( BENCH_NUM_KEYS );
+	for( int it = 0; it < iterations; it++ )
+	{
+		for( int i = 0; i < BENCH_NUM_KEYS; i++ )
+		{
+			strings[i] = pool.AllocString( benchKeys[( i * 3 ) % BENCH_NUM_KEYS] );
+		}
+		sum += pool.Num();
+		for( int i = 0; i < BENCH_NUM_KEYS; i++ )
+		{
+			pool.FreeString( strings[i] );
+		}
+	}
+	return sum;
+}
+
+/*
+==============================================================
+
+	text parsing
+
+==============================================================
+*/
+
+static unsigned int Bench_LexerTokens( int iterations )
+{
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		idLexer lexer( LEXFL_NOERRORS | LEXFL_NOWARNINGS | LEXFL_NOFATALERRORS | LEXFL_ALLOWPATHNAMES );
+		lexer.LoadMemory( benchText.c_str(), benchText.Length(), "bench" );
+		idToken token;
+		while( lexer.ReadToken( &token ) )
+		{
+			sum += token.Length();
+		}
+	}
+	return sum;
+}
+
+static unsigned int Bench_ParserTokens( int iterations )
+{
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		idParser parser( LEXFL_NOERRORS | LEXFL_NOWARNINGS | LEXFL_NOFATALERRORS | LEXFL_ALLOWPATHNAMES );
+		parser.LoadMemory( benchText.c_str(), benchText.Length(), "bench" );
+		idToken token;
+		while( parser.ReadToken( &token ) )
+		{
+			sum += token.Length();
+		}
+	}
+	return sum;
+}
+
+static unsigned int Bench_LexMap( int iterations )
+{
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		// the flags idMapFile parses with
+		idLexer lexer( LEXFL_NOSTRINGCONCAT | LEXFL_NOSTRINGESCAPECHARS | LEXFL_ALLOWPATHNAMES | LEXFL_NOERRORS | LEXFL_NOWARNINGS | LEXFL_NOFATALERRORS );
+		lexer.LoadMemory( benchMapText.c_str(), benchMapText.Length(), "bench.map" );
+		idToken token;
+		while( lexer.ReadToken( &token ) )
+		{
+			sum = sum * 31 + idStr::Hash( token.c_str() ) + token.line;
+		}
+	}
+	return sum;
+}
+
+static unsigned int Bench_LexerMap( int iterations )
+{
+	idLexer::SetFastScan( true );
+	return Bench_LexMap( iterations );
+}
+
+static unsigned int Bench_LexerMapScalar( int iterations )
+{
+	idLexer::SetFastScan( false );
+	const unsigned int sum = Bench_LexMap( iterations );
+	idLexer::SetFastScan( true );
+	return sum;
+}
+
+static unsigned int Bench_DictParse( int iterations )
+{
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		idParser parser( LEXFL_NOERRORS | LEXFL_NOWARNINGS | LEXFL_NOFATALERRORS | LEXFL_ALLOWPATHNAMES );
+		parser.LoadMemory( benchText.c_str(), benchText.Length(), "bench" );
+		idToken token;
+		while( parser.ReadToken( &token ) )
+		{
+			if( token == "{" )
+			{
+				parser.UnreadToken( &token );
+				idDict dict;
+				dict.Parse( parser );
+				sum += dict.GetNumKeyVals();
+			}
+		}
+	}
+	return sum;
+}
+
+/*
+==============================================================
+
+	messages
+
+==============================================================
+*/
+
+static unsigned int Bench_BitMsgWriteRead( int iterations )
+{
+	byte buffer[16384];
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		idBitMsg msg;
+		msg.InitWrite( buffer, sizeof( buffer ) );
+		for( int i = 0; i < 1024; i++ )
+		{
+			const int numBits = 1 + ( i % 30 );
+			msg.WriteBits( benchInts[i] & ( ( 1 << numBits ) - 1 ), numBits );
+			msg.WriteDeltaLong( benchInts[i], benchInts[i + 1] );
+		}
+		msg.WriteFloat( 1.5f );
+		msg.WriteString( benchKeys[it % BENCH_NUM_KEYS] );
+
+		msg.BeginReading();
+		for( int i = 0; i < 1024; i++ )
+		{
+			sum += msg.ReadBits( 1 + ( i % 30 ) );
+			sum += msg.ReadDeltaLong( benchInts[i] );
+		}
+		sum += msg.GetSize();
+	}
+	return sum;
+}
+
+/*
+==============================================================
+
+	math
+
+==============================================================
+*/
+
+static const int BENCH_NUM_VECTORS = 1024;
+
+static unsigned int Bench_Vec3Normalize( int iterations )
+{
+	idVec3 v[BENCH_NUM_VECTORS];
+	for( int i = 0; i < BENCH_NUM_VECTORS; i++ )
+	{
+		v[i].Set( ( benchInts[i * 3 + 0] & 1023 ) + 1.0f, ( benchInts[i * 3 + 1] & 1023 ) - 512.0f, ( benchInts[i * 3 + 2] & 1023 ) - 512.0f );
+	}
+
+	float sum = 0.0f;
+	for( int it = 0; it < iterations; it++ )
+	{
+		for( int i = 0; i < BENCH_NUM_VECTORS; i++ )
+		{
+			idVec3 n = v[i];
+			sum += n.Normalize();
+		}
+	}
+	return Bench_HashFloats( &sum, 1 );
+}
+
+static unsigned int Bench_Mat3Multiply( int iterations )
+{
+	idMat3 m[64];
+	idRandom rnd( BENCH_SEED );
+	for( int i = 0; i < 64; i++ )
+	{
+		m[i] = idAngles( rnd.CRandomFloat() * 180.0f, rnd.CRandomFloat() * 180.0f, rnd.CRandomFloat() * 180.0f ).ToMat3();
+	}
+
+	idMat3 r = mat3_identity;
+	for( int it = 0; it < iterations; it++ )
+	{
+		for( int i = 0; i < 64; i++ )
+		{
+			r = r * m[i];
+		}
+		r.OrthoNormalizeSelf();
+	}
+	return Bench_HashFloats( r.ToFloatPtr(), 9 );
+}
+
+static unsigned int Bench_Mat4Inverse( int iterations )
+{
+	idMat4 m[64];
+	idRandom rnd( BENCH_SEED );
+	for( int i = 0; i < 64; i++ )
+	{
+		m[i] = idMat4( idAngles( rnd.CRandomFloat() * 180.0f, rnd.CRandomFloat() * 180.0f, 0.0f ).ToMat3(), idVec3( rnd.CRandomFloat(), rnd.CRandomFloat(), rnd.CRandomFloat() ) );
+	}
+
+	float sum = 0.0f;
+	for( int it = 0; it < iterations; it++ )
+	{
+		for( int i = 0; i < 64; i++ )
+		{
+			idMat4 inv = m[i].Inverse();
+			sum += inv[0][3];
+		}
+	}
+	return Bench_HashFloats( &sum, 1 );
+}
+
+static unsigned int Bench_QuatSlerp( int iterations )
+{
+	idQuat q[64];
+	idRandom rnd( BENCH_SEED );
+	for( int i = 0; i < 64; i++ )
+	{
+		q[i] = idAngles( rnd.CRandomFloat() * 180.0f, rnd.CRandomFloat() * 180.0f, rnd.CRandomFloat() * 180.0f ).ToQuat();
+	}
+
+	idQuat r;
+	float sum = 0.0f;
+	for( int it = 0; it < iterations; it++ )
+	{
+		for( int i = 0; i < 63; i++ )
+		{
+			r.Slerp( q[i], q[i + 1], ( i & 15 ) * ( 1.0f / 16.0f ) );
+			sum += r.w;
+		}
+	}
+	return Bench_HashFloats( &sum, 1 );
+}
+
+static unsigned int Bench_MathSinCos( int iterations )
+{
+	float sum = 0.0f;
+	for( int it = 0; it < iterations; it++ )
+	{
+		for( int i = 0; i < BENCH_NUM_VECTORS; i++ )
+		{
+			float s, c;
+			idMath::SinCos( i * ( idMath::TWO_PI / BENCH_NUM_VECTORS ), s, c );
+			sum += s * c + idMath::Sqrt( ( float )i );
+		}
+	}
+	return Bench_HashFloats( &sum, 1 );
+}
+
+/*
+==============================================================
+
+	simd
+
+	Run once for every processor the CPU supports, the data is
+	shared so the checksums of the different processors should
+	only differ by floating point rounding.
+
+==============================================================
+*/
+
+static const int BENCH_NUM_JOINTS = 110;
+static const int BENCH_NUM_VERTS = 2048;
+static const int BENCH_NUM_INDEXES = 3 * 3072;
+static const int BENCH_NUM_BOUNDS = 512;
+
+static idJointQuat*		benchJointQuats;
+static idJointQuat*		benchBlendQuats;
+static idJointMat*		benchJointMats;
+static int				benchJointIndex[BENCH_NUM_JOINTS];
+static int				benchJointParents[BENCH_NUM_JOINTS];
+static idDrawVert*		benchVerts;
+static triIndex_t*		benchIndexes;
+static idVec3*			benchTangents[3];
+static idBounds*		benchBounds;
+static idPlane*			benchPlanes;
+static float*			benchFloats[2];
+static byte*			benchCulled;
+static idRenderMatrix	benchMVP;
+
+/*
+========================
+Bench_InitSIMDData
+========================
+*/
+static void Bench_InitSIMDData()
+{
+	idRandom rnd( BENCH_SEED );
+
+	benchJointQuats = ( idJointQuat* )Mem_Alloc16( BENCH_NUM_JOINTS * sizeof( idJointQuat ), TAG_MATH );
+	benchBlendQuats = ( idJointQuat* )Mem_Alloc16( BENCH_NUM_JOINTS * sizeof( idJointQuat ), TAG_MATH );
+	benchJointMats = ( idJointMat* )Mem_Alloc16( BENCH_NUM_JOINTS * sizeof( idJointMat ), TAG_MATH );
+	for( int i = 0; i < BENCH_NUM_JOINTS; i++ )
+	{
+		benchJointQuats[i].q = idAngles( rnd.CRandomFloat() * 180.0f, rnd.CRandomFloat() * 180.0f, rnd.CRandomFloat() * 180.0f ).ToQuat();
+		benchJointQuats[i].t.Set( rnd.CRandomFloat(), rnd.CRandomFloat(), rnd.CRandomFloat() );
+		benchJointQuats[i].w = 0.0f;
+		benchBlendQuats[i].q = idAngles( rnd.CRandomFloat() * 180.0f, rnd.CRandomFloat() * 180.0f, rnd.CRandomFloat() * 180.0f ).ToQuat();
+		benchBlendQuats[i].t.Set( rnd.CRandomFloat(), rnd.CRandomFloat(), rnd.CRandomFloat() );
+		benchBlendQuats[i].w = 0.0f;
+		benchJointIndex[i] = i;
+		benchJointParents[i] = ( i > 0 ) ? ( i - 1 ) / 2 : -1;
+	}
+
+	benchVerts = ( idDrawVert* )Mem_Alloc16( BENCH_NUM_VERTS * sizeof( idDrawVert ), TAG_MATH );
+	for( int i = 0; i < BENCH_NUM_VERTS; i++ )
+	{
+		benchVerts[i].Clear();
+		benchVerts[i].xyz.Set( rnd.CRandomFloat() * 100.0f, rnd.CRandomFloat() * 100.0f, rnd.CRandomFloat() * 100.0f );
+		benchVerts[i].SetTexCoord( rnd.RandomFloat(), rnd.RandomFloat() );
+	}
+
+	benchIndexes = ( triIndex_t* )Mem_Alloc16( BENCH_NUM_INDEXES * sizeof( triIndex_t ), TAG_MATH );
+	for( int i = 0; i < BENCH_NUM_INDEXES; i += 3 )
+	{
+		const int v = ( i / 3 ) % ( BENCH_NUM_VERTS - 2 );
+		benchIndexes[i + 0] = v;
+		benchIndexes[i + 1] = v + 1;
+		benchIndexes[i + 2] = v + 2;
+	}
+
+	for( int i = 0; i < 3; i++ )
+	{
+		benchTangents[i] = ( idVec3* )Mem_Alloc16( BENCH_NUM_VERTS * sizeof( idVec3 ), TAG_MATH );
+	}
+
+	benchBounds = ( idBounds* )Mem_Alloc16( BENCH_NUM_BOUNDS * sizeof( idBounds ), TAG_MATH );
+	benchPlanes = ( idPlane* )Mem_Alloc16( BENCH_NUM_BOUNDS * sizeof( idPlane ), TAG_MATH );
+	for( int i = 0; i < BENCH_NUM_BOUNDS; i++ )
+	{
+		const idVec3 center( rnd.RandomFloat() * 1000.0f, rnd.CRandomFloat() * 1000.0f, rnd.CRandomFloat() * 1000.0f );
+		const idVec3 extents( rnd.RandomFloat() * 64.0f, rnd.RandomFloat() * 64.0f, rnd.RandomFloat() * 64.0f );
+		benchBounds[i][0] = center - extents;
+		benchBounds[i][1] = center + extents;
+
+		idVec3 normal( rnd.CRandomFloat(), rnd.CRandomFloat(), rnd.CRandomFloat() );
+		normal.Normalize();
+		benchPlanes[i].SetNormal( normal );
+		benchPlanes[i].SetDist( rnd.CRandomFloat() * 100.0f );
+	}
+
+	for( int i = 0; i < 2; i++ )
+	{
+		benchFloats[i] = ( float* )Mem_Alloc16( BENCH_NUM_VERTS * sizeof( float ), TAG_MATH );
+	}
+	benchCulled = ( byte* )Mem_Alloc16( BENCH_NUM_BOUNDS, TAG_MATH );
+
+	idRenderMatrix view, projection;
+	idRenderMatrix::CreateViewMatrix( vec3_origin, mat3_identity, view );
+	idRenderMatrix::CreateProjectionMatrixFov( 90.0f, 73.74f, 1.0f, 0.0f, 0.0f, 0.0f, projection );
+	idRenderMatrix::Multiply( projection, view, benchMVP );
+}
+
+/*
+========================
+Bench_FreeSIMDData
+========================
+*/
+static void Bench_FreeSIMDData()
+{
+	Mem_Free16( benchJointQuats );
+	Mem_Free16( benchBlendQuats );
+	Mem_Free16( benchJointMats );
+	Mem_Free16( benchVerts );
+	Mem_Free16( benchIndexes );
+	for( int i = 0; i < 3; i++ )
+	{
+		Mem_Free16( benchTangents[i] );
+	}
+	Mem_Free16( benchBounds );
+	Mem_Free16( benchPlanes );
+	for( int i = 0; i < 2; i++ )
+	{
+		Mem_Free16( benchFloats[i] );
+	}
+	Mem_Free16( benchCulled );
+}
+
+static unsigned int Bench_SIMDMinMax( int iterations )
+{
+	idVec3 mins, maxs;
+	for( int it = 0; it < iterations; it++ )
+	{
+		benchSIMD->MinMax( mins, maxs, benchVerts, BENCH_NUM_VERTS );
+	}
+	return Bench_HashFloats( mins.ToFloatPtr(), 3 ) ^ Bench_HashFloats( maxs.ToFloatPtr(), 3 );
+}
+
+static unsigned int Bench_SIMDMinMaxIndexed( int iterations )
+{
+	idVec3 mins, maxs;
+	for( int it = 0; it < iterations; it++ )
+	{
+		benchSIMD->MinMax( mins, maxs, benchVerts, benchIndexes, BENCH_NUM_INDEXES );
+	}
+	return Bench_HashFloats( mins.ToFloatPtr(), 3 ) ^ Bench_HashFloats( maxs.ToFloatPtr(), 3 );
+}
+
+static unsigned int Bench_SIMDBlendJoints( int iterations )
+{
+	idJointQuat* joints = ( idJointQuat* )_alloca16( BENCH_NUM_JOINTS * sizeof( idJointQuat ) );
+	for( int it = 0; it < iterations; it++ )
+	{
+		memcpy( joints, benchJointQuats, BENCH_NUM_JOINTS * sizeof( idJointQuat ) );
+		benchSIMD->BlendJoints( joints, benchBlendQuats, 0.3f, benchJointIndex, BENCH_NUM_JOINTS );
+	}
+	return Bench_HashFloats( joints[BENCH_NUM_JOINTS - 1].t.ToFloatPtr(), 3 );
+}
+
+static unsigned int Bench_SIMDConvertJoints( int iterations )
+{
+	for( int it = 0; it < iterations; it++ )
+	{
+		benchSIMD->ConvertJointQuatsToJointMats( benchJointMats, benchJointQuats, BENCH_NUM_JOINTS );
+	}
+	return Bench_HashFloats( benchJointMats[BENCH_NUM_JOINTS - 1].ToFloatPtr(), 12 );
+}
+
+static unsigned int Bench_SIMDTransformJoints( int iterations )
+{
+	for( int it = 0; it < iterations; it++ )
+	{
+		benchSIMD->ConvertJointQuatsToJointMats( benchJointMats, benchJointQuats, BENCH_NUM_JOINTS );
+		benchSIMD->TransformJoints( benchJointMats, benchJointParents, 1, BENCH_NUM_JOINTS - 1 );
+	}
+	return Bench_HashFloats( benchJointMats[BENCH_NUM_JOINTS - 1].ToFloatPtr(), 12 );
+}
+
+static unsigned int Bench_SIMDCullBounds( int iterations )
+{
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		benchSIMD->CullBoundsToMVP( benchCulled, benchMVP, benchBounds, BENCH_NUM_BOUNDS, true );
+		sum += benchCulled[it % BENCH_NUM_BOUNDS];
+	}
+	return sum ^ CRC32_BlockChecksum( benchCulled, BENCH_NUM_BOUNDS );
+}
+
+static unsigned int Bench_SIMDDepthBounds( int iterations )
+{
+	for( int it = 0; it < iterations; it++ )
+	{
+		benchSIMD->DepthBoundsForBounds( benchFloats[0], benchFloats[1], benchMVP, benchBounds, BENCH_NUM_BOUNDS, true );
+	}
+	return Bench_HashFloats( benchFloats[0], BENCH_NUM_BOUNDS ) ^ Bench_HashFloats( benchFloats[1], BENCH_NUM_BOUNDS );
+}
+
+static unsigned int Bench_SIMDDotPlanes( int iterations )
+{
+	const idVec3 point( 1.0f, 2.0f, 3.0f );
+	for( int it = 0; it < iterations; it++ )
+	{
+		benchSIMD->Dot( benchFloats[0], point, benchPlanes, BENCH_NUM_BOUNDS );
+	}
+	return Bench_HashFloats( benchFloats[0], BENCH_NUM_BOUNDS );
+}
+
+static unsigned int Bench_SIMDTangentFrames( int iterations )
+{
+	for( int it = 0; it < iterations; it++ )
+	{
+		for( int i = 0; i < 3; i++ )
+		{
+			memset( benchTangents[i], 0, BENCH_NUM_VERTS * sizeof( idVec3 ) );
+		}
+		benchSIMD->DeriveTangentFrames( benchTangents[0], benchTangents[1], benchTangents[2], benchVerts, benchIndexes, BENCH_NUM_INDEXES );
+	}
+	return Bench_HashFloats( benchTangents[0][BENCH_NUM_VERTS / 2].ToFloatPtr(), 3 );
+}
+
+/*
+==============================================================
+
+	hashing and compression
+
+==============================================================
+*/
+
+static unsigned int Bench_CRC32( int iterations )
+{
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		sum += CRC32_BlockChecksum( benchText.c_str(), benchText.Length() );
+	}
+	return sum;
+}
+
+static unsigned int Bench_MD5( int iterations )
+{
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		sum += MD5_BlockChecksum( benchText.c_str(), benchText.Length() );
+	}
+	return sum;
+}
+
+/*
+========================
+Bench_Compress
+========================
+*/
+static unsigned int Bench_Compress( idCompressor* compressor, int iterations )
+{
+	unsigned int sum = 0;
+	for( int it = 0; it < iterations; it++ )
+	{
+		idFile_Memory compressed( "compressed" );
+		compressor->Init( &compressed, true, 8 );
+		compressor->Write( benchText.c_str(), benchText.Length() );
+		compressor->FinishCompress();
+
+		idFile_Memory source( "source", ( const char* )compressed.GetDataPtr(), compressed.Length() );
+		idTempArray<char> decompressed( benchText.Length() );
+		compressor->Init( &source, false, 8 );
+		compressor->Read( decompressed.Ptr(), benchText.Length() );
+
+		sum += CRC32_BlockChecksum( decompressed.Ptr(), benchText.Length() ) + compressed.Length();
+	}
+	delete compressor;
+	return sum;
+}
+
+static unsigned int Bench_CompressHuffman( int iterations )
+{
+	return Bench_Compress( idCompressor::AllocHuffman(), iterations );
+}
+
+static unsigned int Bench_CompressArithmetic( int iterations )
+{
+	return Bench_Compress( idCompressor::AllocArithmetic(), iterations );
+}
+
+static unsigned int Bench_CompressLZSS( int iterations )
+{
+	return Bench_Compress( idCompressor::AllocLZSS(), iterations );
+}
+
+static unsigned int Bench_CompressLZW( int iterations )
+{
+	return Bench_Compress( idCompressor::AllocLZW(), iterations );
+}
+
+/*
+==============================================================
+
+	benchmark tables
+
+==============================================================
+*/
+
+static const benchmark_t benchmarks[] =
+{
+	{ "heap/alloc_free",			Bench_HeapAllocFree,		2000 },
+	{ "list/append",				Bench_ListAppend,			2000 },
+	{ "list/sort",					Bench_ListSort,				200 },
+	{ "list/findindex",				Bench_ListFindIndex,		20000 },
+	{ "hashindex/add_find",			Bench_HashIndexAddFind,		2000 },
+	{ "hashindex/lookup",			Bench_HashIndexLookup,		200 },
+	{ "flathashindex/add_find",		Bench_FlatHashIndexAddFind,	2000 },
+	{ "flathashindex/lookup",		Bench_FlatHashIndexLookup,	200 },
+	{ "dict/set_get",				Bench_DictSetGet,			2000 },
+	{ "dict/copy",					Bench_DictCopy,				5000 },
+	{ "dict/get_string",			Bench_DictGetString,		5000 },
+	{ "dict/get_key_handle",		Bench_DictGetKeyHandle,		5000 },
+	{ "strpool/alloc_free",			Bench_StrPoolAllocFree,		1000 },
+	{ "lexer/tokens",				Bench_LexerTokens,			20 },
+	{ "parser/tokens",				Bench_ParserTokens,			20 },
+	{ "lexer/map",					Bench_LexerMap,				5 },
+	{ "lexer/map_scalar",			Bench_LexerMapScalar,		5 },
+	{ "parser/dict",				Bench_DictParse,			20 },
+	{ "bitmsg/write_read",			Bench_BitMsgWriteRead,		1000 },
+	{ "math/vec3_normalize",		Bench_Vec3Normalize,		2000 },
+	{ "math/mat3_multiply",			Bench_Mat3Multiply,			20000 },
+	{ "math/mat4_inverse",			Bench_Mat4Inverse,			20000 },
+	{ "math/quat_slerp",			Bench_QuatSlerp,			20000 },
+	{ "math/sincos_sqrt",			Bench_MathSinCos,			2000 },
+	{ "hash/crc32",					Bench_CRC32,				100 },
+	{ "hash/md5",					Bench_MD5,					100 },
+	{ "compress/huffman",			Bench_CompressHuffman,		10 },
+	{ "compress/arithmetic",		Bench_CompressArithmetic,	10 },
+	{ "compress/lzss",				Bench_CompressLZSS,			10 },
+	{ "compress/lzw",				Bench_CompressLZW,			10 },
+};
+
+static const benchmark_t simdBenchmarks[] =
+{
+	{ "minmax",						Bench_SIMDMinMax,			5000 },
+	{ "minmax_indexed",				Bench_SIMDMinMaxIndexed,	2000 },
+	{ "blend_joints",				Bench_SIMDBlendJoints,		20000 },
+	{ "convert_joints",				Bench_SIMDConvertJoints,	20000 },
+	{ "transform_joints",			Bench_SIMDTransformJoints,	20000 },
+	{ "cull_bounds",				Bench_SIMDCullBounds,		5000 },
+	{ "depth_bounds",				Bench_SIMDDepthBounds,		5000 },
+	{ "dot_planes",					Bench_SIMDDotPlanes,		20000 },
+	{ "tangent_frames",				Bench_SIMDTangentFrames,	500 },
+};
+
+/*
+========================
+Bench_WriteJSON
+========================
+*/
+static void Bench_WriteJSON( FILE* f, const idList<benchResult_t>& results, int repeat )
+{
+	fprintf( f, "{\n" );
+	fprintf( f, "\t\"version\": %d,\n", BENCH_VERSION );
+	fprintf( f, "\t\"seed\": %d,\n", BENCH_SEED );
+	fprintf( f, "\t\"repeat\": %d,\n", repeat );
+	fprintf( f, "\t\"engine\": \"%s\",\n", ENGINE_VERSION );
+	fprintf( f, "\t\"results\": [\n" );
+	for( int i = 0; i < results.Num(); i++ )
+	{
+		const benchResult_t& r = results[i];
+		fprintf( f, "\t\t{ \"name\": \"%s\", \"iterations\": %d, \"best_ns\": %.2f, \"median_ns\": %.2f, \"checksum\": \"%08x\", \"stable\": %s }%s\n",
+				 r.name.c_str(), r.iterations, r.bestNsec, r.medianNsec, r.checksum, r.stable ? "true" : "false", ( i < results.Num() - 1 ) ? "," : "" );
+	}
+	fprintf( f, "\t]\n" );
+	fprintf( f, "}\n" );
+}
+
+/*
+==============================================================
+
+	main
+
+==============================================================
+*/
+
+int main( int argc, char** argv )
+{
+	const char* outputName = NULL;
+	const char* filter = NULL;
+	int repeat = BENCH_DEFAULT_REPEAT;
+	bool listOnly = false;
+	idList<const char*> mapNames;
+
+	for( int i = 1; i < argc; i++ )
+	{
+		if( idStr::Icmp( argv[i], "-o" ) == 0 && i + 1 < argc )
+		{
+			outputName = argv[++i];
+		}
+		else if( idStr::Icmp( argv[i], "-r" ) == 0 && i + 1 < argc )
+		{
+			repeat = idMath::ClampInt( 1, 1000, atoi( argv[++i] ) );
+		}
+		else if( idStr::Icmp( argv[i], "-f" ) == 0 && i + 1 < argc )
+		{
+			filter = argv[++i];
+		}
+		else if( idStr::Icmp( argv[i], "-l" ) == 0 )
+		{
+			listOnly = true;
+		}
+		else if( idStr::Icmp( argv[i], "-m" ) == 0 && i + 1 < argc )
+		{
+			mapNames.Append( argv[++i] );
+		}
+		else
+		{
+			fprintf( stderr, "usage: idlibbench [-o <file.json>] [-r <repeat>] [-f <filter>] [-m <file.map>] [-l]\n" );
+			return 1;
+		}
+	}
+
+	idLib::common = common;
+	idLib::sys = sys;
+	idLib::Init();
+
+	Bench_InitData();
+	for( int i = 0; i < mapNames.Num(); i++ )
+	{
+		if( !Bench_LoadMapText( mapNames[i] ) )
+		{
+			fprintf( stderr, "couldn't read %s\n", mapNames[i] );
+			return 1;
+		}
+	}
+	Bench_InitMapText();
+	Bench_InitSIMDData();
+
+	// benchmark every processor the CPU supports, not only the one idSIMD would pick
+	idList<idSIMDProcessor*> processors;
+	idStrList processorNames;
+	processors.Append( new( TAG_MATH ) idSIMD_Generic );
+	processorNames.Append( "generic" );
+#if defined(USE_INTRINSICS_SSE)
+	processors.Append( new( TAG_MATH ) idSIMD_SSE );
+	processorNames.Append( "sse" );
+#endif
+#if defined(USE_INTRINSICS_AVX2)
+	if( idSIMD_AVX2::CPUSupported() )
+	{
+		processors.Append( new( TAG_MATH ) idSIMD_AVX2 );
+		processorNames.Append( "avx2" );
+	}
+#endif
+
+	idList<benchResult_t> results;
+
+	for( int i = 0; i < sizeof( benchmarks ) / sizeof( benchmarks[0] ); i++ )
+	{
+		const benchmark_t& b = benchmarks[i];
+		if( filter != NULL && idStr::FindText( b.name, filter, false ) == -1 )
+		{
+			continue;
+		}
+		if( listOnly )
+		{
+			printf( "%s\n", b.name );
+			continue;
+		}
+		Bench_Run( b.name, b.func, b.iterations, repeat, results );
+	}
+
+	for( int p = 0; p < processors.Num(); p++ )
+	{
+		benchSIMD = processors[p];
+
+		for( int i = 0; i < sizeof( simdBenchmarks ) / sizeof( simdBenchmarks[0] ); i++ )
+		{
+			const benchmark_t& b = simdBenchmarks[i];
+			const idStr name = va( "simd/%s/%s", processorNames[p].c_str(), b.name );
+			if( filter != NULL && name.Find( filter, false ) == -1 )
+			{
+				continue;
+			}
+			if( listOnly )
+			{
+				printf( "%s\n", name.c_str() );
+				continue;
+			}
+			Bench_Run( name, b.func, b.iterations, repeat, results );
+		}
+	}
+
+	if( !listOnly )
+	{
+		FILE* f = stdout;
+		if( outputName != NULL )
+		{
+			f = fopen( outputName, "w" );
+			if( f == NULL )
+			{
+				idLib::common->FatalError( "couldn't open %s for writing", outputName );
+			}
+		}
+		Bench_WriteJSON( f, results, repeat );
+		if( f != stdout )
+		{
+			fclose( f );
+		}
+	}
+
+	processors.DeleteContents();
+	Bench_FreeSIMDData();
+
+	idLib::ShutDown();
+
+	return 0;
+}